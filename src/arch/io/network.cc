@@ -5,6 +5,7 @@
 #include <errno.h>
 #include <fcntl.h>
 #include <inttypes.h>
+#include <limits.h>
 #include <string.h>
 #include <sys/types.h>
 
@@ -19,6 +20,7 @@
 #include <netinet/tcp.h>
 #include <sys/ioctl.h>
 #include <sys/socket.h>
+#include <sys/uio.h>
 #endif
 
 #include "arch/io/openssl.hpp"
@@ -217,6 +219,7 @@ linux_tcp_conn_t::linux_tcp_conn_t(const ip_address_t &peer,
         write_queue_limiter(WRITE_QUEUE_MAX_SIZE),
         write_coro_pool(1, &write_queue, &write_handler),
         current_write_buffer(get_write_buffer()),
+        write_buffer_bytes(0),
         drainer(new auto_drainer_t) {
 
 #ifndef _WIN32
@@ -258,6 +261,7 @@ linux_tcp_conn_t::linux_tcp_conn_t(fd_t s) :
        write_queue_limiter(WRITE_QUEUE_MAX_SIZE),
        write_coro_pool(1, &write_queue, &write_handler),
        current_write_buffer(get_write_buffer()),
+       write_buffer_bytes(0),
        drainer(new auto_drainer_t) {
     rassert(sock.get() != INVALID_FD);
 
@@ -524,7 +528,9 @@ linux_tcp_conn_t::write_handler_t::write_handler_t(linux_tcp_conn_t *_parent) :
 { }
 
 void linux_tcp_conn_t::write_handler_t::coro_pool_callback(write_queue_op_t *operation, UNUSED signal_t *interruptor) {
-    if (operation->buffer != nullptr) {
+    if (operation->buffer_group != nullptr) {
+        parent->perform_writev(operation->buffer_group);
+    } else if (operation->buffer != nullptr) {
         parent->perform_write(operation->buffer, operation->size);
         if (operation->dealloc != nullptr) {
             parent->release_write_buffer(operation->dealloc);
@@ -550,6 +556,7 @@ void linux_tcp_conn_t::internal_flush_write_buffer() {
     op->buffer = current_write_buffer->buffer;
     op->size = current_write_buffer->size;
     op->dealloc = current_write_buffer.release();
+    op->buffer_group = nullptr;
     op->cond = nullptr;
     op->keepalive = auto_drainer_t::lock_t(drainer.get());
     current_write_buffer.init(get_write_buffer());
@@ -604,53 +611,122 @@ void linux_tcp_conn_t::perform_write(const void *buf, size_t size) {
     while (size > 0) {
         ssize_t res = ::write(sock.get(), buf, size);
 
-        if (res == -1 && (get_errno() == EAGAIN || get_errno() == EWOULDBLOCK)) {
-            /* Wait for a notification from the event queue, or for an order to
-               shut down */
-            linux_event_watcher_t::watch_t watch(event_watcher.get(), poll_event_out);
-            wait_any_t waiter(&watch, &write_closed);
-            waiter.wait_lazily_unordered();
-
-            if (write_closed.is_pulsed()) {
-                /* We were closed for whatever reason. Whatever signalled us has already called
-                   on_shutdown_write(). */
-                break;
+        if (res <= 0) {
+            if (handle_write_error(res)) {
+                /* Go around the loop and try to write again */
+                continue;
             }
+            break;
+        }
 
-            /* Go around the loop and try to write again */
+        rassert(res <= static_cast<ssize_t>(size));
+        buf = reinterpret_cast<const void *>(reinterpret_cast<const char *>(buf) + res);
+        size -= res;
+        if (write_perfmon) {
+            write_perfmon->record(res);
+        }
+    }
+#endif
+}
 
-        } else if (res == -1 && (get_errno() == EPIPE || get_errno() == ENOTCONN || get_errno() == EHOSTUNREACH ||
-                                 get_errno() == ENETDOWN || get_errno() == EHOSTDOWN || get_errno() == ECONNRESET)) {
-            /* These errors are expected to happen at some point in practice */
-            on_shutdown_write();
-            break;
+void linux_tcp_conn_t::perform_writev(const const_buffer_group_t *buffers) {
+    assert_thread();
 
-        } else if (res == -1) {
-            /* In theory this should never happen, but it probably will. So we write a log message
-               and then shut down normally. */
-            logERR("Could not write to socket: %s", errno_string(get_errno()).c_str());
-            on_shutdown_write();
-            break;
+#ifdef _WIN32
+    for (size_t i = 0; i < buffers->num_buffers(); ++i) {
+        const_buffer_group_t::buffer_t buffer = buffers->get_buffer(i);
+        perform_write(buffer.data, buffer.size);
+    }
+#else
+    if (write_closed.is_pulsed()) {
+        /* See the comment in `perform_write()`. */
+        return;
+    }
+
+    std::vector<iovec> iovecs;
+    iovecs.reserve(buffers->num_buffers());
+    for (size_t i = 0; i < buffers->num_buffers(); ++i) {
+        const_buffer_group_t::buffer_t buffer = buffers->get_buffer(i);
+        if (buffer.size > 0) {
+            iovec iov;
+            iov.iov_base = const_cast<void *>(buffer.data);
+            iov.iov_len = buffer.size;
+            iovecs.push_back(iov);
+        }
+    }
+
+    size_t next = 0;
+    while (next < iovecs.size()) {
+        ssize_t res = ::writev(sock.get(), iovecs.data() + next,
+                               std::min<size_t>(iovecs.size() - next, IOV_MAX));
 
-        } else if (res == 0) {
-            /* This should never happen either, but it's better to write an error message than to
-               crash completely. */
-            logERR("Didn't expect write() to return 0.");
-            on_shutdown_write();
+        if (res <= 0) {
+            if (handle_write_error(res)) {
+                continue;
+            }
             break;
+        }
 
-        } else {
-            rassert(res <= static_cast<ssize_t>(size));
-            buf = reinterpret_cast<const void *>(reinterpret_cast<const char *>(buf) + res);
-            size -= res;
-            if (write_perfmon) {
-                write_perfmon->record(res);
+        if (write_perfmon) {
+            write_perfmon->record(res);
+        }
+        /* Skip the buffers that were written completely, and slide down the one that
+        was written partially. */
+        size_t written = res;
+        while (written > 0) {
+            rassert(next < iovecs.size());
+            if (written >= iovecs[next].iov_len) {
+                written -= iovecs[next].iov_len;
+                ++next;
+            } else {
+                iovecs[next].iov_base =
+                    static_cast<char *>(iovecs[next].iov_base) + written;
+                iovecs[next].iov_len -= written;
+                written = 0;
             }
         }
     }
 #endif
 }
 
+#ifndef _WIN32
+bool linux_tcp_conn_t::handle_write_error(ssize_t res) {
+    rassert(res <= 0);
+
+    if (res == -1 && (get_errno() == EAGAIN || get_errno() == EWOULDBLOCK)) {
+        /* Wait for a notification from the event queue, or for an order to
+           shut down */
+        linux_event_watcher_t::watch_t watch(event_watcher.get(), poll_event_out);
+        wait_any_t waiter(&watch, &write_closed);
+        waiter.wait_lazily_unordered();
+
+        /* If we were closed for whatever reason, whatever signalled us has already
+           called on_shutdown_write(). */
+        return !write_closed.is_pulsed();
+
+    } else if (res == -1 && (get_errno() == EPIPE || get_errno() == ENOTCONN || get_errno() == EHOSTUNREACH ||
+                             get_errno() == ENETDOWN || get_errno() == EHOSTDOWN || get_errno() == ECONNRESET)) {
+        /* These errors are expected to happen at some point in practice */
+        on_shutdown_write();
+        return false;
+
+    } else if (res == -1) {
+        /* In theory this should never happen, but it probably will. So we write a log message
+           and then shut down normally. */
+        logERR("Could not write to socket: %s", errno_string(get_errno()).c_str());
+        on_shutdown_write();
+        return false;
+
+    } else {
+        /* This should never happen either, but it's better to write an error message than to
+           crash completely. */
+        logERR("Didn't expect write() to return 0.");
+        on_shutdown_write();
+        return false;
+    }
+}
+#endif
+
 void linux_tcp_conn_t::write(const void *buf, size_t size, signal_t *closer) THROWS_ONLY(tcp_conn_write_closed_exc_t) {
     write_op_wrapper_t sentry(this, closer);
 
@@ -668,6 +744,7 @@ void linux_tcp_conn_t::write(const void *buf, size_t size, signal_t *closer) THR
     /* Enqueue the write so it will happen eventually */
     op.buffer = buf;
     op.size = size;
+    op.buffer_group = nullptr;
     op.dealloc = nullptr;
     op.cond = &to_signal_when_done;
     write_queue.push(&op);
@@ -699,6 +776,7 @@ void linux_tcp_conn_t::write_buffered(const void *vbuf, size_t size, signal_t *c
 
         memcpy(current_write_buffer->buffer + current_write_buffer->size, buf, chunk);
         current_write_buffer->size += chunk;
+        write_buffer_bytes += chunk;
 
         rassert(current_write_buffer->size <= WRITE_CHUNK_SIZE);
         if (current_write_buffer->size == WRITE_CHUNK_SIZE) {
@@ -714,6 +792,32 @@ void linux_tcp_conn_t::write_buffered(const void *vbuf, size_t size, signal_t *c
     }
 }
 
+void linux_tcp_conn_t::write_gathered(const const_buffer_group_t *buffers, signal_t *closer)
+        THROWS_ONLY(tcp_conn_write_closed_exc_t) {
+    write_op_wrapper_t sentry(this, closer);
+
+    write_queue_op_t op;
+    cond_t to_signal_when_done;
+
+    /* This works like `write()`; see the comments there. */
+    if (current_write_buffer->size > 0) {
+        internal_flush_write_buffer();
+    }
+
+    op.buffer = nullptr;
+    op.size = 0;
+    op.buffer_group = buffers;
+    op.dealloc = nullptr;
+    op.cond = &to_signal_when_done;
+    write_queue.push(&op);
+
+    to_signal_when_done.wait();
+
+    if (write_closed.is_pulsed()) {
+        throw tcp_conn_write_closed_exc_t();
+    }
+}
+
 void linux_tcp_conn_t::writef(signal_t *closer, const char *format, ...) THROWS_ONLY(tcp_conn_write_closed_exc_t) {
     va_list ap;
     va_start(ap, format);
@@ -740,6 +844,7 @@ void linux_tcp_conn_t::flush_buffer(signal_t *closer) THROWS_ONLY(tcp_conn_write
     write_queue_op_t op;
     cond_t to_signal_when_done;
     op.buffer = nullptr;
+    op.buffer_group = nullptr;
     op.dealloc = nullptr;
     op.cond = &to_signal_when_done;
     write_queue.push(&op);
@@ -1047,6 +1152,13 @@ size_t linux_secure_tcp_conn_t::read_internal(void *buffer, size_t size)
     }
 }
 
+void linux_secure_tcp_conn_t::perform_writev(const const_buffer_group_t *buffers) {
+    for (size_t i = 0; i < buffers->num_buffers(); ++i) {
+        const_buffer_group_t::buffer_t buffer = buffers->get_buffer(i);
+        perform_write(buffer.data, buffer.size);
+    }
+}
+
 void linux_secure_tcp_conn_t::perform_write(const void *buffer, size_t size) {
     assert_thread();
 
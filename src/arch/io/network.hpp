@@ -39,6 +39,7 @@
 #include "concurrency/semaphore.hpp"
 #include "concurrency/coro_pool.hpp"
 #include "concurrency/exponential_backoff.hpp"
+#include "containers/buffer_group.hpp"
 #include "containers/intrusive_list.hpp"
 #include "containers/lazy_erase_vector.hpp"
 #include "containers/scoped.hpp"
@@ -144,6 +145,13 @@ public:
     void write_buffered(const void *buf, size_t size, signal_t *closer)
         THROWS_ONLY(tcp_conn_write_closed_exc_t);
 
+    /* write_gathered() is like write(), but it writes the buffers in `buffers` one
+    after the other, straight from where they are (with `writev()` where possible). It
+    doesn't copy them into the connection's write buffer, so it's the cheapest way to
+    send a big message that's spread across several buffers. */
+    void write_gathered(const const_buffer_group_t *buffers, signal_t *closer)
+        THROWS_ONLY(tcp_conn_write_closed_exc_t);
+
     void writef(signal_t *closer, const char *format, ...)
         THROWS_ONLY(tcp_conn_write_closed_exc_t) ATTR_FORMAT(printf, 3, 4);
 
@@ -165,6 +173,13 @@ public:
     transmitted over the network. */
     perfmon_rate_monitor_t *write_perfmon;
 
+    /* Returns the number of bytes that have been copied into the connection's write
+    buffer by `write_buffered()`. Data passed to `write()` or `write_gathered()` isn't
+    copied, so it isn't counted. */
+    uint64_t get_write_buffer_bytes() const {
+        return write_buffer_bytes;
+    }
+
     virtual ~linux_tcp_conn_t() THROWS_NOTHING;
 
     virtual void rethread(threadnum_t thread);
@@ -281,6 +296,8 @@ private:
         write_buffer_t *dealloc;
         const void *buffer;
         size_t size;
+        /* If this isn't null, we write these buffers instead of `buffer`. */
+        const const_buffer_group_t *buffer_group;
         cond_t *cond;
         auto_drainer_t::lock_t keepalive;
     };
@@ -335,6 +352,8 @@ private:
     certain size, we push it onto `write_queue`. */
     scoped_ptr_t<write_buffer_t> current_write_buffer;
 
+    uint64_t write_buffer_bytes;
+
     scoped_ptr_t<auto_drainer_t> drainer;
 
     /* Reads up to the given number of bytes, but not necessarily that many. Simple
@@ -347,6 +366,16 @@ private:
     /* Used to actually perform a write. If the write end of the connection is open, then
     writes `size` bytes from `buffer` to the socket. */
     virtual void perform_write(const void *buffer, size_t size);
+
+    /* Like `perform_write()`, but writes all of the buffers in `buffers`. */
+    virtual void perform_writev(const const_buffer_group_t *buffers);
+
+#ifndef _WIN32
+    /* Deals with a `::write()` or `::writev()` call that returned `res`, which must
+    be zero or negative. Returns `true` if the socket is writable again and the caller
+    should retry, or `false` if the write end of the connection is closed. */
+    bool handle_write_error(ssize_t res);
+#endif
 };
 
 #ifdef ENABLE_TLS
@@ -411,6 +440,10 @@ private:
     writes `size` bytes from `buffer` to the socket. */
     virtual void perform_write(const void *buffer, size_t size);
 
+    /* There's no `writev()` for TLS, so this calls `perform_write()` for each
+    buffer. */
+    virtual void perform_writev(const const_buffer_group_t *buffers);
+
     void shutdown();
     void shutdown_socket();
 
@@ -135,21 +135,25 @@ TLS_with_init(coro_globals_t *, cglobals, nullptr);
 // depends on cglobals.
 std::unique_ptr<perfmon_counter_t> pm_active_coroutines, pm_allocated_coroutines;
 std::unique_ptr<perfmon_duration_sampler_t> pm_eventloop_singleton;
+std::unique_ptr<perfmon_thread_utilization_t> pm_thread_utilization;
 std::unique_ptr<perfmon_multi_membership_t> pm_coroutines_membership;
 
 void init_global_coro_perfmons(int n_threads) {
     pm_active_coroutines.reset(new perfmon_counter_t(n_threads));
     pm_allocated_coroutines.reset(new perfmon_counter_t(n_threads));
     pm_eventloop_singleton.reset(new perfmon_duration_sampler_t(secs_to_ticks(1), false, n_threads));
+    pm_thread_utilization.reset(new perfmon_thread_utilization_t());
     pm_coroutines_membership.reset(new perfmon_multi_membership_t(
         &get_global_perfmon_collection(),
         pm_active_coroutines.get(), "active_coroutines",
         pm_allocated_coroutines.get(), "allocated_coroutines",
-        pm_eventloop_singleton.get(), "eventloop"));
+        pm_eventloop_singleton.get(), "eventloop",
+        pm_thread_utilization.get(), "thread_utilization"));
 }
 
 void destruct_global_coro_perfmons() {
     pm_coroutines_membership.reset();
+    pm_thread_utilization.reset();
     pm_eventloop_singleton.reset();
     pm_allocated_coroutines.reset();
     pm_active_coroutines.reset();
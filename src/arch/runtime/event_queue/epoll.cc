@@ -97,6 +97,8 @@ void epoll_event_queue_t::run() {
         // Caches by Goetz Graege and Pre-Ake Larson).
 
         block_pm_duration event_loop_timer(pm_eventloop_singleton_t::get());
+        thread_busy_period_t busy_period(
+            &linux_thread_pool_t::get_thread()->utilization);
 
         for (int i = 0; i < nevents; i++) {
             if (events[i].data.ptr == nullptr) {
@@ -120,6 +120,7 @@ void iocp_event_queue_t::run() {
                                              &overlapped,
                                              wait_ms);
         DWORD error = res ? NO_ERROR : GetLastError();
+        thread_busy_period_t busy_period(&thread->utilization);
 
         if (timer_cb != nullptr &&
               (error == WAIT_TIMEOUT || next_time_in_nanos < get_ticks())) {
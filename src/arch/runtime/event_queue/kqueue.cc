@@ -67,6 +67,8 @@ void kqueue_event_queue_t::run() {
                               events, MAX_IO_EVENT_PROCESSING_BATCH_SIZE, nullptr);
 
         block_pm_duration event_loop_timer(pm_eventloop_singleton_t::get());
+        thread_busy_period_t busy_period(
+            &linux_thread_pool_t::get_thread()->utilization);
 
         for (int i = 0; i < nevents; i++) {
             if (events[i].udata == nullptr) {
@@ -117,6 +117,8 @@ void poll_event_queue_t::run() {
         guarantee_err(res != -1, "Waiting for poll events failed");
 
         block_pm_duration event_loop_timer(pm_eventloop_singleton_t::get());
+        thread_busy_period_t busy_period(
+            &linux_thread_pool_t::get_thread()->utilization);
 
         int count = 0;
         for (unsigned int i = 0; i < watched_fds.size(); i++) {
@@ -11,6 +11,10 @@ threadnum_t get_thread_id();
 
 int get_num_threads();
 
+// Returns the fraction of the recent past that `thread` spent working rather than
+// waiting for events, between 0 and 1. Can be called from any thread.
+double get_thread_utilization(threadnum_t thread);
+
 #ifndef NDEBUG
 bool in_thread_pool();
 void assert_good_thread_id(threadnum_t thread);
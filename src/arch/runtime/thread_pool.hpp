@@ -14,6 +14,7 @@
 #include "arch/runtime/system_event.hpp"
 #include "arch/runtime/message_hub.hpp"
 #include "arch/runtime/coroutines.hpp"
+#include "arch/runtime/thread_utilization.hpp"
 #include "arch/io/blocker_pool.hpp"
 #include "arch/io/timer_provider.hpp"
 #include "arch/timer.hpp"
@@ -198,6 +199,9 @@ public:
     linux_message_hub_t message_hub;
     timer_handler_t timer_handler;
 
+    /* Updated by `queue`, read by `get_thread_utilization()` */
+    thread_utilization_t utilization;
+
     /* Never accessed; its constructor and destructor set up and tear down thread-local variables
     for coroutines. */
     coro_runtime_t coro_runtime;
@@ -0,0 +1,52 @@
+// Copyright 2010-2016 RethinkDB, all rights reserved.
+#include "arch/runtime/thread_utilization.hpp"
+
+#include <algorithm>
+
+#include "config/args.hpp"
+#include "utils.hpp"
+
+static const ticks_t window_ticks = THREAD_UTILIZATION_WINDOW_MS * MILLION;
+
+thread_utilization_t::thread_utilization_t() :
+    busy_since(0),
+    window_start(get_ticks()),
+    busy_in_window(0),
+    last_window_utilization(0) { }
+
+void thread_utilization_t::begin_busy() {
+    busy_since.store(get_ticks(), std::memory_order_relaxed);
+}
+
+void thread_utilization_t::end_busy() {
+    ticks_t now = get_ticks();
+    ticks_t busy = busy_in_window.load(std::memory_order_relaxed)
+        + (now - busy_since.load(std::memory_order_relaxed));
+    busy_since.store(0, std::memory_order_relaxed);
+    ticks_t start = window_start.load(std::memory_order_relaxed);
+    if (now - start >= window_ticks) {
+        last_window_utilization.store(
+            std::min(1.0, static_cast<double>(busy) / (now - start)),
+            std::memory_order_relaxed);
+        busy_in_window.store(0, std::memory_order_relaxed);
+        window_start.store(now, std::memory_order_relaxed);
+    } else {
+        busy_in_window.store(busy, std::memory_order_relaxed);
+    }
+}
+
+double thread_utilization_t::get() const {
+    ticks_t now = get_ticks();
+    ticks_t start = window_start.load(std::memory_order_relaxed);
+    if (now > start && now - start >= 2 * window_ticks) {
+        /* The thread has been stuck in a single round of work or waiting for events
+        for a long time, so the last window is out of date. */
+        ticks_t busy = busy_in_window.load(std::memory_order_relaxed);
+        ticks_t since = busy_since.load(std::memory_order_relaxed);
+        if (since != 0 && now > since) {
+            busy += now - since;
+        }
+        return std::min(1.0, static_cast<double>(busy) / (now - start));
+    }
+    return last_window_utilization.load(std::memory_order_relaxed);
+}
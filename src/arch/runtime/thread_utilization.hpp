@@ -0,0 +1,57 @@
+// Copyright 2010-2016 RethinkDB, all rights reserved.
+#ifndef ARCH_RUNTIME_THREAD_UTILIZATION_HPP_
+#define ARCH_RUNTIME_THREAD_UTILIZATION_HPP_
+
+#include <atomic>
+
+#include "errors.hpp"
+#include "time.hpp"
+
+/* `thread_utilization_t` measures which fraction of the time a thread spends handling
+events and messages, as opposed to waiting for them in `epoll_wait()` or its
+equivalent. Each `linux_thread_t` has one, and its event queue calls `begin_busy()`
+and `end_busy()` around every round of work.
+
+The fraction is computed over windows of `THREAD_UTILIZATION_WINDOW_MS`. `get()` may be
+called from any thread; it returns the last complete window, unless the thread hasn't
+finished a window for so long that the current one says more. The fields are updated
+one at a time, so a reader on another thread can see a slightly inconsistent value;
+that's fine for the heuristics that use it. */
+class thread_utilization_t {
+public:
+    thread_utilization_t();
+
+    void begin_busy();
+    void end_busy();
+
+    // Returns a number between 0 and 1.
+    double get() const;
+
+private:
+    // 0 while the thread is waiting for events
+    std::atomic<ticks_t> busy_since;
+    std::atomic<ticks_t> window_start;
+    std::atomic<ticks_t> busy_in_window;
+    std::atomic<double> last_window_utilization;
+
+    DISABLE_COPYING(thread_utilization_t);
+};
+
+/* `thread_busy_period_t` calls `begin_busy()` in its constructor and `end_busy()` in its
+destructor, like `block_pm_duration` does for perfmons. */
+class thread_busy_period_t {
+public:
+    explicit thread_busy_period_t(thread_utilization_t *_utilization)
+        : utilization(_utilization) {
+        utilization->begin_busy();
+    }
+    ~thread_busy_period_t() {
+        utilization->end_busy();
+    }
+private:
+    thread_utilization_t *utilization;
+
+    DISABLE_COPYING(thread_busy_period_t);
+};
+
+#endif  // ARCH_RUNTIME_THREAD_UTILIZATION_HPP_
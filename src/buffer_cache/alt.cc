@@ -258,6 +258,10 @@ txn_t::~txn_t() {
 }
 
 void txn_t::commit() {
+    commit(std::function<void()>());
+}
+
+void txn_t::commit(const std::function<void()> &on_flush_started) {
     cache_->assert_thread();
 
     guarantee(!is_committed_);
@@ -269,12 +273,18 @@ void txn_t::commit() {
             std::bind(&txn_t::inform_tracker,
                 cache_,
                 ph::_1));
+        if (on_flush_started) {
+            on_flush_started();
+        }
     } else {
         cond_t cond;
         cache_->page_cache_.flush_and_destroy_txn(
             std::move(page_txn_),
             std::bind(&txn_t::pulse_and_inform_tracker,
                 cache_, ph::_1, &cond));
+        if (on_flush_started) {
+            on_flush_started();
+        }
         cond.wait();
     }
 }
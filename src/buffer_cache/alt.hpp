@@ -2,6 +2,7 @@
 #ifndef BUFFER_CACHE_ALT_HPP_
 #define BUFFER_CACHE_ALT_HPP_
 
+#include <functional>
 #include <map>
 #include <vector>
 #include <utility>
@@ -96,6 +97,13 @@ public:
     // write-transaction will terminate the server.
     void commit();
 
+    // Like `commit()`, but calls `on_flush_started` as soon as the changes have been
+    // handed to the page cache, before waiting for a `write_durability_t::HARD`
+    // transaction to reach the disk. The caller can use it to release its own locks,
+    // so that later transactions get flushed together with this one instead of
+    // queueing up behind it.
+    void commit(const std::function<void()> &on_flush_started);
+
     cache_t *cache() { return cache_; }
     alt::page_txn_t *page_txn() { return page_txn_.get(); }
     access_t access() const { return access_; }
@@ -107,6 +107,7 @@ bool artificial_reql_cluster_interface_t::table_create(
         const table_generate_config_params_t &config_params,
         const std::string &primary_key,
         write_durability_t durability,
+        int num_cpu_shards,
         signal_t *interruptor,
         ql::datum_t *result_out,
         admin_err_t *error_out) {
@@ -124,6 +125,7 @@ bool artificial_reql_cluster_interface_t::table_create(
         config_params,
         primary_key,
         durability,
+        num_cpu_shards,
         interruptor,
         result_out,
         error_out);
@@ -359,6 +361,27 @@ bool artificial_reql_cluster_interface_t::table_emergency_repair(
         user_context, db, name, mode, dry_run, interruptor, result_out, error_out);
 }
 
+bool artificial_reql_cluster_interface_t::table_set_cpu_shards(
+        auth::user_context_t const &user_context,
+        counted_t<const ql::db_t> db,
+        const name_string_t &name,
+        int num_cpu_shards,
+        bool dry_run,
+        signal_t *interruptor,
+        ql::datum_t *result_out,
+        admin_err_t *error_out) {
+    if (db->name == artificial_reql_cluster_interface_t::database_name) {
+        *error_out = admin_err_t{
+            strprintf("Database `%s` is special; you can't configure the "
+                      "tables in it.", artificial_reql_cluster_interface_t::database_name.c_str()),
+            query_state_t::FAILED};
+        return false;
+    }
+    return next_or_error(error_out) && m_next->table_set_cpu_shards(
+        user_context, db, name, num_cpu_shards, dry_run, interruptor, result_out,
+        error_out);
+}
+
 bool artificial_reql_cluster_interface_t::table_rebalance(
         auth::user_context_t const &user_context,
         counted_t<const ql::db_t> db,
@@ -85,6 +85,7 @@ public:
             const table_generate_config_params_t &config_params,
             const std::string &primary_key,
             write_durability_t durability,
+            int num_cpu_shards,
             signal_t *interruptor,
             ql::datum_t *result_out,
             admin_err_t *error_out);
@@ -167,6 +168,16 @@ public:
             ql::datum_t *result_out,
             admin_err_t *error_out);
 
+    bool table_set_cpu_shards(
+            auth::user_context_t const &user_context,
+            counted_t<const ql::db_t> db,
+            const name_string_t &name,
+            int num_cpu_shards,
+            bool dry_run,
+            signal_t *interruptor,
+            ql::datum_t *result_out,
+            admin_err_t *error_out);
+
     bool table_rebalance(
             auth::user_context_t const &user_context,
             counted_t<const ql::db_t> db,
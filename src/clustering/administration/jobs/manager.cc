@@ -10,6 +10,7 @@
 #include <utility>
 #include <vector>
 
+#include "clustering/administration/tables/table_autobalancer.hpp"
 #include "concurrency/watchable.hpp"
 #include "pprint/js_pprint.hpp"
 #include "rdb_protocol/context.hpp"
@@ -31,12 +32,14 @@ jobs_manager_t::jobs_manager_t(mailbox_manager_t *_mailbox_manager,
                                rdb_context_t *_rdb_context,
                                real_table_persistence_interface_t
                                    *_table_persistence_interface,
-                               multi_table_manager_t *_multi_table_manager) :
+                               multi_table_manager_t *_multi_table_manager,
+                               table_autobalancer_t *_table_autobalancer) :
     mailbox_manager(_mailbox_manager),
     server_id(_server_id),
     rdb_context(_rdb_context),
     table_persistence_interface(_table_persistence_interface),
     multi_table_manager(_multi_table_manager),
+    table_autobalancer(_table_autobalancer),
     get_job_reports_mailbox(_mailbox_manager,
                             std::bind(&jobs_manager_t::on_get_job_reports,
                                       this, ph::_1, ph::_2)),
@@ -59,6 +62,7 @@ void jobs_manager_t::on_get_job_reports(
     std::vector<disk_compaction_job_report_t> disk_compaction_job_reports;
     std::vector<index_construction_job_report_t> index_construction_job_reports;
     std::vector<backfill_job_report_t> backfill_job_reports;
+    std::vector<rebalance_job_report_t> rebalance_job_reports;
 
     if (drainer.is_draining()) {
         // We're shutting down, send an empty reponse since we can't acquire a `drainer`
@@ -69,7 +73,8 @@ void jobs_manager_t::on_get_job_reports(
              query_job_reports,
              disk_compaction_job_reports,
              index_construction_job_reports,
-             backfill_job_reports);
+             backfill_job_reports,
+             rebalance_job_reports);
         return;
     }
 
@@ -121,6 +126,10 @@ void jobs_manager_t::on_get_job_reports(
             server_id);
     }
 
+    if (table_autobalancer != nullptr) {
+        table_autobalancer->get_job_reports(time, &rebalance_job_reports);
+    }
+
     try {
         multi_table_manager->visit_tables(interruptor, access_t::read,
         [&](const namespace_id_t &table_id,
@@ -170,6 +179,7 @@ void jobs_manager_t::on_get_job_reports(
                     table_id,
                     backfill.second.is_ready,
                     backfill.second.progress,
+                    backfill.second.bytes_received,
                     backfill.second.source_server_id,
                     server_id);
             }
@@ -180,7 +190,8 @@ void jobs_manager_t::on_get_job_reports(
              query_job_reports,
              disk_compaction_job_reports,
              index_construction_job_reports,
-             backfill_job_reports);
+             backfill_job_reports,
+             rebalance_job_reports);
     } catch (const interrupted_exc_t &) {
         // Do nothing
     }
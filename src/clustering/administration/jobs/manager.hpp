@@ -19,6 +19,7 @@
 
 class rdb_context_t;
 class reactor_driver_t;
+class table_autobalancer_t;
 
 class jobs_manager_t {
 public:
@@ -27,7 +28,8 @@ public:
                             rdb_context_t *rdb_context,
                             real_table_persistence_interface_t
                                 *table_persistence_interface,
-                            multi_table_manager_t *multi_table_manager);
+                            multi_table_manager_t *multi_table_manager,
+                            table_autobalancer_t *table_autobalancer);
 
     typedef jobs_manager_business_card_t business_card_t;
     jobs_manager_business_card_t get_business_card();
@@ -54,6 +56,7 @@ private:
     rdb_context_t *rdb_context;
     real_table_persistence_interface_t *table_persistence_interface;
     multi_table_manager_t *multi_table_manager;
+    table_autobalancer_t *table_autobalancer;
 
     auto_drainer_t drainer;
 
@@ -55,6 +55,7 @@ backfill_job_report_t::backfill_job_report_t(
         namespace_id_t const &_table,
         bool _is_ready,
         double _progress,
+        uint64_t _bytes_received,
         server_id_t const &_source_server,
         server_id_t const &_destination_server)
     : job_report_base_t<backfill_job_report_t>("backfill", _id, _duration, _server_id),
@@ -62,6 +63,7 @@ backfill_job_report_t::backfill_job_report_t(
       is_ready(_is_ready),
       progress_numerator(_progress),
       progress_denominator(1.0),
+      bytes_received(_bytes_received),
       source_server(_source_server),
       destination_server(_destination_server) {
     servers.insert({source_server, destination_server});
@@ -72,6 +74,7 @@ void backfill_job_report_t::merge_derived(
     is_ready &= job_report.is_ready;
     progress_numerator += job_report.progress_numerator;
     progress_denominator += job_report.progress_denominator;
+    bytes_received += job_report.bytes_received;
 }
 
 bool backfill_job_report_t::info_derived(
@@ -128,10 +131,17 @@ bool backfill_job_report_t::info_derived(
     info_builder_out->overwrite("progress",
         ql::datum_t(progress_numerator / progress_denominator));
 
+    /* The shards of the table are backfilled in parallel, so this is the combined
+    throughput of all of them. `duration` is in microseconds. */
+    info_builder_out->overwrite("bytes_per_sec",
+        duration > 0
+            ? ql::datum_t(static_cast<double>(bytes_received) * 1e6 / duration)
+            : ql::datum_t::null());
+
     return true;
 }
 
-RDB_IMPL_SERIALIZABLE_10_FOR_CLUSTER(
+RDB_IMPL_SERIALIZABLE_11_FOR_CLUSTER(
     backfill_job_report_t,
     type,
     id,
@@ -141,6 +151,7 @@ RDB_IMPL_SERIALIZABLE_10_FOR_CLUSTER(
     is_ready,
     progress_numerator,
     progress_denominator,
+    bytes_received,
     source_server,
     destination_server);
 
@@ -255,6 +266,64 @@ bool query_job_report_t::info_derived(
 RDB_IMPL_SERIALIZABLE_7_FOR_CLUSTER(
     query_job_report_t, type, id, duration, servers, client_addr_port, query, user_context);
 
+rebalance_job_report_t::rebalance_job_report_t()
+    : job_report_base_t<rebalance_job_report_t>() { }
+
+rebalance_job_report_t::rebalance_job_report_t(
+        uuid_u const &_id,
+        double _duration,
+        server_id_t const &_server_id,
+        namespace_id_t const &_table,
+        phase_t _phase,
+        double _imbalance)
+    : job_report_base_t<rebalance_job_report_t>("rebalance", _id, _duration, _server_id),
+      table(_table),
+      phase(_phase),
+      imbalance(_imbalance) { }
+
+void rebalance_job_report_t::merge_derived(rebalance_job_report_t const &) { }
+
+bool rebalance_job_report_t::info_derived(
+        admin_identifier_format_t identifier_format,
+        UNUSED server_config_client_t *server_config_client,
+        table_meta_client_t *table_meta_client,
+        cluster_semilattice_metadata_t const &metadata,
+        ql::datum_object_builder_t *info_builder_out) const {
+    ql::datum_t table_name_or_uuid;
+    ql::datum_t db_name_or_uuid;
+    if (!convert_table_id_to_datums(
+            table,
+            identifier_format,
+            metadata,
+            table_meta_client,
+            &table_name_or_uuid,
+            nullptr,
+            &db_name_or_uuid,
+            nullptr)) {
+        return false;
+    }
+    info_builder_out->overwrite("table", table_name_or_uuid);
+    info_builder_out->overwrite("db", db_name_or_uuid);
+
+    switch (phase) {
+        case phase_t::measuring_load:
+            info_builder_out->overwrite("phase", ql::datum_t("measuring_load"));
+            break;
+        case phase_t::moving_boundaries:
+            info_builder_out->overwrite("phase", ql::datum_t("moving_boundaries"));
+            break;
+        default:
+            unreachable();
+    }
+    info_builder_out->overwrite("imbalance",
+        imbalance >= 0 ? ql::datum_t(imbalance) : ql::datum_t::null());
+
+    return true;
+}
+
+RDB_IMPL_SERIALIZABLE_7_FOR_CLUSTER(
+    rebalance_job_report_t, type, id, duration, servers, table, phase, imbalance);
+
 RDB_IMPL_SERIALIZABLE_2_FOR_CLUSTER(jobs_manager_business_card_t,
                                     get_job_reports_mailbox_address,
                                     job_interrupt_mailbox_address);
@@ -60,6 +60,7 @@ public:
             namespace_id_t const &table,
             bool is_ready,
             double progress,
+            uint64_t bytes_received,
             server_id_t const &source_server,
             server_id_t const &destination_server);
 
@@ -76,6 +77,7 @@ public:
     bool is_ready;
     double progress_numerator;
     double progress_denominator;
+    uint64_t bytes_received;
     server_id_t source_server;
     server_id_t destination_server;
 };
@@ -158,12 +160,49 @@ public:
 };
 RDB_DECLARE_SERIALIZABLE_FOR_CLUSTER(query_job_report_t);
 
+/* A table that `table_autobalancer_t` is working on. The backfills that result from
+moving the shard boundaries show up as `backfill_job_report_t`s. */
+class rebalance_job_report_t : public job_report_base_t<rebalance_job_report_t> {
+public:
+    enum class phase_t { measuring_load, moving_boundaries };
+
+    rebalance_job_report_t();
+    rebalance_job_report_t(
+            uuid_u const &id,
+            double duration,
+            server_id_t const &server_id,
+            namespace_id_t const &table,
+            phase_t phase,
+            double imbalance);
+
+    void merge_derived(rebalance_job_report_t const &job_report);
+
+    bool info_derived(
+            admin_identifier_format_t identifier_format,
+            server_config_client_t *server_config_client,
+            table_meta_client_t *table_meta_client,
+            cluster_semilattice_metadata_t const &metadata,
+            ql::datum_object_builder_t *info_builder_out) const;
+
+    namespace_id_t table;
+    phase_t phase;
+    /* The busiest shard's load relative to the mean, or negative if it hasn't been
+    measured yet */
+    double imbalance;
+};
+ARCHIVE_PRIM_MAKE_RANGED_SERIALIZABLE(
+    rebalance_job_report_t::phase_t, int8_t,
+    rebalance_job_report_t::phase_t::measuring_load,
+    rebalance_job_report_t::phase_t::moving_boundaries);
+RDB_DECLARE_SERIALIZABLE_FOR_CLUSTER(rebalance_job_report_t);
+
 class jobs_manager_business_card_t {
 public:
     typedef mailbox_t<std::vector<query_job_report_t>,
                       std::vector<disk_compaction_job_report_t>,
                       std::vector<index_construction_job_report_t>,
-                      std::vector<backfill_job_report_t>> return_mailbox_t;
+                      std::vector<backfill_job_report_t>,
+                      std::vector<rebalance_job_report_t>> return_mailbox_t;
     typedef mailbox_t<return_mailbox_t::address_t> get_job_reports_mailbox_t;
     typedef mailbox_t<uuid_u, auth::user_context_t> job_interrupt_mailbox_t;
 
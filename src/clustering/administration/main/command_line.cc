@@ -86,6 +86,9 @@
 
 namespace cluster_defaults {
 const int reconnect_timeout = (24 * 60 * 60);    // 24 hours (in secs)
+const int connections_per_peer = 1;
+const int max_connections_per_peer = 16;
+const uint64_t compression_threshold = 0;        // off
 }  // namespace cluster_defaults
 
 MUST_USE bool numwrite(const char *path, int number) {
@@ -543,6 +546,45 @@ optional<int> parse_node_reconnect_timeout_secs_option(
     return optional<int>();
 }
 
+optional<int> parse_cluster_connections_option(
+        const std::map<std::string, options::values_t> &opts) {
+    if (exists_option(opts, "--cluster-connections")) {
+        const std::string connections_opt = get_single_option(opts, "--cluster-connections");
+        uint64_t connections_per_peer;
+        if (!strtou64_strict(connections_opt, 10, &connections_per_peer)
+            || connections_per_peer < 1) {
+            throw std::runtime_error(strprintf(
+                    "ERROR: cluster-connections should be a positive number, got '%s'",
+                    connections_opt.c_str()));
+        }
+        if (connections_per_peer > static_cast<uint64_t>(cluster_defaults::max_connections_per_peer)) {
+            throw std::runtime_error(strprintf(
+                    "ERROR: cluster-connections is too large. Must be at most %d",
+                    cluster_defaults::max_connections_per_peer));
+        }
+        return optional<int>(static_cast<int>(connections_per_peer));
+    }
+
+    return optional<int>();
+}
+
+optional<uint64_t> parse_cluster_compression_threshold_option(
+        const std::map<std::string, options::values_t> &opts) {
+    if (exists_option(opts, "--cluster-compression-threshold")) {
+        const std::string threshold_opt =
+            get_single_option(opts, "--cluster-compression-threshold");
+        uint64_t threshold;
+        if (!strtou64_strict(threshold_opt, 10, &threshold)) {
+            throw std::runtime_error(strprintf(
+                    "ERROR: cluster-compression-threshold should be a number of bytes, "
+                    "got '%s'", threshold_opt.c_str()));
+        }
+        return optional<uint64_t>(threshold);
+    }
+
+    return optional<uint64_t>();
+}
+
 /* An empty outer `optional` means the `--cache-size` parameter is not present. An
 empty inner `optional` means the cache size is set to `auto`. */
 optional<optional<uint64_t> > parse_total_cache_size_option(
@@ -1646,6 +1688,22 @@ options::help_section_t get_network_options(const bool join_required, std::vecto
                                                     "before giving up, the default is "
                                                     "24 hours");
 
+    options_out->push_back(options::option_t(options::names_t("--cluster-connections"),
+                                             options::OPTIONAL,
+                                             strprintf("%d", cluster_defaults::connections_per_peer)));
+    help.add("--cluster-connections n", "number of TCP connections to open to each "
+                                        "other server, each served by its own thread; "
+                                        "ignored when --client-port is set");
+
+    options_out->push_back(options::option_t(options::names_t("--cluster-compression-threshold"),
+                                             options::OPTIONAL,
+                                             strprintf("%" PRIu64, cluster_defaults::compression_threshold)));
+    help.add("--cluster-compression-threshold bytes", "compress the messages to other "
+                                                      "servers that are at least this big, "
+                                                      "if the other server supports it; 0 "
+                                                      "turns compression off, which is the "
+                                                      "default");
+
     return help;
 }
 
@@ -2080,6 +2138,9 @@ int main_rethinkdb_serve(int argc, char *argv[]) {
         optional<int> join_delay_secs = parse_join_delay_secs_option(opts);
         optional<int> node_reconnect_timeout_secs =
             parse_node_reconnect_timeout_secs_option(opts);
+        optional<int> connections_per_peer = parse_cluster_connections_option(opts);
+        optional<uint64_t> compression_threshold =
+            parse_cluster_compression_threshold_option(opts);
 
         // Open and lock the directory, but do not create it
         bool is_new_directory = false;
@@ -2121,6 +2182,8 @@ int main_rethinkdb_serve(int argc, char *argv[]) {
                                 std::vector<std::string>(argv, argv + argc),
                                 join_delay_secs.value_or(0),
                                 node_reconnect_timeout_secs.value_or(cluster_defaults::reconnect_timeout),
+                                connections_per_peer.value_or(cluster_defaults::connections_per_peer),
+                                compression_threshold.value_or(cluster_defaults::compression_threshold),
                                 tls_configs);
 
         const file_direct_io_mode_t direct_io_mode = parse_direct_io_mode_option(opts);
@@ -2181,6 +2244,9 @@ int main_rethinkdb_proxy(int argc, char *argv[]) {
         optional<int> join_delay_secs = parse_join_delay_secs_option(opts);
         optional<int> node_reconnect_timeout_secs =
             parse_node_reconnect_timeout_secs_option(opts);
+        optional<int> connections_per_peer = parse_cluster_connections_option(opts);
+        optional<uint64_t> compression_threshold =
+            parse_cluster_compression_threshold_option(opts);
 
 #ifndef _WIN32
         get_and_set_user_group(opts);
@@ -2223,6 +2289,8 @@ int main_rethinkdb_proxy(int argc, char *argv[]) {
                                 std::vector<std::string>(argv, argv + argc),
                                 join_delay_secs.value_or(0),
                                 node_reconnect_timeout_secs.value_or(cluster_defaults::reconnect_timeout),
+                                connections_per_peer.value_or(cluster_defaults::connections_per_peer),
+                                compression_threshold.value_or(cluster_defaults::compression_threshold),
                                 tls_configs);
 
         bool result;
@@ -2344,6 +2412,9 @@ int main_rethinkdb_porcelain(int argc, char *argv[]) {
         optional<int> join_delay_secs = parse_join_delay_secs_option(opts);
         optional<int> node_reconnect_timeout_secs =
             parse_node_reconnect_timeout_secs_option(opts);
+        optional<int> connections_per_peer = parse_cluster_connections_option(opts);
+        optional<uint64_t> compression_threshold =
+            parse_cluster_compression_threshold_option(opts);
 
         // Attempt to create the directory early so that the log file can use it.
         // If we create the file, it will be cleaned up unless directory_initialized()
@@ -2410,6 +2481,8 @@ int main_rethinkdb_porcelain(int argc, char *argv[]) {
                                 std::vector<std::string>(argv, argv + argc),
                                 join_delay_secs.value_or(0),
                                 node_reconnect_timeout_secs.value_or(cluster_defaults::reconnect_timeout),
+                                connections_per_peer.value_or(cluster_defaults::connections_per_peer),
+                                compression_threshold.value_or(cluster_defaults::compression_threshold),
                                 tls_configs);
 
         const file_direct_io_mode_t direct_io_mode = parse_direct_io_mode_option(opts);
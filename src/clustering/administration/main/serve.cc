@@ -28,6 +28,7 @@
 #include "clustering/administration/servers/config_client.hpp"
 #include "clustering/administration/servers/network_logger.hpp"
 #include "clustering/administration/tables/name_resolver.hpp"
+#include "clustering/administration/tables/table_autobalancer.hpp"
 #include "clustering/table_manager/table_meta_client.hpp"
 #include "clustering/table_manager/multi_table_manager.hpp"
 #include "containers/incremental_lenses.hpp"
@@ -233,6 +234,8 @@ bool do_serve(io_backender_t *io_backender,
                 serve_info.join_delay_secs,
                 serve_info.ports.port,
                 serve_info.ports.client_port,
+                serve_info.connections_per_peer,
+                serve_info.compression_threshold,
                 semilattice_manager_heartbeat.get_root_view(),
                 semilattice_manager_auth.get_root_view(),
                 serve_info.tls_configs.cluster.get()));
@@ -388,6 +391,16 @@ bool do_serve(io_backender_t *io_backender,
                 semilattice_manager_cluster.get_root_view()->get(),
                 stop_cond);
 
+            /* `table_autobalancer` periodically moves the shard boundaries of the
+            tables with `auto_rebalance` set that this server looks after, if their load
+            has become uneven. */
+            scoped_ptr_t<table_autobalancer_t> table_autobalancer;
+            if (i_am_a_server) {
+                table_autobalancer.init(new table_autobalancer_t(
+                    &real_reql_cluster_interface,
+                    server_id));
+            }
+
             /* `jobs_manager_t` keeps track of all of the running jobs on this server.
             When the user reads the `rethinkdb.jobs` table, it sends messages to the
             `jobs_manager_t` on each server to get information about running jobs. */
@@ -398,7 +411,9 @@ bool do_serve(io_backender_t *io_backender,
                 /* A `table_persistence_interface` is only instantiated when
                 `i_am_a_server` is true, and a `nullptr` otherwise. */
                 table_persistence_interface.get_or_null(),
-                multi_table_manager.get());
+                multi_table_manager.get(),
+                /* Likewise for `table_autobalancer`. */
+                table_autobalancer.get_or_null());
 
             /* When the user reads the `rethinkdb.stats` table, it sends messages to the
             `stat_manager_t` on each server to get the stats information. */
@@ -117,6 +117,8 @@ public:
                  std::vector<std::string> &&_argv,
                  const int _join_delay_secs,
                  const int _node_reconnect_timeout_secs,
+                 const int _connections_per_peer,
+                 const uint64_t _compression_threshold,
                  tls_configs_t _tls_configs) :
         joins(std::move(_joins)),
         reql_http_proxy(std::move(_reql_http_proxy)),
@@ -125,7 +127,9 @@ public:
         config_file(_config_file),
         argv(std::move(_argv)),
         join_delay_secs(_join_delay_secs),
-        node_reconnect_timeout_secs(_node_reconnect_timeout_secs)
+        node_reconnect_timeout_secs(_node_reconnect_timeout_secs),
+        connections_per_peer(_connections_per_peer),
+        compression_threshold(_compression_threshold)
     {
         tls_configs = _tls_configs;
     }
@@ -145,6 +149,8 @@ public:
     std::vector<std::string> argv;
     int join_delay_secs;
     int node_reconnect_timeout_secs;
+    int connections_per_peer;
+    uint64_t compression_threshold;
     tls_configs_t tls_configs;
 };
 
@@ -71,6 +71,11 @@ public:
         signal_t *interruptor);
     ~metadata_file_t();
 
+    // How many times the file's index has been written to disk. Write transactions
+    // that commit while another one is being flushed share an index write, so this can
+    // be less than the number of write transactions.
+    uint64_t num_index_writes() const;
+
 private:
     friend class metadata::read_txn_t;
     friend class metadata::write_txn_t;
@@ -189,8 +194,12 @@ public:
     // This acts as a safety check to make sure a transaction
     // is not interrupted in the middle, which could leave the
     // metadata in an inconsistent state.
+    // We release the lock on the file before waiting for the changes to reach the
+    // disk. When many tables write their Raft state at once, the transactions that
+    // were queued up behind us can then be flushed while ours is in flight, and the
+    // `merger_serializer_t` merges their index writes into one.
     void commit() {
-        txn.commit();
+        txn.commit([this]() { rwlock_acq.reset(); });
     }
 
 private:
@@ -313,6 +313,7 @@ void migrate_table(const server_id_t &this_server_id,
             metadata_v1_16::write_ack_config_t::mode_t::single ?
                 ::write_ack_config_t::SINGLE : ::write_ack_config_t::MAJORITY;
     config.config.durability = old_config.config.durability;
+    config.config.auto_rebalance = false;
     config.shard_scheme.split_points = old_config.shard_scheme.split_points;
 
     // Scan the servers in the old shard config - need to remove deleted and nil servers
@@ -361,7 +362,8 @@ void migrate_table(const server_id_t &this_server_id,
         }
     }
 
-    table_raft_state_t raft_state = make_new_table_raft_state(config);
+    table_raft_state_t raft_state =
+        make_new_table_raft_state(config, CPU_SHARDING_FACTOR);
     raft_state.branch_history = branch_history;
     auto own_membership = raft_state.member_ids.find(this_server_id);
 
@@ -430,7 +432,7 @@ void check_for_obsolete_sindexes(io_backender_t *io_backender,
 
                 pmap(CPU_SHARDING_FACTOR, [&](int index) {
                         perfmon_collection_t inner_dummy_stats;
-                        store_t store(cpu_sharding_subspace(index),
+                        store_t store(cpu_sharding_subspace(index, CPU_SHARDING_FACTOR),
                                       multiplexer.proxies[index],
                                       &balancer,
                                       "table_migration",
@@ -479,7 +481,7 @@ void migrate_tables(io_backender_t *io_backender,
 
                 pmap(CPU_SHARDING_FACTOR, [&](int index) {
                         perfmon_collection_t inner_dummy_stats;
-                        store_t store(cpu_sharding_subspace(index),
+                        store_t store(cpu_sharding_subspace(index, CPU_SHARDING_FACTOR),
                                       multiplexer.proxies[index],
                                       &balancer,
                                       "table_migration",
@@ -570,7 +572,8 @@ void migrate_cluster_metadata_to_v2_1(io_backender_t *io_backender,
                       case cluster_version_t::v2_1:
                       case cluster_version_t::v2_2:
                       case cluster_version_t::v2_3:
-                      case cluster_version_t::v2_4_is_latest:
+                      case cluster_version_t::v2_4:
+                      case cluster_version_t::v2_5_is_latest:
                       default:
                         unreachable();
                       }
@@ -590,7 +593,8 @@ void migrate_cluster_metadata_to_v2_1(io_backender_t *io_backender,
                       case cluster_version_t::v2_1:
                       case cluster_version_t::v2_2:
                       case cluster_version_t::v2_3:
-                      case cluster_version_t::v2_4_is_latest:
+                      case cluster_version_t::v2_4:
+                      case cluster_version_t::v2_5_is_latest:
                       default:
                         unreachable();
                       }
@@ -665,7 +669,8 @@ void migrate_auth_metadata_to_v2_1(io_backender_t *io_backender,
                       case cluster_version_t::v2_1:
                       case cluster_version_t::v2_2:
                       case cluster_version_t::v2_3:
-                      case cluster_version_t::v2_4_is_latest:
+                      case cluster_version_t::v2_4:
+                      case cluster_version_t::v2_5_is_latest:
                       default:
                           unreachable();
                       }
@@ -686,7 +691,8 @@ void migrate_auth_metadata_to_v2_1(io_backender_t *io_backender,
                       case cluster_version_t::v2_1:
                       case cluster_version_t::v2_2:
                       case cluster_version_t::v2_3:
-                      case cluster_version_t::v2_4_is_latest:
+                      case cluster_version_t::v2_4:
+                      case cluster_version_t::v2_5_is_latest:
                       default:
                           unreachable();
                       }
@@ -2,6 +2,7 @@
 #include "clustering/administration/persist/table_interface.hpp"
 
 #include <errno.h>
+#include <stdio.h>
 #include <unistd.h>
 
 #include <algorithm>
@@ -20,11 +21,15 @@
 #include "serializer/merger.hpp"
 #include "serializer/translator.hpp"
 
+/* `real_multistore_ptr_t` opens the table's file at `path`, or creates it with
+`num_cpu_shards_if_new` CPU shards if it doesn't exist yet. An existing file keeps the
+number of CPU shards that it was created with. */
 class real_multistore_ptr_t :
     public multistore_ptr_t {
 public:
     real_multistore_ptr_t(
             const namespace_id_t &table_id,
+            int num_cpu_shards_if_new,
             const serializer_filepath_t &path,
             scoped_ptr_t<real_branch_history_manager_t> &&bhm,
             const base_path_t &base_path,
@@ -32,17 +37,22 @@ public:
             cache_balancer_t *cache_balancer,
             rdb_context_t *rdb_context,
             perfmon_collection_t *perfmon_collection_serializers,
-            scoped_ptr_t<thread_allocation_t> &&serializer_thread,
-            std::vector<scoped_ptr_t<thread_allocation_t> > &&store_threads,
+            thread_allocator_t *thread_allocator,
             std::map<
                 namespace_id_t, std::pair<real_multistore_ptr_t *, auto_drainer_t::lock_t>
             > *real_multistores) :
+        num_cpu_shards_(num_cpu_shards_if_new),
         branch_history_manager(std::move(bhm)),
-        serializer_thread_allocation(std::move(serializer_thread)),
-        store_thread_allocations(std::move(store_threads)),
-        map_insertion_sentry(
-            real_multistores, table_id, std::make_pair(this, drainer.lock()))
+        serializer_thread_allocation(new thread_allocation_t(thread_allocator))
     {
+        /* `real_multistores` is `nullptr` for the new multistore that
+        `reshard_multistore()` fills, because the table's old multistore is still in the
+        map at that point. */
+        if (real_multistores != nullptr) {
+            map_insertion_sentry.reset(
+                real_multistores, table_id, std::make_pair(this, drainer.lock()));
+        }
+
         // TODO: If the server gets killed when starting up, we can
         // get a database in an invalid startup state.
 
@@ -79,18 +89,31 @@ public:
         std::vector<serializer_t *> ptrs;
         ptrs.push_back(serializer.get());
         if (create) {
-            serializer_multiplexer_t::create(ptrs, CPU_SHARDING_FACTOR);
+            serializer_multiplexer_t::create(ptrs, num_cpu_shards_);
         }
         multiplexer.init(new serializer_multiplexer_t(ptrs));
+        /* The file has one proxy per CPU shard */
+        num_cpu_shards_ = multiplexer->proxies.size();
+        guarantee(num_cpu_shards_ >= 1 && num_cpu_shards_ <= MAX_CPU_SHARDING_FACTOR,
+            "The data file for table %s has %d CPU shards.",
+            uuid_to_str(table_id).c_str(), num_cpu_shards_);
+        stores.resize(num_cpu_shards_);
+        {
+            on_thread_t thread_switcher_2(thread_allocator->home_thread());
+            for (int i = 0; i < num_cpu_shards_; ++i) {
+                store_thread_allocations.emplace_back(
+                    new thread_allocation_t(thread_allocator));
+            }
+        }
 
-        pmap(CPU_SHARDING_FACTOR, [&](int ix) {
+        pmap(num_cpu_shards_, [&](int ix) {
             // TODO: Exceptions? If exceptions are being thrown in here, nothing is
             // handling them.
 
             on_thread_t thread_switcher_2(store_thread_allocations[ix]->get_thread());
 
             stores[ix].init(new store_t(
-                cpu_sharding_subspace(ix),
+                cpu_sharding_subspace(ix, num_cpu_shards_),
                 multiplexer->proxies[ix],
                 cache_balancer,
                 strprintf("shard_%d", ix),
@@ -129,7 +152,7 @@ public:
         store_thread_allocations.clear();
         map_insertion_sentry.reset();
         drainer.drain();
-        pmap(CPU_SHARDING_FACTOR, [this](int ix) {
+        pmap(num_cpu_shards_, [this](int ix) {
             if (stores[ix].has()) {
                 on_thread_t thread_switcher(stores[ix]->home_thread());
                 stores[ix].reset();
@@ -144,6 +167,10 @@ public:
         }
     }
 
+    int num_cpu_shards() {
+        return num_cpu_shards_;
+    }
+
     branch_history_manager_t *get_branch_history_manager() {
         return branch_history_manager.get();
     }
@@ -170,10 +197,11 @@ public:
     }
 
 private:
+    int num_cpu_shards_;
     scoped_ptr_t<real_branch_history_manager_t> branch_history_manager;
     scoped_ptr_t<serializer_t> serializer;
     scoped_ptr_t<serializer_multiplexer_t> multiplexer;
-    scoped_ptr_t<store_t> stores[CPU_SHARDING_FACTOR];
+    std::vector<scoped_ptr_t<store_t> > stores;
 
     scoped_ptr_t<thread_allocation_t> serializer_thread_allocation;
     std::vector<scoped_ptr_t<thread_allocation_t> > store_thread_allocations;
@@ -280,6 +308,7 @@ void real_table_persistence_interface_t::delete_metadata(
 
 void real_table_persistence_interface_t::load_multistore(
         const namespace_id_t &table_id,
+        int num_cpu_shards,
         metadata_file_t::read_txn_t *metadata_read_txn,
         scoped_ptr_t<multistore_ptr_t> *multistore_ptr_out,
         signal_t *interruptor,
@@ -288,15 +317,26 @@ void real_table_persistence_interface_t::load_multistore(
         new real_branch_history_manager_t(
             table_id, metadata_file, metadata_read_txn, interruptor));
 
-    scoped_ptr_t<thread_allocation_t> serializer_thread(
-        new thread_allocation_t(&thread_allocator));
-    std::vector<scoped_ptr_t<thread_allocation_t> > store_threads;
-    for (size_t i = 0; i < CPU_SHARDING_FACTOR; ++i) {
-        store_threads.emplace_back(new thread_allocation_t(&thread_allocator));
+    /* If we crashed in the middle of `reshard_multistore()`, finish or undo it. The
+    resharded file only exists under its own name until it's complete, and the old
+    file is only deleted after that. */
+    std::string path = file_name_for(table_id).permanent_path();
+    std::string reshard_path = reshard_file_name_for(table_id).permanent_path();
+    if (access(reshard_path.c_str(), F_OK) == 0) {
+        if (access(path.c_str(), F_OK) == 0) {
+            logNTC("Removing incomplete file %s\n", reshard_path.c_str());
+            const int res = ::unlink(reshard_path.c_str());
+            guarantee_err(res == 0 || get_errno() == ENOENT,
+                          "unlink failed for file %s", reshard_path.c_str());
+        } else {
+            const int res = ::rename(reshard_path.c_str(), path.c_str());
+            guarantee_err(res == 0, "rename failed for file %s", reshard_path.c_str());
+        }
     }
 
     multistore_ptr_out->init(new real_multistore_ptr_t(
         table_id,
+        num_cpu_shards,
         file_name_for(table_id),
         std::move(bhm),
         base_path,
@@ -304,19 +344,19 @@ void real_table_persistence_interface_t::load_multistore(
         cache_balancer,
         rdb_context,
         perfmon_collection_serializers,
-        std::move(serializer_thread),
-        std::move(store_threads),
+        &thread_allocator,
         &real_multistores));
 }
 
 void real_table_persistence_interface_t::create_multistore(
         const namespace_id_t &table_id,
+        int num_cpu_shards,
         scoped_ptr_t<multistore_ptr_t> *multistore_ptr_out,
         signal_t *interruptor,
         perfmon_collection_t *perfmon_collection_serializers) {
     metadata_file_t::read_txn_t read_txn(metadata_file, interruptor);
     load_multistore(
-        table_id, &read_txn, multistore_ptr_out, interruptor,
+        table_id, num_cpu_shards, &read_txn, multistore_ptr_out, interruptor,
         perfmon_collection_serializers);
 }
 
@@ -333,11 +373,78 @@ void real_table_persistence_interface_t::destroy_multistore(
                   "unlink failed for file %s", filepath.c_str());
 }
 
+void real_table_persistence_interface_t::reshard_multistore(
+        const namespace_id_t &table_id,
+        int num_cpu_shards,
+        const std::function<void(multistore_ptr_t *, multistore_ptr_t *)> &copy_data,
+        scoped_ptr_t<multistore_ptr_t> *multistore_ptr_inout,
+        signal_t *interruptor,
+        perfmon_collection_t *perfmon_collection_serializers) {
+    guarantee(multistore_ptr_inout->has());
+    std::string path = file_name_for(table_id).permanent_path();
+    std::string reshard_path = reshard_file_name_for(table_id).permanent_path();
+
+    /* Left over from an earlier attempt that didn't finish */
+    int res = ::unlink(reshard_path.c_str());
+    guarantee_err(res == 0 || get_errno() == ENOENT,
+                  "unlink failed for file %s", reshard_path.c_str());
+
+    {
+        scoped_ptr_t<real_branch_history_manager_t> bhm;
+        {
+            metadata_file_t::read_txn_t read_txn(metadata_file, interruptor);
+            bhm.init(new real_branch_history_manager_t(
+                table_id, metadata_file, &read_txn, interruptor));
+        }
+        real_multistore_ptr_t new_multistore(
+            table_id,
+            num_cpu_shards,
+            reshard_file_name_for(table_id),
+            std::move(bhm),
+            base_path,
+            io_backender,
+            cache_balancer,
+            rdb_context,
+            perfmon_collection_serializers,
+            &thread_allocator,
+            nullptr);
+        guarantee(new_multistore.num_cpu_shards() == num_cpu_shards);
+        try {
+            copy_data(multistore_ptr_inout->get(), &new_multistore);
+        } catch (const interrupted_exc_t &) {
+            /* The old multistore is still intact, so we just throw away the new one. The
+            destructor of `new_multistore` closes the file first. */
+            res = ::unlink(reshard_path.c_str());
+            throw;
+        }
+    }
+
+    /* Both multistores are closed, so the new file is complete on disk. */
+    multistore_ptr_inout->reset();
+    logNTC("Replacing file %s with %s\n", path.c_str(), reshard_path.c_str());
+    res = ::unlink(path.c_str());
+    guarantee_err(res == 0 || get_errno() == ENOENT,
+                  "unlink failed for file %s", path.c_str());
+    res = ::rename(reshard_path.c_str(), path.c_str());
+    guarantee_err(res == 0, "rename failed for file %s", reshard_path.c_str());
+
+    cond_t non_interruptor;
+    metadata_file_t::read_txn_t read_txn(metadata_file, &non_interruptor);
+    load_multistore(
+        table_id, num_cpu_shards, &read_txn, multistore_ptr_inout, &non_interruptor,
+        perfmon_collection_serializers);
+}
+
 serializer_filepath_t real_table_persistence_interface_t::file_name_for(
         const namespace_id_t &table_id) {
     return serializer_filepath_t(base_path, uuid_to_str(table_id));
 }
 
+serializer_filepath_t real_table_persistence_interface_t::reshard_file_name_for(
+        const namespace_id_t &table_id) {
+    return serializer_filepath_t(base_path, uuid_to_str(table_id) + "_reshard");
+}
+
 bool real_table_persistence_interface_t::is_gc_active() const {
     for (int thread = 0; thread < get_num_db_threads(); ++thread) {
         std::map<serializer_t *, auto_drainer_t::lock_t> serializers_copy;
@@ -57,23 +57,34 @@ public:
 
     void load_multistore(
         const namespace_id_t &table_id,
+        int num_cpu_shards,
         metadata_file_t::read_txn_t *metadata_read_txn,
         scoped_ptr_t<multistore_ptr_t> *multistore_ptr_out,
         signal_t *interruptor,
         perfmon_collection_t *perfmon_collection_serializers);
     void create_multistore(
         const namespace_id_t &table_id,
+        int num_cpu_shards,
         scoped_ptr_t<multistore_ptr_t> *multistore_ptr_out,
         signal_t *interruptor,
         perfmon_collection_t *perfmon_collection_serializers);
     void destroy_multistore(
         const namespace_id_t &table_id,
         scoped_ptr_t<multistore_ptr_t> *multistore_ptr_in);
+    void reshard_multistore(
+        const namespace_id_t &table_id,
+        int num_cpu_shards,
+        const std::function<void(multistore_ptr_t *, multistore_ptr_t *)> &copy_data,
+        scoped_ptr_t<multistore_ptr_t> *multistore_ptr_inout,
+        signal_t *interruptor,
+        perfmon_collection_t *perfmon_collection_serializers);
 
     bool is_gc_active() const;
 
 private:
     serializer_filepath_t file_name_for(const namespace_id_t &table_id);
+    /* The file that `reshard_multistore()` fills before it replaces the table's file */
+    serializer_filepath_t reshard_file_name_for(const namespace_id_t &table_id);
     threadnum_t pick_thread();
 
     io_backender_t * const io_backender;
@@ -292,6 +292,7 @@ bool real_reql_cluster_interface_t::table_create(
         const table_generate_config_params_t &config_params,
         const std::string &primary_key,
         write_durability_t durability,
+        int num_cpu_shards,
         signal_t *interruptor_on_caller,
         ql::datum_t *result_out,
         admin_err_t *error_out) {
@@ -334,12 +335,14 @@ bool real_reql_cluster_interface_t::table_create(
 
         config.config.write_ack_config = write_ack_config_t::MAJORITY;
         config.config.durability = durability;
+        config.config.auto_rebalance = false;
 
         table_id = generate_uuid();
-        m_table_meta_client->create(table_id, config, &interruptor_on_home);
+        m_table_meta_client->create(
+            table_id, config, num_cpu_shards, &interruptor_on_home);
 
         new_config = convert_table_config_to_datum(table_id,
-            convert_name_to_datum(db->name), config.config,
+            convert_name_to_datum(db->name), config.config, num_cpu_shards,
             admin_identifier_format_t::name, config.server_names);
 
     } catch (const admin_op_exc_t &admin_op_exc) {
@@ -508,7 +511,7 @@ bool real_reql_cluster_interface_t::table_estimate_doc_counts(
 
         /* Perform a distribution query against the database */
         std::map<store_key_t, int64_t> counts;
-        fetch_distribution(table_id, this, &interruptor_on_home, &counts);
+        fetch_distribution(table_id, this, false, &interruptor_on_home, &counts);
 
         /* Match the results of the distribution query against the table's shard
         boundaries */
@@ -659,11 +662,13 @@ void real_reql_cluster_interface_t::reconfigure_internal(
 
     /* Fetch the table's current configuration */
     table_config_and_shards_t old_config;
-    m_table_meta_client->get_config(table_id, interruptor_on_home, &old_config);
+    int num_cpu_shards;
+    m_table_meta_client->get_config(
+        table_id, interruptor_on_home, &old_config, &num_cpu_shards);
 
     // Store the old value of the config and status
     ql::datum_t old_config_datum = convert_table_config_to_datum(
-        table_id, convert_name_to_datum(db->name), old_config.config,
+        table_id, convert_name_to_datum(db->name), old_config.config, num_cpu_shards,
         admin_identifier_format_t::name, old_config.server_names);
 
     artificial_table_backend_t *status_backend =
@@ -689,6 +694,7 @@ void real_reql_cluster_interface_t::reconfigure_internal(
     new_config.config.sindexes = old_config.config.sindexes;
     new_config.config.write_ack_config = old_config.config.write_ack_config;
     new_config.config.durability = old_config.config.durability;
+    new_config.config.auto_rebalance = old_config.config.auto_rebalance;
 
     calculate_split_points_intelligently(
         table_id,
@@ -713,7 +719,7 @@ void real_reql_cluster_interface_t::reconfigure_internal(
 
     // Compute the new value of the config and status
     ql::datum_t new_config_datum = convert_table_config_to_datum(
-        table_id, convert_name_to_datum(db->name), new_config.config,
+        table_id, convert_name_to_datum(db->name), new_config.config, num_cpu_shards,
         admin_identifier_format_t::name, new_config.server_names);
     ql::datum_t new_status;
     if (!status_backend->read_row(
@@ -850,11 +856,13 @@ void real_reql_cluster_interface_t::emergency_repair_internal(
 
     /* Fetch the table's current configuration */
     table_config_and_shards_t old_config;
-    m_table_meta_client->get_config(table_id, interruptor_on_home, &old_config);
+    int num_cpu_shards;
+    m_table_meta_client->get_config(
+        table_id, interruptor_on_home, &old_config, &num_cpu_shards);
 
     // Store the old value of the config and status
     ql::datum_t old_config_datum = convert_table_config_to_datum(
-        table_id, convert_name_to_datum(db->name), old_config.config,
+        table_id, convert_name_to_datum(db->name), old_config.config, num_cpu_shards,
         admin_identifier_format_t::name, old_config.server_names);
 
     artificial_table_backend_t *status_backend =
@@ -907,7 +915,7 @@ void real_reql_cluster_interface_t::emergency_repair_internal(
 
     // Compute the new value of the config and status
     ql::datum_t new_config_datum = convert_table_config_to_datum(
-        table_id, convert_name_to_datum(db->name), new_config.config,
+        table_id, convert_name_to_datum(db->name), new_config.config, num_cpu_shards,
         admin_identifier_format_t::name, new_config.server_names);
     ql::datum_t new_status;
     if (!status_backend->read_row(
@@ -977,6 +985,127 @@ bool real_reql_cluster_interface_t::table_emergency_repair(
         "The table may or may not have been repaired.")
 }
 
+void real_reql_cluster_interface_t::set_cpu_shards_internal(
+        auth::user_context_t const &user_context,
+        const counted_t<const ql::db_t> &db,
+        const namespace_id_t &table_id,
+        int num_cpu_shards,
+        bool dry_run,
+        signal_t *interruptor_on_home,
+        ql::datum_t *result_out)
+        THROWS_ONLY(interrupted_exc_t, no_such_table_exc_t,
+            failed_table_op_exc_t, maybe_failed_table_op_exc_t, admin_op_exc_t) {
+    assert_thread();
+
+    /* Fetch the table's current configuration */
+    table_config_and_shards_t config;
+    int old_num_cpu_shards;
+    m_table_meta_client->get_config(
+        table_id, interruptor_on_home, &config, &old_num_cpu_shards);
+
+    // Store the old value of the config and status
+    ql::datum_t old_config_datum = convert_table_config_to_datum(
+        table_id, convert_name_to_datum(db->name), config.config, old_num_cpu_shards,
+        admin_identifier_format_t::name, config.server_names);
+
+    artificial_table_backend_t *status_backend =
+        artificial_reql_cluster_interface->get_table_backend(
+            name_string_t::guarantee_valid("table_status"),
+            admin_identifier_format_t::name);
+    guarantee(status_backend != nullptr);
+    ql::datum_t old_status;
+    admin_err_t error;
+    if (!status_backend->read_row(
+            user_context,
+            convert_uuid_to_datum(table_id),
+            interruptor_on_home,
+            &old_status,
+            &error)) {
+        throw admin_op_exc_t(error);
+    } else if (!old_status.has()) {
+        throw no_such_table_exc_t();
+    }
+
+    if (num_cpu_shards != old_num_cpu_shards) {
+        if (!m_table_meta_client->set_num_cpu_shards(
+                table_id, num_cpu_shards, dry_run, interruptor_on_home)) {
+            throw admin_op_exc_t(
+                "The table's CPU shards can only be changed while all of its servers "
+                "are connected and it isn't being reconfigured. Wait until the table "
+                "is ready and try again.",
+                query_state_t::FAILED);
+        }
+    }
+
+    // Compute the new value of the config and status
+    ql::datum_t new_config_datum = convert_table_config_to_datum(
+        table_id, convert_name_to_datum(db->name), config.config, num_cpu_shards,
+        admin_identifier_format_t::name, config.server_names);
+    ql::datum_t new_status;
+    if (!status_backend->read_row(
+            user_context,
+            convert_uuid_to_datum(table_id),
+            interruptor_on_home,
+            &new_status,
+            &error)) {
+        throw admin_op_exc_t(error);
+    } else if (!new_status.has()) {
+        throw no_such_table_exc_t();
+    }
+
+    ql::datum_object_builder_t result_builder;
+    if (!dry_run) {
+        result_builder.overwrite("reconfigured", ql::datum_t(1.0));
+        result_builder.overwrite("config_changes",
+            make_replacement_pair(old_config_datum, new_config_datum));
+        result_builder.overwrite("status_changes",
+            make_replacement_pair(old_status, new_status));
+    } else {
+        result_builder.overwrite("reconfigured", ql::datum_t(0.0));
+        result_builder.overwrite("config_changes",
+            make_replacement_pair(old_config_datum, new_config_datum));
+    }
+    *result_out = std::move(result_builder).to_datum();
+}
+
+bool real_reql_cluster_interface_t::table_set_cpu_shards(
+        auth::user_context_t const &user_context,
+        counted_t<const ql::db_t> db,
+        const name_string_t &name,
+        int num_cpu_shards,
+        bool dry_run,
+        signal_t *interruptor_on_caller,
+        ql::datum_t *result_out,
+        admin_err_t *error_out) {
+    guarantee(db->name != name_string_t::guarantee_valid("rethinkdb"),
+        "real_reql_cluster_interface_t should never get queries for system tables");
+
+    cross_thread_signal_t interruptor_on_home(interruptor_on_caller, home_thread());
+    try {
+        on_thread_t thread_switcher(home_thread());
+        namespace_id_t table_id;
+        m_table_meta_client->find(db->id, name, &table_id);
+
+        user_context.require_config_permission(m_rdb_context, db->id, table_id);
+
+        set_cpu_shards_internal(
+            user_context,
+            db,
+            table_id,
+            num_cpu_shards,
+            dry_run,
+            &interruptor_on_home,
+            result_out);
+        return true;
+    } catch (const admin_op_exc_t &admin_op_exc) {
+        *error_out = admin_op_exc.to_admin_err();
+        return false;
+    } CATCH_NAME_ERRORS(db->name, name, error_out)
+      CATCH_OP_ERRORS(db->name, name, error_out,
+        "The table's CPU shards were not changed.",
+        "The table's CPU shards may or may not have been changed.")
+}
+
 void real_reql_cluster_interface_t::rebalance_internal(
         auth::user_context_t const &user_context,
         const namespace_id_t &table_id,
@@ -1009,7 +1138,7 @@ void real_reql_cluster_interface_t::rebalance_internal(
     }
 
     std::map<store_key_t, int64_t> counts;
-    fetch_distribution(table_id, this, interruptor_on_home, &counts);
+    fetch_distribution(table_id, this, false, interruptor_on_home, &counts);
 
     /* If there's not enough data to rebalance, return `rebalanced: 0` but don't report
     an error */
@@ -86,6 +86,7 @@ public:
             const table_generate_config_params_t &config_params,
             const std::string &primary_key,
             write_durability_t durability,
+            int num_cpu_shards,
             signal_t *interruptor,
             ql::datum_t *result_out,
             admin_err_t *error_out);
@@ -172,6 +173,16 @@ public:
             ql::datum_t *result_out,
             admin_err_t *error_out);
 
+    bool table_set_cpu_shards(
+            auth::user_context_t const &user_context,
+            counted_t<const ql::db_t> db,
+            const name_string_t &name,
+            int num_cpu_shards,
+            bool dry_run,
+            signal_t *interruptor,
+            ql::datum_t *result_out,
+            admin_err_t *error_out);
+
     bool table_rebalance(
             auth::user_context_t const &user_context,
             counted_t<const ql::db_t> db,
@@ -333,6 +344,17 @@ private:
             THROWS_ONLY(interrupted_exc_t, no_such_table_exc_t,
                 failed_table_op_exc_t, maybe_failed_table_op_exc_t, admin_op_exc_t);
 
+    void set_cpu_shards_internal(
+            auth::user_context_t const &user_context,
+            const counted_t<const ql::db_t> &db,
+            const namespace_id_t &table_id,
+            int num_cpu_shards,
+            bool dry_run,
+            signal_t *interruptor,
+            ql::datum_t *result_out)
+            THROWS_ONLY(interrupted_exc_t, no_such_table_exc_t,
+                failed_table_op_exc_t, maybe_failed_table_op_exc_t, admin_op_exc_t);
+
     void rebalance_internal(
             auth::user_context_t const &user_context,
             const namespace_id_t &table_id,
@@ -31,10 +31,26 @@ const char *table_server_stats_request_t::table_server_request_type = "table_ser
     (BUILDER).overwrite(#NAME, ql::datum_t( \
         (STATS).accumulate_server(SERVER, &parsed_stats_t::table_stats_t::NAME)));
 
+// How many times smaller the messages that we compressed became; 1 if we haven't
+// compressed any yet.
+static double compression_ratio(double input_bytes, double output_bytes) {
+    return output_bytes > 0 ? input_bytes / output_bytes : 1.0;
+}
+
+// How many replication round-trips the primaries made for each majority read; 0 if
+// there haven't been any majority reads.
+static double round_trips_per_read(double reads, double round_trips) {
+    return reads > 0 ? round_trips / reads : 0.0;
+}
+
 parsed_stats_t::server_stats_t::server_stats_t() :
     responsive(false),
     queries_per_sec(0), queries_total(0),
-    client_connections(0), clients_active(0) { }
+    client_connections(0), clients_active(0),
+    changefeed_queued_changes(0), changefeed_changes_coalesced(0),
+    changefeed_limit_reads_per_sec(0),
+    compression_input_bytes_total(0), compression_output_bytes_total(0),
+    compression_cpu_secs_total(0) { }
 
 parsed_stats_t::table_stats_t::table_stats_t() :
     read_docs_per_sec(0), read_docs_total(0),
@@ -42,7 +58,8 @@ parsed_stats_t::table_stats_t::table_stats_t() :
     in_use_bytes(0), metadata_bytes(0), data_bytes(0),
     garbage_bytes(0), preallocated_bytes(0),
     read_bytes_per_sec(0), read_bytes_total(0),
-    written_bytes_per_sec(0), written_bytes_total(0) { }
+    written_bytes_per_sec(0), written_bytes_total(0),
+    majority_reads_total(0), majority_read_round_trips_total(0) { }
 
 parsed_stats_t::parsed_stats_t(const std::vector<ql::datum_t> &stats) {
     for (auto const &s : stats) {
@@ -65,6 +82,10 @@ parsed_stats_t::parsed_stats_t(const std::vector<ql::datum_t> &stats) {
             std::pair<datum_string_t, ql::datum_t> perf_pair = s.get_pair(i);
             if (perf_pair.first == "query_engine") {
                 store_query_engine_stats(perf_pair.second, &serv_stats);
+            } else if (perf_pair.first == "connectivity") {
+                store_connectivity_stats(perf_pair.second, &serv_stats);
+            } else if (perf_pair.first == "thread_utilization") {
+                store_thread_utilization(perf_pair.second, &serv_stats);
             } else {
                 namespace_id_t table_id;
                 res = str_to_uuid(perf_pair.first.to_std(), &table_id);
@@ -167,12 +188,59 @@ void parsed_stats_t::store_query_engine_stats(const ql::datum_t &qe_perf,
     store_perfmon_value(qe_perf, "queries_total", &stats_out->queries_total);
     store_perfmon_value(qe_perf, "client_connections", &stats_out->client_connections);
     store_perfmon_value(qe_perf, "clients_active", &stats_out->clients_active);
+    store_perfmon_value(qe_perf, "changefeed_queued_changes",
+                        &stats_out->changefeed_queued_changes);
+    store_perfmon_value(qe_perf, "changefeed_changes_coalesced",
+                        &stats_out->changefeed_changes_coalesced);
+    store_perfmon_value(qe_perf, "changefeed_limit_reads_per_sec",
+                        &stats_out->changefeed_limit_reads_per_sec);
+}
+
+void parsed_stats_t::store_connectivity_stats(const ql::datum_t &conn_perf,
+                                              server_stats_t *stats_out) {
+    r_sanity_check(conn_perf.get_type() == ql::datum_t::R_OBJECT);
+    store_perfmon_value(conn_perf, "compression_input_bytes",
+                        &stats_out->compression_input_bytes_total);
+    store_perfmon_value(conn_perf, "compression_output_bytes",
+                        &stats_out->compression_output_bytes_total);
+    store_perfmon_value(conn_perf, "compression_nsecs",
+                        &stats_out->compression_cpu_secs_total);
+    stats_out->compression_cpu_secs_total /= BILLION;
+}
+
+void parsed_stats_t::store_primary_values(const ql::datum_t &regions_perf,
+                                          table_stats_t *stats_out) {
+    r_sanity_check(regions_perf.get_type() == ql::datum_t::R_OBJECT);
+    for (size_t i = 0; i < regions_perf.obj_size(); ++i) {
+        std::pair<datum_string_t, ql::datum_t> pair = regions_perf.get_pair(i);
+        if (pair.first.to_std().find("primary-") == 0) {
+            r_sanity_check(pair.second.get_type() == ql::datum_t::R_OBJECT);
+            add_perfmon_value(pair.second, "majority_reads",
+                              &stats_out->majority_reads_total);
+            add_perfmon_value(pair.second, "majority_read_round_trips",
+                              &stats_out->majority_read_round_trips_total);
+        }
+    }
+}
+
+void parsed_stats_t::store_thread_utilization(const ql::datum_t &utilization_perf,
+                                              server_stats_t *stats_out) {
+    r_sanity_check(utilization_perf.get_type() == ql::datum_t::R_ARRAY);
+    stats_out->thread_utilization.clear();
+    for (size_t i = 0; i < utilization_perf.arr_size(); ++i) {
+        stats_out->thread_utilization.push_back(utilization_perf.get(i).as_num());
+    }
 }
 
 void parsed_stats_t::store_table_stats(const namespace_id_t &table_id,
                                        const ql::datum_t &table_perf,
                                        server_stats_t *stats_out) {
     r_sanity_check(table_perf.get_type() == ql::datum_t::R_OBJECT);
+    ql::datum_t regions_perf = table_perf.get_field("regions",
+                                                    ql::throw_bool_t::NOTHROW);
+    if (regions_perf.has()) {
+        store_primary_values(regions_perf, &stats_out->tables[table_id]);
+    }
     ql::datum_t sers_perf = table_perf.get_field("serializers",
                                                  ql::throw_bool_t::NOTHROW);
     if (sers_perf.has()) {
@@ -286,6 +354,7 @@ cluster_stats_request_t::cluster_stats_request_t() { }
 std::set<std::vector<std::string> > cluster_stats_request_t::get_filter() const {
     return std::set<std::vector<std::string> >(
         { {"query_engine" },
+          {"connectivity", "compression_.*" },
           {".*", "serializers", "shard_[0-9]+", "btree-.*", "keys_.*" } });
 }
 
@@ -310,10 +379,21 @@ bool cluster_stats_request_t::to_datum(const parsed_stats_t &stats,
     ADD_CLUSTER_SERVER_STAT(qe_builder, stats, queries_per_sec);
     ADD_CLUSTER_SERVER_STAT(qe_builder, stats, client_connections);
     ADD_CLUSTER_SERVER_STAT(qe_builder, stats, clients_active);
+    ADD_CLUSTER_SERVER_STAT(qe_builder, stats, changefeed_queued_changes);
     ADD_CLUSTER_TABLE_STAT(qe_builder, stats, read_docs_per_sec);
     ADD_CLUSTER_TABLE_STAT(qe_builder, stats, written_docs_per_sec);
     row_builder.overwrite("query_engine", std::move(qe_builder).to_datum());
 
+    ql::datum_object_builder_t network_builder;
+    ADD_CLUSTER_SERVER_STAT(network_builder, stats, compression_input_bytes_total);
+    ADD_CLUSTER_SERVER_STAT(network_builder, stats, compression_output_bytes_total);
+    ADD_CLUSTER_SERVER_STAT(network_builder, stats, compression_cpu_secs_total);
+    network_builder.overwrite("compression_ratio", ql::datum_t(compression_ratio(
+        stats.accumulate(&parsed_stats_t::server_stats_t::compression_input_bytes_total),
+        stats.accumulate(
+            &parsed_stats_t::server_stats_t::compression_output_bytes_total))));
+    row_builder.overwrite("network", std::move(network_builder).to_datum());
+
     *result_out = std::move(row_builder).to_datum();
     return true;
 }
@@ -344,7 +424,8 @@ table_stats_request_t::table_stats_request_t(const namespace_id_t &_table_id) :
 
 std::set<std::vector<std::string> > table_stats_request_t::get_filter() const {
     return std::set<std::vector<std::string> >({
-        { uuid_to_str(table_id), "serializers", "shard_[0-9]+", "btree-.*", "keys_.*" }
+        { uuid_to_str(table_id), "serializers", "shard_[0-9]+", "btree-.*", "keys_.*" },
+        { uuid_to_str(table_id), "regions", "primary-[0-9]+", "majority_read.*" }
         });
 }
 
@@ -374,6 +455,15 @@ bool table_stats_request_t::to_datum(const parsed_stats_t &stats,
     ql::datum_object_builder_t qe_builder;
     ADD_TABLE_STAT(qe_builder, stats, table_id, read_docs_per_sec);
     ADD_TABLE_STAT(qe_builder, stats, table_id, written_docs_per_sec);
+    ADD_TABLE_STAT(qe_builder, stats, table_id, majority_reads_total);
+    ADD_TABLE_STAT(qe_builder, stats, table_id, majority_read_round_trips_total);
+    qe_builder.overwrite("majority_read_round_trips_per_read", ql::datum_t(
+        round_trips_per_read(
+            stats.accumulate_table(
+                table_id, &parsed_stats_t::table_stats_t::majority_reads_total),
+            stats.accumulate_table(
+                table_id,
+                &parsed_stats_t::table_stats_t::majority_read_round_trips_total))));
     row_builder.overwrite("query_engine", std::move(qe_builder).to_datum());
 
     *result_out = std::move(row_builder).to_datum();
@@ -407,6 +497,8 @@ server_stats_request_t::server_stats_request_t(const server_id_t &_server_id) :
 std::set<std::vector<std::string> > server_stats_request_t::get_filter() const {
     return std::set<std::vector<std::string> >(
         { {"query_engine"},
+          {"connectivity", "compression_.*"},
+          {"thread_utilization"},
           {".*", "serializers", "shard_[0-9]+", "btree-.*" } });
 }
 
@@ -452,11 +544,34 @@ bool server_stats_request_t::to_datum(const parsed_stats_t &stats,
         ADD_STAT(qe_builder, server_stats, clients_active);
         ADD_STAT(qe_builder, server_stats, queries_per_sec);
         ADD_STAT(qe_builder, server_stats, queries_total);
+        ADD_STAT(qe_builder, server_stats, changefeed_queued_changes);
+        ADD_STAT(qe_builder, server_stats, changefeed_changes_coalesced);
+        ADD_STAT(qe_builder, server_stats, changefeed_limit_reads_per_sec);
         ADD_SERVER_STAT(qe_builder, stats, server_id, read_docs_per_sec);
         ADD_SERVER_STAT(qe_builder, stats, server_id, read_docs_total);
         ADD_SERVER_STAT(qe_builder, stats, server_id, written_docs_per_sec);
         ADD_SERVER_STAT(qe_builder, stats, server_id, written_docs_total);
         row_builder.overwrite("query_engine", std::move(qe_builder).to_datum());
+
+        ql::datum_object_builder_t network_builder;
+        ADD_STAT(network_builder, server_stats, compression_input_bytes_total);
+        ADD_STAT(network_builder, server_stats, compression_output_bytes_total);
+        ADD_STAT(network_builder, server_stats, compression_cpu_secs_total);
+        network_builder.overwrite("compression_ratio", ql::datum_t(compression_ratio(
+            server_stats.compression_input_bytes_total,
+            server_stats.compression_output_bytes_total)));
+        row_builder.overwrite("network", std::move(network_builder).to_datum());
+
+        /* One entry per thread, so that a single busy thread stands out. */
+        ql::datum_array_builder_t utilization_builder(
+            ql::configured_limits_t::unlimited);
+        for (double utilization : server_stats.thread_utilization) {
+            utilization_builder.add(ql::datum_t(utilization));
+        }
+        ql::datum_object_builder_t cpu_builder;
+        cpu_builder.overwrite(
+            "thread_utilization", std::move(utilization_builder).to_datum());
+        row_builder.overwrite("cpu", std::move(cpu_builder).to_datum());
     }
     *result_out = std::move(row_builder).to_datum();
     return true;
@@ -494,7 +609,8 @@ table_server_stats_request_t::table_server_stats_request_t(
 
 std::set<std::vector<std::string> > table_server_stats_request_t::get_filter() const {
     return std::set<std::vector<std::string> >({
-        { uuid_to_str(table_id), "serializers" } });
+        { uuid_to_str(table_id), "serializers" },
+        { uuid_to_str(table_id), "regions", "primary-[0-9]+", "majority_read.*" } });
 }
 
 std::vector<peer_id_t> table_server_stats_request_t::get_peers(
@@ -549,6 +665,11 @@ bool table_server_stats_request_t::to_datum(const parsed_stats_t &stats,
         ADD_STAT(qe_builder, table_stats, read_docs_total);
         ADD_STAT(qe_builder, table_stats, written_docs_per_sec);
         ADD_STAT(qe_builder, table_stats, written_docs_total);
+        ADD_STAT(qe_builder, table_stats, majority_reads_total);
+        ADD_STAT(qe_builder, table_stats, majority_read_round_trips_total);
+        qe_builder.overwrite("majority_read_round_trips_per_read", ql::datum_t(
+            round_trips_per_read(table_stats.majority_reads_total,
+                                 table_stats.majority_read_round_trips_total)));
 
         ql::datum_object_builder_t se_cache_builder;
         ADD_STAT(se_cache_builder, table_stats, in_use_bytes);
@@ -36,6 +36,8 @@ public:
         double read_bytes_total;
         double written_bytes_per_sec;
         double written_bytes_total;
+        double majority_reads_total;
+        double majority_read_round_trips_total;
     };
 
     struct server_stats_t {
@@ -46,6 +48,13 @@ public:
         double queries_total;
         double client_connections;
         double clients_active;
+        double changefeed_queued_changes;
+        double changefeed_changes_coalesced;
+        double changefeed_limit_reads_per_sec;
+        double compression_input_bytes_total;
+        double compression_output_bytes_total;
+        double compression_cpu_secs_total;
+        std::vector<double> thread_utilization;
 
         std::map<namespace_id_t, table_stats_t> tables;
     };
@@ -90,6 +99,15 @@ private:
     void store_query_engine_stats(const ql::datum_t &qe_perf,
                                   server_stats_t *stats_out);
 
+    void store_connectivity_stats(const ql::datum_t &conn_perf,
+                                  server_stats_t *stats_out);
+
+    void store_thread_utilization(const ql::datum_t &utilization_perf,
+                                  server_stats_t *stats_out);
+
+    void store_primary_values(const ql::datum_t &regions_perf,
+                              table_stats_t *stats_out);
+
     void store_table_stats(const namespace_id_t &table_id,
                            const ql::datum_t &table_perf,
                            server_stats_t *stats_out);
@@ -275,6 +275,7 @@ void debug_table_status_artificial_table_backend_t::format_row(
         auth::user_context_t const &user_context,
         const namespace_id_t &table_id,
         const table_config_and_shards_t &config_and_shards,
+        int num_cpu_shards,
         const ql::datum_t &db_name_or_uuid,
         signal_t *interruptor_on_home,
         ql::datum_t *row_out)
@@ -303,6 +304,7 @@ void debug_table_status_artificial_table_backend_t::format_row(
             table_id,
             db_name_or_uuid,
             config_and_shards.config,
+            num_cpu_shards,
             admin_identifier_format_t::uuid,
             config_and_shards.server_names));
     builder.overwrite(
@@ -34,6 +34,7 @@ private:
             auth::user_context_t const &user_context,
             const namespace_id_t &table_id,
             const table_config_and_shards_t &config,
+            int num_cpu_shards,
             const ql::datum_t &db_name_or_uuid,
             signal_t *interruptor_on_home,
             ql::datum_t *row_out)
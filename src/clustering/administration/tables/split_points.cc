@@ -99,6 +99,7 @@ static void ensure_distinct(std::vector<store_key_t> *split_points) {
 void fetch_distribution(
         const namespace_id_t &table_id,
         real_reql_cluster_interface_t *reql_cluster_interface,
+        bool weight_by_load,
         signal_t *interruptor,
         std::map<store_key_t, int64_t> *counts_out)
         THROWS_ONLY(interrupted_exc_t, failed_table_op_exc_t, no_such_table_exc_t) {
@@ -107,7 +108,7 @@ void fetch_distribution(
             table_id, interruptor);
     static const int depth = 2;
     static const int limit = 128;
-    distribution_read_t inner_read(depth, limit);
+    distribution_read_t inner_read(depth, limit, weight_by_load);
     read_t read(inner_read, profile_bool_t::DONT_PROFILE, read_mode_t::OUTDATED);
     read_response_t resp;
     try {
@@ -236,7 +237,8 @@ void calculate_split_points_intelligently(
         THROWS_ONLY(interrupted_exc_t, failed_table_op_exc_t, no_such_table_exc_t) {
     if (num_shards > old_split_points.num_shards()) {
         std::map<store_key_t, int64_t> counts;
-        fetch_distribution(table_id, reql_cluster_interface, interruptor, &counts);
+        fetch_distribution(
+            table_id, reql_cluster_interface, false, interruptor, &counts);
         if (!calculate_split_points_with_distribution(
                 counts, num_shards, split_points_out)) {
             /* There aren't enough documents to calculate distribution. We'll just assume
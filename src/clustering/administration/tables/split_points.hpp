@@ -14,10 +14,13 @@ class real_reql_cluster_interface_t;
 class signal_t;
 class table_shard_scheme_t;
 
-/* `fetch_distribution` fetches the distribution information from the database. */
+/* `fetch_distribution` fetches the distribution information from the database. If
+`weight_by_load` is `true`, the counts also include the recent point reads and writes
+that each server has sampled (see `key_access_sampler_t`). */
 void fetch_distribution(
         const namespace_id_t &table_id,
         real_reql_cluster_interface_t *reql_cluster_interface,
+        bool weight_by_load,
         signal_t *interruptor,
         std::map<store_key_t, int64_t> *counts_out)
         THROWS_ONLY(interrupted_exc_t, failed_table_op_exc_t, no_such_table_exc_t);
@@ -0,0 +1,188 @@
+// Copyright 2010-2016 RethinkDB, all rights reserved.
+#include "clustering/administration/tables/table_autobalancer.hpp"
+
+#include <algorithm>
+#include <functional>
+#include <vector>
+
+#include "clustering/administration/real_reql_cluster_interface.hpp"
+#include "clustering/administration/tables/split_points.hpp"
+#include "clustering/table_manager/table_meta_client.hpp"
+#include "logger.hpp"
+
+/* How often we look at the tables. This is about as long as the half-life of the load
+that `key_access_sampler_t` measures, so each round sees mostly new load. */
+static const int64_t round_interval_ms = 60 * THOUSAND;
+/* We only move a table's boundaries if its busiest shard has at least this many times
+its fair share of the load... */
+static const double min_imbalance = 1.5;
+/* ...and if the new boundaries cut the imbalance by at least this fraction. */
+static const double min_improvement = 0.2;
+/* After we have changed a table, we leave it alone for this many rounds, so that the
+backfills can finish and the samples can catch up with the new boundaries. */
+static const uint64_t cooldown_rounds = 5;
+
+/* Adds up the counts from a distribution query by shard. Each bucket is counted towards
+the shard that contains its first key; with 128 buckets per table that's close enough. */
+static std::vector<int64_t> compute_shard_loads(
+        const std::map<store_key_t, int64_t> &counts,
+        const table_shard_scheme_t &shard_scheme) {
+    std::vector<int64_t> loads(shard_scheme.num_shards(), 0);
+    for (const auto &pair : counts) {
+        loads[shard_scheme.find_shard_for_key(pair.first)] += pair.second;
+    }
+    return loads;
+}
+
+/* Returns the ratio between the busiest shard's load and the mean load, or 0 if there
+is no load at all. */
+static double compute_imbalance(const std::vector<int64_t> &loads) {
+    int64_t total = 0, max = 0;
+    for (int64_t load : loads) {
+        total += load;
+        max = std::max(max, load);
+    }
+    if (total == 0) {
+        return 0;
+    }
+    return static_cast<double>(max) * loads.size() / total;
+}
+
+const uuid_u table_autobalancer_t::base_rebalance_id =
+    str_to_uuid("3f4c7a36-6a5e-4f0e-9a1b-52d9c0e8b7a4");
+
+table_autobalancer_t::table_autobalancer_t(
+        real_reql_cluster_interface_t *_reql_cluster_interface,
+        const server_id_t &_server_id) :
+    reql_cluster_interface(_reql_cluster_interface),
+    server_id(_server_id),
+    round_in_progress(false),
+    round(0),
+    current_table(nil_uuid()),
+    current_start_time(0),
+    current_phase(rebalance_job_report_t::phase_t::measuring_load),
+    current_imbalance(-1),
+    timer(round_interval_ms, this)
+    { }
+
+void table_autobalancer_t::get_job_reports(
+        microtime_t now,
+        std::vector<rebalance_job_report_t> *job_reports_out) {
+    assert_thread();
+    if (current_table.is_nil()) {
+        return;
+    }
+    job_reports_out->emplace_back(
+        uuid_u::from_hash(base_rebalance_id, uuid_to_str(current_table)),
+        now - std::min(current_start_time, now),
+        server_id,
+        current_table,
+        current_phase,
+        current_imbalance);
+}
+
+void table_autobalancer_t::on_ring() {
+    /* A round can take longer than the interval if a table is slow to respond. There's
+    no point in starting another one on top of it. */
+    if (!round_in_progress) {
+        round_in_progress = true;
+        coro_t::spawn_sometime(std::bind(&table_autobalancer_t::do_round,
+                                         this,
+                                         drainer.lock()));
+    }
+}
+
+void table_autobalancer_t::do_round(auto_drainer_t::lock_t keepalive) {
+    reql_cluster_interface->assert_thread();
+    ++round;
+    try {
+        std::map<namespace_id_t, table_config_and_shards_t> configs;
+        std::map<namespace_id_t, table_basic_config_t> disconnected_configs;
+        reql_cluster_interface->get_table_meta_client()->list_configs(
+            keepalive.get_drain_signal(), &configs, &disconnected_configs);
+        for (const auto &pair : configs) {
+            const table_config_t &config = pair.second.config;
+            if (!config.auto_rebalance
+                    || config.shards.size() < 2
+                    || config.shards[0].primary_replica != server_id) {
+                continue;
+            }
+            auto it = last_changed_round.find(pair.first);
+            if (it != last_changed_round.end() && round - it->second < cooldown_rounds) {
+                continue;
+            }
+            bool changed = maybe_rebalance_table(
+                pair.first, pair.second, keepalive.get_drain_signal());
+            current_table = nil_uuid();
+            if (changed) {
+                last_changed_round[pair.first] = round;
+                break;
+            }
+        }
+    } catch (const interrupted_exc_t &) {
+        /* We're shutting down */
+    }
+    current_table = nil_uuid();
+    round_in_progress = false;
+}
+
+bool table_autobalancer_t::maybe_rebalance_table(
+        const namespace_id_t &table_id,
+        const table_config_and_shards_t &config,
+        signal_t *interruptor)
+        THROWS_ONLY(interrupted_exc_t) {
+    current_table = table_id;
+    current_start_time = current_microtime();
+    current_phase = rebalance_job_report_t::phase_t::measuring_load;
+    current_imbalance = -1;
+
+    try {
+        std::map<store_key_t, int64_t> counts;
+        fetch_distribution(table_id, reql_cluster_interface, true, interruptor, &counts);
+
+        double old_imbalance =
+            compute_imbalance(compute_shard_loads(counts, config.shard_scheme));
+        current_imbalance = old_imbalance;
+        if (old_imbalance < min_imbalance) {
+            return false;
+        }
+
+        table_config_and_shards_t new_config = config;
+        if (!calculate_split_points_with_distribution(
+                counts, config.config.shards.size(), &new_config.shard_scheme)) {
+            return false;
+        }
+        double new_imbalance =
+            compute_imbalance(compute_shard_loads(counts, new_config.shard_scheme));
+        if (new_imbalance > old_imbalance * (1 - min_improvement)) {
+            return false;
+        }
+
+        current_phase = rebalance_job_report_t::phase_t::moving_boundaries;
+        table_config_and_shards_change_t table_config_and_shards_change(
+            table_config_and_shards_change_t::set_table_config_and_shards_t{
+                new_config });
+        reql_cluster_interface->get_table_meta_client()->set_config(
+            table_id, table_config_and_shards_change, interruptor);
+
+        logNTC("Automatically rebalanced table %s.%s (%s): the busiest shard had %.2f "
+               "times its share of the load and should now have %.2f times.\n",
+               uuid_to_str(config.config.basic.database).c_str(),
+               config.config.basic.name.c_str(),
+               uuid_to_str(table_id).c_str(),
+               old_imbalance,
+               new_imbalance);
+        return true;
+    } catch (const no_such_table_exc_t &) {
+        /* The table was dropped in the meantime */
+    } catch (const failed_table_op_exc_t &) {
+        /* The table isn't available right now; we'll try again next round */
+    } catch (const maybe_failed_table_op_exc_t &) {
+        logWRN("Failed to automatically rebalance table %s. The new shard boundaries "
+               "may or may not have been applied.\n", uuid_to_str(table_id).c_str());
+        return true;
+    } catch (const config_change_exc_t &) {
+        /* Someone else reconfigured the table at the same time */
+    }
+    return false;
+}
@@ -0,0 +1,82 @@
+// Copyright 2010-2016 RethinkDB, all rights reserved.
+#ifndef CLUSTERING_ADMINISTRATION_TABLES_TABLE_AUTOBALANCER_HPP_
+#define CLUSTERING_ADMINISTRATION_TABLES_TABLE_AUTOBALANCER_HPP_
+
+#include <map>
+#include <vector>
+
+#include "arch/timing.hpp"
+#include "clustering/administration/jobs/report.hpp"
+#include "clustering/administration/tables/table_metadata.hpp"
+#include "concurrency/auto_drainer.hpp"
+#include "containers/uuid.hpp"
+#include "rpc/connectivity/server_id.hpp"
+#include "threading.hpp"
+#include "time.hpp"
+
+class real_reql_cluster_interface_t;
+class signal_t;
+
+/* `table_autobalancer_t` is created in `serve.cc` on every server. Every round it looks
+at the tables that have `auto_rebalance` set and whose first shard has its primary
+replica on this server, so that each table is looked after by exactly one server at a
+time. For each of them it runs a distribution query that is weighted by the recent
+point reads and writes (see `key_access_sampler_t`), and if one shard gets much more
+than its share it moves the shard boundaries, just like `r.table(...).rebalance()`
+would. It never changes the number of shards or where the replicas are; that is still
+up to the user.
+
+To keep it from thrashing, it changes at most one table per round, leaves a table alone
+for a few rounds after changing it, and only acts if the new boundaries are clearly
+better than the old ones. While it's working on a table it shows up in the `jobs` table,
+and every change is logged, so it shows up in the `logs` table. */
+class table_autobalancer_t :
+    public home_thread_mixin_t,
+    private repeating_timer_callback_t {
+public:
+    table_autobalancer_t(
+        real_reql_cluster_interface_t *_reql_cluster_interface,
+        const server_id_t &_server_id);
+
+    /* Appends a report for the table that we're working on right now, if any. */
+    void get_job_reports(
+        microtime_t now,
+        std::vector<rebalance_job_report_t> *job_reports_out);
+
+private:
+    static const uuid_u base_rebalance_id;
+
+    void on_ring() final;
+    void do_round(auto_drainer_t::lock_t keepalive);
+
+    /* Returns `true` if it changed the table's shard boundaries. */
+    bool maybe_rebalance_table(
+        const namespace_id_t &table_id,
+        const table_config_and_shards_t &config,
+        signal_t *interruptor)
+        THROWS_ONLY(interrupted_exc_t);
+
+    real_reql_cluster_interface_t *const reql_cluster_interface;
+    const server_id_t server_id;
+
+    bool round_in_progress;
+    uint64_t round;
+    /* The round in which we last changed each table */
+    std::map<namespace_id_t, uint64_t> last_changed_round;
+
+    /* What `maybe_rebalance_table()` is doing, for `get_job_reports()`. `current_table`
+    is nil when it isn't running. `current_imbalance` is negative until the load has
+    been measured. */
+    namespace_id_t current_table;
+    microtime_t current_start_time;
+    rebalance_job_report_t::phase_t current_phase;
+    double current_imbalance;
+
+    // `timer` must be destroyed before `drainer`, because `on_ring()` locks `drainer`.
+    auto_drainer_t drainer;
+    repeating_timer_t timer;
+
+    DISABLE_COPYING(table_autobalancer_t);
+};
+
+#endif  // CLUSTERING_ADMINISTRATION_TABLES_TABLE_AUTOBALANCER_HPP_
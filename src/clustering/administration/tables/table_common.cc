@@ -35,8 +35,9 @@ bool common_table_artificial_table_backend_t::read_all_rows_as_vector(
     cluster_semilattice_metadata_t metadata = semilattice_view->get();
     std::map<namespace_id_t, table_config_and_shards_t> configs;
     std::map<namespace_id_t, table_basic_config_t> disconnected_configs;
+    std::map<namespace_id_t, int> num_cpu_shards;
     table_meta_client->list_configs(
-        &interruptor_on_home, &configs, &disconnected_configs);
+        &interruptor_on_home, &configs, &disconnected_configs, &num_cpu_shards);
     rows_out->clear();
     pmap(configs.cbegin(), configs.cend(),
         [&](const std::pair<namespace_id_t, table_config_and_shards_t> &pair) {
@@ -52,6 +53,7 @@ bool common_table_artificial_table_backend_t::read_all_rows_as_vector(
                 user_context,
                 pair.first,
                 pair.second,
+                num_cpu_shards.at(pair.first),
                 db_name_or_uuid,
                 &interruptor_on_home, &row);
             rows_out->push_back(row);
@@ -119,12 +121,15 @@ bool common_table_artificial_table_backend_t::read_row(
         }
 
         table_config_and_shards_t config;
+        int num_cpu_shards;
         try {
-            table_meta_client->get_config(table_id, &interruptor_on_home, &config);
+            table_meta_client->get_config(
+                table_id, &interruptor_on_home, &config, &num_cpu_shards);
             format_row(
                 user_context,
                 table_id,
                 config,
+                num_cpu_shards,
                 db_name_or_uuid,
                 &interruptor_on_home,
                 row_out);
@@ -51,6 +51,7 @@ protected:
             auth::user_context_t const &user_context,
             const namespace_id_t &table_id,
             const table_config_and_shards_t &config,
+            int num_cpu_shards,
             /* In theory `db_name_or_uuid` can be computed from `config`, but the
             computation is non-trivial, so it's easier if `table_common` does it for all
             the subclasses. */
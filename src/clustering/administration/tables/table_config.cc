@@ -390,6 +390,7 @@ ql::datum_t convert_table_config_to_datum(
         namespace_id_t table_id,
         const ql::datum_t &db_name_or_uuid,
         const table_config_t &config,
+        int num_cpu_shards,
         admin_identifier_format_t identifier_format,
         const server_name_map_t &server_names) {
     ql::datum_object_builder_t builder;
@@ -410,6 +411,8 @@ ql::datum_t convert_table_config_to_datum(
         convert_write_ack_config_to_datum(config.write_ack_config));
     builder.overwrite("durability",
         convert_durability_to_datum(config.durability));
+    builder.overwrite("auto_rebalance", ql::datum_t::boolean(config.auto_rebalance));
+    builder.overwrite("cpu_shards", ql::datum_t(static_cast<double>(num_cpu_shards)));
     return std::move(builder).to_datum();
 }
 
@@ -417,13 +420,14 @@ void table_config_artificial_table_backend_t::format_row(
         UNUSED auth::user_context_t const &user_context,
         const namespace_id_t &table_id,
         const table_config_and_shards_t &config,
+        int num_cpu_shards,
         const ql::datum_t &db_name_or_uuid,
         UNUSED signal_t *interruptor_on_home,
         ql::datum_t *row_out)
         THROWS_ONLY(interrupted_exc_t, no_such_table_exc_t, failed_table_op_exc_t) {
     assert_thread();
     *row_out = convert_table_config_to_datum(table_id, db_name_or_uuid,
-        config.config, identifier_format, config.server_names);
+        config.config, num_cpu_shards, identifier_format, config.server_names);
 }
 
 bool convert_table_config_and_name_from_datum(
@@ -433,10 +437,12 @@ bool convert_table_config_and_name_from_datum(
         admin_identifier_format_t identifier_format,
         server_config_client_t *server_config_client,
         const table_config_and_shards_t &old_config,
+        int old_num_cpu_shards,
         table_meta_client_t *table_meta_client,
         signal_t *interruptor,
         namespace_id_t *id_out,
         table_config_t *config_out,
+        int *num_cpu_shards_out,
         server_name_map_t *server_names_out,
         name_string_t *db_name_out,
         admin_err_t *error_out)
@@ -480,7 +486,7 @@ bool convert_table_config_and_name_from_datum(
     }
 
     /* As a special case, we allow the user to omit `indexes`, `primary_key`, `shards`,
-    `write_acks`, and/or `durability` for newly-created tables. */
+    `write_acks`, `durability`, and/or `auto_rebalance` for newly-created tables. */
 
     if (converter.has("indexes")) {
         ql::datum_t indexes_datum;
@@ -603,6 +609,26 @@ bool convert_table_config_and_name_from_datum(
         config_out->durability = write_durability_t::HARD;
     }
 
+    /* Tables from before `auto_rebalance` existed don't have it in their rows, so we
+    allow it to be omitted for existing tables too, and keep the old value. */
+    if (converter.has("auto_rebalance")) {
+        ql::datum_t auto_rebalance_datum;
+        if (!converter.get("auto_rebalance", &auto_rebalance_datum, error_out)) {
+            return false;
+        }
+        if (auto_rebalance_datum.get_type() != ql::datum_t::R_BOOL) {
+            *error_out = admin_err_t{
+                "In `auto_rebalance`: Expected a boolean, got: "
+                    + auto_rebalance_datum.print(),
+                query_state_t::FAILED};
+            return false;
+        }
+        config_out->auto_rebalance = auto_rebalance_datum.as_bool();
+    } else {
+        config_out->auto_rebalance =
+            existed_before ? old_config.config.auto_rebalance : false;
+    }
+
     if (converter.has("write_hook")) {
         ql::datum_t write_hook_datum;
         if (!converter.get("write_hook", &write_hook_datum, error_out)) {
@@ -626,6 +652,38 @@ bool convert_table_config_and_name_from_datum(
         }
     }
 
+    /* Like `auto_rebalance`, `cpu_shards` may be omitted for existing tables. Changing
+    it means copying the table's data on every server, so that has to go through
+    `reconfigure()` instead. */
+    if (converter.has("cpu_shards")) {
+        ql::datum_t cpu_shards_datum;
+        if (!converter.get("cpu_shards", &cpu_shards_datum, error_out)) {
+            return false;
+        }
+        if (cpu_shards_datum.get_type() != ql::datum_t::R_NUM
+                || !(cpu_shards_datum.as_num() >= 1)
+                || cpu_shards_datum.as_num() > MAX_CPU_SHARDING_FACTOR
+                || cpu_shards_datum.as_num()
+                    != static_cast<int>(cpu_shards_datum.as_num())) {
+            *error_out = admin_err_t{
+                strprintf("In `cpu_shards`: Expected an integer between 1 and %d, got: ",
+                    MAX_CPU_SHARDING_FACTOR) + cpu_shards_datum.print(),
+                query_state_t::FAILED};
+            return false;
+        }
+        *num_cpu_shards_out = static_cast<int>(cpu_shards_datum.as_num());
+        if (existed_before && *num_cpu_shards_out != old_num_cpu_shards) {
+            *error_out = admin_err_t{
+                "The `cpu_shards` field can't be changed by writing to "
+                "`rethinkdb.table_config`. Use `table.reconfigure(cpu_shards=...)` "
+                "instead.",
+                query_state_t::FAILED};
+            return false;
+        }
+    } else {
+        *num_cpu_shards_out = existed_before ? old_num_cpu_shards : CPU_SHARDING_FACTOR;
+    }
+
     if (!converter.check_no_extra_keys(error_out)) {
         return false;
     }
@@ -680,6 +738,7 @@ void table_config_artificial_table_backend_t::do_modify(
 void table_config_artificial_table_backend_t::do_create(
         const namespace_id_t &table_id,
         table_config_t &&new_config_no_shards,
+        int num_cpu_shards,
         server_name_map_t &&new_server_names,
         const name_string_t &new_db_name,
         signal_t *interruptor)
@@ -700,7 +759,7 @@ void table_config_artificial_table_backend_t::do_create(
     calculate_split_points_for_uuids(
         new_config.config.shards.size(), &new_config.shard_scheme);
 
-    table_meta_client->create(table_id, new_config, interruptor);
+    table_meta_client->create(table_id, new_config, num_cpu_shards, interruptor);
 }
 
 bool table_config_artificial_table_backend_t::write_row(
@@ -743,21 +802,24 @@ bool table_config_artificial_table_backend_t::write_row(
 
             if (new_value_inout->has()) {
                 table_config_and_shards_t old_config;
+                int old_num_cpu_shards;
                 try {
-                    table_meta_client->get_config(
-                        table_id, &interruptor_on_home, &old_config);
+                    table_meta_client->get_config(table_id, &interruptor_on_home,
+                        &old_config, &old_num_cpu_shards);
                 } CATCH_OP_ERRORS(old_db_name, old_basic_config.name, error_out,
                     "Failed to retrieve the table's configuration, it was not changed.",
                     "Failed to retrieve the table's configuration, it was not changed.")
 
                 table_config_t new_config;
+                int new_num_cpu_shards;
                 server_name_map_t new_server_names;
                 namespace_id_t new_table_id;
                 name_string_t new_db_name;
                 if (!convert_table_config_and_name_from_datum(*new_value_inout, true,
                         metadata, identifier_format, server_config_client,
-                        old_config, table_meta_client, &interruptor_on_home,
-                        &new_table_id, &new_config, &new_server_names, &new_db_name,
+                        old_config, old_num_cpu_shards, table_meta_client,
+                        &interruptor_on_home, &new_table_id, &new_config,
+                        &new_num_cpu_shards, &new_server_names, &new_db_name,
                         error_out)) {
                     error_out->msg = "The change you're trying to make to "
                         "`rethinkdb.table_config` has the wrong format. "
@@ -804,13 +866,14 @@ bool table_config_artificial_table_backend_t::write_row(
 
             namespace_id_t new_table_id;
             table_config_t new_config;
+            int new_num_cpu_shards;
             server_name_map_t new_server_names;
             name_string_t new_db_name;
             if (!convert_table_config_and_name_from_datum(*new_value_inout, false,
                     metadata, identifier_format, server_config_client,
-                    table_config_and_shards_t(), table_meta_client,
-                    &interruptor_on_home, &new_table_id, &new_config, &new_server_names,
-                    &new_db_name, error_out)) {
+                    table_config_and_shards_t(), CPU_SHARDING_FACTOR, table_meta_client,
+                    &interruptor_on_home, &new_table_id, &new_config,
+                    &new_num_cpu_shards, &new_server_names, &new_db_name, error_out)) {
                 error_out->msg = "The change you're trying to make to "
                     "`rethinkdb.table_config` has the wrong format. " + error_out->msg;
                 return false;
@@ -823,11 +886,11 @@ bool table_config_artificial_table_backend_t::write_row(
             */
             *new_value_inout = convert_table_config_to_datum(
                 table_id, new_value_inout->get_field("db"), new_config,
-                identifier_format, new_server_names);
+                new_num_cpu_shards, identifier_format, new_server_names);
 
             try {
-                do_create(table_id, std::move(new_config), std::move(new_server_names),
-                    new_db_name, &interruptor_on_home);
+                do_create(table_id, std::move(new_config), new_num_cpu_shards,
+                    std::move(new_server_names), new_db_name, &interruptor_on_home);
                 return true;
             } CATCH_OP_ERRORS(new_db_name, new_config.basic.name, error_out,
                 "The table was not created.",
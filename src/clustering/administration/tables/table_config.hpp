@@ -21,6 +21,7 @@ ql::datum_t convert_table_config_to_datum(
         namespace_id_t table_id,
         const ql::datum_t &db_name_or_uuid,
         const table_config_t &config,
+        int num_cpu_shards,
         admin_identifier_format_t identifier_format,
         const server_name_map_t &server_names);
 
@@ -55,6 +56,7 @@ private:
             auth::user_context_t const &user_context,
             const namespace_id_t &table_id,
             const table_config_and_shards_t &config,
+            int num_cpu_shards,
             const ql::datum_t &db_name_or_uuid,
             signal_t *interruptor_on_home,
             ql::datum_t *row_out)
@@ -74,6 +76,7 @@ private:
     void do_create(
         const namespace_id_t &table_id,
         table_config_t &&new_config_no_shards,
+        int num_cpu_shards,
         server_name_map_t &&new_server_names,
         const name_string_t &new_db_name,
         signal_t *interruptor)
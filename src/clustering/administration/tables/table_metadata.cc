@@ -150,6 +150,8 @@ void serialize(write_message_t *wm, const table_config_t &tc) {
 
     write_durability_t durability = tc.durability;
     serialize<W>(wm, durability);
+
+    serialize<W>(wm, tc.auto_rebalance);
 }
 
 INSTANTIATE_SERIALIZE_FOR_CLUSTER_AND_DISK(table_config_t);
@@ -184,12 +186,13 @@ archive_result_t deserialize_table_config_pre_v2_4(
     tc->sindexes = std::move(sindexes);
     tc->write_ack_config = std::move(write_ack_config);
     tc->durability = std::move(durability);
+    tc->auto_rebalance = false;
 
     return res;
 }
 
-template <cluster_version_t  W>
-archive_result_t deserialize(
+template <cluster_version_t W>
+archive_result_t deserialize_table_config_pre_v2_5(
     read_stream_t *s, table_config_t *tc) {
     archive_result_t res;
 
@@ -222,11 +225,22 @@ archive_result_t deserialize(
                          std::move(sindexes),
                          std::move(write_hook),
                          std::move(write_ack_config),
-                         std::move(durability)};
+                         std::move(durability),
+                         false};
 
     return res;
 }
 
+template <cluster_version_t W>
+archive_result_t deserialize(
+    read_stream_t *s, table_config_t *tc) {
+    archive_result_t res = deserialize_table_config_pre_v2_5<W>(s, tc);
+    if (bad(res)) { return res; }
+
+    res = deserialize<W>(s, &tc->auto_rebalance);
+    return res;
+}
+
 template <>
 archive_result_t deserialize<cluster_version_t::v2_1>(
     read_stream_t *s, table_config_t *tc) {
@@ -245,11 +259,17 @@ archive_result_t deserialize<cluster_version_t::v2_3>(
     return deserialize_table_config_pre_v2_4<cluster_version_t::v2_3>(s, tc);
 }
 
-template archive_result_t deserialize<cluster_version_t::v2_4_is_latest>(
+template <>
+archive_result_t deserialize<cluster_version_t::v2_4>(
+    read_stream_t *s, table_config_t *tc) {
+    return deserialize_table_config_pre_v2_5<cluster_version_t::v2_4>(s, tc);
+}
+
+template archive_result_t deserialize<cluster_version_t::v2_5_is_latest>(
     read_stream_t *, table_config_t *);
 
-RDB_IMPL_EQUALITY_COMPARABLE_6(table_config_t,
-    basic, shards, write_hook, sindexes, write_ack_config, durability);
+RDB_IMPL_EQUALITY_COMPARABLE_7(table_config_t,
+    basic, shards, write_hook, sindexes, write_ack_config, durability, auto_rebalance);
 
 RDB_IMPL_SERIALIZABLE_1_SINCE_v1_16(table_shard_scheme_t, split_points);
 RDB_IMPL_EQUALITY_COMPARABLE_1(table_shard_scheme_t, split_points);
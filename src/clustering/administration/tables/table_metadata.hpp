@@ -64,6 +64,9 @@ public:
     optional<write_hook_config_t> write_hook;
     write_ack_config_t write_ack_config;
     write_durability_t durability;
+    /* If `auto_rebalance` is `true`, `table_autobalancer_t` moves the shard boundaries
+    when the load on the shards becomes uneven. */
+    bool auto_rebalance;
 };
 
 RDB_DECLARE_EQUALITY_COMPARABLE(table_config_t);
@@ -47,7 +47,8 @@ bool raft_networked_member_t<state_t>::send_rpc(
             *reply_out = reply;
             got_reply.pulse();
         });
-    send(mailbox_manager, bcard->rpc, request, reply_mailbox.get_address());
+    send(mailbox_manager, cluster_message_class_t::CRITICAL, bcard->rpc, request,
+        reply_mailbox.get_address());
     wait_any_t waiter(&watcher, &got_reply);
     wait_interruptible(&waiter, interruptor);
     return got_reply.is_pulsed();
@@ -80,7 +81,7 @@ void raft_networked_member_t<state_t>::on_rpc(
         const mailbox_t<raft_rpc_reply_t>::address_t &reply_addr) {
     raft_rpc_reply_t reply;
     member.on_rpc(request, &reply);
-    send(mailbox_manager, reply_addr, reply);
+    send(mailbox_manager, cluster_message_class_t::CRITICAL, reply_addr, reply);
 }
 
 #endif   /* CLUSTERING_GENERIC_RAFT_NETWORK_TCC_ */
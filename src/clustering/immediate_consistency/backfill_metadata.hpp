@@ -19,9 +19,13 @@ public:
     /* The default constructor assigns reasonable defaults */
     backfill_config_t();
 
-    /* The maximum amount of RAM that can be used for the items queued in memory on the
-    backfillee. */
+    /* The amount of RAM that can initially be used for the items queued in memory on
+    the backfillee. If the backfillee keeps draining the queue faster than the backfiller
+    can refill it, the backfiller doubles the limit, up to `max_item_queue_mem_size`.
+    `remote_replicator_client_t` lowers `max_item_queue_mem_size` to what its server's
+    shared budget allows; see `backfill_throttler_t::item_queue_mem_reservation_t`. */
     size_t item_queue_mem_size;
+    size_t max_item_queue_mem_size;
 
     /* The maximum size, in bytes, of a chunk of items sent over the network from the
     backfiller to the backfillee. */
@@ -2,10 +2,12 @@
 #ifndef CLUSTERING_IMMEDIATE_CONSISTENCY_BACKFILL_THROTTLER_HPP_
 #define CLUSTERING_IMMEDIATE_CONSISTENCY_BACKFILL_THROTTLER_HPP_
 
+#include <algorithm>
 #include <map>
 
 #include "concurrency/interruptor.hpp"
 #include "concurrency/new_semaphore.hpp"
+#include "config/args.hpp"
 #include "containers/scoped.hpp"
 #include "rpc/connectivity/peer_id.hpp"
 #include "threading.hpp"
@@ -64,9 +66,41 @@ public:
         cond_t preempt_signal;
     };
 
+    /* Each backfill into this server lets up to `backfill_config_t::item_queue_mem_size`
+    of backfill items queue up in memory, and the backfiller may grow that window up to
+    `max_item_queue_mem_size`. The growth beyond the initial window comes out of a budget
+    of `MAX_EXTRA_ITEM_QUEUE_MEM` that all backfills into this server share, so that the
+    larger windows don't multiply with the number of tables, CPU shards and concurrent
+    backfills. An `item_queue_mem_reservation_t` takes as much of the budget as is left,
+    up to `wanted`, and gives it back when it's destroyed. */
+    class item_queue_mem_reservation_t {
+    public:
+        item_queue_mem_reservation_t(backfill_throttler_t *p, size_t wanted) :
+                parent(p), size(0) {
+            on_thread_t thread_switcher(parent->home_thread());
+            size = std::min(wanted, parent->extra_item_queue_mem_available);
+            parent->extra_item_queue_mem_available -= size;
+        }
+        ~item_queue_mem_reservation_t() {
+            on_thread_t thread_switcher(parent->home_thread());
+            parent->extra_item_queue_mem_available += size;
+        }
+        size_t get_size() const {
+            return size;
+        }
+    private:
+        backfill_throttler_t *parent;
+        size_t size;
+        DISABLE_COPYING(item_queue_mem_reservation_t);
+    };
+
+    static const size_t MAX_EXTRA_ITEM_QUEUE_MEM = 64 * MEGABYTE;
+
 protected:
     friend class lock_t;
 
+    backfill_throttler_t() :
+        extra_item_queue_mem_available(MAX_EXTRA_ITEM_QUEUE_MEM) { }
     virtual ~backfill_throttler_t() { }
 
     virtual void enter(lock_t *lock, signal_t *interruptor) = 0;
@@ -77,6 +111,11 @@ protected:
     void preempt(lock_t *lock) {
         lock->preempt_signal.pulse();
     }
+
+private:
+    /* `extra_item_queue_mem_available` is the part of `MAX_EXTRA_ITEM_QUEUE_MEM` that
+    isn't reserved. It's only accessed on our home thread. */
+    size_t extra_item_queue_mem_available;
 };
 
 #endif  // CLUSTERING_IMMEDIATE_CONSISTENCY_BACKFILL_THROTTLER_HPP_
@@ -1,6 +1,8 @@
 // Copyright 2010-2015 RethinkDB, all rights reserved.
 #include "clustering/immediate_consistency/backfillee.hpp"
 
+#include <algorithm>
+
 #include "arch/timing.hpp"
 #include "assignment_sentry.hpp"
 #include "clustering/immediate_consistency/history.hpp"
@@ -9,7 +11,9 @@
 
 /* `ITEM_ACK_INTERVAL_MS` controls how often we send acknowledgements back to the
 backfiller. If it's too short, we'll waste resources sending lots of tiny
-acknowledgements; if it's too long, the pipeline might stall. */
+acknowledgements; if it's too long, the pipeline might stall. To keep it from stalling
+when we apply items quickly, we also acknowledge as soon as we've applied a quarter of
+the backfiller's initial window. */
 static const int ITEM_ACK_INTERVAL_MS = 100;
 
 /* `backfillee_t::session_t` contains all the bits and pieces for managing a single
@@ -61,6 +65,7 @@ public:
             backfill_item_seq_t<backfill_item_t> &&chunk) {
         rassert(metainfo_chunk.get_domain() == chunk.get_region());
         items_mem_size_unacked += chunk.get_mem_size();
+        parent->progress_tracker->bytes_received += chunk.get_mem_size();
         items.concat(std::move(chunk));
         metainfo.extend_keys_right(std::move(metainfo_chunk));
         metainfo_binary = from_version_map(metainfo);
@@ -133,7 +138,12 @@ private:
                 range or we run out of items */
                 class producer_t : public store_view_t::backfill_item_producer_t {
                 public:
-                    explicit producer_t(session_t *_parent) : parent(_parent) {
+                    explicit producer_t(session_t *_parent) :
+                            parent(_parent),
+                            ack_threshold(std::max(
+                                parent->parent->backfill_config.item_chunk_mem_size,
+                                parent->parent->backfill_config.item_queue_mem_size / 4)),
+                            pulse_when_ack_due(nullptr) {
                         coro_t::spawn_sometime(std::bind(
                             &producer_t::ack_periodically, this, drainer.lock()));
                     }
@@ -148,6 +158,14 @@ private:
                             *is_item_out = true;
                             *item_out = parent->items.front();
                             parent->items.pop_front();
+                            /* We can't send the acknowledgement from here because
+                            sending might block, so we wake up `ack_periodically()`. */
+                            if (pulse_when_ack_due != nullptr
+                                    && parent->items_mem_size_unacked
+                                        - parent->items.get_mem_size()
+                                        >= ack_threshold) {
+                                pulse_when_ack_due->pulse_if_not_already_pulsed();
+                            }
                             return continue_bool_t::CONTINUE;
                         } else if (!parent->items.empty_domain()) {
                             /* There aren't any more items left in the queue, but there's
@@ -207,7 +225,13 @@ private:
                     void ack_periodically(auto_drainer_t::lock_t keepalive2) {
                         try {
                             while (true) {
-                                nap(ITEM_ACK_INTERVAL_MS, keepalive2.get_drain_signal());
+                                signal_timer_t timer(ITEM_ACK_INTERVAL_MS);
+                                cond_t ack_due;
+                                assignment_sentry_t<cond_t *> sentry(
+                                    &pulse_when_ack_due, &ack_due);
+                                wait_any_t waiter(&timer, &ack_due);
+                                wait_interruptible(
+                                    &waiter, keepalive2.get_drain_signal());
                                 parent->send_ack_items();
                             }
                         } catch (const interrupted_exc_t &) {
@@ -215,6 +239,11 @@ private:
                         }
                     }
                     session_t *parent;
+                    /* Once we've applied this many bytes' worth of items without
+                    acknowledging them, we acknowledge them right away. */
+                    size_t const ack_threshold;
+                    /* `ack_periodically()` puts a `cond_t` here while it waits. */
+                    cond_t *pulse_when_ack_due;
                     auto_drainer_t drainer;
                 } producer(this);
 
@@ -501,9 +530,10 @@ void backfillee_t::send_pre_items(auto_drainer_t::lock_t keepalive) {
             sem_acq.change_count(chunk.get_mem_size());
             pre_item_throttler_acq.transfer_in(std::move(sem_acq));
 
-            /* Send the chunk over the network */
-            send(mailbox_manager, intro.pre_items_mailbox,
-                fifo_source.enter_write(), chunk);
+            /* Send the chunk over the network. Pre-item chunks can be big, so we
+            send them as bulk messages to keep them from holding up queries. */
+            send(mailbox_manager, cluster_message_class_t::BULK,
+                intro.pre_items_mailbox, fifo_source.enter_write(), chunk);
 
             /* Update `progress` */
             guarantee(chunk.get_left_key() == pre_item_sent_threshold);
@@ -33,6 +33,7 @@ backfiller_t::client_t::client_t(
         key_range_t::right_bound_t(full_region.inner.left)),
     item_throttler(intro.config.item_queue_mem_size),
     item_throttler_acq(&item_throttler, 0),
+    item_window_was_full(false),
     pre_items_mailbox(parent->mailbox_manager,
         std::bind(&client_t::on_pre_items, this, ph::_1, ph::_2, ph::_3)),
     begin_session_mailbox(parent->mailbox_manager,
@@ -255,6 +256,9 @@ private:
                 chunk later. */
                 new_semaphore_in_line_t sem_acq(
                     &parent->item_throttler, parent->intro.config.item_chunk_mem_size);
+                if (!sem_acq.acquisition_signal()->is_pulsed()) {
+                    parent->item_window_was_full = true;
+                }
                 wait_interruptible(
                     sem_acq.acquisition_signal(), keepalive.get_drain_signal());
 
@@ -381,8 +385,12 @@ private:
                     represent the state of the backfillee after it applies all the chunks
                     we've sent. */
                     try {
-                        /* Send the chunk over the network */
+                        /* Send the chunk over the network. Item chunks can be big,
+                        so we send them as bulk messages to keep them from holding up
+                        queries. The acknowledgement below may overtake the chunk, but
+                        the backfillee's FIFO enforcer puts them back in order. */
                         send(parent->parent->mailbox_manager,
+                            cluster_message_class_t::BULK,
                             parent->intro.items_mailbox,
                             parent->fifo_source.enter_write(), metainfo, chunk);
 
@@ -488,6 +496,18 @@ void backfiller_t::client_t::on_ack_items(
 
     guarantee(static_cast<int64_t>(mem_size) <= item_throttler_acq.count());
     item_throttler_acq.change_count(item_throttler_acq.count() - mem_size);
+
+    /* If the backfillee has applied every item we sent while we were held back by the
+    window, the window is what limits the backfill, so we make it bigger. */
+    if (item_throttler_acq.count() == 0 && item_window_was_full) {
+        int64_t max_capacity = static_cast<int64_t>(std::max(
+            intro.config.item_queue_mem_size, intro.config.max_item_queue_mem_size));
+        if (item_throttler.capacity() < max_capacity) {
+            item_throttler.set_capacity(
+                std::min(item_throttler.capacity() * 2, max_capacity));
+        }
+        item_window_was_full = false;
+    }
 }
 
 void backfiller_t::client_t::on_pre_items(
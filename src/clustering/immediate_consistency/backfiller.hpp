@@ -101,6 +101,11 @@ private:
         new_semaphore_t item_throttler;
         new_semaphore_in_line_t item_throttler_acq;
 
+        /* `item_window_was_full` is set when a session has to wait for room in
+        `item_throttler`. If the backfillee then acknowledges everything we've sent, it
+        was waiting on us, so `on_ack_items()` grows the capacity of `item_throttler`. */
+        bool item_window_was_full;
+
         scoped_ptr_t<session_t> current_session;
 
         backfiller_bcard_t::pre_items_mailbox_t pre_items_mailbox;
@@ -156,6 +156,13 @@ public:
         return branch_bc;
     }
 
+    /* Returns the timestamp of the most recent write that `spawn_write()` has been
+    called for. Every write that started before the call has a timestamp less than or
+    equal to it. */
+    state_timestamp_t get_latest_started_timestamp() {
+        return current_timestamp;
+    }
+
     /* `read()` performs the given read, blocking until the read is complete. */
     void read(
         const read_t &r,
@@ -7,12 +7,23 @@
 #include <string>
 #include <utility>
 
+#include "arch/timing.hpp"
 #include "clustering/immediate_consistency/backfill_throttler.hpp"
 #include "clustering/immediate_consistency/backfillee.hpp"
+#include "clustering/immediate_consistency/replica_freshness.hpp"
 #include "clustering/table_manager/backfill_progress_tracker.hpp"
+#include "concurrency/wait_any.hpp"
 #include "stl_utils.hpp"
 #include "store_view.hpp"
 
+/* How often a streaming `remote_replicator_client_t` refreshes its
+`replica_freshness_t`. This is roughly the smallest `max_staleness` bound that a
+secondary can serve reads for. */
+static const int FRESHNESS_PROBE_INTERVAL_MS = 200;
+/* How long we wait for the primary to answer a probe before we send another one. The
+primary doesn't answer while it can't reach a majority of the replicas. */
+static const int FRESHNESS_PROBE_TIMEOUT_MS = 1000;
+
 class remote_replicator_client_t::timestamp_range_tracker_t {
 public:
     timestamp_range_tracker_t(
@@ -157,23 +168,33 @@ remote_replicator_client_t::remote_replicator_client_t(
 
         store_view_t *store,
         branch_history_manager_t *branch_history_manager,
+        replica_freshness_t *freshness,
 
         signal_t *interruptor) THROWS_ONLY(interrupted_exc_t) :
 
     mailbox_manager_(mailbox_manager),
     store_(store),
+    freshness_(freshness),
     region_(store->get_region()),
     branch_id_(branch_id),
     mode_(backfill_mode_t::PAUSED),
 
     next_write_waiter_(nullptr),
 
+    write_sync_callback_(
+        std::bind(&remote_replicator_client_t::perform_write_sync, this,
+            ph::_1, ph::_2)),
+    write_sync_workers_(
+        MAX_WRITE_BATCHES_IN_FLIGHT * MAX_WRITES_PER_BATCH,
+        &write_sync_queue_,
+        &write_sync_callback_),
+
     write_async_mailbox_(mailbox_manager,
         std::bind(&remote_replicator_client_t::on_write_async, this,
             ph::_1, ph::_2, ph::_3, ph::_4, ph::_5)),
     write_sync_mailbox_(mailbox_manager,
         std::bind(&remote_replicator_client_t::on_write_sync, this,
-            ph::_1, ph::_2, ph::_3, ph::_4, ph::_5, ph::_6)),
+            ph::_1, ph::_2, ph::_3)),
     dummy_write_mailbox_(mailbox_manager,
         std::bind(&remote_replicator_client_t::on_dummy_write, this,
             ph::_1, ph::_2)),
@@ -190,6 +211,7 @@ remote_replicator_client_t::remote_replicator_client_t(
     progress_tracker->start_time = current_microtime();
     progress_tracker->source_server_id = primary_server_id;
     progress_tracker->progress = 0.0;
+    progress_tracker->bytes_received = 0;
 
     /* If the store is currently constructing a secondary index, wait until it finishes
     before we start the backfill. We'll also check again periodically during the
@@ -227,8 +249,21 @@ remote_replicator_client_t::remote_replicator_client_t(
     /* OK, now we're streaming writes from the primary, but they're being discarded as
     they arrive because `tracker_` indicates that nothing has been backfilled. */
 
+    /* The backfiller may only grow the item queue beyond its initial size as far as this
+    server's shared budget allows. */
+    backfill_throttler_t::item_queue_mem_reservation_t extra_item_queue_mem(
+        backfill_throttler,
+        backfill_config.max_item_queue_mem_size > backfill_config.item_queue_mem_size
+            ? backfill_config.max_item_queue_mem_size
+                - backfill_config.item_queue_mem_size
+            : 0);
+    backfill_config_t limited_backfill_config = backfill_config;
+    limited_backfill_config.max_item_queue_mem_size =
+        backfill_config.item_queue_mem_size + extra_item_queue_mem.get_size();
+
     backfillee_t backfillee(mailbox_manager, branch_history_manager, store,
-        replica_bcard.backfiller_bcard, backfill_config, progress_tracker, interruptor);
+        replica_bcard.backfiller_bcard, limited_backfill_config, progress_tracker,
+        interruptor);
 
     while (tracker_->get_backfill_threshold() != region_.inner.right) {
 
@@ -365,11 +400,62 @@ remote_replicator_client_t::remote_replicator_client_t(
     /* Now that we're completely up-to-date, tell the primary that it's OK to send us
     reads and synchronous writes */
     send(mailbox_manager, intro.ready_mailbox);
+
+    if (freshness_ != nullptr) {
+        coro_t::spawn_sometime(std::bind(
+            &remote_replicator_client_t::run_freshness_probes, this,
+            remote_replicator_server_bcard.timestamp_mailbox, drainer_.lock()));
+    }
 }
 
 remote_replicator_client_t::~remote_replicator_client_t() {
     /* The destructor is declared here instead of the header file so that we can see the
     destructor for `timestamp_range_tracker_t` */
+    drainer_.drain();
+    if (freshness_ != nullptr) {
+        /* We won't be receiving writes anymore, so we can't vouch for the store. */
+        freshness_->reset();
+    }
+}
+
+void remote_replicator_client_t::run_freshness_probes(
+        const remote_replicator_server_bcard_t::timestamp_mailbox_t::address_t &addr,
+        auto_drainer_t::lock_t keepalive) {
+    try {
+        while (true) {
+            /* Every write that the primary started before `asked_at` will have a
+            timestamp less than or equal to the one it sends back. If we lose contact
+            with the primary, or it stops answering because it can't vouch for its
+            timestamps anymore, we just keep asking; the staleness that `freshness_`
+            reports grows on its own in the meantime. */
+            ticks_t asked_at = get_ticks();
+            cond_t got_reply;
+            state_timestamp_t latest_timestamp;
+            mailbox_t<state_timestamp_t> reply_mailbox(
+                mailbox_manager_,
+                [&](signal_t *, const state_timestamp_t &ts) {
+                    latest_timestamp = ts;
+                    got_reply.pulse_if_not_already_pulsed();
+                },
+                mailbox_delivery_t::INLINE);
+            send(mailbox_manager_, addr, reply_mailbox.get_address());
+            signal_timer_t timeout;
+            timeout.start(FRESHNESS_PROBE_TIMEOUT_MS);
+            wait_any_t waiter(&got_reply, &timeout);
+            wait_interruptible(&waiter, keepalive.get_drain_signal());
+            if (!got_reply.is_pulsed()) {
+                continue;
+            }
+
+            replica_->wait_for_timestamp(
+                latest_timestamp, keepalive.get_drain_signal());
+            freshness_->set_up_to_date_as_of(asked_at);
+
+            nap(FRESHNESS_PROBE_INTERVAL_MS, keepalive.get_drain_signal());
+        }
+    } catch (const interrupted_exc_t &) {
+        /* We're being destroyed */
+    }
 }
 
 void remote_replicator_client_t::on_write_async(
@@ -453,23 +539,41 @@ void remote_replicator_client_t::on_write_async(
 }
 
 void remote_replicator_client_t::on_write_sync(
-        signal_t *interruptor,
-        const write_t &write,
-        state_timestamp_t timestamp,
-        order_token_t order_token,
-        write_durability_t durability,
-        const mailbox_t<write_response_t>::address_t &ack_addr)
+        UNUSED signal_t *interruptor,
+        const std::vector<remote_replicator_write_t> &writes,
+        const mailbox_t<std::vector<write_response_t> >::address_t &ack_addr)
         THROWS_ONLY(interrupted_exc_t) {
-    /* The current implementation of the dispatcher will never send us an async write
-    once it's started sending sync writes, but we don't want to rely on that detail, so
-    we pass sync writes through the timestamp enforcer too. */
-    timestamp_enforcer_->complete(timestamp);
+    guarantee(!writes.empty());
+    /* The writes in a batch are independent, so `write_sync_workers_` runs them
+    concurrently just like it would if they had arrived in separate messages.
+    `replica_t` puts them in timestamp order. */
+    counted_t<write_sync_batch_t> batch = make_counted<write_sync_batch_t>();
+    batch->writes = writes;
+    batch->responses.resize(writes.size());
+    batch->num_running = writes.size();
+    batch->ack_addr = ack_addr;
+    for (size_t i = 0; i < writes.size(); ++i) {
+        /* The current implementation of the dispatcher will never send us an async
+        write once it's started sending sync writes, but we don't want to rely on that
+        detail, so we pass sync writes through the timestamp enforcer too. */
+        timestamp_enforcer_->complete(writes[i].timestamp);
+        write_sync_queue_.push(std::make_pair(batch, i));
+    }
+}
 
-    write_response_t response;
+void remote_replicator_client_t::perform_write_sync(
+        write_sync_item_t item,
+        signal_t *interruptor)
+        THROWS_ONLY(interrupted_exc_t) {
+    write_sync_batch_t *batch = item.first.get();
+    const remote_replicator_write_t &write = batch->writes[item.second];
     replica_->do_write(
-        write, timestamp, order_token, durability,
-        interruptor, &response);
-    send(mailbox_manager_, ack_addr, response);
+        write.write, write.timestamp, write.order_token, write.durability,
+        interruptor, &batch->responses[item.second]);
+    --batch->num_running;
+    if (batch->num_running == 0) {
+        send(mailbox_manager_, batch->ack_addr, batch->responses);
+    }
 }
 
 void remote_replicator_client_t::on_dummy_write(
@@ -3,16 +3,22 @@
 #define CLUSTERING_IMMEDIATE_CONSISTENCY_REMOTE_REPLICATOR_CLIENT_HPP_
 
 #include <queue>
+#include <utility>
+#include <vector>
 
 #include "clustering/generic/registrant.hpp"
 #include "clustering/immediate_consistency/backfill_throttler.hpp"
 #include "clustering/immediate_consistency/remote_replicator_metadata.hpp"
 #include "clustering/immediate_consistency/replica.hpp"
+#include "concurrency/auto_drainer.hpp"
 #include "concurrency/coro_pool.hpp"
+#include "concurrency/queue/unlimited_fifo.hpp"
 #include "concurrency/queue/disk_backed_queue_wrapper.hpp"
 #include "concurrency/semaphore.hpp"
+#include "containers/counted.hpp"
 
 class backfill_progress_tracker_t;
+class replica_freshness_t;
 
 /* `remote_replicator_client_t` contacts a `remote_replicator_server_t` on another server
 to sign up for writes to a given shard, and then applies them to a `store_t` on the same
@@ -53,7 +59,11 @@ public:
 
     The `remote_replicator_client_t` constructor blocks until this entire process is
     complete. The backfilled data will be safely flushed to disk by the time it returns.
-    */
+
+    After that, if `freshness` is non-null, we periodically ask the
+    `remote_replicator_server_t` for its latest timestamp and record in `freshness` how
+    far behind the primary we are. `freshness` must outlive the
+    `remote_replicator_client_t`. */
 
     remote_replicator_client_t(
         backfill_throttler_t *backfill_throttler,
@@ -70,6 +80,7 @@ public:
 
         store_view_t *store,
         branch_history_manager_t *branch_history_manager,
+        replica_freshness_t *freshness,
 
         signal_t *interruptor) THROWS_ONLY(interrupted_exc_t);
 
@@ -91,11 +102,24 @@ private:
 
     void on_write_sync(
             signal_t *interruptor,
-            const write_t &write,
-            state_timestamp_t timestamp,
-            order_token_t order_token,
-            write_durability_t durability,
-            const mailbox_t<write_response_t>::address_t &ack_addr)
+            const std::vector<remote_replicator_write_t> &writes,
+            const mailbox_t<std::vector<write_response_t> >::address_t &ack_addr)
+        THROWS_ONLY(interrupted_exc_t);
+
+    /* The writes from one message to `write_sync_mailbox_`. We respond once
+    `num_running` drops to zero. */
+    class write_sync_batch_t : public single_threaded_countable_t<write_sync_batch_t> {
+    public:
+        std::vector<remote_replicator_write_t> writes;
+        std::vector<write_response_t> responses;
+        size_t num_running;
+        mailbox_t<std::vector<write_response_t> >::address_t ack_addr;
+    };
+    typedef std::pair<counted_t<write_sync_batch_t>, size_t> write_sync_item_t;
+
+    /* `perform_write_sync()` is the `write_sync_workers_` callback. It performs the
+    write at the given index of the batch. */
+    void perform_write_sync(write_sync_item_t item, signal_t *interruptor)
         THROWS_ONLY(interrupted_exc_t);
 
     void on_dummy_write(
@@ -110,8 +134,14 @@ private:
             const mailbox_t<read_response_t>::address_t &ack_addr)
         THROWS_ONLY(interrupted_exc_t);
 
+    /* `run_freshness_probes()` keeps `freshness_` up to date while we're streaming. */
+    void run_freshness_probes(
+            const remote_replicator_server_bcard_t::timestamp_mailbox_t::address_t &addr,
+            auto_drainer_t::lock_t keepalive);
+
     mailbox_manager_t *const mailbox_manager_;
     store_view_t *const store_;
+    replica_freshness_t *const freshness_;
     region_t const region_;   /* same as `store_->get_region()` */
     branch_id_t const branch_id_;
 
@@ -170,6 +200,16 @@ private:
     acquires it in write mode. */
     rwlock_t cleanup_rwlock_;
 
+    /* `on_write_sync()` puts the writes of each batch into `write_sync_queue_`, and the
+    coroutines of `write_sync_workers_` perform them. The workers go on to the next
+    write instead of exiting as long as there is one, so under load the same
+    coroutines drive all of the batches instead of a new set for every message. There
+    is a worker for every write that the server can have in flight; fewer could
+    deadlock, because `replica_t` makes each write wait for the ones before it. */
+    unlimited_fifo_queue_t<write_sync_item_t> write_sync_queue_;
+    std_function_callback_t<write_sync_item_t> write_sync_callback_;
+    coro_pool_t<write_sync_item_t> write_sync_workers_;
+
     remote_replicator_client_bcard_t::write_async_mailbox_t write_async_mailbox_;
     remote_replicator_client_bcard_t::write_sync_mailbox_t write_sync_mailbox_;
     remote_replicator_client_bcard_t::dummy_write_mailbox_t dummy_write_mailbox_;
@@ -178,6 +218,10 @@ private:
     /* We use `registrant_` to subscribe to a stream of reads and writes from the
     dispatcher via the `remote_replicator_server_t`. */
     scoped_ptr_t<registrant_t<remote_replicator_client_bcard_t> > registrant_;
+
+    /* `drainer_` is destroyed first, so `run_freshness_probes()` can use everything
+    else. */
+    auto_drainer_t drainer_;
 };
 
 #endif  // CLUSTERING_IMMEDIATE_CONSISTENCY_REMOTE_REPLICATOR_CLIENT_HPP_
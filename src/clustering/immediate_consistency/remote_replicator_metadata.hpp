@@ -2,6 +2,8 @@
 #ifndef CLUSTERING_IMMEDIATE_CONSISTENCY_REMOTE_REPLICATOR_METADATA_HPP_
 #define CLUSTERING_IMMEDIATE_CONSISTENCY_REMOTE_REPLICATOR_METADATA_HPP_
 
+#include <vector>
+
 #include "clustering/generic/registration_metadata.hpp"
 #include "clustering/immediate_consistency/history.hpp"
 #include "rdb_protocol/protocol.hpp"
@@ -17,6 +19,24 @@ public:
 
 RDB_DECLARE_SERIALIZABLE(remote_replicator_client_intro_t);
 
+/* A write that the `remote_replicator_server_t` forwards to a replica that is ready. */
+class remote_replicator_write_t {
+public:
+    write_t write;
+    state_timestamp_t timestamp;
+    order_token_t order_token;
+    write_durability_t durability;
+};
+
+RDB_DECLARE_SERIALIZABLE(remote_replicator_write_t);
+
+/* The server sends each replica at most `MAX_WRITE_BATCHES_IN_FLIGHT` batches of sync
+writes before it waits for a response, and starts a new batch once the current one has
+`MAX_WRITES_PER_BATCH` writes. So a replica never has more than
+`MAX_WRITE_BATCHES_IN_FLIGHT * MAX_WRITES_PER_BATCH` sync writes to work on at once. */
+static const int MAX_WRITE_BATCHES_IN_FLIGHT = 4;
+static const size_t MAX_WRITES_PER_BATCH = 32;
+
 class remote_replicator_client_bcard_t {
 public:
     typedef mailbox_t<
@@ -26,9 +46,12 @@ public:
         write_t, state_timestamp_t, order_token_t,
         mailbox_t<>::address_t
         > write_async_mailbox_t;
+    /* The server sends the writes that pile up while earlier ones are in flight in a
+    single message. The responses come back in the same order, also in a single
+    message, once the replica has performed all of the writes. */
     typedef mailbox_t<
-        write_t, state_timestamp_t, order_token_t, write_durability_t,
-        mailbox_t<write_response_t>::address_t
+        std::vector<remote_replicator_write_t>,
+        mailbox_t<std::vector<write_response_t> >::address_t
         > write_sync_mailbox_t;
     typedef mailbox_t<
         mailbox_t<write_response_t>::address_t
@@ -50,9 +73,17 @@ RDB_DECLARE_SERIALIZABLE(remote_replicator_client_bcard_t);
 
 class remote_replicator_server_bcard_t {
 public:
+    /* `remote_replicator_client_t` sends a message to the `timestamp_mailbox` to find
+    out the timestamp of the latest write that the primary has started. It uses that to
+    keep track of how far behind the primary it is. */
+    typedef mailbox_t<
+        mailbox_t<state_timestamp_t>::address_t
+        > timestamp_mailbox_t;
+
     branch_id_t branch;
     region_t region;
     registrar_business_card_t<remote_replicator_client_bcard_t> registrar;
+    timestamp_mailbox_t::address_t timestamp_mailbox;
 };
 
 RDB_DECLARE_SERIALIZABLE(remote_replicator_server_bcard_t);
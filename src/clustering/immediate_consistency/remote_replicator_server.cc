@@ -5,17 +5,31 @@
 
 remote_replicator_server_t::remote_replicator_server_t(
         mailbox_manager_t *_mailbox_manager,
-        primary_dispatcher_t *_primary) :
+        primary_dispatcher_t *_primary,
+        const std::function<bool()> &_can_vouch_for_timestamp) :
     mailbox_manager(_mailbox_manager),
     primary(_primary),
-    registrar(mailbox_manager, this)
+    can_vouch_for_timestamp(_can_vouch_for_timestamp),
+    registrar(mailbox_manager, this),
+    timestamp_mailbox(mailbox_manager,
+        std::bind(&remote_replicator_server_t::on_timestamp_request, this,
+                  ph::_1, ph::_2))
     { }
 
+void remote_replicator_server_t::on_timestamp_request(
+        UNUSED signal_t *interruptor,
+        const mailbox_t<state_timestamp_t>::address_t &reply_addr) {
+    if (can_vouch_for_timestamp()) {
+        send(mailbox_manager, reply_addr, primary->get_latest_started_timestamp());
+    }
+}
+
 remote_replicator_server_t::proxy_replica_t::proxy_replica_t(
         remote_replicator_server_t *_parent,
         const remote_replicator_client_bcard_t &_client_bcard,
         UNUSED signal_t *interruptor) :
     client_bcard(_client_bcard), parent(_parent), is_ready(false),
+    write_batches_in_flight(0), write_batch_scheduled(false),
     ready_mailbox(
         parent->mailbox_manager,
         std::bind(&proxy_replica_t::on_ready, this, ph::_1))
@@ -41,7 +55,8 @@ void remote_replicator_server_t::proxy_replica_t::do_read(
         [&](signal_t *, const read_response_t &response) {
             *response_out = response;
             got_response.pulse();
-        });
+        },
+        mailbox_delivery_t::INLINE);
     send(parent->mailbox_manager, client_bcard.read_mailbox,
         read, min_timestamp, response_mailbox.get_address());
     wait_interruptible(&got_response, interruptor);
@@ -55,16 +70,66 @@ void remote_replicator_server_t::proxy_replica_t::do_write_sync(
         signal_t *interruptor,
         write_response_t *response_out) {
     guarantee(is_ready);
-    cond_t got_response;
-    mailbox_t<write_response_t> response_mailbox(
-        parent->mailbox_manager,
-        [&](signal_t *, const write_response_t &response) {
-            *response_out = response;
-            got_response.pulse();
-        });
-    send(parent->mailbox_manager, client_bcard.write_sync_mailbox,
-        write, timestamp, order_token, durability, response_mailbox.get_address());
-    wait_interruptible(&got_response, interruptor);
+    /* The replica responds to a batch once all of its writes are done, so we don't put
+    soft and hard writes together. Otherwise the soft writes would have to wait for the
+    hard ones to reach the disk. */
+    if (pending_write_batches.empty()
+            || pending_write_batches.back()->writes.size() >= MAX_WRITES_PER_BATCH
+            || pending_write_batches.back()->writes.back().durability != durability) {
+        pending_write_batches.push_back(make_counted<write_batch_t>());
+    }
+    counted_t<write_batch_t> batch = pending_write_batches.back();
+    size_t index = batch->writes.size();
+    batch->writes.push_back(
+        remote_replicator_write_t { write, timestamp, order_token, durability });
+    maybe_schedule_write_batch();
+    wait_interruptible(&batch->done, interruptor);
+    *response_out = std::move(batch->responses[index]);
+}
+
+void remote_replicator_server_t::proxy_replica_t::maybe_schedule_write_batch() {
+    if (!write_batch_scheduled
+            && !pending_write_batches.empty()
+            && write_batches_in_flight < MAX_WRITE_BATCHES_IN_FLIGHT) {
+        /* We don't send the batch right away, so that the writes that arrive in the
+        meantime can still go with it. */
+        write_batch_scheduled = true;
+        coro_t::spawn_later_ordered(std::bind(
+            &proxy_replica_t::send_write_batch, this, drainer.lock()));
+    }
+}
+
+void remote_replicator_server_t::proxy_replica_t::send_write_batch(
+        auto_drainer_t::lock_t keepalive) {
+    guarantee(write_batch_scheduled);
+    write_batch_scheduled = false;
+    counted_t<write_batch_t> batch = std::move(pending_write_batches.front());
+    pending_write_batches.pop_front();
+    ++write_batches_in_flight;
+    maybe_schedule_write_batch();
+
+    try {
+        cond_t got_responses;
+        mailbox_t<std::vector<write_response_t> > response_mailbox(
+            parent->mailbox_manager,
+            [&](signal_t *, const std::vector<write_response_t> &responses) {
+                batch->responses = responses;
+                got_responses.pulse();
+            },
+            mailbox_delivery_t::INLINE);
+        send(parent->mailbox_manager, client_bcard.write_sync_mailbox,
+            batch->writes, response_mailbox.get_address());
+        wait_interruptible(&got_responses, keepalive.get_drain_signal());
+    } catch (const interrupted_exc_t &) {
+        /* We're being destroyed. The `do_write_sync()` calls that are waiting for this
+        batch have already been interrupted by `registration`. */
+        return;
+    }
+
+    guarantee(batch->responses.size() == batch->writes.size());
+    batch->done.pulse();
+    --write_batches_in_flight;
+    maybe_schedule_write_batch();
 }
 
 void remote_replicator_server_t::proxy_replica_t::do_dummy_write(
@@ -77,7 +142,8 @@ void remote_replicator_server_t::proxy_replica_t::do_dummy_write(
         [&](signal_t *, const write_response_t &response) {
             *response_out = response;
             got_response.pulse();
-        });
+        },
+        mailbox_delivery_t::INLINE);
     send(parent->mailbox_manager, client_bcard.dummy_write_mailbox,
         response_mailbox.get_address());
     wait_interruptible(&got_response, interruptor);
@@ -91,7 +157,8 @@ void remote_replicator_server_t::proxy_replica_t::do_write_async(
     cond_t got_ack;
     mailbox_t<> ack_mailbox(
         parent->mailbox_manager,
-        [&](signal_t *) { got_ack.pulse(); });
+        [&](signal_t *) { got_ack.pulse(); },
+        mailbox_delivery_t::INLINE);
     send(parent->mailbox_manager, client_bcard.write_async_mailbox,
         write, timestamp, order_token, ack_mailbox.get_address());
     wait_interruptible(&got_ack, interruptor);
@@ -2,30 +2,52 @@
 #ifndef CLUSTERING_IMMEDIATE_CONSISTENCY_REMOTE_REPLICATOR_SERVER_HPP_
 #define CLUSTERING_IMMEDIATE_CONSISTENCY_REMOTE_REPLICATOR_SERVER_HPP_
 
+#include <deque>
+#include <functional>
+#include <vector>
+
 #include "clustering/generic/registrar.hpp"
 #include "clustering/immediate_consistency/primary_dispatcher.hpp"
 #include "clustering/immediate_consistency/remote_replicator_metadata.hpp"
+#include "concurrency/auto_drainer.hpp"
+#include "concurrency/cond_var.hpp"
+#include "containers/counted.hpp"
 
 /* `remote_replicator_server_t` takes reads and writes from the `primary_dispatcher_t`
 and sends them over the network to `remote_replicator_client_t`s on other machines.
 
 There is one `remote_replicator_server_t` per shard. It lives on the primary replica
-server with the `primary_dispatcher_t`. */
+server with the `primary_dispatcher_t`.
+
+It also answers the `remote_replicator_client_t`s' requests for the primary's latest
+timestamp, which they use to bound how stale they are. An answer says that no other
+primary can be accepting writes for the shard, so it only answers while
+`can_vouch_for_timestamp()` returns `true`; the owner makes sure that's only the case
+while it's the primary under the current contract and can reach a majority of the
+replicas. Otherwise the requests are dropped, and the replicas' staleness grows until
+it's back. `can_vouch_for_timestamp()` is called on the thread the
+`remote_replicator_server_t` was constructed on. */
 
 class remote_replicator_server_t {
 public:
     remote_replicator_server_t(
         mailbox_manager_t *mailbox_manager,
-        primary_dispatcher_t *primary);
+        primary_dispatcher_t *primary,
+        const std::function<bool()> &can_vouch_for_timestamp);
 
     remote_replicator_server_bcard_t get_bcard() {
         return remote_replicator_server_bcard_t {
             primary->get_branch_id(),
             primary->get_branch_birth_certificate().get_region(),
-            registrar.get_business_card() };
+            registrar.get_business_card(),
+            timestamp_mailbox.get_address() };
     }
 
 private:
+    void on_timestamp_request(
+        signal_t *interruptor,
+        const mailbox_t<state_timestamp_t>::address_t &reply_addr);
+
     /* Whenever a `remote_replicator_client_t` connects, the `registrar` will construct a
     `proxy_replica_t` to represent it. */
     class proxy_replica_t : public primary_dispatcher_t::dispatchee_t {
@@ -64,12 +86,39 @@ private:
             write_response_t *response_out);
 
     private:
+        /* `do_write_sync()` doesn't send its write right away. It adds it to a
+        `write_batch_t`, and `send_write_batch()` sends the whole batch in one message
+        and waits for a single message with all of the responses. If the connection is
+        quiet, the batch goes out as soon as the writes that arrive in the same pass of
+        the event loop have been added. But if `MAX_WRITE_BATCHES_IN_FLIGHT` batches are
+        already waiting for responses, the writes keep piling up until one of them comes
+        back, so the batches get bigger as the load goes up. */
+        class write_batch_t : public single_threaded_countable_t<write_batch_t> {
+        public:
+            std::vector<remote_replicator_write_t> writes;
+            std::vector<write_response_t> responses;
+            /* Pulsed once `responses` has been filled in */
+            cond_t done;
+        };
+
+        void maybe_schedule_write_batch();
+        void send_write_batch(auto_drainer_t::lock_t keepalive);
+
         void on_ready(signal_t *interruptor);
 
         remote_replicator_client_bcard_t client_bcard;
         remote_replicator_server_t *parent;
         bool is_ready;
 
+        std::deque<counted_t<write_batch_t> > pending_write_batches;
+        int write_batches_in_flight;
+        /* `true` if `send_write_batch()` has been spawned but hasn't started yet */
+        bool write_batch_scheduled;
+
+        /* `drainer` stops `send_write_batch()`. It must be destroyed after
+        `registration`, so that nobody calls `do_write_sync()` anymore. */
+        auto_drainer_t drainer;
+
         // The destruction order matters: The `ready_mailbox` callback assumes
         // that `registration` is still valid.
         scoped_ptr_t<primary_dispatcher_t::dispatchee_registration_t> registration;
@@ -78,11 +127,14 @@ private:
 
     mailbox_manager_t *mailbox_manager;
     primary_dispatcher_t *primary;
+    std::function<bool()> can_vouch_for_timestamp;
 
     registrar_t<
         remote_replicator_client_bcard_t,
         remote_replicator_server_t *,
         proxy_replica_t> registrar;
+
+    remote_replicator_server_bcard_t::timestamp_mailbox_t timestamp_mailbox;
 };
 
 #endif // CLUSTERING_IMMEDIATE_CONSISTENCY_REMOTE_REPLICATOR_SERVER_HPP_
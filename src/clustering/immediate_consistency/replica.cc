@@ -117,11 +117,18 @@ void replica_t::do_dummy_write(
     response_out->response = dummy_write_response_t();
 }
 
+void replica_t::wait_for_timestamp(
+        state_timestamp_t timestamp,
+        signal_t *interruptor) {
+    assert_thread();
+    end_enforcer.wait_all_before(timestamp, interruptor);
+}
+
 void replica_t::on_synchronize(
         signal_t *interruptor,
         state_timestamp_t timestamp,
         mailbox_t<>::address_t ack_addr) {
-    end_enforcer.wait_all_before(timestamp, interruptor);
+    wait_for_timestamp(timestamp, interruptor);
     send(mailbox_manager, ack_addr);
 }
 
@@ -50,6 +50,12 @@ public:
         signal_t *interruptor,
         write_response_t *response_out);
 
+    /* Blocks until every write with a timestamp up to and including `timestamp` has
+    been applied to the store. */
+    void wait_for_timestamp(
+        state_timestamp_t timestamp,
+        signal_t *interruptor);
+
 private:
     void on_synchronize(
         signal_t *interruptor,
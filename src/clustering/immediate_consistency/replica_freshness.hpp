@@ -0,0 +1,61 @@
+// Copyright 2010-2016 RethinkDB, all rights reserved.
+#ifndef CLUSTERING_IMMEDIATE_CONSISTENCY_REPLICA_FRESHNESS_HPP_
+#define CLUSTERING_IMMEDIATE_CONSISTENCY_REPLICA_FRESHNESS_HPP_
+
+#include "config/args.hpp"
+#include "containers/optional.hpp"
+#include "threading.hpp"
+#include "time.hpp"
+
+/* `replica_freshness_t` records how far a secondary replica's `store_t` is behind the
+primary. `remote_replicator_client_t` periodically asks the primary for the timestamp
+of the latest write it has started, notes the local time `t` at which it asked, and
+once the local replica has applied every write up to that timestamp it calls
+`set_up_to_date_as_of(t)`. At that point every write that the primary started before
+`t` is visible in the store.
+
+All times are taken from the local monotonic clock, so the guarantee doesn't depend on
+the clocks of the two servers agreeing. The price is that the staleness we compute is
+an overestimate by up to the probe interval plus one round trip.
+
+`direct_query_server_t` consults it to decide whether it may serve a read with a
+`max_staleness_ms` bound. It lives on the store's home thread. */
+
+class replica_freshness_t : public home_thread_mixin_debug_only_t {
+public:
+    replica_freshness_t() { }
+
+    void set_up_to_date_as_of(ticks_t ticks) {
+        assert_thread();
+        /* Probes can complete out of order if one of them got stuck, so we never move
+        backwards. */
+        if (!up_to_date_as_of.has_value() || *up_to_date_as_of < ticks) {
+            up_to_date_as_of.set(ticks);
+        }
+    }
+
+    /* Called when we stop receiving writes from the primary. */
+    void reset() {
+        assert_thread();
+        up_to_date_as_of.reset();
+    }
+
+    /* Returns `true` if every write that the primary started more than
+    `max_staleness_ms` milliseconds ago is visible in the store. */
+    bool is_within(uint64_t max_staleness_ms) const {
+        assert_thread();
+        if (!up_to_date_as_of.has_value()) {
+            return false;
+        }
+        ticks_t now = get_ticks();
+        return now < *up_to_date_as_of
+            || now - *up_to_date_as_of <= max_staleness_ms * MILLION;
+    }
+
+private:
+    optional<ticks_t> up_to_date_as_of;
+
+    DISABLE_COPYING(replica_freshness_t);
+};
+
+#endif  // CLUSTERING_IMMEDIATE_CONSISTENCY_REPLICA_FRESHNESS_HPP_
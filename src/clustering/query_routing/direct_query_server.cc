@@ -3,20 +3,32 @@
 
 #include <functional>
 
+#include "clustering/immediate_consistency/replica_freshness.hpp"
 #include "protocol_api.hpp"
 #include "store_view.hpp"
 
 direct_query_server_t::direct_query_server_t(
         mailbox_manager_t *mm,
-        store_view_t *svs_) :
+        store_view_t *svs_,
+        replica_freshness_t *freshness_) :
     mailbox_manager(mm),
     svs(svs_),
+    freshness(freshness_),
     read_mailbox(mm, std::bind(&direct_query_server_t::on_read, this,
-                               ph::_1, ph::_2, ph::_3))
-    { }
+                               ph::_1, ph::_2, ph::_3)) {
+    if (freshness != nullptr) {
+        bounded_read_mailbox.init(new direct_query_bcard_t::bounded_read_mailbox_t(
+            mm, std::bind(&direct_query_server_t::on_bounded_read, this,
+                          ph::_1, ph::_2, ph::_3)));
+    }
+}
 
 direct_query_bcard_t direct_query_server_t::get_bcard() {
-    return direct_query_bcard_t(read_mailbox.get_address());
+    optional<direct_query_bcard_t::bounded_read_mailbox_t::address_t> bounded_addr;
+    if (bounded_read_mailbox.has()) {
+        bounded_addr.set(bounded_read_mailbox->get_address());
+    }
+    return direct_query_bcard_t(read_mailbox.get_address(), bounded_addr);
 }
 
 void direct_query_server_t::on_read(
@@ -35,22 +47,52 @@ void direct_query_server_t::on_read(
     }
 
     try {
-        /* Leave the token empty. We're not actually interested in ordering here. */
-        read_token_t token;
-
-#ifndef NDEBUG
-        metainfo_checker_t metainfo_checker(svs->get_region(),
-            [](const region_t &, const binary_blob_t &) { });
-#endif
-
         read_response_t response;
-        svs->read(DEBUG_ONLY(metainfo_checker, )
-                  read,
-                  &response,
-                  &token,
-                  interruptor);
+        perform_read(read, interruptor, &response);
         send(mailbox_manager, cont, response);
     } catch (const interrupted_exc_t &) {
         /* ignore */
     }
 }
+
+void direct_query_server_t::on_bounded_read(
+        signal_t *interruptor,
+        const read_t &read,
+        const mailbox_addr_t<bool, read_response_t> &cont) {
+    guarantee(static_cast<bool>(read.max_staleness_ms));
+    /* The store may be a secondary, whose aggregate views don't see backfills. */
+    guarantee(!read.aggregate_view_key().has_value());
+    /* The mailbox lives on the store's home thread, and so does `freshness`. */
+    if (!freshness->is_within(*read.max_staleness_ms)) {
+        /* The client will retry the read on the primary replica. */
+        send(mailbox_manager, cont, false, read_response_t());
+        return;
+    }
+    try {
+        read_response_t response;
+        perform_read(read, interruptor, &response);
+        send(mailbox_manager, cont, true, response);
+    } catch (const interrupted_exc_t &) {
+        /* ignore */
+    }
+}
+
+void direct_query_server_t::perform_read(
+        const read_t &read,
+        signal_t *interruptor,
+        read_response_t *response_out)
+        THROWS_ONLY(interrupted_exc_t) {
+    /* Leave the token empty. We're not actually interested in ordering here. */
+    read_token_t token;
+
+#ifndef NDEBUG
+    metainfo_checker_t metainfo_checker(svs->get_region(),
+        [](const region_t &, const binary_blob_t &) { });
+#endif
+
+    svs->read(DEBUG_ONLY(metainfo_checker, )
+              read,
+              response_out,
+              &token,
+              interruptor);
+}
@@ -4,20 +4,27 @@
 
 #include "clustering/query_routing/metadata.hpp"
 #include "concurrency/fifo_checker.hpp"
+#include "containers/scoped.hpp"
 
+class replica_freshness_t;
 class store_view_t;
 
 /* For each primary or secondary replica of each shard, there is a
 `direct_query_server_t`. The `direct_query_server_t` allows the `table_query_server_t` to
 bypass the `broadcaster_t` and read directly from the B-tree itself. This reduces network
 traffic and is possible even when the primary replica is unavailable, but the data it
-returns might be out of date. */
+returns might be out of date.
+
+If `freshness` is non-null, the `direct_query_server_t` also serves reads with a
+`max_staleness_ms` bound, as long as `freshness` says that the store is recent enough.
+`freshness` must live on the store's home thread. */
 
 class direct_query_server_t {
 public:
     direct_query_server_t(
             mailbox_manager_t *mm,
-            store_view_t *svs);
+            store_view_t *svs,
+            replica_freshness_t *freshness = nullptr);
 
     direct_query_bcard_t get_bcard();
 
@@ -27,12 +34,25 @@ private:
             const read_t &,
             const mailbox_addr_t<read_response_t> &);
 
+    void on_bounded_read(
+            signal_t *interruptor,
+            const read_t &,
+            const mailbox_addr_t<bool, read_response_t> &);
+
+    void perform_read(
+            const read_t &read,
+            signal_t *interruptor,
+            read_response_t *response_out)
+        THROWS_ONLY(interrupted_exc_t);
+
     mailbox_manager_t *mailbox_manager;
     store_view_t *svs;
+    replica_freshness_t *freshness;
 
     order_source_t order_source;  // TODO: order_token_t::ignore
 
     direct_query_bcard_t::read_mailbox_t read_mailbox;
+    scoped_ptr_t<direct_query_bcard_t::bounded_read_mailbox_t> bounded_read_mailbox;
 };
 
 #endif // CLUSTERING_QUERY_ROUTING_DIRECT_QUERY_SERVER_HPP_
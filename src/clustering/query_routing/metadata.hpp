@@ -78,10 +78,22 @@ class direct_query_bcard_t {
 public:
     typedef mailbox_t<read_t, mailbox_addr_t<read_response_t>> read_mailbox_t;
 
+    /* Reads sent to the `bounded_read_mailbox` carry a `max_staleness_ms`. The reply is
+    `false` with an empty response if the replica is too far behind to serve them. */
+    typedef mailbox_t<read_t, mailbox_addr_t<bool, read_response_t>>
+        bounded_read_mailbox_t;
+
     direct_query_bcard_t() { }
-    explicit direct_query_bcard_t(const read_mailbox_t::address_t &rm) : read_mailbox(rm) { }
+    direct_query_bcard_t(
+            const read_mailbox_t::address_t &rm,
+            const optional<bounded_read_mailbox_t::address_t> &brm) :
+        read_mailbox(rm), bounded_read_mailbox(brm) { }
 
     read_mailbox_t::address_t read_mailbox;
+
+    /* Only secondary replicas have a `bounded_read_mailbox`; bounded reads that would
+    go to the primary replica go through the `primary_query_bcard_t` instead. */
+    optional<bounded_read_mailbox_t::address_t> bounded_read_mailbox;
 };
 
 RDB_DECLARE_SERIALIZABLE(direct_query_bcard_t);
@@ -129,6 +129,15 @@ void table_query_client_t::read(
         guarantee(!r.route_to_primary());
         dispatch_debug_direct_read(r, response, interruptor);
     } else {
+        if (r.read_mode == read_mode_t::SINGLE
+                && static_cast<bool>(r.max_staleness_ms)
+                && !r.route_to_primary()) {
+            if (dispatch_bounded_staleness_read(r, response, interruptor)) {
+                return;
+            }
+            /* Some shard had no replica that was recent enough, so the primary
+            replicas will have to handle the read after all. */
+        }
         dispatch_immediate_op<read_t, fifo_enforcer_sink_t::exit_read_t, read_response_t>(
                 &primary_query_client_t::new_read_token,
                 &primary_query_client_t::read,
@@ -434,6 +443,107 @@ void table_query_client_t::perform_outdated_read(
     }
 }
 
+bool table_query_client_t::dispatch_bounded_staleness_read(
+        const read_t &op,
+        read_response_t *response,
+        signal_t *interruptor)
+        THROWS_ONLY(interrupted_exc_t, cannot_perform_query_exc_t) {
+
+    if (interruptor->is_pulsed()) throw interrupted_exc_t();
+
+    /* This is the same as `dispatch_outdated_read()`, except that we only consider
+    replicas that can serve bounded reads. If any shard doesn't have one, we give up
+    on the whole read rather than mixing results from the primary and secondary
+    replicas. */
+    std::vector<scoped_ptr_t<outdated_read_info_t> > replicas_to_contact;
+    bool all_shards_covered = true;
+
+    scoped_ptr_t<outdated_read_info_t> new_op_info(new outdated_read_info_t());
+    relationships.visit(region_t::universe(),
+    [&](const region_t &region, const std::set<relationship_t *> &rels) {
+        if (!all_shards_covered || !op.shard(region, &new_op_info->sharded_op)) {
+            return;
+        }
+        std::vector<relationship_t *> potential_relationships;
+        relationship_t *chosen_relationship = nullptr;
+        for (auto jt = rels.begin(); jt != rels.end(); ++jt) {
+            if ((*jt)->direct_bcard != nullptr
+                    && static_cast<bool>((*jt)->direct_bcard->bounded_read_mailbox)
+                    && (*jt)->region == region) {
+                if ((*jt)->is_local) {
+                    chosen_relationship = *jt;
+                    break;
+                } else {
+                    potential_relationships.push_back(*jt);
+                }
+            }
+        }
+        if (!chosen_relationship && !potential_relationships.empty()) {
+            chosen_relationship
+                = potential_relationships[randint(potential_relationships.size())];
+        }
+        if (!chosen_relationship) {
+            all_shards_covered = false;
+            return;
+        }
+        new_op_info->direct_bcard = chosen_relationship->direct_bcard;
+        new_op_info->keepalive = auto_drainer_t::lock_t(&chosen_relationship->drainer);
+        replicas_to_contact.push_back(std::move(new_op_info));
+        new_op_info.init(new outdated_read_info_t());
+    });
+    if (!all_shards_covered) {
+        return false;
+    }
+
+    std::vector<read_response_t> results(replicas_to_contact.size());
+    std::vector<bool> served(replicas_to_contact.size(), false);
+    pmap(replicas_to_contact.size(),
+        std::bind(&table_query_client_t::perform_bounded_staleness_read, this,
+            &replicas_to_contact, &results, &served, ph::_1, interruptor));
+
+    if (interruptor->is_pulsed()) throw interrupted_exc_t();
+
+    for (size_t i = 0; i < replicas_to_contact.size(); ++i) {
+        if (!served[i]) {
+            return false;
+        }
+    }
+
+    op.unshard(results.data(), results.size(), response, ctx, interruptor);
+    return true;
+}
+
+void table_query_client_t::perform_bounded_staleness_read(
+        std::vector<scoped_ptr_t<outdated_read_info_t> > *replicas_to_contact,
+        std::vector<read_response_t> *results,
+        std::vector<bool> *served,
+        size_t i,
+        signal_t *interruptor) THROWS_NOTHING {
+    outdated_read_info_t *replica_to_contact = (*replicas_to_contact)[i].get();
+
+    try {
+        cond_t done;
+        mailbox_t<bool, read_response_t> cont(mailbox_manager,
+            [&](signal_t *, bool fresh_enough, const read_response_t &res) {
+                (*served)[i] = fresh_enough;
+                results->at(i) = res;
+                done.pulse();
+            });
+
+        send(mailbox_manager,
+            *replica_to_contact->direct_bcard->bounded_read_mailbox,
+            replica_to_contact->sharded_op,
+            cont.get_address());
+        /* If we lose contact with the replica, `served` stays `false` and the read
+        goes to the primary. */
+        wait_any_t waiter(replica_to_contact->keepalive.get_drain_signal(), &done);
+        wait_interruptible(&waiter, interruptor);
+    } catch (const interrupted_exc_t &) {
+        /* Return immediately. `dispatch_bounded_staleness_read()` will notice that
+        the interruptor has been pulsed. */
+    }
+}
+
 void table_query_client_t::dispatch_debug_direct_read(
         const read_t &op,
         read_response_t *response,
@@ -450,9 +560,10 @@ void table_query_client_t::dispatch_debug_direct_read(
                 query_state_t::FAILED);
         }
         std::vector<read_response_t> responses;
-        pmap(CPU_SHARDING_FACTOR, [&](size_t shard_number) {
+        pmap(multistore->num_cpu_shards(), [&](int shard_number) {
             try {
-                region_t region = cpu_sharding_subspace(shard_number);
+                region_t region =
+                    cpu_sharding_subspace(shard_number, multistore->num_cpu_shards());
                 read_t subread;
                 if (!op.shard(region, &subread)) {
                     return;
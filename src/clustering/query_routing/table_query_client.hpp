@@ -137,6 +137,23 @@ private:
             signal_t *interruptor)
         THROWS_NOTHING;
 
+    /* Tries to serve a read with a `max_staleness_ms` bound from secondary replicas.
+    Returns `false` if some shard had no replica that was recent enough, in which case
+    the caller should send the read to the primary replicas instead. */
+    MUST_USE bool dispatch_bounded_staleness_read(
+            const read_t &op,
+            read_response_t *response,
+            signal_t *interruptor)
+        THROWS_ONLY(interrupted_exc_t, cannot_perform_query_exc_t);
+
+    void perform_bounded_staleness_read(
+            std::vector<scoped_ptr_t<outdated_read_info_t> > *replicas_to_contact,
+            std::vector<read_response_t> *results,
+            std::vector<bool> *served,
+            size_t i,
+            signal_t *interruptor)
+        THROWS_NOTHING;
+
     void dispatch_debug_direct_read(
             const read_t &op,
             read_response_t *response,
@@ -1,6 +1,8 @@
 // Copyright 2010-2015 RethinkDB, all rights reserved.
 #include "clustering/table_contract/contract_metadata.hpp"
 
+#include <map>
+#include <set>
 #include <type_traits>
 #include <vector>
 
@@ -203,8 +205,23 @@ RDB_IMPL_SERIALIZABLE_6_SINCE_v2_1(
     table_raft_state_t, config, contracts, branch_history, current_branches,
     member_ids, server_names);
 
+int table_raft_state_t::num_cpu_shards() const {
+    std::set<uint64_t> cpu_shard_begs;
+    for (const auto &pair : contracts) {
+        cpu_shard_begs.insert(pair.second.first.beg);
+    }
+    int num = static_cast<int>(cpu_shard_begs.size());
+#ifndef NDEBUG
+    for (const auto &pair : contracts) {
+        get_cpu_shard_number(pair.second.first, num);
+    }
+#endif
+    return num;
+}
+
 table_raft_state_t make_new_table_raft_state(
-        const table_config_and_shards_t &config) {
+        const table_config_and_shards_t &config,
+        int num_cpu_shards) {
     table_raft_state_t state;
     state.config = config;
     for (size_t i = 0; i < config.shard_scheme.num_shards(); ++i) {
@@ -217,10 +234,10 @@ table_raft_state_t make_new_table_raft_state(
                 contract_t::primary_t { shard_conf.primary_replica, r_nullopt });
         }
         contract.after_emergency_repair = false;
-        for (size_t j = 0; j < CPU_SHARDING_FACTOR; ++j) {
+        for (int j = 0; j < num_cpu_shards; ++j) {
             region_t region = region_intersection(
                 region_t(config.shard_scheme.get_shard_range(i)),
-                cpu_sharding_subspace(j));
+                cpu_sharding_subspace(j, num_cpu_shards));
             state.contracts.insert(std::make_pair(generate_uuid(),
                 std::make_pair(region, contract)));
         }
@@ -235,6 +252,63 @@ table_raft_state_t make_new_table_raft_state(
     return state;
 }
 
+bool make_cpu_resharded_table_raft_state(
+        const table_raft_state_t &old_state,
+        int num_cpu_shards,
+        table_raft_state_t *new_state_out) {
+    /* The new epoch's Raft members are the servers in the config, so they have to be
+    the only servers in the contracts. */
+    std::set<server_id_t> config_servers;
+    for (const table_config_t::shard_t &shard : old_state.config.config.shards) {
+        config_servers.insert(shard.all_replicas.begin(), shard.all_replicas.end());
+    }
+    for (const server_id_t &server : config_servers) {
+        if (old_state.member_ids.count(server) == 0) {
+            return false;
+        }
+    }
+
+    /* Find the contract for every key range, and make sure that the key ranges cover the
+    key space without overlapping. */
+    std::map<key_range_t, const contract_t *> contracts_by_range;
+    for (const auto &pair : old_state.contracts) {
+        for (const server_id_t &server : pair.second.second.replicas) {
+            if (config_servers.count(server) == 0) {
+                return false;
+            }
+        }
+        auto res = contracts_by_range.insert(
+            std::make_pair(pair.second.first.inner, &pair.second.second));
+        if (!res.second && !(*res.first->second == pair.second.second)) {
+            return false;
+        }
+    }
+    key_range_t::right_bound_t covered(store_key_t::min());
+    for (const auto &pair : contracts_by_range) {
+        if (covered.unbounded ||
+                !(key_range_t::right_bound_t(pair.first.left) == covered)) {
+            return false;
+        }
+        covered = pair.first.right;
+    }
+    if (!covered.unbounded) {
+        return false;
+    }
+
+    *new_state_out = old_state;
+    new_state_out->contracts.clear();
+    for (const auto &pair : contracts_by_range) {
+        for (int i = 0; i < num_cpu_shards; ++i) {
+            region_t region = cpu_sharding_subspace(i, num_cpu_shards);
+            region.inner = pair.first;
+            new_state_out->contracts.insert(std::make_pair(generate_uuid(),
+                std::make_pair(region, *pair.second)));
+        }
+    }
+    DEBUG_ONLY_CODE(new_state_out->sanity_check());
+    return true;
+}
+
 RDB_IMPL_EQUALITY_COMPARABLE_6(table_shard_status_t,
     primary, secondary, need_primary, need_quorum, backfilling, transitioning);
 RDB_IMPL_SERIALIZABLE_6_FOR_CLUSTER(table_shard_status_t,
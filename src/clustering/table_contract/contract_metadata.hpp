@@ -234,6 +234,12 @@ public:
     void sanity_check() const;
 #endif /* NDEBUG */
 
+    /* `num_cpu_shards()` returns the number of CPU shards that the table was created
+    with. It isn't stored separately; the contracts never span more than one CPU shard
+    and always cover the whole hash space, so it's the number of distinct hash ranges in
+    `contracts`. */
+    int num_cpu_shards() const;
+
     /* `config` is the latest user-specified config. The user can freely read and modify
     this at any time. */
     table_config_and_shards_t config;
@@ -283,10 +289,22 @@ RDB_DECLARE_SERIALIZABLE(table_raft_state_t::change_t::new_server_names_t);
 RDB_DECLARE_SERIALIZABLE(table_raft_state_t::change_t);
 RDB_DECLARE_SERIALIZABLE(table_raft_state_t);
 
-/* Returns a `table_raft_state_t` for a newly-created table with the given configuration.
-*/
+/* Returns a `table_raft_state_t` for a newly-created table with the given configuration
+and number of CPU shards. */
 table_raft_state_t make_new_table_raft_state(
-    const table_config_and_shards_t &config);
+    const table_config_and_shards_t &config,
+    int num_cpu_shards);
+
+/* `make_cpu_resharded_table_raft_state()` sets `*new_state_out` to a copy of
+`old_state` whose contracts are split into `num_cpu_shards` CPU shards instead. The
+config, branches and servers stay the same, and every new contract is the same as the old
+contracts for its key range. Returns `false` without touching `*new_state_out` if the old
+contracts for some key range differ between CPU shards, or if they mention servers that
+aren't in the config; both happen while the table is being reconfigured. */
+bool make_cpu_resharded_table_raft_state(
+    const table_raft_state_t &old_state,
+    int num_cpu_shards,
+    table_raft_state_t *new_state_out);
 
 /* `table_shard_status_t` describes the current state of the server with respect to some
 range of the key-space. It's used for producing `rethinkdb.table_status`. It's designed
@@ -1,34 +1,131 @@
 // Copyright 2010-2015 RethinkDB, all rights reserved.
 #include "clustering/table_contract/cpu_sharding.hpp"
 
-static const uint64_t CPU_SHARD_WIDTH = HASH_REGION_HASH_SIZE / CPU_SHARDING_FACTOR;
+#include <algorithm>
 
-region_t cpu_sharding_subspace(int subregion_number) {
+#include "clustering/immediate_consistency/backfillee.hpp"
+#include "clustering/immediate_consistency/backfiller.hpp"
+#include "clustering/table_manager/backfill_progress_tracker.hpp"
+#include "concurrency/cross_thread_signal.hpp"
+#include "concurrency/pmap.hpp"
+#include "store_subview.hpp"
+
+static uint64_t cpu_shard_width(int num_cpu_shards) {
+    guarantee(num_cpu_shards >= 1);
+    guarantee(num_cpu_shards <= MAX_CPU_SHARDING_FACTOR);
+    return HASH_REGION_HASH_SIZE / num_cpu_shards;
+}
+
+region_t cpu_sharding_subspace(int subregion_number, int num_cpu_shards) {
     guarantee(subregion_number >= 0);
-    guarantee(subregion_number < CPU_SHARDING_FACTOR);
+    guarantee(subregion_number < num_cpu_shards);
 
     /* Changing this implementation would break backwards compatibility in the disk
     format. */
 
     // We have to be careful with the math here, to avoid overflow.
-    uint64_t beg = CPU_SHARD_WIDTH * subregion_number;
-    uint64_t end = subregion_number + 1 == CPU_SHARDING_FACTOR
-        ? HASH_REGION_HASH_SIZE : beg + CPU_SHARD_WIDTH;
+    uint64_t width = cpu_shard_width(num_cpu_shards);
+    uint64_t beg = width * subregion_number;
+    uint64_t end = subregion_number + 1 == num_cpu_shards
+        ? HASH_REGION_HASH_SIZE : beg + width;
 
     return region_t(beg, end, key_range_t::universe());
 }
 
-int get_cpu_shard_number(const region_t &region) {
-    int subregion_number = region.beg / CPU_SHARD_WIDTH;
-    guarantee(region.beg == subregion_number * CPU_SHARD_WIDTH);
+int get_cpu_shard_number(const region_t &region, int num_cpu_shards) {
+    uint64_t width = cpu_shard_width(num_cpu_shards);
+    int subregion_number = region.beg / width;
+    guarantee(region.beg == subregion_number * width);
     guarantee(region.end == (
-        subregion_number + 1 == CPU_SHARDING_FACTOR
+        subregion_number + 1 == num_cpu_shards
             ? HASH_REGION_HASH_SIZE
-            : region.beg + CPU_SHARD_WIDTH));
+            : region.beg + width));
     return subregion_number;
 }
 
-int get_cpu_shard_approx_number(const region_t &region) {
-    return region.beg / CPU_SHARD_WIDTH;
+int get_cpu_shard_approx_number(const region_t &region, int num_cpu_shards) {
+    /* The last CPU shard also gets the remainder of the division, so it can be a bit
+    wider than the others. */
+    return std::min<uint64_t>(
+        region.beg / cpu_shard_width(num_cpu_shards), num_cpu_shards - 1);
+}
+
+/* Backfills the part of `from_store` that lies in `region` into the same part of
+`to_store`. The backfiller has to live on `from_store`'s thread and the backfillee on
+`to_store`'s thread; they talk to each other through mailboxes. */
+static void backfill_between_stores(
+        mailbox_manager_t *mailbox_manager,
+        branch_history_manager_t *from_branch_history_manager,
+        store_view_t *from_store,
+        branch_history_manager_t *to_branch_history_manager,
+        store_view_t *to_store,
+        const region_t &region,
+        signal_t *interruptor) {
+    cross_thread_signal_t from_interruptor(interruptor, from_store->home_thread());
+    on_thread_t from_thread_switcher(from_store->home_thread());
+    store_subview_t from_subview(from_store, region);
+    backfiller_t backfiller(
+        mailbox_manager, from_branch_history_manager, &from_subview);
+    backfiller_bcard_t backfiller_bcard = backfiller.get_business_card();
+
+    cross_thread_signal_t to_interruptor(interruptor, to_store->home_thread());
+    on_thread_t to_thread_switcher(to_store->home_thread());
+    store_subview_t to_subview(to_store, region);
+    to_subview.wait_until_ok_to_receive_backfill(&to_interruptor);
+
+    backfill_progress_tracker_t backfill_progress_tracker;
+    backfillee_t backfillee(
+        mailbox_manager,
+        to_branch_history_manager,
+        &to_subview,
+        backfiller_bcard,
+        backfill_config_t(),
+        backfill_progress_tracker.insert_progress_tracker(region),
+        &to_interruptor);
+    class callback_t : public backfillee_t::callback_t {
+    public:
+        bool on_progress(const region_map_t<version_t> &) THROWS_NOTHING {
+            return true;
+        }
+    } callback;
+    backfillee.go(
+        &callback,
+        key_range_t::right_bound_t(region.inner.left),
+        &to_interruptor);
 }
 
+void backfill_between_multistores(
+        mailbox_manager_t *mailbox_manager,
+        multistore_ptr_t *from,
+        multistore_ptr_t *to,
+        signal_t *interruptor) {
+    /* Every CPU shard of `to` receives one backfill at a time, but the CPU shards
+    receive theirs in parallel. */
+    pmap(to->num_cpu_shards(), [&](int to_shard) {
+        store_view_t *to_store = to->get_cpu_sharded_store(to_shard);
+        for (int from_shard = 0; from_shard < from->num_cpu_shards(); ++from_shard) {
+            store_view_t *from_store = from->get_cpu_sharded_store(from_shard);
+            region_t region = region_intersection(
+                from_store->get_region(), to_store->get_region());
+            if (region_is_empty(region)) {
+                continue;
+            }
+            try {
+                backfill_between_stores(
+                    mailbox_manager,
+                    from->get_branch_history_manager(),
+                    from_store,
+                    to->get_branch_history_manager(),
+                    to_store,
+                    region,
+                    interruptor);
+            } catch (const interrupted_exc_t &) {
+                /* We'll throw below */
+                return;
+            }
+        }
+    });
+    if (interruptor->is_pulsed()) {
+        throw interrupted_exc_t();
+    }
+}
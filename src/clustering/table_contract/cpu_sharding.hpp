@@ -3,36 +3,58 @@
 #define CLUSTERING_TABLE_CONTRACT_CPU_SHARDING_HPP_
 
 #include "clustering/immediate_consistency/history.hpp"
+#include "config/args.hpp"
 #include "protocol_api.hpp"
 #include "region/region.hpp"
 
 class store_t;
 
-/* Changing this number would break backwards compatibility in the disk format. */
-#define CPU_SHARDING_FACTOR 8
+/* Each table splits the hash space into `num_cpu_shards` CPU shards, where
+`num_cpu_shards` is chosen when the table is created and never changes afterwards. Tables
+that were created without choosing get `CPU_SHARDING_FACTOR`, which is also what every
+table had before the number became configurable (see `config/args.hpp`). Changing the
+way the hash space is split for a given number would break backwards compatibility in the
+disk format. */
 
 /* `cpu_sharding_subspace()` returns a `region_t` that contains the full key-range space
-but only 1/CPU_SHARDING_FACTOR of the shard space. */
-region_t cpu_sharding_subspace(int subregion_number);
+but only 1/`num_cpu_shards` of the shard space. */
+region_t cpu_sharding_subspace(int subregion_number, int num_cpu_shards);
 
 /* `get_cpu_shard_number()` is the reverse of `cpu_sharding_subspace()`; it returns the
 subregion number for `region`'s hash subspace. It ignores `region`'s key boundaries. If
 `region`'s hash subspace doesn't exactly correspond to a specific CPU sharding region, it
 crashes. */
-int get_cpu_shard_number(const region_t &region);
+int get_cpu_shard_number(const region_t &region, int num_cpu_shards);
 
 /* `get_cpu_shard_approx_number()` is like `get_cpu_shard_number()`, except that if the
 input doesn't correspond exactly to a CPU shard, it returns an estimate. */
-int get_cpu_shard_approx_number(const region_t &region);
+int get_cpu_shard_approx_number(const region_t &region, int num_cpu_shards);
+
+class mailbox_manager_t;
+class multistore_ptr_t;
+class signal_t;
+
+/* `backfill_between_multistores()` copies all of the data and metainfo in `from` into
+`to`, which must be empty and may have a different number of CPU shards. It runs one
+local backfill for every pair of a CPU shard of `from` and a CPU shard of `to` whose
+hash ranges overlap. Nothing else may use either multistore while it runs. */
+void backfill_between_multistores(
+    mailbox_manager_t *mailbox_manager,
+    multistore_ptr_t *from,
+    multistore_ptr_t *to,
+    signal_t *interruptor)
+    THROWS_ONLY(interrupted_exc_t);
 
 /* `multistore_ptr_t` is a bundle of `store_view_t`s, one for each CPU shard. The rule
-is that `get_cpu_sharded_store(i)->get_region() == cpu_sharding_subspace(i)`. The
-individual stores' home threads may be different from the `multistore_ptr_t`'s home
-thread. */
+is that `get_cpu_sharded_store(i)->get_region() ==
+cpu_sharding_subspace(i, num_cpu_shards())`. The individual stores' home threads may be
+different from the `multistore_ptr_t`'s home thread. */
 class multistore_ptr_t : public home_thread_mixin_t {
 public:
     virtual ~multistore_ptr_t() { }
 
+    virtual int num_cpu_shards() = 0;
+
     virtual branch_history_manager_t *get_branch_history_manager() = 0;
 
     virtual store_view_t *get_cpu_sharded_store(size_t i) = 0;
@@ -131,6 +131,8 @@ void calculate_emergency_repair(
         new_state_out->config.config.write_ack_config =
             old_state.config.config.write_ack_config;
         new_state_out->config.config.durability = old_state.config.config.durability;
+        new_state_out->config.config.auto_rebalance =
+            old_state.config.config.auto_rebalance;
 
         /* We first calculate all the voting and nonvoting replicas for each range in a
         `range_map_t`. */
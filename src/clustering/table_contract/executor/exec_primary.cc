@@ -55,12 +55,27 @@ public:
     cond_t obsolete;
 };
 
+class primary_execution_t::committed_read_sync_t
+    : public single_threaded_countable_t<primary_execution_t::committed_read_sync_t> {
+public:
+    committed_read_sync_t() : result(false) { }
+    /* `done` is pulsed once the sync write has finished; then `result` says whether it
+    succeeded, and `error` says why not if it didn't. */
+    cond_t done;
+    bool result;
+    admin_err_t error;
+};
+
 primary_execution_t::primary_execution_t(
         const execution_t::context_t *_context,
         execution_t::params_t *_params,
         const contract_id_t &contract_id,
         const table_raft_state_t &raft_state) :
-    execution_t(_context, _params), our_dispatcher(nullptr)
+    execution_t(_context, _params),
+    our_dispatcher(nullptr),
+    read_syncs_running(false),
+    majority_reads(get_num_threads()),
+    majority_read_round_trips(get_num_threads())
 {
     const contract_t &contract = raft_state.contracts.at(contract_id).second;
     guarantee(static_cast<bool>(contract.primary));
@@ -169,6 +184,9 @@ void primary_execution_t::run(auto_drainer_t::lock_t keepalive) {
         perfmon_membership_t perfmon_membership(params->get_parent_perfmon_collection(),
                                                 &perfmon_collection,
                                                 params->get_perfmon_name());
+        perfmon_multi_membership_t read_sync_perfmon_membership(&perfmon_collection,
+            &majority_reads, "majority_reads",
+            &majority_read_round_trips, "majority_read_round_trips");
 
         primary_dispatcher_t primary_dispatcher(&perfmon_collection, initial_version);
 
@@ -232,7 +250,8 @@ void primary_execution_t::run(auto_drainer_t::lock_t keepalive) {
 
         remote_replicator_server_t remote_replicator_server(
             context->mailbox_manager,
-            &primary_dispatcher);
+            &primary_dispatcher,
+            [this]() { return can_vouch_for_timestamp(); });
 
         auto_drainer_t primary_dispatcher_drainer;
         assignment_sentry_t<auto_drainer_t *> our_dispatcher_drainer_assign(
@@ -410,13 +429,60 @@ bool primary_execution_t::on_write(
     return res;
 }
 
-bool primary_execution_t::sync_committed_read(const read_t &read_request,
-                                              order_token_t order_token,
-                                              signal_t *interruptor,
-                                              admin_err_t *error_out) {
+bool primary_execution_t::wait_for_committed_read_sync(signal_t *interruptor,
+                                                       admin_err_t *error_out) {
+    store->assert_thread();
+    guarantee(our_dispatcher != nullptr);
+    ++majority_reads;
+
+    /* The read has already been performed, so any sync write that hasn't been started
+    yet is good enough for it. */
+    if (!next_read_sync.has()) {
+        next_read_sync = make_counted<committed_read_sync_t>();
+    }
+    counted_t<committed_read_sync_t> sync = next_read_sync;
+    if (!read_syncs_running) {
+        read_syncs_running = true;
+        coro_t::spawn_sometime(std::bind(
+            &primary_execution_t::run_read_syncs, this,
+            our_dispatcher_drainer->lock()));
+    }
+
+    wait_interruptible(&sync->done, interruptor);
+    if (!sync->result) {
+        *error_out = sync->error;
+    }
+    return sync->result;
+}
+
+void primary_execution_t::run_read_syncs(auto_drainer_t::lock_t keepalive) {
+    store->assert_thread();
+    keepalive.assert_is_holding(our_dispatcher_drainer);
+    /* Reads that finish while a sync write is running join `next_read_sync`, so we
+    keep going until nobody is waiting. */
+    while (next_read_sync.has()) {
+        counted_t<committed_read_sync_t> sync;
+        sync.swap(next_read_sync);
+        ++majority_read_round_trips;
+        try {
+            sync->result = sync_committed_reads(
+                keepalive.get_drain_signal(), &sync->error);
+        } catch (const interrupted_exc_t &) {
+            sync->result = false;
+            sync->error = admin_err_t{
+                "The primary replica is shutting down. The read could not be "
+                "guaranteed as committed.",
+                query_state_t::FAILED};
+        }
+        sync->done.pulse();
+    }
+    read_syncs_running = false;
+}
+
+bool primary_execution_t::sync_committed_reads(signal_t *interruptor,
+                                               admin_err_t *error_out) {
     write_response_t response;
-    write_t request = write_t::make_sync(read_request.get_region(),
-                                         read_request.profile);
+    write_t request = write_t::make_sync(region, profile_bool_t::DONT_PROFILE);
 
     /* See the comments in `on_write` for an explanation about why we're acquiring
     `begin_write_mutex_assertion` here. */
@@ -438,7 +504,7 @@ bool primary_execution_t::sync_committed_read(const read_t &read_request,
                                     write_durability_t::HARD,
                                     write_ack_config_t::MAJORITY,
                                     &contract_snapshot->contract);
-    our_dispatcher->spawn_write(request, order_token, &write_callback);
+    our_dispatcher->spawn_write(request, order_token_t::ignore, &write_callback);
 
     DEBUG_ONLY(finite_coro_waiting.reset());
     begin_write_mutex_acq.reset();
@@ -497,7 +563,7 @@ bool primary_execution_t::on_read(
             response_out);
 
         if (request.read_mode == read_mode_t::MAJORITY) {
-            return sync_committed_read(request, order_token, interruptor, error_out);
+            return wait_for_committed_read_sync(interruptor, error_out);
         } else {
             return true;
         }
@@ -564,6 +630,7 @@ void primary_execution_t::update_contract_on_store_thread(
                     &interruptor_store_thread, keepalive2.get_drain_signal());
                 should_ack = true;
                 sync_contract_with_replicas(contract, &combiner);
+                synced_contract_store_thread = contract;
             } else {
                 should_ack = false;
             }
@@ -657,6 +724,18 @@ bool primary_execution_t::is_contract_ackable(
     return ack_counter.is_safe();
 }
 
+bool primary_execution_t::can_vouch_for_timestamp() {
+    store->assert_thread();
+    if (our_dispatcher == nullptr) {
+        return false;
+    }
+    /* If the contract changed, the replicas might not all be following us yet.
+    `synced_contract_store_thread` catches up once they are. */
+    counted_t<contract_info_t> contract_snapshot = latest_contract_store_thread;
+    return synced_contract_store_thread.get() == contract_snapshot.get()
+        && is_majority_available(contract_snapshot, our_dispatcher);
+}
+
 bool primary_execution_t::is_majority_available(
         counted_t<contract_info_t> contract_info,
         primary_dispatcher_t *dispatcher) {
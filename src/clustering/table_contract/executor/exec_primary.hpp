@@ -5,6 +5,7 @@
 #include "clustering/query_routing/primary_query_server.hpp"
 #include "clustering/table_contract/executor/exec.hpp"
 #include "containers/counted.hpp"
+#include "perfmon/perfmon.hpp"
 
 class contract_t;
 class io_backender_t;
@@ -48,6 +49,8 @@ private:
     indicating if it's obsolete. The reason this is in a struct is because we sometimes
     need to reason about old contracts, so we may keep multiple versions around. */
     class contract_info_t;
+    /* `committed_read_sync_t` is one sync write that majority reads wait for. */
+    class committed_read_sync_t;
 
     /* This is started in a coroutine when the `primary_t` is created. It sets up the
     broadcaster, listener, etc. */
@@ -71,13 +74,19 @@ private:
         read_response_t *response_out,
         admin_err_t *error_out);
 
-    /* `sync_majority()` is used after a read in 'majority' mode, and will perform a
-    `sync` operation across a majority of replicas to make sure what has just been read
-    has been committed to disk on a majority of replicas for each shard. */
-    bool sync_committed_read(const read_t &read_request,
-                             order_token_t order_token,
-                             signal_t *interruptor,
-                             admin_err_t *error_out);
+    /* `wait_for_committed_read_sync()` is used after a read in 'majority' mode. It
+    blocks until a `sync` write that was started after the call has been committed to
+    disk on a majority of replicas, which ensures the same for what has just been read.
+    Concurrent majority reads share their sync writes: while one sync write is in
+    flight, every read that finishes joins the next one, which `run_read_syncs()` starts
+    as soon as the current one is done. So there's at most one replication round-trip
+    in flight for majority reads, however many reads there are. */
+    bool wait_for_committed_read_sync(signal_t *interruptor, admin_err_t *error_out);
+    void run_read_syncs(auto_drainer_t::lock_t keepalive);
+
+    /* `sync_committed_reads()` performs a single sync write across our whole region
+    for `run_read_syncs()`. */
+    bool sync_committed_reads(signal_t *interruptor, admin_err_t *error_out);
 
     /* `update_contract_or_raft_state()` spawns `update_contract_on_store_thread()`
     to deliver the new contract to `store->home_thread()`. It has two jobs:
@@ -106,6 +115,13 @@ private:
         counted_t<contract_info_t> contract,
         const std::set<server_id_t> &servers);
 
+    /* `can_vouch_for_timestamp()` tells the `remote_replicator_server_t` whether it
+    may tell the replicas our latest timestamp. That's the case while we've synced the
+    latest contract that we received with the replicas, and a majority of them are still
+    available; if we can't reach a majority, another primary might be taking writes
+    that we don't know about. Must be called on `store->home_thread()`. */
+    bool can_vouch_for_timestamp();
+
     /* `is_majority_available()` is a helper function to determine whether a majority
     of the replicas are available to acknowledge a read or write. */
     static bool is_majority_available(
@@ -119,6 +135,11 @@ private:
     and the `store_thread` version should only be accessed on `store->home_thread()`. */
     counted_t<contract_info_t> latest_contract_home_thread, latest_contract_store_thread;
 
+    /* `synced_contract_store_thread` is the latest contract that
+    `sync_contract_with_replicas()` has finished for. It's null until then, and should
+    only be accessed on `store->home_thread()`. */
+    counted_t<contract_info_t> synced_contract_store_thread;
+
     /* `latest_ack` stores the latest contract ack we've sent.  This is possibly null --
     treated as an optional<contract_ack_t>, with a pointer indirection for the sake of
     compile times. */
@@ -144,6 +165,17 @@ private:
     `our_dispatcher_drainer` will always both be null or both be non-null. */
     auto_drainer_t *our_dispatcher_drainer;
 
+    /* `next_read_sync` is the sync write that majority reads that finish now will wait
+    for. It hasn't been started yet, and it's null if no read is waiting.
+    `read_syncs_running` is true while `run_read_syncs()` is running. Both should only be
+    accessed on `store->home_thread()`. */
+    counted_t<committed_read_sync_t> next_read_sync;
+    bool read_syncs_running;
+
+    /* `majority_read_round_trips / majority_reads` is how many replication
+    round-trips each majority read costs. */
+    perfmon_counter_t majority_reads, majority_read_round_trips;
+
     /* `begin_write_mutex_assertion` is used to ensure that we don't ack a contract until
     all past and ongoing writes are safe under the contract's conditions. */
     mutex_assertion_t begin_write_mutex_assertion;
@@ -7,6 +7,7 @@
 #include <utility>
 
 #include "clustering/immediate_consistency/remote_replicator_client.hpp"
+#include "clustering/immediate_consistency/replica_freshness.hpp"
 #include "clustering/query_routing/direct_query_server.hpp"
 #include "concurrency/cross_thread_signal.hpp"
 
@@ -85,7 +86,11 @@ void secondary_execution_t::run(auto_drainer_t::lock_t keepalive) {
                     order_source.check_in("secondary_execution_t").with_read_mode(),
                     &token, region, &interruptor_on_store_thread)));
 
-            direct_query_server_t direct_query_server(context->mailbox_manager, store);
+            /* Once we're streaming, `remote_replicator_client_t` keeps `freshness` up
+            to date so that `direct_query_server` can serve bounded-staleness reads. */
+            replica_freshness_t freshness;
+            direct_query_server_t direct_query_server(
+                context->mailbox_manager, store, &freshness);
 
             /* Switch back to the home thread so we can send the initial ack */
             on_thread_t thread_switcher_2(home_thread());
@@ -187,6 +192,7 @@ void secondary_execution_t::run(auto_drainer_t::lock_t keepalive) {
                 primary,
                 store,
                 context->branch_history_manager,
+                &freshness,
                 &stop_signal_on_store_thread);
 
             on_thread_t thread_switcher_4(home_thread());
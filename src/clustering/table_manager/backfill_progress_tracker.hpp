@@ -18,6 +18,8 @@ public:
         microtime_t start_time;
         server_id_t source_server_id;
         double progress;
+        /* The total mem size of the backfill items received so far */
+        uint64_t bytes_received;
     };
 
     progress_tracker_t * insert_progress_tracker(const region_t &region);
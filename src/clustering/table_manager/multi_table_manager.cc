@@ -2,7 +2,10 @@
 #include "clustering/table_manager/multi_table_manager.hpp"
 
 #include <functional>
+#include <map>
 #include <string>
+#include <utility>
+#include <vector>
 
 #include "clustering/generic/raft_core.tcc"
 #include "clustering/query_routing/metadata.hpp"
@@ -38,6 +41,12 @@ multi_table_manager_t::multi_table_manager_t(
 
     /* Resurrect any tables that were sitting on disk from when we last shut down */
     cond_t non_interruptor;
+    /* Tables whose multistores have the wrong number of CPU shards, because we shut
+    down before `reshard_multistore_if_needed()` was done. Resharding writes to the
+    metadata file, so we can't do it while `read_all_metadata()` is reading it. */
+    std::vector<std::pair<namespace_id_t, table_active_persistent_state_t> > to_reshard;
+    std::map<namespace_id_t, raft_storage_interface_t<table_raft_state_t> *>
+        to_reshard_storage;
     persistence_interface->read_all_metadata(
         [&](const namespace_id_t &table_id,
                 const table_active_persistent_state_t &state,
@@ -51,8 +60,15 @@ multi_table_manager_t::multi_table_manager_t(
                 perfmon_collection_repo->get_perfmon_collections_for_namespace(table_id);
             table->status = table_t::status_t::ACTIVE;
             persistence_interface->load_multistore(
-                table_id, metadata_read_txn, &table->multistore_ptr, &non_interruptor,
+                table_id, raft_storage->get()->snapshot_state.num_cpu_shards(),
+                metadata_read_txn, &table->multistore_ptr, &non_interruptor,
                 &perfmon_collections->serializers_collection);
+            if (table->multistore_ptr->num_cpu_shards() !=
+                    raft_storage->get()->snapshot_state.num_cpu_shards()) {
+                to_reshard.push_back(std::make_pair(table_id, state));
+                to_reshard_storage[table_id] = raft_storage;
+                return;
+            }
             table->active = make_scoped<active_table_t>(
                 this, table, table_id, state.epoch, state.raft_member_id, raft_storage,
                 raft_start_election_immediately_t::NO, table->multistore_ptr.get(),
@@ -71,6 +87,22 @@ multi_table_manager_t::multi_table_manager_t(
         },
         &non_interruptor);
 
+    for (const auto &pair : to_reshard) {
+        table_t *table = tables.at(pair.first).get();
+        rwlock_acq_t table_lock_acq(&table->access_rwlock, access_t::write);
+        perfmon_collection_repo_t::collections_t *perfmon_collections =
+            perfmon_collection_repo->get_perfmon_collections_for_namespace(pair.first);
+        raft_storage_interface_t<table_raft_state_t> *raft_storage =
+            to_reshard_storage.at(pair.first);
+        reshard_multistore_if_needed(
+            pair.first, table, raft_storage->get()->snapshot_state.num_cpu_shards(),
+            &perfmon_collections->serializers_collection);
+        table->active = make_scoped<active_table_t>(
+            this, table, pair.first, pair.second.epoch, pair.second.raft_member_id,
+            raft_storage, raft_start_election_immediately_t::NO,
+            table->multistore_ptr.get(), &perfmon_collections->namespace_collection);
+    }
+
     help_construct();
 }
 
@@ -268,6 +300,35 @@ void multi_table_manager_t::help_construct() {
         std::bind(&multi_table_manager_t::on_get_status, this, ph::_1, ph::_2)));
 }
 
+void multi_table_manager_t::reshard_multistore_if_needed(
+        const namespace_id_t &table_id,
+        table_t *table,
+        int num_cpu_shards,
+        perfmon_collection_t *perfmon_collection_serializers) {
+    guarantee(!table->active.has());
+    int old_num_cpu_shards = table->multistore_ptr->num_cpu_shards();
+    if (old_num_cpu_shards == num_cpu_shards) {
+        return;
+    }
+    logINF("Table %s: Moving the data on this server from %d into %d CPU shards.",
+        uuid_to_str(table_id).c_str(), old_num_cpu_shards, num_cpu_shards);
+    /* Like the rest of `on_action()`, this can't be interrupted, because the table must
+    have a multistore while it's `ACTIVE`. */
+    cond_t non_interruptor;
+    persistence_interface->reshard_multistore(
+        table_id,
+        num_cpu_shards,
+        [&](multistore_ptr_t *old_multistore, multistore_ptr_t *new_multistore) {
+            backfill_between_multistores(
+                mailbox_manager, old_multistore, new_multistore, &non_interruptor);
+        },
+        &table->multistore_ptr,
+        &non_interruptor,
+        perfmon_collection_serializers);
+    logINF("Table %s: Finished moving the data on this server into %d CPU shards.",
+        uuid_to_str(table_id).c_str(), num_cpu_shards);
+}
+
 void multi_table_manager_t::on_action(
         signal_t *interruptor,
         const multi_table_manager_bcard_t::action_message_t &msg) {
@@ -407,9 +468,13 @@ void multi_table_manager_t::on_action(
             cond_t non_interruptor;
             persistence_interface->create_multistore(
                 table_id,
+                initial_raft_state->snapshot_state.num_cpu_shards(),
                 &table->multistore_ptr,
                 &non_interruptor,
                 &perfmon_collections->serializers_collection);
+            reshard_multistore_if_needed(
+                table_id, table, initial_raft_state->snapshot_state.num_cpu_shards(),
+                &perfmon_collections->serializers_collection);
 
             /* Create the `active_table_t`, which contains the `raft_member_t` and does
             all of the important work of actually handing queries */
@@ -437,6 +502,12 @@ void multi_table_manager_t::on_action(
                 *initial_raft_state,
                 &raft_storage);
 
+            /* The new epoch may split the table into a different number of CPU shards,
+            see `table_meta_client_t::set_num_cpu_shards()`. */
+            reshard_multistore_if_needed(
+                table_id, table, initial_raft_state->snapshot_state.num_cpu_shards(),
+                &perfmon_collections->serializers_collection);
+
             table->active = make_scoped<active_table_t>(
                 this, table, table_id, timestamp.epoch, *raft_member_id,
                 raft_storage, *start_election_immediately, table->multistore_ptr.get(),
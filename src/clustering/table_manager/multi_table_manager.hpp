@@ -325,6 +325,16 @@ private:
     `table_manager_directory_subs`, `action_mailbox`, and `get_config_mailbox`. */
     void help_construct();
 
+    /* `reshard_multistore_if_needed()` moves our data for the table into
+    `num_cpu_shards` CPU shards if its multistore has a different number, which happens
+    after `table_meta_client_t::set_num_cpu_shards()`. The caller must hold the table's
+    `access_rwlock` and must not have created `table->active` yet. */
+    void reshard_multistore_if_needed(
+        const namespace_id_t &table_id,
+        table_t *table,
+        int num_cpu_shards,
+        perfmon_collection_t *perfmon_collection_serializers);
+
     /* `on_action()` and `on_get_config()` are mailbox callbacks */
 
     void on_action(
@@ -42,7 +42,7 @@ sindex_manager_t::get_status(signal_t *interruptor) const {
         }
     });
 
-    pmap(static_cast<int64_t>(0), static_cast<int64_t>(CPU_SHARDING_FACTOR),
+    pmap(static_cast<int64_t>(0), static_cast<int64_t>(multistore->num_cpu_shards()),
     [&](int64_t i) {
         std::map<std::string, std::pair<sindex_config_t, sindex_status_t> > store_state;
         store_t *store = multistore->get_underlying_store(i);
@@ -73,7 +73,7 @@ void sindex_manager_t::update_blocking(signal_t *interruptor) {
         goal = config->sindexes;
     });
 
-    for (size_t i = 0; i < CPU_SHARDING_FACTOR; ++i) {
+    for (int i = 0; i < multistore->num_cpu_shards(); ++i) {
         store_t *store = multistore->get_underlying_store(i);
         cross_thread_signal_t ct_interruptor(interruptor, store->home_thread());
         on_thread_t thread_switcher(store->home_thread());
@@ -111,6 +111,7 @@ void table_manager_t::get_status(
         get_raft()->get_committed_state()->apply_read(
             [&](const raft_member_t<table_raft_state_t>::state_and_config_t *s) {
                 response->config.set(s->state.config);
+                response->num_cpu_shards = s->state.num_cpu_shards();
             });
     }
     if (request.want_sindexes) {
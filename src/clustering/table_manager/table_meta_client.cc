@@ -101,7 +101,8 @@ void table_meta_client_t::list_names(
 void table_meta_client_t::get_config(
         const namespace_id_t &table_id,
         signal_t *interruptor_on_caller,
-        table_config_and_shards_t *config_out)
+        table_config_and_shards_t *config_out,
+        int *num_cpu_shards_out)
         THROWS_ONLY(interrupted_exc_t, no_such_table_exc_t, failed_table_op_exc_t) {
     cross_thread_signal_t interruptor(interruptor_on_caller, home_thread());
     on_thread_t thread_switcher(home_thread());
@@ -116,6 +117,9 @@ void table_meta_client_t::get_config(
         [&](const server_id_t &, const namespace_id_t &,
                 const table_status_response_t &response) {
             *config_out = *response.config;
+            if (num_cpu_shards_out != nullptr) {
+                *num_cpu_shards_out = response.num_cpu_shards;
+            }
         },
         &failures);
     if (!failures.empty()) {
@@ -126,7 +130,8 @@ void table_meta_client_t::get_config(
 void table_meta_client_t::list_configs(
         signal_t *interruptor_on_caller,
         std::map<namespace_id_t, table_config_and_shards_t> *configs_out,
-        std::map<namespace_id_t, table_basic_config_t> *disconnected_configs_out)
+        std::map<namespace_id_t, table_basic_config_t> *disconnected_configs_out,
+        std::map<namespace_id_t, int> *num_cpu_shards_out)
         THROWS_ONLY(interrupted_exc_t) {
     cross_thread_signal_t interruptor(interruptor_on_caller, home_thread());
     on_thread_t thread_switcher(home_thread());
@@ -142,6 +147,9 @@ void table_meta_client_t::list_configs(
         [&](const server_id_t &, const namespace_id_t &table_id,
                 const table_status_response_t &response) {
             configs_out->insert(std::make_pair(table_id, *response.config));
+            if (num_cpu_shards_out != nullptr) {
+                (*num_cpu_shards_out)[table_id] = response.num_cpu_shards;
+            }
         },
         &failures);
     for (const namespace_id_t &table_id : failures) {
@@ -292,6 +300,7 @@ void table_meta_client_t::get_debug_status(
 void table_meta_client_t::create(
         namespace_id_t table_id,
         const table_config_and_shards_t &initial_config,
+        int num_cpu_shards,
         signal_t *interruptor_on_caller)
         THROWS_ONLY(interrupted_exc_t, failed_table_op_exc_t,
             maybe_failed_table_op_exc_t) {
@@ -306,7 +315,7 @@ void table_meta_client_t::create(
 
     create_or_emergency_repair(
         table_id,
-        make_new_table_raft_state(initial_config),
+        make_new_table_raft_state(initial_config, num_cpu_shards),
         multi_table_manager_timestamp_t::epoch_t::make(
             multi_table_manager_timestamp_t::epoch_t::min()),
         &interruptor);
@@ -543,6 +552,69 @@ void table_meta_client_t::emergency_repair(
     }
 }
 
+bool table_meta_client_t::set_num_cpu_shards(
+        const namespace_id_t &table_id,
+        int num_cpu_shards,
+        bool dry_run,
+        signal_t *interruptor_on_caller)
+        THROWS_ONLY(interrupted_exc_t, no_such_table_exc_t, failed_table_op_exc_t,
+            maybe_failed_table_op_exc_t) {
+    cross_thread_signal_t interruptor(interruptor_on_caller, home_thread());
+    on_thread_t thread_switcher(home_thread());
+
+    table_raft_state_t old_state;
+    table_status_request_t request;
+    request.want_raft_state = true;
+    std::set<namespace_id_t> failures;
+    get_status(
+        make_optional(table_id),
+        request,
+        server_selector_t::BEST_SERVER_ONLY,
+        &interruptor,
+        [&](const server_id_t &, const namespace_id_t &,
+                const table_status_response_t &response) {
+            old_state = *response.raft_state;
+        },
+        &failures);
+    if (!failures.empty()) {
+        throw_appropriate_exception(table_id);
+    }
+
+    /* Unlike an emergency repair, this must not lose any data, so every server has to
+    take part. */
+    for (const auto &pair : old_state.member_ids) {
+        if (!server_config_client->
+                get_server_to_peer_map()->get_key(pair.first).has_value()) {
+            return false;
+        }
+    }
+
+    table_raft_state_t new_state;
+    if (!make_cpu_resharded_table_raft_state(old_state, num_cpu_shards, &new_state)) {
+        return false;
+    }
+    if (dry_run) {
+        return true;
+    }
+
+    multi_table_manager_timestamp_t::epoch_t old_epoch;
+    multi_table_manager->get_table_basic_configs()->read_key(table_id,
+        [&](const std::pair<table_basic_config_t,
+                multi_table_manager_timestamp_t> *pair) {
+            if (pair == nullptr) {
+                throw no_such_table_exc_t();
+            }
+            old_epoch = pair->second.epoch;
+        });
+
+    create_or_emergency_repair(
+        table_id,
+        new_state,
+        multi_table_manager_timestamp_t::epoch_t::make(old_epoch),
+        &interruptor);
+    return true;
+}
+
 void table_meta_client_t::create_or_emergency_repair(
         const namespace_id_t &table_id,
         const table_raft_state_t &raft_state,
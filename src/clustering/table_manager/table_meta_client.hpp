@@ -131,20 +131,24 @@ public:
         std::map<namespace_id_t, table_basic_config_t> *names_out) const;
 
     /* `get_config()` fetches the configuration of the table with the given ID. It may
-    block and it may fail. */
+    block and it may fail. If `num_cpu_shards_out` isn't null, it also fetches the
+    number of CPU shards that the table is split into. */
     void get_config(
         const namespace_id_t &table_id,
         signal_t *interruptor,
-        table_config_and_shards_t *config_out)
+        table_config_and_shards_t *config_out,
+        int *num_cpu_shards_out = nullptr)
         THROWS_ONLY(interrupted_exc_t, no_such_table_exc_t, failed_table_op_exc_t);
 
     /* `list_configs()` fetches the configurations of every table at once. It may block.
     If it can't find a config for a certain table, then it puts the table's name and info
-    into `disconnected_configs_out` instead. */
+    into `disconnected_configs_out` instead. `num_cpu_shards_out` is optional, like in
+    `get_config()`. */
     void list_configs(
         signal_t *interruptor,
         std::map<namespace_id_t, table_config_and_shards_t> *configs_out,
-        std::map<namespace_id_t, table_basic_config_t> *disconnected_configs_out)
+        std::map<namespace_id_t, table_basic_config_t> *disconnected_configs_out,
+        std::map<namespace_id_t, int> *num_cpu_shards_out = nullptr)
         THROWS_ONLY(interrupted_exc_t);
 
     /* `get_sindex_status()` returns a list of the sindexes on the given table and the
@@ -185,12 +189,14 @@ public:
         std::map<server_id_t, table_status_response_t> *responses_out)
         THROWS_ONLY(interrupted_exc_t, no_such_table_exc_t, failed_table_op_exc_t);
 
-    /* `create()` creates a table with the given configuration. It sets `*table_id_out`
-    to the ID of the newly generated table. It may block. If it returns successfully, the
-    change will be visible in `find()`, etc. */
+    /* `create()` creates a table with the given configuration, splitting each shard
+    into `num_cpu_shards` CPU shards. It sets `*table_id_out` to the ID of the newly
+    generated table. It may block. If it returns successfully, the change will be visible
+    in `find()`, etc. */
     void create(
         namespace_id_t new_table_id,
         const table_config_and_shards_t &new_config,
+        int num_cpu_shards,
         signal_t *interruptor)
         THROWS_ONLY(interrupted_exc_t, failed_table_op_exc_t,
             maybe_failed_table_op_exc_t);
@@ -229,6 +235,23 @@ public:
         THROWS_ONLY(interrupted_exc_t, no_such_table_exc_t, failed_table_op_exc_t,
             maybe_failed_table_op_exc_t);
 
+    /* `set_num_cpu_shards()` splits the table into `num_cpu_shards` CPU shards. Like
+    `emergency_repair()` it creates a new table epoch, whose contracts are the table's
+    current contracts split along the new CPU shard boundaries (see
+    `make_cpu_resharded_table_raft_state()`). Every server that hosts the table then
+    moves its local copy of the data into the new CPU shards through a local backfill
+    before it serves the table again (see `backfill_between_multistores()`). Returns
+    `false` and changes nothing if one of the table's servers isn't connected, or if the
+    table is in the middle of a reconfiguration. If `dry_run` is `true`, it only checks
+    whether the change could be made. */
+    bool set_num_cpu_shards(
+        const namespace_id_t &table_id,
+        int num_cpu_shards,
+        bool dry_run,
+        signal_t *interruptor)
+        THROWS_ONLY(interrupted_exc_t, no_such_table_exc_t, failed_table_op_exc_t,
+            maybe_failed_table_op_exc_t);
+
 private:
     typedef std::pair<table_basic_config_t, multi_table_manager_timestamp_t>
         timestamped_basic_config_t;
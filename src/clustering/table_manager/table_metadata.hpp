@@ -138,10 +138,12 @@ public:
 
     /* We must default-initialize boolean fields or they might cause out of range
     errors during serialization and/or deserializtion. */
-    table_status_response_t() : all_replicas_ready(false) { }
+    table_status_response_t() : num_cpu_shards(0), all_replicas_ready(false) { }
 
-    /* `config` is controlled by `want_config`. */
+    /* `config` and `num_cpu_shards` are controlled by `want_config`. `num_cpu_shards`
+    is the number of CPU shards that the table's contracts are split into. */
     optional<table_config_and_shards_t> config;
+    int num_cpu_shards;
 
     /* `sindexes` is controlled by `want_sindexes`. */
     std::map<std::string, std::pair<sindex_config_t, sindex_status_t> > sindexes;
@@ -347,14 +349,21 @@ public:
     virtual void delete_metadata(
         const namespace_id_t &table_id) = 0;
 
+    /* `load_multistore()` and `create_multistore()` take the number of CPU shards from
+    the table's Raft state (see `table_raft_state_t::num_cpu_shards()`). A new multistore
+    gets that many CPU shards, but an existing one keeps the number that it was created
+    with. The two differ after the table's CPU shards were changed, until
+    `reshard_multistore()` has caught up. */
     virtual void load_multistore(
         const namespace_id_t &table_id,
+        int num_cpu_shards,
         metadata::read_txn_t *metadata_read_txn,
         scoped_ptr_t<multistore_ptr_t> *multistore_ptr_out,
         signal_t *interruptor,
         perfmon_collection_t *perfmon_collection_serializers) = 0;
     virtual void create_multistore(
         const namespace_id_t &table_id,
+        int num_cpu_shards,
         scoped_ptr_t<multistore_ptr_t> *multistore_ptr_out,
         signal_t *interruptor,
         perfmon_collection_t *perfmon_collection_serializers) = 0;
@@ -362,6 +371,20 @@ public:
         const namespace_id_t &table_id,
         scoped_ptr_t<multistore_ptr_t> *multistore_ptr_in) = 0;
 
+    /* `reshard_multistore()` replaces `*multistore_ptr_inout` with a multistore that has
+    `num_cpu_shards` CPU shards. It creates the new multistore next to the old one, calls
+    `copy_data()` to fill it (see `backfill_between_multistores()`), and only then
+    deletes the old one. Nothing else may use the multistore in the meantime. If the
+    server crashes, the table comes back with either the old or the new multistore. */
+    virtual void reshard_multistore(
+        const namespace_id_t &table_id,
+        int num_cpu_shards,
+        const std::function<void(multistore_ptr_t *old_multistore,
+                                 multistore_ptr_t *new_multistore)> &copy_data,
+        scoped_ptr_t<multistore_ptr_t> *multistore_ptr_inout,
+        signal_t *interruptor,
+        perfmon_collection_t *perfmon_collection_serializers) = 0;
+
 protected:
     virtual ~table_persistence_interface_t() { }
 };
@@ -21,11 +21,14 @@
  * Basic configuration parameters.
  */
 
-// The number of hash-based CPU shards per table.
-// This "must" be hard-coded because a cluster cannot run with
-// differing cpu sharding factors.
+// The number of hash-based CPU shards of a table that is created without
+// an explicit `cpu_shards` setting. Every table created before the number
+// became configurable has this many.
 #define CPU_SHARDING_FACTOR                       8
 
+// The most hash-based CPU shards a table can have.
+#define MAX_CPU_SHARDING_FACTOR                   64
+
 // Defines the maximum size of the batch of IO events to process on
 // each loop iteration. A larger number will increase throughput but
 // decrease concurrency
@@ -110,6 +113,21 @@
 // Ticks (in milliseconds) the internal timed tasks are performed at
 #define TIMER_TICKS_IN_MS                         5
 
+// The length of the windows over which we measure how busy each thread is
+#define THREAD_UTILIZATION_WINDOW_MS              100
+
+// A range read evaluates its ReQL transformations on another thread if the thread of
+// its store is at least this busy, and the other thread at most this busy.  It hands
+// the rows over in batches of at most `READ_OFFLOAD_MAX_BATCH_SIZE` rows.  These are
+// the defaults for `read_offload_config` (see `rdb_protocol/btree.hpp`).
+#define READ_OFFLOAD_MIN_STORE_THREAD_UTILIZATION 0.9
+#define READ_OFFLOAD_MAX_HELPER_THREAD_UTILIZATION 0.5
+#define READ_OFFLOAD_MAX_BATCH_SIZE               64
+
+// The most memory, in serialized bytes, that an `inner_join` or `outer_join` puts into
+// the hash table of a hash join (see `rdb_protocol/datum_stream/hash_join.hpp`)
+#define HASH_JOIN_MAX_TABLE_SIZE                  (64 * MEGABYTE)
+
 // How many times the page replacement algorithm tries to find an eligible page before giving up.
 // Note that (MAX_UNSAVED_DATA_LIMIT_FRACTION ** PAGE_REPL_NUM_TRIES) is the probability that the
 // page replacement algorithm will succeed on a given try, and if that probability is less than 1/2
@@ -117,6 +117,10 @@ public:
 
     void append(const void *p, int64_t n);
 
+    // Moves the contents of `other` to the front of this message without copying
+    // them, and leaves `other` empty.
+    void prepend(write_message_t *other);
+
     size_t size() const;
 
     intrusive_list_t<write_buffer_t> *unsafe_expose_buffers() { return &buffers_; }
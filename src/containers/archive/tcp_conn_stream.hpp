@@ -8,6 +8,7 @@
 #include "containers/archive/archive.hpp"
 #include "threading.hpp"
 
+class const_buffer_group_t;
 class signal_t;
 
 class tcp_conn_stream_t : public read_stream_t, public write_stream_t {
@@ -23,6 +24,9 @@ public:
     virtual MUST_USE int64_t read(void *p, int64_t n);
     virtual MUST_USE int64_t write(const void *p, int64_t n);
     virtual MUST_USE int64_t write_buffered(const void *p, int64_t n);
+    // Writes the buffers without copying them. Returns the number of bytes written, or
+    // -1 upon error. See `linux_tcp_conn_t::write_gathered()`.
+    virtual MUST_USE int64_t write_gathered(const const_buffer_group_t *buffers);
     virtual bool flush_buffer();
 
     void rethread(threadnum_t new_thread);
@@ -75,6 +79,7 @@ public:
     virtual MUST_USE int64_t read(void *p, int64_t n);
     virtual MUST_USE int64_t write(const void *p, int64_t n);
     virtual MUST_USE int64_t write_buffered(const void *p, int64_t n);
+    virtual MUST_USE int64_t write_gathered(const const_buffer_group_t *buffers);
     virtual bool flush_buffer();
 
 private:
@@ -41,7 +41,7 @@ inline MUST_USE archive_result_t deserialize_cluster_version(
     } else {
         // This is the same rassert in `ARCHIVE_PRIM_MAKE_RANGED_SERIALIZABLE`.
         if (raw >= static_cast<int8_t>(cluster_version_t::v1_14)
-            && raw <= static_cast<int8_t>(cluster_version_t::v2_4_is_latest)) {
+            && raw <= static_cast<int8_t>(cluster_version_t::v2_5_is_latest)) {
             *thing = static_cast<cluster_version_t>(raw);
         } else {
             throw archive_exc_t{"Unrecognized cluster serialization version."};
@@ -112,8 +112,10 @@ archive_result_t deserialize_for_version(cluster_version_t version,
         return deserialize<cluster_version_t::v2_2>(s, thing);
     case cluster_version_t::v2_3:
         return deserialize<cluster_version_t::v2_3>(s, thing);
-    case cluster_version_t::v2_4_is_latest:
-        return deserialize<cluster_version_t::v2_4_is_latest>(s, thing);
+    case cluster_version_t::v2_4:
+        return deserialize<cluster_version_t::v2_4>(s, thing);
+    case cluster_version_t::v2_5_is_latest:
+        return deserialize<cluster_version_t::v2_5_is_latest>(s, thing);
     default:
         unreachable("deserialize_for_version: unsupported cluster version");
     }
@@ -142,8 +144,10 @@ size_t serialized_size_for_version(cluster_version_t version,
         return serialized_size<cluster_version_t::v2_2>(thing);
     case cluster_version_t::v2_3:
         return serialized_size<cluster_version_t::v2_3>(thing);
-    case cluster_version_t::v2_4_is_latest:
-        return serialized_size<cluster_version_t::v2_4_is_latest>(thing);
+    case cluster_version_t::v2_4:
+        return serialized_size<cluster_version_t::v2_4>(thing);
+    case cluster_version_t::v2_5_is_latest:
+        return serialized_size<cluster_version_t::v2_5_is_latest>(thing);
     default:
         unreachable("serialize_size_for_version: unsupported version");
     }
@@ -197,7 +201,9 @@ size_t serialized_size_for_version(cluster_version_t version,
             read_stream_t *, typ *);                                             \
     template archive_result_t deserialize<cluster_version_t::v2_3>(              \
             read_stream_t *, typ *);                                             \
-    template archive_result_t deserialize<cluster_version_t::v2_4_is_latest>(    \
+    template archive_result_t deserialize<cluster_version_t::v2_4>(              \
+            read_stream_t *, typ *);                                             \
+    template archive_result_t deserialize<cluster_version_t::v2_5_is_latest>(    \
             read_stream_t *, typ *)
 
 #define INSTANTIATE_SERIALIZABLE_SINCE_v1_13(typ)        \
@@ -215,7 +221,9 @@ size_t serialized_size_for_version(cluster_version_t version,
             read_stream_t *, typ *);                                             \
     template archive_result_t deserialize<cluster_version_t::v2_3>(              \
             read_stream_t *, typ *);                                             \
-    template archive_result_t deserialize<cluster_version_t::v2_4_is_latest>(    \
+    template archive_result_t deserialize<cluster_version_t::v2_4>(              \
+            read_stream_t *, typ *);                                             \
+    template archive_result_t deserialize<cluster_version_t::v2_5_is_latest>(    \
             read_stream_t *, typ *)
 
 #define INSTANTIATE_SERIALIZABLE_SINCE_v1_16(typ)        \
@@ -229,7 +237,9 @@ size_t serialized_size_for_version(cluster_version_t version,
             read_stream_t *, typ *);                                             \
     template archive_result_t deserialize<cluster_version_t::v2_3>(              \
             read_stream_t *, typ *);                                             \
-    template archive_result_t deserialize<cluster_version_t::v2_4_is_latest>(    \
+    template archive_result_t deserialize<cluster_version_t::v2_4>(              \
+            read_stream_t *, typ *);                                             \
+    template archive_result_t deserialize<cluster_version_t::v2_5_is_latest>(    \
             read_stream_t *, typ *)
 
 #define INSTANTIATE_SERIALIZABLE_SINCE_v2_1(typ)         \
@@ -241,7 +251,9 @@ size_t serialized_size_for_version(cluster_version_t version,
             read_stream_t *, typ *);                                             \
     template archive_result_t deserialize<cluster_version_t::v2_3>(              \
             read_stream_t *, typ *);                                             \
-    template archive_result_t deserialize<cluster_version_t::v2_4_is_latest>(    \
+    template archive_result_t deserialize<cluster_version_t::v2_4>(              \
+            read_stream_t *, typ *);                                             \
+    template archive_result_t deserialize<cluster_version_t::v2_5_is_latest>(    \
             read_stream_t *, typ *)
 
 #define INSTANTIATE_SERIALIZABLE_SINCE_v2_2(typ)         \
@@ -251,21 +263,33 @@ size_t serialized_size_for_version(cluster_version_t version,
 #define INSTANTIATE_DESERIALIZE_SINCE_v2_3(typ)                                  \
     template archive_result_t deserialize<cluster_version_t::v2_3>(              \
             read_stream_t *, typ *);                                             \
-    template archive_result_t deserialize<cluster_version_t::v2_4_is_latest>(    \
+    template archive_result_t deserialize<cluster_version_t::v2_4>(              \
+            read_stream_t *, typ *);                                             \
+    template archive_result_t deserialize<cluster_version_t::v2_5_is_latest>(    \
             read_stream_t *, typ *)
 
 #define INSTANTIATE_SERIALIZABLE_SINCE_v2_3(typ)         \
     INSTANTIATE_SERIALIZE_FOR_CLUSTER_AND_DISK(typ);     \
     INSTANTIATE_DESERIALIZE_SINCE_v2_3(typ)
 
-#define INSTANTIATE_DESERIALIZE_SINCE_v2_4(typ)                         \
-    template archive_result_t deserialize<cluster_version_t::v2_4_is_latest>( \
+#define INSTANTIATE_DESERIALIZE_SINCE_v2_4(typ)                                  \
+    template archive_result_t deserialize<cluster_version_t::v2_4>(              \
+            read_stream_t *, typ *);                                             \
+    template archive_result_t deserialize<cluster_version_t::v2_5_is_latest>(    \
             read_stream_t *, typ *)
 
 #define INSTANTIATE_SERIALIZABLE_SINCE_v2_4(typ)         \
     INSTANTIATE_SERIALIZE_FOR_CLUSTER_AND_DISK(typ);     \
     INSTANTIATE_DESERIALIZE_SINCE_v2_4(typ)
 
+#define INSTANTIATE_DESERIALIZE_SINCE_v2_5(typ)                                  \
+    template archive_result_t deserialize<cluster_version_t::v2_5_is_latest>(    \
+            read_stream_t *, typ *)
+
+#define INSTANTIATE_SERIALIZABLE_SINCE_v2_5(typ)         \
+    INSTANTIATE_SERIALIZE_FOR_CLUSTER_AND_DISK(typ);     \
+    INSTANTIATE_DESERIALIZE_SINCE_v2_5(typ)
+
 #define INSTANTIATE_SERIALIZABLE_FOR_CLUSTER(typ)                      \
     INSTANTIATE_SERIALIZE_FOR_CLUSTER(typ);                            \
     template archive_result_t deserialize<cluster_version_t::CLUSTER>( \
@@ -0,0 +1,214 @@
+// Copyright 2010-2016 RethinkDB, all rights reserved.
+#ifndef CONTAINERS_OPEN_HASH_MAP_HPP_
+#define CONTAINERS_OPEN_HASH_MAP_HPP_
+
+#include <functional>
+#include <utility>
+#include <vector>
+
+#include "errors.hpp"
+
+/* `open_hash_map_t` is a hash map that uses open addressing with linear probing, so
+lookups walk a contiguous array instead of chasing tree or bucket pointers.  The hash
+of every entry is cached next to it, which means that growing the table never calls
+`Hash` again and probing only calls `Eq` on entries whose hashes match.  That matters
+when keys are expensive to hash and compare, like `ql::datum_t`.
+
+Iteration order is unspecified.  `K` and `V` must be default-constructible and
+movable.  Inserting invalidates iterators and pointers into the map (because of
+rehashing), and so does erasing (because of backward-shift deletion). */
+template <class K, class V, class Hash = std::hash<K>, class Eq = std::equal_to<K> >
+class open_hash_map_t {
+private:
+    struct slot_t {
+        slot_t() : tag(0) { }
+        // 0 if the slot is empty, otherwise the entry's hash with `occupied_bit` set.
+        size_t tag;
+        std::pair<K, V> kv;
+    };
+
+public:
+    typedef std::pair<K, V> value_type;
+
+    class iterator {
+    public:
+        iterator() : slot(nullptr), end(nullptr) { }
+        // Don't modify the key through the iterator.
+        value_type &operator*() const { return slot->kv; }
+        value_type *operator->() const { return &slot->kv; }
+        iterator &operator++() {
+            ++slot;
+            skip_empty();
+            return *this;
+        }
+        bool operator==(const iterator &other) const { return slot == other.slot; }
+        bool operator!=(const iterator &other) const { return slot != other.slot; }
+    private:
+        friend class open_hash_map_t;
+        iterator(slot_t *_slot, slot_t *_end) : slot(_slot), end(_end) {
+            skip_empty();
+        }
+        void skip_empty() {
+            while (slot != end && slot->tag == 0) {
+                ++slot;
+            }
+        }
+        slot_t *slot;
+        slot_t *end;
+    };
+
+    explicit open_hash_map_t(const Hash &_hash = Hash(), const Eq &_eq = Eq())
+        : hash(_hash), eq(_eq), count(0) { }
+
+    open_hash_map_t(open_hash_map_t &&) = default;
+    open_hash_map_t &operator=(open_hash_map_t &&) = default;
+
+    size_t size() const { return count; }
+    bool empty() const { return count == 0; }
+
+    iterator begin() { return iterator(slots.data(), slots.data() + slots.size()); }
+    iterator end() {
+        return iterator(slots.data() + slots.size(), slots.data() + slots.size());
+    }
+
+    // Like `std::map::insert`, this leaves an existing entry for the key alone.  The
+    // `bool` is true if a new entry was inserted.
+    std::pair<iterator, bool> insert(value_type &&val) {
+        const size_t tag = make_tag(val.first);
+        size_t ix;
+        if (find_slot(val.first, tag, &ix)) {
+            return std::make_pair(iterator_at(ix), false);
+        }
+        if ((count + 1) * max_load_denominator > slots.size() * max_load_numerator) {
+            grow();
+            DEBUG_VAR bool found = find_slot(val.first, tag, &ix);
+            rassert(!found);
+        }
+        slots[ix].tag = tag;
+        slots[ix].kv = std::move(val);
+        ++count;
+        return std::make_pair(iterator_at(ix), true);
+    }
+
+    iterator find(const K &key) {
+        size_t ix;
+        if (find_slot(key, make_tag(key), &ix)) {
+            return iterator_at(ix);
+        }
+        return end();
+    }
+
+    V &operator[](const K &key) {
+        return insert(value_type(key, V())).first->second;
+    }
+
+    void erase(iterator pos) {
+        rassert(pos.slot != nullptr && pos.slot->tag != 0);
+        erase_at(pos.slot - slots.data());
+    }
+
+    size_t erase(const K &key) {
+        size_t ix;
+        if (find_slot(key, make_tag(key), &ix)) {
+            erase_at(ix);
+            return 1;
+        }
+        return 0;
+    }
+
+    void clear() {
+        slots.clear();
+        count = 0;
+    }
+
+    void swap(open_hash_map_t &other) {
+        std::swap(hash, other.hash);
+        std::swap(eq, other.eq);
+        slots.swap(other.slots);
+        std::swap(count, other.count);
+    }
+
+private:
+    static const size_t occupied_bit = static_cast<size_t>(1) << (sizeof(size_t) * 8 - 1);
+    static const size_t initial_capacity = 16;
+    // We grow the table once it's more than 3/4 full.
+    static const size_t max_load_numerator = 3;
+    static const size_t max_load_denominator = 4;
+
+    size_t make_tag(const K &key) const { return hash(key) | occupied_bit; }
+    size_t mask() const { return slots.size() - 1; }
+
+    iterator iterator_at(size_t ix) {
+        return iterator(slots.data() + ix, slots.data() + slots.size());
+    }
+
+    // Returns true and sets `*ix_out` to the key's slot if it's present.  Otherwise
+    // returns false and sets `*ix_out` to the empty slot where it belongs (or to 0 if
+    // the table hasn't been allocated yet).
+    bool find_slot(const K &key, size_t tag, size_t *ix_out) const {
+        if (slots.empty()) {
+            *ix_out = 0;
+            return false;
+        }
+        for (size_t ix = tag & mask(); ; ix = (ix + 1) & mask()) {
+            const slot_t &slot = slots[ix];
+            if (slot.tag == 0) {
+                *ix_out = ix;
+                return false;
+            }
+            if (slot.tag == tag && eq(slot.kv.first, key)) {
+                *ix_out = ix;
+                return true;
+            }
+        }
+    }
+
+    void grow() {
+        // (The cast keeps `initial_capacity` from being odr-used.)
+        std::vector<slot_t> old_slots(slots.empty()
+                                      ? static_cast<size_t>(initial_capacity)
+                                      : slots.size() * 2);
+        old_slots.swap(slots);
+        for (slot_t &old_slot : old_slots) {
+            if (old_slot.tag != 0) {
+                size_t ix = old_slot.tag & mask();
+                while (slots[ix].tag != 0) {
+                    ix = (ix + 1) & mask();
+                }
+                slots[ix].tag = old_slot.tag;
+                slots[ix].kv = std::move(old_slot.kv);
+            }
+        }
+    }
+
+    // Backward-shift deletion: rather than leaving a tombstone, we move later
+    // entries of the probe sequence up into the hole so lookups stay short.
+    void erase_at(size_t hole) {
+        for (size_t ix = (hole + 1) & mask(); slots[ix].tag != 0; ix = (ix + 1) & mask()) {
+            const size_t home = slots[ix].tag & mask();
+            // The entry at `ix` can only move into the hole if its home slot isn't
+            // cyclically within `(hole, ix]`.
+            const bool stays = hole <= ix
+                ? (hole < home && home <= ix)
+                : (hole < home || home <= ix);
+            if (!stays) {
+                slots[hole].tag = slots[ix].tag;
+                slots[hole].kv = std::move(slots[ix].kv);
+                hole = ix;
+            }
+        }
+        slots[hole].tag = 0;
+        slots[hole].kv = value_type();
+        --count;
+    }
+
+    Hash hash;
+    Eq eq;
+    // The size is always zero or a power of two.
+    std::vector<slot_t> slots;
+    size_t count;
+
+    DISABLE_COPYING(open_hash_map_t);
+};
+
+#endif  // CONTAINERS_OPEN_HASH_MAP_HPP_
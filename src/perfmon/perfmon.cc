@@ -326,6 +326,25 @@ ql::datum_t perfmon_rate_monitor_t::output_stat(const double &stat) {
     return ql::datum_t(stat / ticks_to_secs(length));
 }
 
+/* perfmon_thread_utilization_t */
+
+void perfmon_thread_utilization_t::get_thread_stat(double *stat) {
+    *stat = get_thread_utilization(get_thread_id());
+}
+
+std::vector<double> perfmon_thread_utilization_t::combine_stats(const double *data) {
+    return std::vector<double>(data, data + get_num_threads());
+}
+
+ql::datum_t perfmon_thread_utilization_t::output_stat(
+        const std::vector<double> &stat) {
+    ql::datum_array_builder_t builder(ql::configured_limits_t::unlimited);
+    for (double utilization : stat) {
+        builder.add(ql::datum_t(utilization));
+    }
+    return std::move(builder).to_datum();
+}
+
 perfmon_duration_sampler_t::perfmon_duration_sampler_t(ticks_t length, bool _ignore_global_full_perfmon, int n_threads)
     : stat(), active(n_threads), total(n_threads), recent(length, true, n_threads),
       active_membership(&stat, &active, "active_count"),
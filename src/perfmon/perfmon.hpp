@@ -13,6 +13,7 @@
 #include <string>
 #include <map>
 #include <memory>
+#include <vector>
 
 #include "concurrency/cache_line_padded.hpp"
 #include "config/args.hpp"
@@ -23,6 +24,7 @@
 // Some arch/runtime declarations.
 int get_num_threads();
 threadnum_t get_thread_id();
+double get_thread_utilization(threadnum_t thread);
 
 /* When `global_full_perfmon` is true, some perfmons will perform more
  * elaborate stat calculations, which might take longer but will produce more
@@ -215,6 +217,23 @@ public:
     void record(double value = 1.0);
 };
 
+/* perfmon_thread_utilization_t reports which fraction of the recent past each thread
+ * spent working rather than waiting for events, as an array with one number between 0
+ * and 1 per thread (see `thread_utilization_t`).
+ */
+class perfmon_thread_utilization_t
+    : public perfmon_perthread_t<perfmon_thread_utilization_t> {
+private:
+    friend class perfmon_perthread_t<perfmon_thread_utilization_t>;
+    void get_thread_stat(double *);
+    std::vector<double> combine_stats(const double *);
+    ql::datum_t output_stat(const std::vector<double> &);
+public:
+    typedef double thread_stat_type;
+    typedef std::vector<double> combined_stat_type;
+    perfmon_thread_utilization_t() { }
+};
+
 /* perfmon_duration_sampler_t is a perfmon_t that monitors events that have a
  * starting and ending time. When something starts, call begin(); when
  * something ends, call end() with the same value as begin. It will produce
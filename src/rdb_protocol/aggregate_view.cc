@@ -0,0 +1,144 @@
+// Copyright 2010-2016 RethinkDB, all rights reserved.
+#include "rdb_protocol/aggregate_view.hpp"
+
+#include "containers/archive/boost_types.hpp"
+#include "containers/archive/stl_types.hpp"
+#include "containers/archive/vector_stream.hpp"
+#include "rdb_protocol/env.hpp"
+#include "rdb_protocol/func.hpp"
+
+namespace ql {
+
+optional<std::string> aggregate_view_t::key_for(
+        const std::vector<transform_variant_t> &transforms,
+        const optional<terminal_variant_t> &terminal) {
+    // Of the terminals that can be updated when a row goes away, only `count` stays
+    // exact (see the comment on `aggregate_view_t`).
+    if (!terminal.has_value()
+        || boost::get<count_wire_func_t>(&*terminal) == nullptr) {
+        return r_nullopt;
+    }
+    // A view can only be maintained through transformations that are deterministic
+    // and look at one row at a time.
+    for (const auto &transform : transforms) {
+        if (!is_row_local_and_deterministic(transform)) {
+            return r_nullopt;
+        }
+    }
+    // Like `sindex_config_t::operator==`, we identify the functions by their
+    // serialization.
+    write_message_t wm;
+    serialize<cluster_version_t::CLUSTER>(&wm, transforms);
+    serialize<cluster_version_t::CLUSTER>(&wm, *terminal);
+    vector_stream_t stream;
+    int res = send_write_message(&stream, &wm);
+    guarantee(res == 0);
+    return make_optional(std::string(stream.vector().begin(), stream.vector().end()));
+}
+
+aggregate_view_t::aggregate_view_t(
+        rdb_context_t *ctx,
+        const serializable_env_t &s_env,
+        const std::vector<transform_variant_t> &transforms,
+        const terminal_variant_t &_terminal)
+    : terminal(_terminal), built(false) {
+    guarantee(boost::get<count_wire_func_t>(&terminal) != nullptr);
+    // The final `nullptr` argument means we don't profile any work done with this `env`.
+    env = make_scoped<env_t>(
+        ctx,
+        return_empty_normal_batches_t::NO,
+        &non_interruptor,
+        s_env,
+        nullptr);
+    for (const auto &transform : transforms) {
+        ops.push_back(make_op(transform));
+    }
+}
+
+bool aggregate_view_t::finish_build(const result_t &res) {
+    guarantee(!built);
+    built = true;
+    if (!add_result(res, false)) {
+        return false;
+    }
+    for (const auto &pair : groups) {
+        if (pair.second < 0) {
+            // The changes removed rows that weren't in the snapshot.
+            return false;
+        }
+    }
+    return true;
+}
+
+bool aggregate_view_t::apply_change(const datum_t &old_val, const datum_t &new_val) {
+    result_t old_res, new_res;
+    try {
+        if (old_val.has()) {
+            old_res = accumulate_row(old_val);
+        }
+        if (new_val.has()) {
+            new_res = accumulate_row(new_val);
+        }
+    } catch (const base_exc_t &) {
+        return false;
+    }
+    return add_result(old_res, true) && add_result(new_res, false);
+}
+
+result_t aggregate_view_t::get_result() {
+    guarantee(built);
+    result_t out = grouped_t<uint64_t>();
+    auto *map = boost::get<grouped_t<uint64_t> >(&out)->get_underlying_map();
+    for (const auto &pair : groups) {
+        map->insert(std::make_pair(pair.first, static_cast<uint64_t>(pair.second)));
+    }
+    return out;
+}
+
+result_t aggregate_view_t::accumulate_row(const datum_t &row) {
+    // This mirrors what `rget_cb_t` does with every row it reads.
+    groups_t data = {{datum_t(), datums_t{row}}};
+    auto no_sindex_val = []() { return datum_t(); };
+    for (const auto &op : ops) {
+        (*op)(env.get(), &data, no_sindex_val);
+    }
+    scoped_ptr_t<accumulator_t> acc = make_terminal(terminal);
+    (*acc)(env.get(), &data, store_key_t(), no_sindex_val);
+    result_t res;
+    acc->finish(continue_bool_t::CONTINUE, &res);
+    return res;
+}
+
+bool aggregate_view_t::add_result(const result_t &res, bool subtract) {
+    const auto *counts = boost::get<grouped_t<uint64_t> >(&res);
+    if (counts == nullptr) {
+        return false;
+    }
+    for (const auto &delta : *counts->get_underlying_map()) {
+        int64_t count = static_cast<int64_t>(delta.second);
+        if (subtract) {
+            auto it = groups.find(delta.first);
+            if (built && (it == groups.end() || it->second < count)) {
+                // The view doesn't match the shard.
+                return false;
+            }
+            if (it == groups.end()) {
+                groups[delta.first] = -count;
+            } else {
+                it->second -= count;
+                if (it->second == 0) {
+                    groups.erase(it);
+                }
+            }
+        } else {
+            int64_t *value = &groups[delta.first];
+            *value += count;
+            if (*value == 0) {
+                groups.erase(delta.first);
+            }
+        }
+    }
+    return true;
+}
+
+}  // namespace ql
@@ -0,0 +1,90 @@
+// Copyright 2010-2016 RethinkDB, all rights reserved.
+#ifndef RDB_PROTOCOL_AGGREGATE_VIEW_HPP_
+#define RDB_PROTOCOL_AGGREGATE_VIEW_HPP_
+
+#include <string>
+#include <vector>
+
+#include "concurrency/cond_var.hpp"
+#include "containers/optional.hpp"
+#include "containers/scoped.hpp"
+#include "rdb_protocol/shards.hpp"
+
+class rdb_context_t;
+struct serializable_env_t;
+
+namespace ql {
+
+class env_t;
+
+/* An `aggregate_view_t` is a materialized `count` over one shard of a table,
+optionally after row-by-row transformations like `group`, `map` and `filter`.  It lives
+in the shard's `changefeed::server_t`, which applies every modification of the shard
+to it, so reading it is as good as running the aggregation but doesn't have to scan
+the shard.  The server is destroyed when the shard is resharded, and with it the
+view; the next read then builds it again from a snapshot.  Backfills and
+`store_t::reset_data` drop the views instead of updating them.
+
+Only reads that ask for it with `r.table(..., aggregate_views=True)` use views.  They
+are a cache for such reads, not a kind of table of their own: a view that isn't read
+for a while is dropped, and the next read builds it again.
+
+A view is registered before its first scan, at the point of the snapshot that the
+scan reads, so that the writes that happen during the scan can be applied to it.
+Until `finish_build` adds the result of the scan, it only holds the sum of those
+changes, which can be negative.
+
+We don't keep views for `sum`: adding and subtracting the values of rows as they
+change can drift from summing the rows from scratch by floating-point rounding, and a
+view must always give exactly the result of the scan. */
+class aggregate_view_t {
+public:
+    // Returns the key that identifies views for `transforms` and `terminal`, or
+    // `r_nullopt` if we can't maintain such a view.
+    static optional<std::string> key_for(
+        const std::vector<transform_variant_t> &transforms,
+        const optional<terminal_variant_t> &terminal);
+
+    aggregate_view_t(rdb_context_t *ctx,
+                     const serializable_env_t &s_env,
+                     const std::vector<transform_variant_t> &transforms,
+                     const terminal_variant_t &terminal);
+
+    // `built` is the result of reading the snapshot with `terminal`.  Returns false
+    // if it doesn't fit the changes that were applied since, in which case the view
+    // must be discarded.
+    MUST_USE bool finish_build(const result_t &built);
+    bool is_built() const { return built; }
+
+    // Applies a change to a row of the shard.  `old_val` is empty if the row was
+    // inserted and `new_val` is empty if it was deleted.  Returns false if the view
+    // can't be maintained any more (e.g. because the aggregation fails on
+    // `new_val`), in which case it must be discarded.
+    MUST_USE bool apply_change(const datum_t &old_val, const datum_t &new_val);
+
+    // Returns what reading the shard with the terminal would.  Only call this once
+    // the view is built.
+    result_t get_result();
+
+private:
+    // Runs the transformations and the terminal on `row`.  Throws if the
+    // aggregation fails.
+    result_t accumulate_row(const datum_t &row);
+    MUST_USE bool add_result(const result_t &res, bool subtract);
+
+    cond_t non_interruptor;
+    scoped_ptr_t<env_t> env;
+    std::vector<scoped_ptr_t<op_t> > ops;
+    const terminal_variant_t terminal;
+
+    bool built;
+    // The number of elements that were accumulated into each group.  These are only
+    // negative while the view is being built.
+    hashed_groups_t<int64_t> groups;
+
+    DISABLE_COPYING(aggregate_view_t);
+};
+
+}  // namespace ql
+
+#endif  // RDB_PROTOCOL_AGGREGATE_VIEW_HPP_
@@ -11,19 +11,26 @@
 #include <string>
 #include <vector>
 
+#include "arch/runtime/coroutines.hpp"
+#include "arch/runtime/runtime.hpp"
 #include "btree/concurrent_traversal.hpp"
 #include "btree/get_distribution.hpp"
 #include "btree/operations.hpp"
 #include "btree/reql_specific.hpp"
 #include "btree/superblock.hpp"
 #include "buffer_cache/serialize_onto_blob.hpp"
+#include "concurrency/cond_var.hpp"
 #include "concurrency/coro_pool.hpp"
+#include "concurrency/cross_thread_signal.hpp"
+#include "concurrency/interruptor.hpp"
 #include "concurrency/new_mutex.hpp"
 #include "concurrency/queue/unlimited_fifo.hpp"
 #include "containers/archive/boost_types.hpp"
 #include "containers/archive/buffer_group_stream.hpp"
 #include "containers/archive/buffer_stream.hpp"
+#include "config/args.hpp"
 #include "containers/scoped.hpp"
+#include "random.hpp"
 #include "rdb_protocol/geo/exceptions.hpp"
 #include "rdb_protocol/geo/indexing.hpp"
 #include "rdb_protocol/blob_wrapper.hpp"
@@ -652,9 +659,12 @@ public:
                                         std::move(last_key),
                                         sorting,
                                         batcher.get(),
-                                        require_sindex_val)) {
+                                        require_sindex_val)),
+          transformers_are_row_local(!_transforms.empty()) {
         for (size_t i = 0; i < _transforms.size(); ++i) {
             transformers.push_back(ql::make_op(_transforms[i]));
+            transformers_are_row_local &=
+                ql::is_row_local_and_deterministic(_transforms[i]);
         }
         guarantee(transformers.size() == _transforms.size());
     }
@@ -670,6 +680,9 @@ private:
     std::vector<scoped_ptr_t<ql::op_t> > transformers;
     sorting_t sorting;
     scoped_ptr_t<ql::accumulator_t> accumulator;
+    // True if there are transformers and we can run them on any thread and in any
+    // order (see `ql::is_row_local_and_deterministic()`).
+    bool transformers_are_row_local;
 };
 
 class rget_io_data_t {
@@ -683,11 +696,33 @@ private:
 };
 
 
+read_offload_config_t read_offload_config = {
+    READ_OFFLOAD_MIN_STORE_THREAD_UTILIZATION,
+    READ_OFFLOAD_MAX_HELPER_THREAD_UTILIZATION,
+    READ_OFFLOAD_MAX_BATCH_SIZE
+};
+
+// Rows whose transformers `rget_cb_t` runs together on another thread.  Each row's
+// `handle_pair()` adds its row and then waits for `done`.
+class offload_batch_t : public single_threaded_countable_t<offload_batch_t> {
+public:
+    explicit offload_batch_t(threadnum_t _thread)
+        : thread(_thread), interrupted(false) { }
+    const threadnum_t thread;
+    std::vector<ql::groups_t> rows;
+    // The error for each row in `rows`, if its transformers failed
+    std::vector<optional<ql::exc_t> > errors;
+    // Set if we were interrupted before all of the rows were transformed
+    bool interrupted;
+    cond_t done;
+};
+
 class rget_cb_t {
 public:
     rget_cb_t(rget_io_data_t &&_io,
               job_data_t &&_job,
               optional<rget_sindex_data_t> &&_sindex);
+    ~rget_cb_t();
 
     continue_bool_t handle_pair(
         scoped_key_value_t &&keyvalue,
@@ -697,17 +732,59 @@ public:
         THROWS_ONLY(interrupted_exc_t);
     void finish(continue_bool_t last_cb) THROWS_ONLY(interrupted_exc_t);
 private:
+    // Returns how many times the row at `key` falls into the sindex range, if
+    // that can be decided from the key alone, or `r_nullopt` if we need to compute
+    // the row's secondary index value.  For a `get_all`, `default_copies` is how
+    // often the key `skey_left` was requested.
+    //
+    // This is what keeps `count()` over a sindex range from loading the rows.  It
+    // still visits every leaf entry in the range, so the count stays linear in the
+    // number of matching rows.  Making it logarithmic would take per-subtree
+    // counters in the internal nodes, which would change the btree's disk format
+    // and every split, merge and level path, so we don't do that.
+    optional<size_t> sindex_copies_from_key(
+        const store_key_t &key,
+        size_t default_copies,
+        const optional<std::string> &skey_left) const;
+
+    // Returns a thread to run the transformers for the next batch of rows on, or
+    // `r_nullopt` if we should run them here.  We only move work away from the store's
+    // thread while that thread is saturated, and only to threads that have time to
+    // spare.
+    optional<threadnum_t> pick_offload_thread();
+    // Adds `data` to the batch that we're about to hand to another thread, or starts a
+    // new one.  Returns the batch and sets `*index_out` to the position of `data` in
+    // it, or returns an empty `counted_t` if we should transform `data` here.
+    counted_t<offload_batch_t> offload(ql::groups_t &&data, size_t *index_out);
+    // Closes `batch`, so no more rows are added to it, and runs the transformers for
+    // all of its rows on its thread, in a single `env_t`.
+    void run_offload_batch(
+        counted_t<offload_batch_t> batch,
+        auto_drainer_t::lock_t keepalive);
+
     const rget_io_data_t io; // How do get data in/out.
     job_data_t job; // What to do next (stateful).
     const optional<rget_sindex_data_t> sindex; // Optional sindex information.
 
     scoped_ptr_t<ql::env_t> sindex_env;
 
+    bool can_offload;
+    int next_offload_candidate;
+    // `job.env->interruptor` on other threads, indexed by thread number.  We create
+    // them the first time we run transformers on the respective thread.
+    std::vector<scoped_ptr_t<cross_thread_signal_t> > offload_interruptors;
+    // The batch that rows are being added to, until `run_offload_batch()` starts on
+    // it.  Rows that the traversal hands us in the meantime end up in the same batch.
+    counted_t<offload_batch_t> open_offload_batch;
+
     // State for internal bookkeeping.
     bool bad_init;
     optional<std::string> last_truncated_secondary_for_abort;
     scoped_ptr_t<profile::disabler_t> disabler;
     scoped_ptr_t<profile::sampler_t> sampler;
+
+    // Keeps the `run_offload_batch()` coroutines from outliving us.
+    auto_drainer_t drainer;
 };
 
 // This is the interface the btree code expects, but our actual callback needs a
@@ -741,6 +818,8 @@ rget_cb_t::rget_cb_t(rget_io_data_t &&_io,
     : io(std::move(_io)),
       job(std::move(_job)),
       sindex(std::move(_sindex)),
+      can_offload(false),
+      next_offload_candidate(0),
       bad_init(false) {
 
     if (sindex) {
@@ -758,12 +837,219 @@ rget_cb_t::rget_cb_t(rget_io_data_t &&_io,
     disabler.init(new profile::disabler_t(job.env->trace));
     sampler.init(new profile::sampler_t("Range traversal doc evaluation.",
                                         job.env->trace));
+
+    // The profiler trace can't be shared with other threads, and we need an
+    // `rdb_context_t` to set up the environments there.
+    can_offload = job.transformers_are_row_local
+        && job.env->profile() == profile_bool_t::DONT_PROFILE
+        && job.env->get_rdb_ctx() != nullptr
+        && get_num_db_threads() > 1;
+    if (can_offload) {
+        offload_interruptors.resize(get_num_threads());
+        next_offload_candidate = randint(get_num_db_threads());
+    }
+}
+
+rget_cb_t::~rget_cb_t() {
+    // `run_offload_batch()` uses `job` and `offload_interruptors`.
+    drainer.drain();
 }
 
 void rget_cb_t::finish(continue_bool_t last_cb) THROWS_ONLY(interrupted_exc_t) {
     job.accumulator->finish(last_cb, &io.response->result);
 }
 
+optional<threadnum_t> rget_cb_t::pick_offload_thread() {
+    if (!can_offload
+        || get_thread_utilization(get_thread_id())
+           < read_offload_config.min_store_thread_utilization) {
+        return r_nullopt;
+    }
+    // We only look at a few threads for each batch, but we start where we left off
+    // the last time, so we get around to all of them.
+    const int num_threads = get_num_db_threads();
+    for (int i = 0; i < std::min(num_threads, 4); ++i) {
+        threadnum_t thread(next_offload_candidate);
+        next_offload_candidate = (next_offload_candidate + 1) % num_threads;
+        if (thread != get_thread_id()
+            && get_thread_utilization(thread)
+               <= read_offload_config.max_helper_thread_utilization) {
+            return make_optional(thread);
+        }
+    }
+    return r_nullopt;
+}
+
+counted_t<offload_batch_t> rget_cb_t::offload(
+        ql::groups_t &&data, size_t *index_out) {
+    if (!open_offload_batch.has()) {
+        optional<threadnum_t> thread = pick_offload_thread();
+        if (!thread) {
+            return counted_t<offload_batch_t>();
+        }
+        open_offload_batch = make_counted<offload_batch_t>(*thread);
+        // `spawn_later_ordered()` only starts the batch once the rows that are ready
+        // in this pass of the event loop have joined it.
+        coro_t::spawn_later_ordered(std::bind(&rget_cb_t::run_offload_batch,
+                                              this,
+                                              open_offload_batch,
+                                              auto_drainer_t::lock_t(&drainer)));
+    }
+    counted_t<offload_batch_t> batch = open_offload_batch;
+    *index_out = batch->rows.size();
+    batch->rows.push_back(std::move(data));
+    if (batch->rows.size() >= read_offload_config.max_batch_size) {
+        open_offload_batch.reset();
+    }
+    return batch;
+}
+
+void rget_cb_t::run_offload_batch(
+        counted_t<offload_batch_t> batch,
+        auto_drainer_t::lock_t) {
+    if (open_offload_batch.get() == batch.get()) {
+        open_offload_batch.reset();
+    }
+    offload_batch_t *b = batch.get();
+    b->errors.resize(b->rows.size());
+    scoped_ptr_t<cross_thread_signal_t> *interruptor =
+        &offload_interruptors[b->thread.threadnum];
+    if (!interruptor->has()) {
+        interruptor->init(new cross_thread_signal_t(job.env->interruptor, b->thread));
+    }
+    serializable_env_t s_env = job.env->get_serializable_env();
+
+    try {
+        on_thread_t thread_switcher(b->thread);
+        ql::env_t env(job.env->get_rdb_ctx(),
+                      ql::return_empty_normal_batches_t::NO,
+                      interruptor->get(),
+                      std::move(s_env),
+                      nullptr);
+        for (size_t i = 0; i < b->rows.size(); ++i) {
+            try {
+                for (auto it = job.transformers.begin();
+                     it != job.transformers.end();
+                     ++it) {
+                    (**it)(&env, &b->rows[i], []() { return ql::datum_t(); });
+                }
+            } catch (const ql::exc_t &e) {
+                b->errors[i].set(e);
+            }
+        }
+    } catch (const interrupted_exc_t &) {
+        b->interrupted = true;
+    }
+    b->done.pulse();
+}
+
+optional<size_t> rget_cb_t::sindex_copies_from_key(
+        const store_key_t &key,
+        size_t default_copies,
+        const optional<std::string> &skey_left) const {
+    guarantee(sindex);
+    /* Here's an attempt at explaining the different case distinctions handled in
+       this check (for the left bound; the right bound check is similar):
+       The case distinctions are as follows:
+       1. left_bound_is_truncated
+        If the left bound key had to be truncated, we first compare the prefix of
+        the current secondary key (skey_current), and the left bound key.
+        The comparison cannot be -1, because that would mean that we computed the
+        traversal key range incorrectly in the first place (there's no need to
+        consider keys that are *smaller* than the left bound).
+        If the comparison is 1, the current key's secondary part is larger than
+        the left bound, and we know that the corresponding datum_t value must
+        also be larger than the datum_t corresponding to the left bound.
+        Finally, since the left bound is truncated, the comparison can determine
+        that the prefix is equal for values in the btree with corresponding index
+        values that are either left of the bound (but match in the truncated
+        prefix), at the bound (which we want to include only if the left bound is
+        closed), or right of the bound (which we always want to include, as far
+        as the left bound id concerned). We can't determine which case we have,
+        by looking only at the keys. Hence we must check the number of copies for
+        `cmp == 0`. The only exception is if the current key was actually not
+        truncated, in which case we know that it will actually be smaller than
+        the left bound.
+       2. !left_bound_is_truncated && left_bound is closed
+        If the bound wasn't truncated, we know that the traversal range will not
+        include any values which are smaller than the left bound. Hence we can
+        skip the check for whether the sindex value is actually in the datum
+        range.
+       3. !left_bound_is_truncated && left_bound is open
+        In contrast, if the left bound is open, we compare the left bound and
+        current key. If they have the same size and their contents compare equal,
+        we actually know that they are outside the range and could set the number
+        of copies to 0. We do the slightly less optimal but simpler thing and
+        just check the number of copies in this case, so that we can share the
+        code path with case 1. */
+    const size_t max_trunc_size = ql::datum_t::max_trunc_size();
+    return sindex->datumspec.visit<optional<size_t> >(
+    [&](const ql::datum_range_t &r) -> optional<size_t> {
+        bool must_check_copies = false;
+        std::string skey_current =
+            ql::datum_t::extract_truncated_secondary(key_to_unescaped_str(key));
+        const bool left_bound_is_truncated =
+            sindex->lbound_trunc_key.size() == max_trunc_size;
+        if (left_bound_is_truncated
+            || r.left_bound_type == key_range_t::bound_t::open) {
+            int cmp = memcmp(
+                skey_current.data(),
+                sindex->lbound_trunc_key.data(),
+                std::min<size_t>(skey_current.size(),
+                                 sindex->lbound_trunc_key.size()));
+            if (skey_current.size() < sindex->lbound_trunc_key.size()) {
+                guarantee(cmp != 0);
+            }
+            guarantee(cmp >= 0);
+            if (cmp == 0
+                && skey_current.size() == sindex->lbound_trunc_key.size()) {
+                must_check_copies = true;
+            }
+        }
+        if (!must_check_copies) {
+            const bool right_bound_is_truncated =
+                sindex->rbound_trunc_key.size() == max_trunc_size;
+            if (right_bound_is_truncated
+                || r.right_bound_type == key_range_t::bound_t::open) {
+                int cmp = memcmp(
+                    skey_current.data(),
+                    sindex->rbound_trunc_key.data(),
+                    std::min<size_t>(skey_current.size(),
+                                     sindex->rbound_trunc_key.size()));
+                if (skey_current.size() > sindex->rbound_trunc_key.size()) {
+                    guarantee(cmp != 0);
+                }
+                guarantee(cmp <= 0);
+                if (cmp == 0
+                    && skey_current.size() == sindex->rbound_trunc_key.size()) {
+                    must_check_copies = true;
+                }
+            }
+        }
+        if (must_check_copies) {
+            return r_nullopt;
+        } else {
+            return make_optional<size_t>(1);
+        }
+    },
+    [&](const std::map<ql::datum_t, uint64_t> &) -> optional<size_t> {
+        guarantee(skey_left);
+        std::string skey_current =
+            ql::datum_t::extract_secondary(key_to_unescaped_str(key));
+        const bool skey_current_is_truncated =
+            skey_current.size() >= max_trunc_size;
+        const bool skey_left_is_truncated = skey_left->size() >= max_trunc_size;
+
+        if (skey_current_is_truncated || skey_left_is_truncated) {
+            return r_nullopt;
+        } else if (*skey_left != skey_current) {
+            return make_optional<size_t>(0);
+        } else {
+            return make_optional(default_copies);
+        }
+    });
+}
+
 // Handle a keyvalue pair.  Returns whether or not we're done early.
 continue_bool_t rget_cb_t::handle_pair(
     scoped_key_value_t &&keyvalue,
@@ -784,20 +1070,58 @@ continue_bool_t rget_cb_t::handle_pair(
     if (sindex && !sindex->pkey_range.contains_key(ql::datum_t::extract_primary(key))) {
         return continue_bool_t::CONTINUE;
     }
+    // Most of the time we can tell from the key alone whether a row is in the
+    // sindex range.  Only if we can't do we need the row's value to compute its
+    // secondary index value.
+    optional<size_t> sindex_copies;
+    if (sindex) {
+        sindex_copies = sindex_copies_from_key(key, default_copies, skey_left);
+    }
     lazy_btree_val_t row(static_cast<const rdb_value_t *>(keyvalue.value()),
                          keyvalue.expose_buf());
     ql::datum_t val;
     // Count stats whether or not we deserialize the value
     io.slice->stats.pm_keys_read.record();
     io.slice->stats.pm_total_keys_read += 1;
-    // We only load the value if we actually use it (`count` does not).
-    if (job.accumulator->uses_val() || job.transformers.size() != 0 || sindex) {
+    // We only load the value if we actually use it (`count` does not, even on a
+    // secondary index range, as long as the keys tell us which rows to count).
+    if (job.accumulator->uses_val()
+        || job.transformers.size() != 0
+        || (sindex && !sindex_copies)) {
         val = row.get();
     } else {
         row.reset();
     }
     guarantee(!row.references_parent());
     keyvalue.reset();
+
+    // If the store's thread is saturated, we run the transformers for this row on
+    // another thread, together with the other rows that are ready at the same time,
+    // while we go on with the traversal here.  That's fine because `can_offload` means
+    // that they don't care about the order of the rows, and they can't use the
+    // secondary index value.  Errors are only reported once it's this row's turn,
+    // just like they would be otherwise.
+    optional<ql::groups_t> offloaded_data;
+    optional<ql::exc_t> offloaded_exc;
+    if (val.has() && (!sindex || (sindex_copies && *sindex_copies > 0))) {
+        size_t index;
+        counted_t<offload_batch_t> batch = offload(
+            {{ql::datum_t(), ql::datums_t(
+                sindex ? *sindex_copies : default_copies, val)}},
+            &index);
+        if (batch.has()) {
+            wait_interruptible(&batch->done, job.env->interruptor);
+            if (batch->interrupted) {
+                throw interrupted_exc_t();
+            }
+            if (batch->errors[index]) {
+                offloaded_exc = std::move(batch->errors[index]);
+            } else {
+                offloaded_data.set(std::move(batch->rows[index]));
+            }
+        }
+    }
+
     waiter.wait_interruptible(); // This enforces ordering.
 
     ///////////////////////////////////////////////////////
@@ -873,113 +1197,27 @@ continue_bool_t rget_cb_t::handle_pair(
         // the involved keys are truncated.
         size_t copies = default_copies;
         if (sindex) {
-            /* Here's an attempt at explaining the different case distinctions handled in
-               this check (for the left bound; the right bound check is similar):
-               The case distinctions are as follows:
-               1. left_bound_is_truncated
-                If the left bound key had to be truncated, we first compare the prefix of
-                the current secondary key (skey_current), and the left bound key.
-                The comparison cannot be -1, because that would mean that we computed the
-                traversal key range incorrectly in the first place (there's no need to
-                consider keys that are *smaller* than the left bound).
-                If the comparison is 1, the current key's secondary part is larger than
-                the left bound, and we know that the corresponding datum_t value must
-                also be larger than the datum_t corresponding to the left bound.
-                Finally, since the left bound is truncated, the comparison can determine
-                that the prefix is equal for values in the btree with corresponding index
-                values that are either left of the bound (but match in the truncated
-                prefix), at the bound (which we want to include only if the left bound is
-                closed), or right of the bound (which we always want to include, as far
-                as the left bound id concerned). We can't determine which case we have,
-                by looking only at the keys. Hence we must check the number of copies for
-                `cmp == 0`. The only exception is if the current key was actually not
-                truncated, in which case we know that it will actually be smaller than
-                the left bound (that's encoded in line 825).
-               2. !left_bound_is_truncated && left_bound is closed
-                If the bound wasn't truncated, we know that the traversal range will not
-                include any values which are smaller than the left bound. Hence we can
-                skip the check for whether the sindex value is actually in the datum
-                range.
-               3. !left_bound_is_truncated && left_bound is open
-                In contrast, if the left bound is open, we compare the left bound and
-                current key. If they have the same size and their contents compare equal,
-                we actually know that they are outside the range and could set the number
-                of copies to 0. We do the slightly less optimal but simpler thing and
-                just check the number of copies in this case, so that we can share the
-                code path with case 1. */
-            const size_t max_trunc_size = ql::datum_t::max_trunc_size();
-            sindex->datumspec.visit<void>(
-            [&](const ql::datum_range_t &r) {
-                bool must_check_copies = false;
-                std::string skey_current =
-                    ql::datum_t::extract_truncated_secondary(key_to_unescaped_str(key));
-                const bool left_bound_is_truncated =
-                    sindex->lbound_trunc_key.size() == max_trunc_size;
-                if (left_bound_is_truncated
-                    || r.left_bound_type == key_range_t::bound_t::open) {
-                    int cmp = memcmp(
-                        skey_current.data(),
-                        sindex->lbound_trunc_key.data(),
-                        std::min<size_t>(skey_current.size(),
-                                         sindex->lbound_trunc_key.size()));
-                    if (skey_current.size() < sindex->lbound_trunc_key.size()) {
-                        guarantee(cmp != 0);
-                    }
-                    guarantee(cmp >= 0);
-                    if (cmp == 0
-                        && skey_current.size() == sindex->lbound_trunc_key.size()) {
-                        must_check_copies = true;
-                    }
-                }
-                if (!must_check_copies) {
-                    const bool right_bound_is_truncated =
-                        sindex->rbound_trunc_key.size() == max_trunc_size;
-                    if (right_bound_is_truncated
-                        || r.right_bound_type == key_range_t::bound_t::open) {
-                        int cmp = memcmp(
-                            skey_current.data(),
-                            sindex->rbound_trunc_key.data(),
-                            std::min<size_t>(skey_current.size(),
-                                             sindex->rbound_trunc_key.size()));
-                        if (skey_current.size() > sindex->rbound_trunc_key.size()) {
-                            guarantee(cmp != 0);
-                        }
-                        guarantee(cmp <= 0);
-                        if (cmp == 0
-                            && skey_current.size() == sindex->rbound_trunc_key.size()) {
-                            must_check_copies = true;
-                        }
-                    }
-                }
-                if (must_check_copies) {
-                    copies = sindex->datumspec.copies(lazy_sindex_val());
-                } else {
-                    copies = 1;
-                }
-            },
-            [&](const std::map<ql::datum_t, uint64_t> &) {
-                guarantee(skey_left);
-                std::string skey_current =
-                    ql::datum_t::extract_secondary(key_to_unescaped_str(key));
-                const bool skey_current_is_truncated =
-                    skey_current.size() >= max_trunc_size;
-                const bool skey_left_is_truncated = skey_left->size() >= max_trunc_size;
-
-                if (skey_current_is_truncated || skey_left_is_truncated) {
-                    copies = sindex->datumspec.copies(lazy_sindex_val());
-                } else if (*skey_left != skey_current) {
-                    copies = 0;
-                }
-            });
+            copies = sindex_copies
+                ? *sindex_copies
+                : sindex->datumspec.copies(lazy_sindex_val());
             if (copies == 0) {
                 return continue_bool_t::CONTINUE;
             }
         }
 
-        ql::groups_t data = {{ql::datum_t(), ql::datums_t(copies, val)}};
-
-        for (auto it = job.transformers.begin(); it != job.transformers.end(); ++it) {
-            (**it)(job.env, &data, lazy_sindex_val);
+        if (offloaded_exc) {
+            throw *offloaded_exc;
+        }
+        ql::groups_t data;
+        if (offloaded_data) {
+            data = std::move(*offloaded_data);
+        } else {
+            data = {{ql::datum_t(), ql::datums_t(copies, val)}};
+            for (auto it = job.transformers.begin();
+                 it != job.transformers.end();
+                 ++it) {
+                (**it)(job.env, &data, lazy_sindex_val);
+            }
         }
         // We need lots of extra data for the accumulation because we might be
         // accumulating `rget_item_t`s for a batch.
@@ -1436,6 +1674,11 @@ void rdb_modification_report_cb_t::on_mod_report(
         }
         keys_available_cond.wait_lazily_unordered();
         if (cserver.first != nullptr) {
+            cserver.first->update_aggregate_views(
+                report.info.deleted.first,
+                report.info.added.first,
+                cfeed_stamp_spot,
+                cserver.second);
             cserver.first->send_all(
                 ql::changefeed::msg_t(
                     ql::changefeed::msg_t::change_t{
@@ -1443,7 +1686,8 @@ void rdb_modification_report_cb_t::on_mod_report(
                         new_cfeed_keys,
                         report.primary_key,
                         report.info.deleted.first,
-                        report.info.added.first}),
+                        report.info.added.first,
+                        0 /* `send_all` assigns the position */}),
                 report.primary_key,
                 cfeed_stamp_spot,
                 cserver.second);
@@ -1662,7 +1906,8 @@ void deserialize_sindex_info(
     case cluster_version_t::v2_1:
     case cluster_version_t::v2_2:
     case cluster_version_t::v2_3:
-    case cluster_version_t::v2_4_is_latest:
+    case cluster_version_t::v2_4:
+    case cluster_version_t::v2_5_is_latest:
         success = deserialize_reql_version(
                 &read_stream,
                 &info_out->mapping_version_info.original_reql_version,
@@ -1699,7 +1944,8 @@ void deserialize_sindex_info(
     case cluster_version_t::v2_1: // fallthru
     case cluster_version_t::v2_2: // fallthru
     case cluster_version_t::v2_3: // fallthru
-    case cluster_version_t::v2_4_is_latest:
+    case cluster_version_t::v2_4: // fallthru
+    case cluster_version_t::v2_5_is_latest:
         success = deserialize_for_version(cluster_version, &read_stream, &info_out->geo);
         throw_if_bad_deserialization(success, "sindex description");
         break;
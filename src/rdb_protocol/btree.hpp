@@ -140,6 +140,17 @@ void rdb_delete(const store_key_t &key, btree_slice_t *slice, repli_timestamp_t
                 profile::trace_t *trace,
                 promise_t<superblock_t *> *pass_back_superblock = nullptr);
 
+/* When the thread of a store is busy, range reads run their ReQL transformations on
+other threads (see `rget_cb_t` in `btree.cc`).  `read_offload_config` decides when they
+do that.  It starts out with the values from `config/args.hpp`; only the unit tests
+change it. */
+struct read_offload_config_t {
+    double min_store_thread_utilization;
+    double max_helper_thread_utilization;
+    size_t max_batch_size;
+};
+extern read_offload_config_t read_offload_config;
+
 void rdb_rget_slice(
     btree_slice_t *slice,
     const region_t &shard,
@@ -92,6 +92,7 @@ store_t::store_t(const region_t &_region,
       perfmon_collection(),
       io_backender_(io_backender), base_path_(base_path),
       perfmon_collection_membership(parent_perfmon_collection, &perfmon_collection, perfmon_name),
+      aggregate_view_blockers(0),
       ctx(_ctx),
       table_id(_table_id),
       write_superblock_acq_semaphore(WRITE_SUPERBLOCK_ACQ_WAITERS_LIMIT)
@@ -248,6 +249,7 @@ void store_t::reset_data(
     guarantee(subregion.beg == get_region().beg && subregion.end == get_region().end);
     assert_thread();
     with_priority_t p(CORO_PRIORITY_RESET_DATA);
+    aggregate_view_blocker_t view_blocker(this);
 
     // Erase the data in small chunks
     always_true_key_tester_t key_tester;
@@ -506,6 +508,27 @@ rwlock_in_line_t store_t::get_in_line_for_cfeed_stamp(access_t access) {
     return rwlock_in_line_t(&cfeed_stamp_lock, access);
 }
 
+store_t::aggregate_view_blocker_t::aggregate_view_blocker_t(store_t *_store)
+    : store(_store) {
+    store->assert_thread();
+    ++store->aggregate_view_blockers;
+    // Readers check `aggregate_views_blocked()` while they hold a read lock on the
+    // stamp lock, so once we have the write lock nobody uses the views any more.
+    rwlock_in_line_t stamp_spot = store->get_in_line_for_cfeed_stamp(access_t::write);
+    // Like the write path in `btree.cc`, we only look up the changefeed servers once
+    // we hold the stamp lock.
+    stamp_spot.write_signal()->wait_lazily_unordered();
+    auto cservers = store->access_changefeed_servers();
+    for (auto &&pair : *cservers.first) {
+        pair.second->drop_aggregate_views(&stamp_spot, pair.second->get_keepalive());
+    }
+}
+
+store_t::aggregate_view_blocker_t::~aggregate_view_blocker_t() {
+    store->assert_thread();
+    --store->aggregate_view_blockers;
+}
+
 
 void store_t::register_sindex_queue(
             disk_backed_queue_wrapper_t<rdb_modification_report_t> *disk_backed_queue,
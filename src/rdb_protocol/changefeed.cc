@@ -11,6 +11,8 @@
 #include "concurrency/cross_thread_signal.hpp"
 #include "concurrency/interruptor.hpp"
 #include "containers/archive/boost_types.hpp"
+#include "containers/archive/vector_stream.hpp"
+#include "rdb_protocol/aggregate_view.hpp"
 #include "rdb_protocol/artificial_table/backend.hpp"
 #include "rdb_protocol/btree.hpp"
 #include "rdb_protocol/datum_stream.hpp"
@@ -74,12 +76,14 @@ struct change_val_t {
     change_val_t(std::pair<uuid_u, uint64_t> _source_stamp,
                  store_key_t _pkey,
                  optional<indexed_datum_t> _old_val,
-                 optional<indexed_datum_t> _new_val
+                 optional<indexed_datum_t> _new_val,
+                 uint64_t _position
                  DEBUG_ONLY(, optional<std::string> _sindex))
         : source_stamp(std::move(_source_stamp)),
           pkey(std::move(_pkey)),
           old_val(std::move(_old_val)),
-          new_val(std::move(_new_val))
+          new_val(std::move(_new_val)),
+          position(_position)
           DEBUG_ONLY(, sindex(std::move(_sindex))) {
         guarantee(old_val || new_val);
         if (old_val && new_val) {
@@ -91,6 +95,8 @@ struct change_val_t {
     std::pair<uuid_u, uint64_t> source_stamp;
     store_key_t pkey;
     optional<indexed_datum_t> old_val, new_val;
+    // The change's position on the server it came from.
+    uint64_t position;
     DEBUG_ONLY(optional<std::string> sindex;);
     // This should be true, but older versions of boost don't support `move`
     // well in optionals.
@@ -317,6 +323,89 @@ optional<datum_t> apply_ops(
     }
 }
 
+change_filter_t::change_filter_t(rdb_context_t *ctx,
+                                 const changefeed_filter_spec_t &spec)
+    : id(spec.id),
+      range(spec.range) {
+    if (!range.sindex) {
+        store_keys = range.datumspec.primary_key_map();
+        if (!store_keys.has_value()) {
+            store_key_range.set(range.datumspec.covering_range().to_primary_keyrange());
+        }
+    }
+    if (ctx != nullptr && !range.transforms.empty()) {
+        // The final `nullptr` argument means we don't profile any work done with
+        // this `env`.
+        env = make_scoped<env_t>(
+            ctx,
+            return_empty_normal_batches_t::NO,
+            &non_interruptor,
+            spec.serializable_env,
+            nullptr);
+        for (const auto &transform : range.transforms) {
+            ops.push_back(make_op(transform));
+        }
+    }
+}
+
+change_filter_t::change_filter_t(uuid_u _id, store_key_t _point_key)
+    : id(std::move(_id)),
+      point_key(std::move(_point_key)) { }
+
+bool change_filter_t::range_contains(const msg_t::change_t &change) const {
+    if (range.sindex) {
+        // We don't have the intersection geometry here (it isn't serialized), so
+        // for geospatial feeds this only checks the datumspec.
+        for (const index_vals_t *indexes : {&change.old_indexes, &change.new_indexes}) {
+            auto it = indexes->find(*range.sindex);
+            if (it != indexes->end()) {
+                for (const auto &idx : it->second) {
+                    if (range.datumspec.copies(idx.first) != 0) {
+                        return true;
+                    }
+                }
+            }
+        }
+        return false;
+    } else if (store_keys.has_value()) {
+        return store_keys->count(change.pkey) != 0;
+    } else {
+        return store_key_range->contains_key(change.pkey);
+    }
+}
+
+bool change_filter_t::wants(const msg_t::change_t &change) {
+    if (point_key.has_value()) {
+        return *point_key == change.pkey;
+    }
+    if (!range_contains(change)) {
+        return false;
+    }
+    if (ops.empty()) {
+        return true;
+    }
+    // Like `range_sub_t::apply_ops`, which our results have to match.
+    datum_t null = datum_t::null();
+    datum_t old_val = null, new_val = null;
+    if (change.old_val.has()) {
+        if (optional<datum_t> d = apply_ops(change.old_val, ops, env.get(), datum_t())) {
+            old_val = *d;
+        }
+    }
+    if (change.new_val.has()) {
+        if (optional<datum_t> d = apply_ops(change.new_val, ops, env.get(), datum_t())) {
+            new_val = *d;
+        }
+    }
+    if (range.sindex) {
+        // An sindex subscription can still report a trivial change if the row's
+        // index values changed.
+        return old_val != null || new_val != null;
+    } else {
+        return old_val != new_val;
+    }
+}
+
 server_t::client_info_t::client_info_t()
     : limit_clients(),
       limit_clients_lock(new rwlock_t()) { }
@@ -325,10 +414,19 @@ server_t::server_t(mailbox_manager_t *_manager, store_t *_parent)
     : uuid(generate_uuid()),
       manager(_manager),
       parent(_parent),
+      next_aggregate_view_build_id(1),
+      next_position(1),
+      change_log_enabled(false),
+      positions_filters_count(0),
+      change_log_idle_since(0),
+      change_log_start(1),
+      change_log_bytes(0),
       stop_mailbox(manager,
                    std::bind(&server_t::stop_mailbox_cb, this, ph::_1, ph::_2)),
       limit_stop_mailbox(manager, std::bind(&server_t::limit_stop_mailbox_cb,
-                                            this, ph::_1, ph::_2, ph::_3, ph::_4)) { }
+                                            this, ph::_1, ph::_2, ph::_3, ph::_4)),
+      filter_stop_mailbox(manager, std::bind(&server_t::filter_stop_mailbox_cb,
+                                             this, ph::_1, ph::_2, ph::_3)) { }
 
 server_t::~server_t() { }
 
@@ -394,6 +492,51 @@ void server_t::limit_stop_mailbox_cb(signal_t *,
     }
 }
 
+void server_t::filter_stop_mailbox_cb(signal_t *,
+                                      client_t::addr_t addr,
+                                      uuid_u filter_id) {
+    scoped_ptr_t<change_filter_t> destroyable_filter;
+    auto_drainer_t::lock_t lock(&drainer);
+    rwlock_acq_t stamp_acq(&parent->cfeed_stamp_lock, access_t::read);
+    rwlock_acq_t client_acq(&clients_lock, access_t::read);
+    auto it = clients.find(addr);
+    // The client might have already been removed, or we might never have
+    // registered the filter (e.g. if the subscription failed to start).
+    if (it != clients.end()) {
+        client_info_t *info = &it->second;
+        auto filter_it = info->filters.find(filter_id);
+        if (filter_it != info->filters.end()) {
+            if (filter_it->second->point_key.has_value()) {
+                auto key_it = info->point_filter_keys.find(
+                    *filter_it->second->point_key);
+                guarantee(key_it != info->point_filter_keys.end());
+                if (--key_it->second == 0) {
+                    info->point_filter_keys.erase(key_it);
+                }
+            }
+            if (info->positions_filters.erase(filter_id) != 0) {
+                guarantee(positions_filters_count > 0);
+                if (--positions_filters_count == 0) {
+                    change_log_idle_since = current_microtime();
+                }
+            }
+            destroyable_filter = std::move(filter_it->second);
+            info->filters.erase(filter_it);
+        }
+    }
+}
+
+void server_t::forget_positions_filters(client_info_t *info) {
+    if (!info->positions_filters.empty()) {
+        guarantee(positions_filters_count >= info->positions_filters.size());
+        positions_filters_count -= info->positions_filters.size();
+        info->positions_filters.clear();
+        if (positions_filters_count == 0) {
+            change_log_idle_since = current_microtime();
+        }
+    }
+}
+
 void server_t::add_client(
         const client_t::addr_t &addr,
         region_t region,
@@ -407,6 +550,7 @@ void server_t::add_client(
     // address, because we might be subscribed to multiple regions if we're
     // oversharded.  This will have to become smarter once you can unsubscribe
     // at finer granularity (i.e. when we support changefeeds on selections).
+    clients_by_region[region][addr] = info;
     info->regions.push_back(std::move(region));
 
     // The entry might already exist if we have multiple shards per btree, but
@@ -487,6 +631,22 @@ void server_t::add_client_cb(
         send_one_with_lock(&*it, msg_t(msg_t::stop_t()), keepalive);
     }
     coro_spot.write_signal()->wait_lazily_unordered();
+    it = clients.find(addr);
+    if (it != clients.end()) {
+        for (const region_t &region : it->second.regions) {
+            auto region_it = clients_by_region.find(region);
+            if (region_it != clients_by_region.end()) {
+                region_it->second.erase(addr);
+                if (region_it->second.empty()) {
+                    clients_by_region.erase(region_it);
+                }
+            }
+        }
+        // We don't hold the stamp lock here, but we don't block between this and
+        // erasing the client either.
+        ASSERT_NO_CORO_WAITING;
+        forget_positions_filters(&it->second);
+    }
     size_t erased = clients.erase(addr);
     // This is true even if we have multiple shards per btree because
     // `add_client` only spawns one of us.
@@ -506,6 +666,35 @@ struct stamped_msg_t {
 
 RDB_MAKE_SERIALIZABLE_3(stamped_msg_t, server_uuid, stamp, submsg);
 
+// Writes a `stamped_msg_t` whose `submsg` has already been serialized, so that
+// `send_all` only serializes a change once no matter how many clients it goes to.
+class stamped_msg_writer_t : public mailbox_write_callback_t {
+public:
+    stamped_msg_writer_t(const uuid_u &_server_uuid,
+                         uint64_t _stamp,
+                         const std::vector<char> *_serialized_submsg)
+        : server_uuid(_server_uuid),
+          stamp(_stamp),
+          serialized_submsg(_serialized_submsg) { }
+    void write(DEBUG_VAR cluster_version_t cluster_version, write_message_t *wm) {
+        rassert(cluster_version == cluster_version_t::CLUSTER);
+        // This has to match `mailbox_write_impl<stamped_msg_t>`, which serializes
+        // the fields in order.
+        serialize<cluster_version_t::CLUSTER>(wm, server_uuid);
+        serialize<cluster_version_t::CLUSTER>(wm, stamp);
+        wm->append(serialized_submsg->data(), serialized_submsg->size());
+    }
+#ifdef ENABLE_MESSAGE_PROFILER
+    const char *message_profiler_tag() const {
+        return "mailbox<stamped_msg_t>";
+    }
+#endif
+private:
+    const uuid_u &server_uuid;
+    const uint64_t stamp;
+    const std::vector<char> *const serialized_submsg;
+};
+
 // This function takes a `lock_t` to make sure you have one.  (We can't just
 // always acquire a drainer lock before sending because we sometimes send a
 // `stop_t` during destruction, and you can't acquire a drain lock on a draining
@@ -525,8 +714,17 @@ void server_t::send_one_with_lock(
     send(manager, client->first, stamped_msg_t(uuid, stamp, std::move(msg)));
 }
 
+// The bounds on the size of a `server_t`'s change log.  When we go over either of
+// them we drop the oldest changes, so feeds can't resume from before them anymore.
+const size_t MAX_CHANGE_LOG_CHANGES = 100000;
+const size_t MAX_CHANGE_LOG_BYTES = 16 * MEGABYTE;
+
+// How long we keep the change log after the last subscription with positions has
+// been stopped, so that a feed that lost its connection can still resume.
+const microtime_t CHANGE_LOG_RETENTION_USECS = 10 * 60 * 1000 * 1000;
+
 void server_t::send_all(
-        const msg_t &msg,
+        msg_t &&msg,
         const store_key_t &key,
         rwlock_in_line_t *stamp_spot,
         const auto_drainer_t::lock_t &keepalive) {
@@ -535,24 +733,199 @@ void server_t::send_all(
     stamp_spot->write_signal()->wait_lazily_unordered();
 
     rwlock_acq_t acq(&clients_lock, access_t::read);
+    msg_t::change_t *change = boost::get<msg_t::change_t>(&msg.op);
+    if (change != nullptr) {
+        change->position = next_position++;
+    }
     std::map<client_t::addr_t, uint64_t> stamps;
-    for (auto &&pair : clients) {
-        // We don't need a write lock as long as we make sure the coroutine
-        // doesn't block between reading and updating the stamp.
-        ASSERT_NO_CORO_WAITING;
-        if (std::any_of(pair.second.regions.begin(),
-                        pair.second.regions.end(),
-                        std::bind(&region_contains_key, ph::_1, std::cref(key)))) {
-            stamps[pair.first] = pair.second.stamp++;
+    for (auto &&region_pair : clients_by_region) {
+        if (!region_contains_key(region_pair.first, key)) {
+            continue;
+        }
+        for (auto &&client_pair : region_pair.second) {
+            client_info_t *info = client_pair.second;
+            // A client can't be subscribed to two regions that contain the key,
+            // but better safe than sorry.
+            if (stamps.count(client_pair.first) == 0
+                && (change == nullptr || client_wants(info, *change))) {
+                // We don't need a write lock as long as we make sure the coroutine
+                // doesn't block between reading and updating the stamp.  Skipping
+                // a client doesn't use up a stamp, so it doesn't wait for the
+                // change.
+                ASSERT_NO_CORO_WAITING;
+                stamps[client_pair.first] = info->stamp++;
+            }
         }
     }
     acq.reset();
+    if (change_log_enabled
+        && positions_filters_count == 0
+        && current_microtime()
+           > change_log_idle_since + CHANGE_LOG_RETENTION_USECS) {
+        // Nobody could resume from the log anymore, so stop keeping it.  The next
+        // subscription with positions starts a new one, and positions from before
+        // then can't be resumed from.
+        change_log_enabled = false;
+        change_log.clear();
+        change_log_bytes = 0;
+        change_log_start = next_position;
+    }
+    const bool log_change = change != nullptr && change_log_enabled;
+    if (stamps.empty() && !log_change) {
+        stamp_spot->reset();
+        return;
+    }
+
+    // Only the stamp differs between the clients, so we serialize the message
+    // once and reuse the buffer for every client.
+    std::vector<char> serialized_msg;
+    {
+        write_message_t wm;
+        serialize<cluster_version_t::CLUSTER>(&wm, msg);
+        vector_stream_t stream;
+        stream.reserve(wm.size());
+        int res = send_write_message(&stream, &wm);
+        guarantee(res == 0);
+        stream.swap(&serialized_msg);
+    }
+    if (log_change) {
+        change_log.push_back(std::make_pair(*change, serialized_msg.size()));
+        change_log_bytes += serialized_msg.size();
+        while (change_log.size() > MAX_CHANGE_LOG_CHANGES
+               || change_log_bytes > MAX_CHANGE_LOG_BYTES) {
+            change_log_start = change_log.front().first.position + 1;
+            change_log_bytes -= change_log.front().second;
+            change_log.pop_front();
+        }
+    }
     stamp_spot->reset(); // Done stamping, no need to hold onto it while we send.
+
     for (const auto &pair : stamps) {
-        send(manager, pair.first, stamped_msg_t(uuid, pair.second, msg));
+        stamped_msg_writer_t writer(uuid, pair.second, &serialized_msg);
+        send_write(manager, pair.first, &writer);
     }
 }
 
+// The most aggregate views a `server_t` maintains, and how long it keeps a view that
+// nobody reads.  Every write to the shard has to update all of them.
+const size_t MAX_AGGREGATE_VIEWS = 16;
+const microtime_t AGGREGATE_VIEW_IDLE_USECS = 10 * 60 * 1000 * 1000;
+
+bool server_t::read_aggregate_view(
+        const std::string &key,
+        rwlock_in_line_t *stamp_spot,
+        result_t *out,
+        const auto_drainer_t::lock_t &keepalive) {
+    keepalive.assert_is_holding(&drainer);
+    stamp_spot->guarantee_is_for_lock(&parent->cfeed_stamp_lock);
+    stamp_spot->read_signal()->wait_lazily_unordered();
+    auto it = aggregate_views.find(key);
+    if (it == aggregate_views.end() || !it->second.view->is_built()) {
+        return false;
+    }
+    // Other readers might be using the views at the same time, but they don't block
+    // while they do.
+    ASSERT_NO_CORO_WAITING;
+    it->second.last_read = current_microtime();
+    *out = it->second.view->get_result();
+    return true;
+}
+
+uint64_t server_t::start_aggregate_view(
+        const std::string &key,
+        scoped_ptr_t<aggregate_view_t> &&view,
+        rwlock_in_line_t *stamp_spot,
+        const auto_drainer_t::lock_t &keepalive) {
+    keepalive.assert_is_holding(&drainer);
+    stamp_spot->guarantee_is_for_lock(&parent->cfeed_stamp_lock);
+    stamp_spot->read_signal()->wait_lazily_unordered();
+    guarantee(!view->is_built());
+    ASSERT_NO_CORO_WAITING;
+    if (aggregate_views.count(key) != 0) {
+        // Another read is building it.
+        return 0;
+    }
+    if (aggregate_views.size() >= MAX_AGGREGATE_VIEWS) {
+        auto lru = aggregate_views.begin();
+        for (auto it = aggregate_views.begin(); it != aggregate_views.end(); ++it) {
+            if (it->second.last_read < lru->second.last_read) {
+                lru = it;
+            }
+        }
+        aggregate_views.erase(lru);
+    }
+    aggregate_view_info_t *info = &aggregate_views[key];
+    info->view = std::move(view);
+    info->build_id = next_aggregate_view_build_id++;
+    info->last_read = current_microtime();
+    return info->build_id;
+}
+
+void server_t::finish_aggregate_view(
+        const std::string &key,
+        uint64_t build_id,
+        const result_t *built,
+        rwlock_in_line_t *stamp_spot,
+        const auto_drainer_t::lock_t &keepalive) {
+    keepalive.assert_is_holding(&drainer);
+    stamp_spot->guarantee_is_for_lock(&parent->cfeed_stamp_lock);
+    stamp_spot->read_signal()->wait_lazily_unordered();
+    ASSERT_NO_CORO_WAITING;
+    auto it = aggregate_views.find(key);
+    if (it == aggregate_views.end() || it->second.build_id != build_id) {
+        return;
+    }
+    guarantee(!it->second.view->is_built());
+    if (built == nullptr || !it->second.view->finish_build(*built)) {
+        aggregate_views.erase(it);
+    }
+}
+
+void server_t::update_aggregate_views(
+        const datum_t &old_val,
+        const datum_t &new_val,
+        rwlock_in_line_t *stamp_spot,
+        const auto_drainer_t::lock_t &keepalive) {
+    keepalive.assert_is_holding(&drainer);
+    stamp_spot->guarantee_is_for_lock(&parent->cfeed_stamp_lock);
+    stamp_spot->write_signal()->wait_lazily_unordered();
+    if (aggregate_views.empty()) {
+        return;
+    }
+    microtime_t now = current_microtime();
+    for (auto it = aggregate_views.begin(); it != aggregate_views.end();) {
+        // If the change can't be applied, the next read will run the aggregation
+        // again, and build a new view if it succeeds.
+        if (now > it->second.last_read + AGGREGATE_VIEW_IDLE_USECS
+            || !it->second.view->apply_change(old_val, new_val)) {
+            aggregate_views.erase(it++);
+        } else {
+            ++it;
+        }
+    }
+}
+
+void server_t::drop_aggregate_views(
+        rwlock_in_line_t *stamp_spot,
+        const auto_drainer_t::lock_t &keepalive) {
+    keepalive.assert_is_holding(&drainer);
+    stamp_spot->guarantee_is_for_lock(&parent->cfeed_stamp_lock);
+    stamp_spot->write_signal()->wait_lazily_unordered();
+    aggregate_views.clear();
+}
+
+bool server_t::client_wants(client_info_t *info, const msg_t::change_t &change) {
+    if (info->point_filter_keys.count(change.pkey) != 0) {
+        return true;
+    }
+    for (auto &&pair : info->filters) {
+        if (!pair.second->point_key.has_value() && pair.second->wants(change)) {
+            return true;
+        }
+    }
+    return false;
+}
+
 server_t::addr_t server_t::get_stop_addr() {
     return stop_mailbox.get_address();
 }
@@ -561,8 +934,24 @@ server_t::limit_addr_t server_t::get_limit_stop_addr() {
     return limit_stop_mailbox.get_address();
 }
 
+server_t::filter_stop_addr_t server_t::get_filter_stop_addr() {
+    return filter_stop_mailbox.get_address();
+}
+
+void server_t::add_filter(
+        client_info_t *info, scoped_ptr_t<change_filter_t> &&filter) {
+    const uuid_u filter_id = filter->id;
+    const optional<store_key_t> point_key = filter->point_key;
+    // If the read is retried we might see the same filter again.
+    if (info->filters.insert(std::make_pair(filter_id, std::move(filter))).second
+        && point_key.has_value()) {
+        info->point_filter_keys[*point_key] += 1;
+    }
+}
+
 optional<uint64_t> server_t::get_stamp(
         const client_t::addr_t &addr,
+        scoped_ptr_t<change_filter_t> &&filter,
         const auto_drainer_t::lock_t &keepalive) {
     keepalive.assert_is_holding(&drainer);
     rwlock_acq_t stamp_acq(&parent->cfeed_stamp_lock, access_t::read);
@@ -571,10 +960,76 @@ optional<uint64_t> server_t::get_stamp(
     if (it == clients.end()) {
         return r_nullopt;
     } else {
+        if (filter.has()) {
+            add_filter(&it->second, std::move(filter));
+        }
         return make_optional(it->second.stamp);
     }
 }
 
+optional<uint64_t> server_t::get_stamp_with_positions(
+        const client_t::addr_t &addr,
+        scoped_ptr_t<change_filter_t> &&filter,
+        const optional<std::map<uuid_u, uint64_t> > &since,
+        optional<uint64_t> *position_out,
+        const auto_drainer_t::lock_t &keepalive) {
+    keepalive.assert_is_holding(&drainer);
+    guarantee(filter.has());
+    const uuid_u filter_id = filter->id;
+    std::vector<const msg_t::change_t *> replay;
+    std::vector<stamped_msg_t> replay_msgs;
+    uint64_t start_stamp;
+    {
+        rwlock_acq_t stamp_acq(&parent->cfeed_stamp_lock, access_t::read);
+        rwlock_acq_t client_acq(&clients_lock, access_t::read);
+        auto it = clients.find(addr);
+        if (it == clients.end()) {
+            return r_nullopt;
+        }
+        client_info_t *info = &it->second;
+        add_filter(info, std::move(filter));
+        change_filter_t *added_filter = info->filters.at(filter_id).get();
+        if (info->positions_filters.insert(filter_id).second) {
+            ++positions_filters_count;
+        }
+        if (!change_log_enabled) {
+            change_log_enabled = true;
+            change_log_start = next_position;
+        }
+        const uint64_t last_position = next_position - 1;
+        if (!since.has_value()) {
+            position_out->set(last_position);
+        } else {
+            auto since_it = since->find(uuid);
+            if (since_it != since->end()
+                && since_it->second + 1 >= change_log_start
+                && since_it->second <= last_position) {
+                position_out->set(since_it->second);
+                for (const auto &entry : change_log) {
+                    if (entry.first.position > since_it->second
+                        && added_filter->wants(entry.first)) {
+                        replay.push_back(&entry.first);
+                    }
+                }
+            }
+        }
+        // We don't need a write lock as long as we make sure the coroutine doesn't
+        // block between reading and updating the stamp.  If the read is retried,
+        // the subscription drops the changes we replayed the first time because
+        // their stamps are from before the stamp it ends up with.
+        ASSERT_NO_CORO_WAITING;
+        start_stamp = info->stamp;
+        for (const msg_t::change_t *change : replay) {
+            replay_msgs.push_back(stamped_msg_t(
+                uuid, info->stamp++, msg_t(msg_t::replay_change_t{filter_id, *change})));
+        }
+    }
+    for (auto &&msg : replay_msgs) {
+        send(manager, addr, std::move(msg));
+    }
+    return make_optional(start_stamp);
+}
+
 uuid_u server_t::get_uuid() {
     return uuid;
 }
@@ -857,6 +1312,10 @@ void limit_manager_t::send(msg_t &&msg) {
     }
 }
 
+// The most items a `limit_manager_t` keeps beyond its limit.  (It keeps as many
+// items as the limit, up to this.)
+const size_t MAX_LIMIT_CUSHION = 256;
+
 limit_manager_t::limit_manager_t(
     rwlock_in_line_t *clients_lock,
     region_t _region,
@@ -879,6 +1338,8 @@ limit_manager_t::limit_manager_t(
       spec(std::move(_spec)),
       gt(std::move(_gt)),
       item_queue(gt),
+      cushion(gt),
+      cushion_size(std::min(spec.limit, MAX_LIMIT_CUSHION)),
       aborted(false) {
     guarantee(clients_lock->read_signal()->is_pulsed());
 
@@ -948,6 +1409,7 @@ public:
                   const keyspec_t::limit_t *_spec,
                   sorting_t _sorting,
                   optional<item_t> _start,
+                  size_t _n,
                   const item_queue_t *_item_queue)
         : env(_env),
           ops(_ops),
@@ -955,6 +1417,7 @@ public:
           spec(_spec),
           sorting(_sorting),
           start(std::move(_start)),
+          n_to_read(_n),
           item_queue(_item_queue) { }
 
     std::vector<item_t> operator()(const primary_ref_t &ref) {
@@ -978,7 +1441,7 @@ public:
         case sorting_t::UNORDERED: // fallthru
         default: unreachable();
         }
-        size_t n = spec->limit - item_queue->size();
+        size_t n = n_to_read;
         rdb_rget_slice(
             ref.btree,
             region_t(),
@@ -1033,7 +1496,7 @@ public:
                 [](const datum_range_t &) { return true; },
                 [](const std::map<datum_t, uint64_t> &) { return false; }));
         datum_range_t srange = spec->range.datumspec.covering_range();
-        size_t n = spec->limit - item_queue->size();
+        size_t n = n_to_read;
         if (start) {
             datum_t dstart = start->second.first;
             switch (sorting) {
@@ -1110,18 +1573,53 @@ private:
     const keyspec_t::limit_t *spec;
     sorting_t sorting;
     optional<item_t> start;
+    size_t n_to_read;
     const item_queue_t *item_queue;
 };
 
 std::vector<item_t> limit_manager_t::read_more(
     const boost::variant<primary_ref_t, sindex_ref_t> &ref,
-    const optional<item_t> &start) {
+    const optional<item_t> &start,
+    size_t n) {
     guarantee(item_queue.size() < spec.limit);
+    if (rdb_context_t *ctx = env->get_rdb_ctx()) {
+        ctx->stats.changefeed_limit_reads_per_sec.record();
+    }
     ref_visitor_t visitor(
-        env.get(), &ops, &region.inner, &spec, spec.range.sorting, start, &item_queue);
+        env.get(), &ops, &region.inner, &spec, spec.range.sorting, start, n,
+        &item_queue);
     return boost::apply_visitor(visitor, ref);
 }
 
+void limit_manager_t::move_worst_to_cushion(item_queue_t *real_added,
+                                            std::set<std::string> *real_deleted) {
+    auto worst = item_queue.begin();
+    guarantee(worst != item_queue.end());
+    item_t item = **worst;
+    item_queue.erase(worst);
+    auto it = real_added->find_id(item.first);
+    if (it != real_added->end()) {
+        real_added->erase(it);
+    } else {
+        bool inserted = real_deleted->insert(item.first).second;
+        guarantee(inserted);
+    }
+    bool inserted = cushion.insert(std::move(item)).second;
+    guarantee(inserted);
+}
+
+void limit_manager_t::move_best_from_cushion(item_queue_t *real_added) {
+    guarantee(cushion.size() != 0);
+    auto best = cushion.end();
+    --best;
+    item_t item = **best;
+    cushion.erase(best);
+    bool inserted = item_queue.insert(item).second;
+    guarantee(inserted);
+    inserted = real_added->insert(std::move(item)).second;
+    guarantee(inserted);
+}
+
 void limit_manager_t::commit(
     rwlock_in_line_t *spot,
     const boost::variant<primary_ref_t, sindex_ref_t> &sindex_ref) THROWS_NOTHING {
@@ -1130,23 +1628,27 @@ void limit_manager_t::commit(
         return;
     }
 
-    // Before we delete anything, we get the boundary between the active set and
-    // the data that didn't make it into the set.  Anything <= that according to
-    // our ordering could never be kicked out of the set because of a read from
-    // disk.
-    optional<item_t> active_boundary;
-    auto item_queue_it = item_queue.begin();
-    if (item_queue_it != item_queue.end()) {
-        active_boundary.set(**item_queue_it);
+    // Before we delete anything, we get the boundary between the items we have
+    // (the active set and the cushion) and the data that didn't make it into
+    // them.  Anything <= that according to our ordering could never be kicked
+    // out of the set because of a read from disk.
+    optional<item_t> boundary;
+    if (cushion.size() != 0) {
+        boundary.set(**cushion.begin());
+    } else if (item_queue.size() != 0) {
+        boundary.set(**item_queue.begin());
     }
 
     item_queue_t real_added(gt);
     std::set<std::string> real_deleted;
+    bool deleted_any = false;
     for (const auto &id : deleted) {
-        bool data_deleted = item_queue.del_id(id);
-        if (data_deleted) {
+        if (item_queue.del_id(id)) {
             bool inserted = real_deleted.insert(id).second;
             guarantee(inserted);
+            deleted_any = true;
+        } else if (cushion.del_id(id)) {
+            deleted_any = true;
         }
     }
     deleted.clear();
@@ -1156,7 +1658,7 @@ void limit_manager_t::commit(
         // off of disk below.  This is fine because if the resulting set is
         // still too small, and the things we didn't add happen to beat the
         // other things in the table, we'll read them first.
-        if (!(active_boundary && gt(item_t(pair), *active_boundary))) {
+        if (!(boundary && gt(item_t(pair), *boundary))) {
             bool inserted = item_queue.insert(pair).second;
             // We can never get two additions for the same key without a deletion
             // in-between.
@@ -1169,23 +1671,28 @@ void limit_manager_t::commit(
     }
     added.clear();
 
-    std::vector<std::string> truncated = item_queue.truncate_top(spec.limit);
-    for (auto &&id : truncated) {
-        auto it = real_added.find_id(id);
-        if (it != real_added.end()) {
-            real_added.erase(it);
-        } else {
-            bool inserted = real_deleted.insert(std::move(id)).second;
-            guarantee(inserted);
-        }
+    // Items that drop out of the active set become the start of the cushion, and
+    // items from the cushion replace the ones that were deleted.
+    while (item_queue.size() > spec.limit) {
+        move_worst_to_cushion(&real_added, &real_deleted);
+    }
+    while (item_queue.size() < spec.limit && cushion.size() != 0) {
+        move_best_from_cushion(&real_added);
     }
+    cushion.truncate_top(cushion_size);
 
-    bool anything_on_disk = real_deleted.size() != 0 || added_on_disk;
+    bool anything_on_disk = deleted_any || added_on_disk;
     if (item_queue.size() < spec.limit && anything_on_disk) {
+        // We've used up the cushion, so we read enough to refill it too.  That
+        // way we read once every `cushion_size` deletions rather than on every
+        // commit that deletes something from the active set.
+        guarantee(cushion.size() == 0);
         std::vector<item_t> s;
         optional<exc_t> exc;
         try {
-            s = read_more(sindex_ref, active_boundary);
+            s = read_more(sindex_ref,
+                          boundary,
+                          spec.limit - item_queue.size() + cushion_size);
         } catch (const exc_t &e) {
             exc.set(e);
         }
@@ -1203,18 +1710,12 @@ void limit_manager_t::commit(
                 guarantee(added_insert);
             }
         }
-        // We need to truncate again because `read_more` may read too much in
-        // the secondary index case.
-        std::vector<std::string> read_trunc = item_queue.truncate_top(spec.limit);
-        for (auto &&id : read_trunc) {
-            auto it = real_added.find_id(id);
-            if (it != real_added.end()) {
-                real_added.erase(it);
-            } else {
-                bool inserted = real_deleted.insert(std::move(id)).second;
-                guarantee(inserted);
-            }
+        while (item_queue.size() > spec.limit) {
+            move_worst_to_cushion(&real_added, &real_deleted);
         }
+        // We need to truncate because `read_more` may read too much in the
+        // secondary index case.
+        cushion.truncate_top(cushion_size);
     }
     std::set<std::string> remaining_deleted;
     for (auto &&id : real_deleted) {
@@ -1265,10 +1766,12 @@ RDB_IMPL_SERIALIZABLE_3(msg_t::limit_change_t, sub, old_key, new_val);
 INSTANTIATE_SERIALIZABLE_FOR_CLUSTER(msg_t::limit_change_t);
 RDB_IMPL_SERIALIZABLE_2(msg_t::limit_stop_t, sub, exc);
 INSTANTIATE_SERIALIZABLE_FOR_CLUSTER(msg_t::limit_stop_t);
-RDB_IMPL_SERIALIZABLE_5(
+RDB_IMPL_SERIALIZABLE_6(
     msg_t::change_t,
-    old_indexes, new_indexes, pkey, old_val, new_val);
+    old_indexes, new_indexes, pkey, old_val, new_val, position);
 INSTANTIATE_SERIALIZABLE_FOR_CLUSTER(msg_t::change_t);
+RDB_IMPL_SERIALIZABLE_2(msg_t::replay_change_t, sub, change);
+INSTANTIATE_SERIALIZABLE_FOR_CLUSTER(msg_t::replay_change_t);
 RDB_IMPL_SERIALIZABLE_0_SINCE_v1_13(msg_t::stop_t);
 
 enum class detach_t { NO, YES };
@@ -1388,6 +1891,8 @@ protected:
     void maybe_signal_cond() THROWS_NOTHING;
     void maybe_signal_queue_nearly_full_cond() THROWS_NOTHING;
     void destructor_cleanup(std::function<void()> del_sub) THROWS_NOTHING;
+    // `nullptr` in the unit tests.
+    rdb_context_t *get_rdb_context() const { return rdb_context; }
 
     datum_t maybe_add_type(datum_t &&datum, change_type_t type);
     // If an error occurs, we're detached and `exc` is set to an exception to rethrow.
@@ -1548,6 +2053,8 @@ public:
     template<class... Args>
     explicit flat_sub_t(init_squashing_queue_t init_squashing_queue, Args &&... args)
         : subscription_t(std::forward<Args>(args)...),
+          coalescing(false),
+          reported_queue_size(0),
           last_stamp(std::make_pair(nil_uuid(), std::numeric_limits<uint64_t>::max())) {
         if (init_squashing_queue == init_squashing_queue_t::YES && squash) {
             queue = make_scoped<squashing_queue_t>();
@@ -1555,13 +2062,18 @@ public:
             queue = make_scoped<nonsquashing_queue_t>();
         }
     }
+    virtual ~flat_sub_t() {
+        queue->clear();
+        update_queue_stats(0);
+    }
     virtual void add_el(
         const uuid_u &shard_uuid,
         uint64_t stamp,
         const store_key_t &pkey,
         const optional<std::string> &DEBUG_ONLY(sindex),
         optional<indexed_datum_t> old_val,
-        optional<indexed_datum_t> new_val) {
+        optional<indexed_datum_t> new_val,
+        uint64_t position) {
         if (!active()) return;
         auto stamp_pair = std::make_pair(shard_uuid, stamp);
         if (stamp_pair == last_stamp || update_stamp(shard_uuid, stamp)) {
@@ -1569,12 +2081,29 @@ public:
             // update step and always pass it through.  (This supports cases
             // like `.get_all(1, 1)`).
             last_stamp = stamp_pair;
+            const size_t old_size = queue->size();
             queue->add(change_val_t(
                 std::make_pair(shard_uuid, stamp),
                 pkey,
                 old_val,
-                new_val
+                new_val,
+                position
                 DEBUG_ONLY(, sindex)));
+            size_t coalesced = coalescing ? old_size + 1 - queue->size() : 0;
+            if (queue->size() > limits.changefeed_queue_size()
+                && !coalescing
+                && can_coalesce()) {
+                // The client isn't keeping up.  Rather than dropping changes, we
+                // only keep the latest change for each row until it catches up,
+                // like `squash` does.
+                scoped_ptr_t<maybe_squashing_queue_t> old_queue = std::move(queue);
+                queue = make_scoped<squashing_queue_t>();
+                while (old_queue->size() != 0) {
+                    queue->add(old_queue->pop());
+                }
+                coalescing = true;
+                coalesced = old_size + 1 - queue->size();
+            }
             if (queue->size() > limits.changefeed_queue_size()) {
                 skipped += queue->size();
                 queue->clear();
@@ -1588,17 +2117,50 @@ public:
                 // case.)
                 maybe_signal_queue_nearly_full_cond();
             }
+            update_queue_stats(coalesced);
             maybe_signal_cond();
         }
     }
     bool has_change_val() { return queue->size() != 0; }
-    change_val_t pop_change_val() { return queue->pop(); }
+    change_val_t pop_change_val() {
+        change_val_t ret = queue->pop();
+        if (coalescing && queue->size() == 0) {
+            // The client has caught up, so it gets every change again.
+            queue = make_scoped<nonsquashing_queue_t>();
+            coalescing = false;
+        }
+        update_queue_stats(0);
+        return ret;
+    }
     const change_val_t &peek_change_val() { return queue->peek(); }
     bool active() { return !exc; }
 protected:
+    // Whether we can switch to only keeping the latest change for each row when
+    // the queue is full.  That's only OK once the subscription has started and
+    // it doesn't matter which changes we return, so not for `squash` (which
+    // already does that) or for subscriptions that care about the order.
+    virtual bool can_coalesce() const { return false; }
+
+    // Call this when `queue` changes size without going through `add_el` or
+    // `pop_change_val`.
+    void update_queue_stats(size_t coalesced) {
+        if (rdb_context_t *ctx = get_rdb_context()) {
+            ctx->stats.changefeed_queued_changes +=
+                static_cast<int64_t>(queue->size())
+                - static_cast<int64_t>(reported_queue_size);
+            ctx->stats.changefeed_changes_coalesced += coalesced;
+        }
+        reported_queue_size = queue->size();
+    }
+
     // The queue of changes we've accumulated since the last time we were read from.
     scoped_ptr_t<maybe_squashing_queue_t> queue;
+    // Whether `queue` is only keeping the latest change for each row because the
+    // client fell behind.
+    bool coalescing;
 private:
+    // How much we've added to the `changefeed_queued_changes` stat.
+    size_t reported_queue_size;
     std::pair<uuid_u, uint64_t> last_stamp;
     virtual void apply_queued_changes() { } // Changes are never queued.
     virtual bool update_stamp(const uuid_u &uuid, uint64_t new_stamp) = 0;
@@ -1661,6 +2223,9 @@ protected:
 private:
     virtual void maybe_remove_feed() = 0;
     virtual void stop_limit_sub(limit_sub_t *sub) = 0;
+    // Removes the server-side filter of a range or point subscription, see
+    // `change_filter_t`.
+    virtual void stop_filter(const uuid_u &filter_id) = 0;
 
     void add_sub_with_lock(
         rwlock_t *rwlock, const std::function<void()> &f) THROWS_NOTHING;
@@ -1746,6 +2311,7 @@ public:
 private:
     virtual void maybe_remove_feed() { client->maybe_remove_feed(client_lock, table_id); }
     virtual void stop_limit_sub(limit_sub_t *sub);
+    virtual void stop_filter(const uuid_u &filter_id);
 
     void mailbox_cb(signal_t *interruptor, stamped_msg_t msg);
     void constructor_cb();
@@ -1756,6 +2322,7 @@ private:
     mailbox_manager_t *manager;
     mailbox_t<stamped_msg_t> mailbox;
     std::vector<server_t::addr_t> stop_addrs;
+    std::vector<server_t::filter_stop_addr_t> filter_stop_addrs;
     std::vector<scoped_ptr_t<disconnect_watcher_t> > disconnect_watchers;
 
     struct queue_t {
@@ -1811,6 +2378,8 @@ real_feed_t::real_feed_t(auto_drainer_t::lock_t _client_lock,
         for (auto it = resp->addrs.begin(); it != resp->addrs.end(); ++it) {
             stop_addrs.push_back(std::move(*it));
         }
+        filter_stop_addrs.assign(
+            resp->filter_stop_addrs.begin(), resp->filter_stop_addrs.end());
 
         std::set<peer_id_t> peers;
         for (auto it = stop_addrs.begin(); it != stop_addrs.end(); ++it) {
@@ -1995,6 +2564,7 @@ public:
                      _include_states,
                      _include_types),
           pkey(std::move(_pkey)),
+          filter_id(generate_uuid()),
           stamp(0),
           started(false),
           state(state_t::INITIALIZING),
@@ -2007,6 +2577,7 @@ public:
                                      store_key_t(pkey.print_primary())));
     }
     feed_type_t cfeed_type() const final { return feed_type_t::point; }
+    const uuid_u &get_filter_id() const { return filter_id; }
 
     bool update_stamp(const uuid_u &, uint64_t new_stamp) final {
         if (new_stamp >= stamp) {
@@ -2050,6 +2621,7 @@ public:
             || (include_initial && state != state_t::READY)
             || has_change_val();
     }
+    bool can_coalesce() const final { return started && !squash; }
     counted_t<datum_stream_t> to_stream(
         env_t *env,
         std::string,
@@ -2069,7 +2641,8 @@ public:
         read_response_t read_resp;
         nif->read(
             env->get_user_context(),
-            read_t(changefeed_point_stamp_t{addr, store_key_t(pkey.print_primary())},
+            read_t(changefeed_point_stamp_t{
+                       addr, store_key_t(pkey.print_primary()), filter_id},
                    profile_bool_t::DONT_PROFILE, read_mode_t::SINGLE),
             &read_resp,
             order_token_t::ignore,
@@ -2084,11 +2657,13 @@ public:
                resp->stamp,
                store_key_t(pkey.print_primary()),
                r_nullopt,
-               make_optional(indexed_datum_t(resp->initial_val, r_nullopt))
+               make_optional(indexed_datum_t(resp->initial_val, r_nullopt)),
+               0
                DEBUG_ONLY(, r_nullopt)));
         if (start_stamp > stamp) {
             stamp = start_stamp;
             queue->clear();
+            update_queue_stats(0);
         } else {
             while (queue->size() != 0) {
                 const change_val_t *cv = &peek_change_val();
@@ -2135,7 +2710,8 @@ public:
             std::make_pair(nil_uuid(), 0),
             store_key_t(pkey.print_primary()),
             r_nullopt,
-            make_optional(indexed_datum_t(initial, r_nullopt))
+            make_optional(indexed_datum_t(initial, r_nullopt)),
+            0
             DEBUG_ONLY(, r_nullopt)));
         started = true;
 
@@ -2143,6 +2719,7 @@ public:
     }
 private:
     datum_t pkey;
+    const uuid_u filter_id;
     optional<change_val_t> initial_val;
     uint64_t stamp;
     bool started;
@@ -2172,6 +2749,8 @@ public:
                 const datum_t &_squash,
                 bool _include_states,
                 bool _include_types,
+                bool _include_positions,
+                optional<std::map<uuid_u, uint64_t> > _since,
                 env_t *outer_env,
                 keyspec_t::range_t _spec)
         // We don't turn on squashing until later for range subs.  (We need to
@@ -2185,6 +2764,11 @@ public:
                      _include_states,
                      _include_types),
           spec(std::move(_spec)),
+          filter_id(generate_uuid()),
+          include_positions(_include_positions),
+          since(std::move(_since)),
+          sent_positions(false),
+          live(false),
           state(state_t::READY),
           sent_state(state_t::NONE),
           artificial_include_initial(false) {
@@ -2203,6 +2787,7 @@ public:
         destructor_cleanup(std::bind(&feed_t::del_range_sub, feed, this));
     }
     optional<std::string> sindex() const { return spec.sindex; }
+    const uuid_u &get_filter_id() const { return filter_id; }
     size_t copies(const datum_t &sindex_key) const {
         guarantee(spec.sindex);
         if (spec.intersect_geometry) {
@@ -2279,14 +2864,25 @@ public:
                 vals_to_change(datum_t(), d, true),
                 change_type_t::INITIAL);
         }
-        return change_val_to_change(pop_change_val(),
-                                    false,
-                                    false,
-                                    include_types);
+        if (include_positions && !sent_positions) {
+            sent_positions = true;
+            return positions_datum();
+        }
+        change_val_t change_val = pop_change_val();
+        datum_t change = change_val_to_change(change_val,
+                                              false,
+                                              false,
+                                              include_types);
+        if (include_positions) {
+            positions[change_val.source_stamp.first] = change_val.position;
+            change = change.merge(positions_datum());
+        }
+        return change;
     }
     bool has_el() final {
         return (include_states && state != sent_state)
             || artificial_initial_vals.size() != 0
+            || (include_positions && !sent_positions)
             || has_change_val();
     }
 
@@ -2297,7 +2893,12 @@ public:
             while (old_queue->size() != 0) {
                 queue->add(old_queue->pop());
             }
+            update_queue_stats(0);
         }
+        live = true;
+    }
+    bool can_coalesce() const final {
+        return live && !squash && !include_positions;
     }
 
     counted_t<datum_stream_t> to_stream(
@@ -2310,12 +2911,22 @@ public:
         backtrace_id_t bt) final {
         assert_thread();
         r_sanity_check(self.get() == this);
+        rcheck_src(bt, !(include_positions && maybe_src.has()), base_exc_t::LOGIC,
+                   "Cannot call `include_initial` on a changefeed with positions.");
 
         read_response_t read_resp;
-        // Note that we use the `outer_env`'s interruptor for the read.
+        // Note that we use the `outer_env`'s interruptor for the read.  We
+        // register our filter with the servers as part of it.
         nif->read(
             outer_env->get_user_context(),
-            read_t(changefeed_stamp_t(addr),
+            read_t(changefeed_stamp_t(
+                       addr,
+                       changefeed_filter_spec_t{
+                           filter_id,
+                           spec,
+                           outer_env->get_serializable_env(),
+                           include_positions,
+                           since}),
                    profile_bool_t::DONT_PROFILE,
                    read_mode_t::SINGLE),
             &read_resp, order_token_t::ignore, outer_env->interruptor);
@@ -2325,6 +2936,15 @@ public:
                      "Unable to retrieve the start stamps.  Did you just reshard?");
         std::map<uuid_u, uint64_t> purge_stamps;
         for (const auto &pair : *resp->stamp_infos) {
+            if (include_positions) {
+                rcheck_datum(pair.second.start_position.has_value(),
+                             base_exc_t::OP_FAILED,
+                             "Cannot resume the changefeed from the given position.  "
+                             "The changes since then are no longer available, or "
+                             "the table was resharded, restarted or got a new primary "
+                             "replica in the meantime.");
+                positions[pair.first] = *pair.second.start_position;
+            }
             const auto id_stamp_pair = std::make_pair(pair.first, pair.second.stamp);
             auto orig_res = orig_stamps.insert(id_stamp_pair);
             guarantee(orig_res.second);
@@ -2339,6 +2959,7 @@ public:
             }
         }
         queue->purge_below(purge_stamps);
+        update_queue_stats(0);
         rcheck_datum(orig_stamps.size() != 0, base_exc_t::RESUMABLE_OP_FAILED,
                      "Empty start stamps.  Did you just reshard?");
 
@@ -2365,6 +2986,8 @@ public:
         backtrace_id_t bt) {
         assert_thread();
         r_sanity_check(self.get() == this);
+        rcheck_src(bt, !include_positions, base_exc_t::LOGIC,
+                   "Cannot include positions in a changefeed on a system table.");
 
         artificial_include_initial = include_initial;
 
@@ -2388,6 +3011,19 @@ public:
     const std::map<uuid_u, uint64_t> &get_next_stamps() { return next_stamps; }
     const std::map<uuid_u, uint64_t> &get_orig_stamps() { return orig_stamps; }
 private:
+    // The position token that lets a later feed resume after the last change
+    // we've returned.
+    datum_t positions_datum() const {
+        std::map<datum_string_t, datum_t> token;
+        for (const auto &pair : positions) {
+            token[datum_string_t(uuid_to_str(pair.first))] =
+                datum_t(static_cast<double>(pair.second));
+        }
+        return datum_t(
+            std::map<datum_string_t, datum_t>{
+                { datum_string_t("position"), datum_t(std::move(token)) }});
+    }
+
     scoped_ptr_t<env_t> make_env(env_t *outer_env) {
         // This is to support fake environments from the unit tests that don't
         // actually have a context.
@@ -2411,6 +3047,14 @@ private:
     // our subscription.
     std::map<uuid_u, uint64_t> orig_stamps, next_stamps;
     keyspec_t::range_t spec;
+    const uuid_u filter_id;
+    const bool include_positions;
+    const optional<std::map<uuid_u, uint64_t> > since;
+    // The position of the last change we've returned from each server.
+    std::map<uuid_u, uint64_t> positions;
+    bool sent_positions;
+    // Whether we've reconciled the initial values and are only returning changes.
+    bool live;
     optional<std::map<store_key_t, uint64_t> > store_keys;
     optional<key_range_t> store_key_range;
     state_t state, sent_state;
@@ -2816,6 +3460,12 @@ void real_feed_t::stop_limit_sub(limit_sub_t *sub) {
     }
 }
 
+void real_feed_t::stop_filter(const uuid_u &filter_id) {
+    for (const auto &addr : filter_stop_addrs) {
+        send(manager, addr, mailbox.get_address(), filter_id);
+    }
+}
+
 class msg_visitor_t : public boost::static_visitor<void> {
 public:
     msg_visitor_t(feed_t *_feed, const auto_drainer_t::lock_t *_lock,
@@ -2843,96 +3493,8 @@ public:
             });
     }
     void operator()(const msg_t::change_t &change) const {
-        datum_t null = datum_t::null();
-
         feed->each_range_sub(*lock, [&](range_sub_t *sub) {
-            datum_t new_val = null, old_val = null;
-            if (!sub->active()) return;
-            bool trivial = false;
-            if (sub->has_ops()) {
-                if (change.new_val.has()) {
-                    if (optional<datum_t> d = sub->apply_ops(change.new_val)) {
-                        new_val = *d;
-                    }
-                }
-                if (!sub->active()) return;
-                if (change.old_val.has()) {
-                    if (optional<datum_t> d = sub->apply_ops(change.old_val)) {
-                        old_val = *d;
-                    }
-                }
-                if (!sub->active()) return;
-                // Duplicate values are caught before being written to disk and
-                // don't generate a `mod_report`, but if we have transforms the
-                // values might have changed.
-                trivial = (new_val == old_val);
-            } else {
-                guarantee(change.old_val.has() || change.new_val.has());
-                if (change.new_val.has()) {
-                    new_val = change.new_val;
-                }
-                if (change.old_val.has()) {
-                    old_val = change.old_val;
-                }
-            }
-            ASSERT_NO_CORO_WAITING;
-            optional<std::string> sindex = sub->sindex();
-            if (sindex) {
-                std::vector<indexed_datum_t> old_idxs, new_idxs;
-                auto old_it = change.old_indexes.find(*sindex);
-                if (old_it != change.old_indexes.end()) {
-                    for (const auto &idx : old_it->second) {
-                        for (size_t i = 0; i < sub->copies(idx.first); ++i) {
-                            old_idxs.push_back(
-                                indexed_datum_t(old_val, make_optional(idx.second)));
-                        }
-                    }
-                }
-                auto new_it = change.new_indexes.find(*sindex);
-                if (new_it != change.new_indexes.end()) {
-                    for (const auto &idx : new_it->second) {
-                        for (size_t i = 0; i < sub->copies(idx.first); ++i) {
-                            new_idxs.push_back(
-                                indexed_datum_t(new_val, make_optional(idx.second)));
-                        }
-                    }
-                }
-                while (old_idxs.size() > 0 && new_idxs.size() > 0) {
-                    if (!trivial) {
-                        sub->add_el(server_uuid, stamp, change.pkey, sindex,
-                                    make_optional(std::move(old_idxs.back())),
-                                    make_optional(std::move(new_idxs.back())));
-                    }
-                    old_idxs.pop_back();
-                    new_idxs.pop_back();
-                }
-                while (old_idxs.size() > 0) {
-                    guarantee(new_idxs.size() == 0);
-                    if (old_val != null) {
-                        sub->add_el(server_uuid, stamp, change.pkey, sindex,
-                                    make_optional(std::move(old_idxs.back())),
-                                    r_nullopt);
-                    }
-                    old_idxs.pop_back();
-                }
-                while (new_idxs.size() > 0) {
-                    guarantee(old_idxs.size() == 0);
-                    if (new_val != null) {
-                        sub->add_el(server_uuid, stamp, change.pkey, sindex,
-                                    r_nullopt,
-                                    make_optional(std::move(new_idxs.back())));
-                    }
-                    new_idxs.pop_back();
-                }
-            } else {
-                if (!trivial) {
-                    for (size_t i = 0; i < sub->copies(change.pkey); ++i) {
-                        sub->add_el(server_uuid, stamp, change.pkey, sindex,
-                                    make_optional(indexed_datum_t(old_val, r_nullopt)),
-                                    make_optional(indexed_datum_t(new_val, r_nullopt)));
-                    }
-                }
-            }
+            add_range_change(sub, change);
         });
         feed->on_point_sub(
             change.pkey,
@@ -2951,12 +3513,115 @@ public:
                 change.new_val.has()
                     ? optional<indexed_datum_t>(
                         indexed_datum_t(change.new_val, r_nullopt))
-                    : r_nullopt));
+                    : r_nullopt,
+                change.position));
+    }
+    void operator()(const msg_t::replay_change_t &replay) const {
+        feed->each_range_sub(*lock, [&](range_sub_t *sub) {
+            if (sub->get_filter_id() == replay.sub) {
+                add_range_change(sub, replay.change);
+            }
+        });
     }
     void operator()(const msg_t::stop_t &) const {
         feed->abort_feed();
     }
 private:
+    void add_range_change(range_sub_t *sub, const msg_t::change_t &change) const {
+        datum_t null = datum_t::null();
+        datum_t new_val = null, old_val = null;
+        if (!sub->active()) return;
+        bool trivial = false;
+        if (sub->has_ops()) {
+            if (change.new_val.has()) {
+                if (optional<datum_t> d = sub->apply_ops(change.new_val)) {
+                    new_val = *d;
+                }
+            }
+            if (!sub->active()) return;
+            if (change.old_val.has()) {
+                if (optional<datum_t> d = sub->apply_ops(change.old_val)) {
+                    old_val = *d;
+                }
+            }
+            if (!sub->active()) return;
+            // Duplicate values are caught before being written to disk and
+            // don't generate a `mod_report`, but if we have transforms the
+            // values might have changed.
+            trivial = (new_val == old_val);
+        } else {
+            guarantee(change.old_val.has() || change.new_val.has());
+            if (change.new_val.has()) {
+                new_val = change.new_val;
+            }
+            if (change.old_val.has()) {
+                old_val = change.old_val;
+            }
+        }
+        ASSERT_NO_CORO_WAITING;
+        optional<std::string> sindex = sub->sindex();
+        if (sindex) {
+            std::vector<indexed_datum_t> old_idxs, new_idxs;
+            auto old_it = change.old_indexes.find(*sindex);
+            if (old_it != change.old_indexes.end()) {
+                for (const auto &idx : old_it->second) {
+                    for (size_t i = 0; i < sub->copies(idx.first); ++i) {
+                        old_idxs.push_back(
+                            indexed_datum_t(old_val, make_optional(idx.second)));
+                    }
+                }
+            }
+            auto new_it = change.new_indexes.find(*sindex);
+            if (new_it != change.new_indexes.end()) {
+                for (const auto &idx : new_it->second) {
+                    for (size_t i = 0; i < sub->copies(idx.first); ++i) {
+                        new_idxs.push_back(
+                            indexed_datum_t(new_val, make_optional(idx.second)));
+                    }
+                }
+            }
+            while (old_idxs.size() > 0 && new_idxs.size() > 0) {
+                if (!trivial) {
+                    sub->add_el(server_uuid, stamp, change.pkey, sindex,
+                                make_optional(std::move(old_idxs.back())),
+                                make_optional(std::move(new_idxs.back())),
+                                change.position);
+                }
+                old_idxs.pop_back();
+                new_idxs.pop_back();
+            }
+            while (old_idxs.size() > 0) {
+                guarantee(new_idxs.size() == 0);
+                if (old_val != null) {
+                    sub->add_el(server_uuid, stamp, change.pkey, sindex,
+                                make_optional(std::move(old_idxs.back())),
+                                r_nullopt,
+                                change.position);
+                }
+                old_idxs.pop_back();
+            }
+            while (new_idxs.size() > 0) {
+                guarantee(old_idxs.size() == 0);
+                if (new_val != null) {
+                    sub->add_el(server_uuid, stamp, change.pkey, sindex,
+                                r_nullopt,
+                                make_optional(std::move(new_idxs.back())),
+                                change.position);
+                }
+                new_idxs.pop_back();
+            }
+        } else {
+            if (!trivial) {
+                for (size_t i = 0; i < sub->copies(change.pkey); ++i) {
+                    sub->add_el(server_uuid, stamp, change.pkey, sindex,
+                                make_optional(indexed_datum_t(old_val, r_nullopt)),
+                                make_optional(indexed_datum_t(new_val, r_nullopt)),
+                                change.position);
+                }
+            }
+        }
+    }
+
     feed_t *feed;
     const auto_drainer_t::lock_t *lock;
     uuid_u server_uuid;
@@ -3520,6 +4185,7 @@ void feed_t::add_point_sub(point_sub_t *sub, const store_key_t &key) THROWS_NOTH
 // Can't throw because it's called in a destructor.
 void feed_t::del_point_sub(point_sub_t *sub, const store_key_t &key) THROWS_NOTHING {
     del_sub_with_lock(&point_subs_lock, [this, sub, &key]() {
+            stop_filter(sub->get_filter_id());
             return map_del_sub(&point_subs, key, sub);
         });
 }
@@ -3535,6 +4201,7 @@ void feed_t::add_range_sub(range_sub_t *sub) THROWS_NOTHING {
 // Can't throw because it's called in a destructor.
 void feed_t::del_range_sub(range_sub_t *sub) THROWS_NOTHING {
     del_sub_with_lock(&range_subs_lock, [this, sub]() {
+            stop_filter(sub->get_filter_id());
             return range_subs[sub->home_thread().threadnum].erase(sub);
         });
 }
@@ -3774,6 +4441,10 @@ scoped_ptr_t<subscription_t> new_sub(
         subscription_t *operator()(const keyspec_t::range_t &range) const {
             rcheck_datum(!ss->include_offsets, base_exc_t::LOGIC,
                          "Cannot include offsets for range subs.");
+            // Squashing would merge changes with different positions.
+            rcheck_datum(!ss->include_positions || !ss->squash.as_bool(),
+                         base_exc_t::LOGIC,
+                         "Cannot include positions in a squashed changefeed.");
             return new range_sub_t(
                 env->get_rdb_ctx(),
                 env->get_user_context(),
@@ -3782,12 +4453,16 @@ scoped_ptr_t<subscription_t> new_sub(
                 ss->squash,
                 ss->include_states,
                 ss->include_types,
+                ss->include_positions,
+                ss->since,
                 env,
                 range);
         }
         subscription_t *operator()(const keyspec_t::empty_t &) const {
             rcheck_datum(!ss->include_offsets, base_exc_t::LOGIC,
                          "Cannot include offsets for empty subs.");
+            rcheck_datum(!ss->include_positions, base_exc_t::LOGIC,
+                         "Cannot include positions for empty subs.");
             return new empty_sub_t(
                 env->get_rdb_ctx(),
                 env->get_user_context(),
@@ -3798,6 +4473,8 @@ scoped_ptr_t<subscription_t> new_sub(
                 ss->include_types);
         }
         subscription_t *operator()(const keyspec_t::limit_t &limit) const {
+            rcheck_datum(!ss->include_positions, base_exc_t::LOGIC,
+                         "Cannot include positions for limit subs.");
             return new limit_sub_t(
                 env->get_rdb_ctx(),
                 env->get_user_context(),
@@ -3812,6 +4489,8 @@ scoped_ptr_t<subscription_t> new_sub(
         subscription_t *operator()(const keyspec_t::point_t &point) const {
             rcheck_datum(!ss->include_offsets, base_exc_t::LOGIC,
                          "Cannot include offsets for point subs.");
+            rcheck_datum(!ss->include_positions, base_exc_t::LOGIC,
+                         "Cannot include positions for point subs.");
             return new point_sub_t(
                 env->get_rdb_ctx(),
                 env->get_user_context(),
@@ -3835,6 +4514,8 @@ streamspec_t::streamspec_t(counted_t<datum_stream_t> _maybe_src,
                            bool _include_offsets,
                            bool _include_states,
                            bool _include_types,
+                           bool _include_positions,
+                           optional<std::map<uuid_u, uint64_t> > _since,
                            configured_limits_t _limits,
                            datum_t _squash,
                            keyspec_t::spec_t _spec) :
@@ -3843,6 +4524,8 @@ streamspec_t::streamspec_t(counted_t<datum_stream_t> _maybe_src,
     include_offsets(std::move(_include_offsets)),
     include_states(std::move(_include_states)),
     include_types(std::move(_include_types)),
+    include_positions(std::move(_include_positions)),
+    since(std::move(_since)),
     limits(std::move(_limits)),
     squash(std::move(_squash)),
     spec(std::move(_spec)) { }
@@ -4005,6 +4688,8 @@ public:
     NORETURN virtual void stop_limit_sub(limit_sub_t *) {
         crash("Limit subscriptions are not supported on artificial feeds.");
     }
+    // Artificial tables send all changes to all subscriptions.
+    virtual void stop_filter(const uuid_u &) { }
 private:
     artificial_t *parent;
     auto_drainer_t drainer;
@@ -6,6 +6,7 @@
 #include <exception>
 #include <functional>
 #include <map>
+#include <set>
 #include <string>
 #include <vector>
 #include <utility>
@@ -14,6 +15,7 @@
 #include <boost/variant.hpp>
 
 #include "btree/keys.hpp"
+#include "concurrency/cond_var.hpp"
 #include "concurrency/new_mutex.hpp"
 #include "concurrency/promise.hpp"
 #include "concurrency/rwlock.hpp"
@@ -30,6 +32,7 @@
 #include "rpc/connectivity/peer_id.hpp"
 #include "rpc/mailbox/typed.hpp"
 #include "rpc/serialize_macros.hpp"
+#include "time.hpp"
 #include "containers/archive/boost_types.hpp"
 
 class artificial_table_backend_t;
@@ -41,6 +44,7 @@ class namespace_interface_access_t;
 class name_resolver_t;
 class real_superblock_t;
 class sindex_superblock_t;
+struct changefeed_filter_spec_t;
 struct rdb_modification_report_t;
 struct serializable_env_t;
 struct sindex_disk_info_t;
@@ -51,6 +55,7 @@ typedef std::map<std::string, std::vector<index_pair_t> > index_vals_t;
 
 namespace ql {
 
+class aggregate_view_t;
 class base_exc_t;
 class batcher_t;
 class datum_stream_t;
@@ -100,8 +105,18 @@ struct msg_t {
         /* For a newly-created row, `old_val` is an empty `datum_t`. For a deleted row,
         `new_val` is an empty `datum_t`. */
         datum_t old_val, new_val;
+        // The change's position in the `server_t`'s sequence of changes, which
+        // `send_all` assigns.  See `server_t::get_stamp_with_positions`.
+        uint64_t position;
         RDB_DECLARE_ME_SERIALIZABLE(change_t);
     };
+    // A change from the `server_t`'s change log, which is only for the range
+    // subscription whose filter has the id `sub`.
+    struct replay_change_t {
+        uuid_u sub;
+        change_t change;
+        RDB_DECLARE_ME_SERIALIZABLE(replay_change_t);
+    };
     struct stop_t {
         RDB_DECLARE_ME_SERIALIZABLE(stop_t);
     };
@@ -116,7 +131,8 @@ struct msg_t {
                            change_t,
                            limit_start_t,
                            limit_change_t,
-                           limit_stop_t> op_t;
+                           limit_stop_t,
+                           replay_change_t> op_t;
     op_t op;
 
     // Accursed reference collapsing!
@@ -182,6 +198,10 @@ public:
     bool include_offsets;
     bool include_states;
     bool include_types;
+    // Whether to include the positions of changes, so the feed can be resumed
+    // from them with `since`.  (Only for range subscriptions.)
+    bool include_positions;
+    optional<std::map<uuid_u, uint64_t> > since;
     configured_limits_t limits;
     datum_t squash;
     keyspec_t::spec_t spec;
@@ -190,6 +210,8 @@ public:
                  bool _include_offsets,
                  bool _include_states,
                  bool _include_types,
+                 bool _include_positions,
+                 optional<std::map<uuid_u, uint64_t> > _since,
                  configured_limits_t _limits,
                  datum_t _squash,
                  keyspec_t::spec_t _spec);
@@ -391,6 +413,42 @@ struct sindex_ref_t {
     const sindex_disk_info_t *sindex_info;
 };
 
+// A `change_filter_t` lives in the `server_t` on behalf of one range or point
+// subscription, and tells it whether the subscription could do anything with a
+// change.  If none of the subscriptions of a `client_t` want a change, the server
+// doesn't send it.  This way a feed like `.filter(...).changes()` or
+// `.between(...).changes()` is evaluated on the shard, rather than every change
+// to the table being sent to the subscriber and discarded there.
+class change_filter_t {
+public:
+    // For a range subscription.  If `ctx` is `nullptr` we don't evaluate the
+    // transformations.
+    change_filter_t(rdb_context_t *ctx, const changefeed_filter_spec_t &spec);
+    // For a point subscription.
+    change_filter_t(uuid_u _id, store_key_t _point_key);
+
+    // Returns false if the subscription would certainly ignore `change`.  This
+    // mirrors what `msg_visitor_t` does with the change on the subscriber's side,
+    // and has to err on the side of returning true.
+    bool wants(const msg_t::change_t &change);
+
+    const uuid_u id;
+    const optional<store_key_t> point_key;
+
+private:
+    bool range_contains(const msg_t::change_t &change) const;
+
+    keyspec_t::range_t range;
+    optional<std::map<store_key_t, uint64_t> > store_keys;
+    optional<key_range_t> store_key_range;
+
+    cond_t non_interruptor;
+    scoped_ptr_t<env_t> env;
+    std::vector<scoped_ptr_t<op_t> > ops;
+
+    DISABLE_COPYING(change_filter_t);
+};
+
 class server_t;
 class limit_manager_t {
 public:
@@ -431,10 +489,17 @@ public:
     const optional<uuid_u> sindex_id;
     const uuid_u uuid;
 private:
-    // Can throw `exc_t` exceptions if an error occurs while reading from disk.
+    // Reads up to `n` items after `start`.  Can throw `exc_t` exceptions if an
+    // error occurs while reading from disk.
     std::vector<item_t> read_more(
         const boost::variant<primary_ref_t, sindex_ref_t> &ref,
-        const optional<item_t> &start);
+        const optional<item_t> &start,
+        size_t n);
+    // These move items between `item_queue` and `cushion`, and record the
+    // changes to the active set in `real_added` and `real_deleted`.
+    void move_worst_to_cushion(item_queue_t *real_added,
+                               std::set<std::string> *real_deleted);
+    void move_best_from_cushion(item_queue_t *real_added);
     void send(msg_t &&msg);
 
     scoped_ptr_t<env_t> env;
@@ -446,7 +511,15 @@ private:
     std::vector<scoped_ptr_t<op_t> > ops;
 
     limit_order_t gt;
+    // The items the client has, i.e. the top `spec.limit` items in `region`.
     item_queue_t item_queue;
+    // The next up to `cushion_size` items after the ones in `item_queue`.  When
+    // items are deleted from the active set, we replace them from here, so we
+    // only need to read from disk once we run out of cushion.  Together with
+    // `item_queue` this always holds the top items in `region` (except for items
+    // that are added after we've read the cushion and don't beat its last item).
+    item_queue_t cushion;
+    const size_t cushion_size;
 
     std::map<std::string, std::pair<datum_t, datum_t> > added;
     std::set<std::string> deleted;
@@ -465,6 +538,7 @@ public:
     typedef server_addr_t addr_t;
     typedef mailbox_addr_t<client_t::addr_t, optional<std::string>, uuid_u>
         limit_addr_t;
+    typedef mailbox_addr_t<client_t::addr_t, uuid_u> filter_stop_addr_t;
     explicit server_t(mailbox_manager_t *_manager, store_t *_parent);
     ~server_t();
     void add_client(
@@ -485,14 +559,34 @@ public:
         const auto_drainer_t::lock_t &keepalive);
     // `key` should be non-NULL if there is a key associated with the message.
     void send_all(
-        const msg_t &msg,
+        msg_t &&msg,
         const store_key_t &key,
         rwlock_in_line_t *stamp_spot,
         const auto_drainer_t::lock_t &keepalive);
     addr_t get_stop_addr();
     limit_addr_t get_limit_stop_addr();
+    filter_stop_addr_t get_filter_stop_addr();
+    // If `filter` is non-empty, it's registered for the client together with
+    // taking the stamp, so it applies to exactly the changes from that stamp on.
+    // (It's dropped if the client doesn't exist.)
     optional<uint64_t> get_stamp(
         const client_t::addr_t &addr,
+        scoped_ptr_t<change_filter_t> &&filter,
+        const auto_drainer_t::lock_t &keepalive);
+    // Like `get_stamp`, for a range subscription that wants to know the positions
+    // of its changes.  This turns on the change log if it isn't on yet (it stays
+    // on at least until the filter is stopped).  If `since` is empty,
+    // `*position_out` is set to the position of the last change so far.
+    // Otherwise, if the change log still has every change after the
+    // position that `since` has for this server, those changes are sent to the
+    // client as `replay_change_t`s stamped from the returned stamp on, and
+    // `*position_out` is set to that position.  If it doesn't, `*position_out`
+    // is left empty.
+    optional<uint64_t> get_stamp_with_positions(
+        const client_t::addr_t &addr,
+        scoped_ptr_t<change_filter_t> &&filter,
+        const optional<std::map<uuid_u, uint64_t> > &since,
+        optional<uint64_t> *position_out,
         const auto_drainer_t::lock_t &keepalive);
     uuid_u get_uuid();
     // `f` will be called with a read lock on `clients` and a write lock on the
@@ -510,6 +604,45 @@ public:
         const optional<std::string> &sindex_name,
         const auto_drainer_t::lock_t &keepalive);
     auto_drainer_t::lock_t get_keepalive();
+
+    // Aggregate views are read, started and finished with a read lock on the
+    // parent's stamp lock, and updated with a write lock when `send_all` would stamp
+    // the change, so a view reflects exactly the writes that came before the read.
+    // `read_aggregate_view` returns false if there's no built view for `key`.
+    bool read_aggregate_view(
+        const std::string &key,
+        rwlock_in_line_t *stamp_spot,
+        result_t *out,
+        const auto_drainer_t::lock_t &keepalive);
+    // Registers `view`, which isn't built yet, unless there is a view for `key`
+    // already.  If there are `MAX_AGGREGATE_VIEWS` views, it drops the one that was
+    // read least recently to make room.  Returns the id to pass to
+    // `finish_aggregate_view`, or 0 if it didn't register `view`.
+    uint64_t start_aggregate_view(
+        const std::string &key,
+        scoped_ptr_t<aggregate_view_t> &&view,
+        rwlock_in_line_t *stamp_spot,
+        const auto_drainer_t::lock_t &keepalive);
+    // `built` is the result of scanning the snapshot that the view was started at,
+    // or `nullptr` if the scan failed.  Does nothing if the view was dropped in the
+    // meantime.
+    void finish_aggregate_view(
+        const std::string &key,
+        uint64_t build_id,
+        const result_t *built,
+        rwlock_in_line_t *stamp_spot,
+        const auto_drainer_t::lock_t &keepalive);
+    // This also drops the views that weren't read for `AGGREGATE_VIEW_IDLE_USECS`,
+    // because every write has to update them.
+    void update_aggregate_views(
+        const datum_t &old_val,
+        const datum_t &new_val,
+        rwlock_in_line_t *stamp_spot,
+        const auto_drainer_t::lock_t &keepalive);
+    // Like `update_aggregate_views`, this needs a write lock on the stamp lock.
+    void drop_aggregate_views(
+        rwlock_in_line_t *stamp_spot,
+        const auto_drainer_t::lock_t &keepalive);
 private:
     friend class limit_manager_t;
     void stop_mailbox_cb(signal_t *interruptor, client_t::addr_t addr);
@@ -517,6 +650,9 @@ private:
                                client_t::addr_t addr,
                                optional<std::string> sindex,
                                uuid_u uuid);
+    void filter_stop_mailbox_cb(signal_t *interruptor,
+                                client_t::addr_t addr,
+                                uuid_u filter_id);
     void add_client_cb(
         signal_t *stopped,
         client_t::addr_t addr,
@@ -536,8 +672,21 @@ private:
         std::map<optional<std::string>,
                  std::vector<scoped_ptr_t<limit_manager_t>>> limit_clients;
         scoped_ptr_t<rwlock_t> limit_clients_lock;
+        // The filters of the client's range and point subscriptions, and how many
+        // point subscriptions there are for each key.  These are protected by the
+        // parent's stamp lock, like `aggregate_views`.
+        std::map<uuid_u, scoped_ptr_t<change_filter_t> > filters;
+        std::map<store_key_t, size_t> point_filter_keys;
+        // The ids of the filters that were registered by
+        // `get_stamp_with_positions`.
+        std::set<uuid_u> positions_filters;
     };
     std::map<client_t::addr_t, client_info_t> clients;
+    // The entries of `clients` by the regions they're subscribed to, so that
+    // `send_all` checks each distinct region only once.  (Usually every client
+    // is subscribed to the server's whole region.)
+    std::map<region_t, std::map<client_t::addr_t, client_info_t *> >
+        clients_by_region;
 
     void prune_dead_limit(
         auto_drainer_t::lock_t *stealable_lock,
@@ -546,6 +695,14 @@ private:
         optional<std::string> sindex,
         size_t offset);
 
+    // Registers `filter` for the client, unless it already has a filter with the
+    // same id.  Call this with the parent's stamp lock.
+    static void add_filter(
+        client_info_t *info, scoped_ptr_t<change_filter_t> &&filter);
+
+    // Returns true if any of the client's subscriptions might want `change`.
+    static bool client_wants(client_info_t *info, const msg_t::change_t &change);
+
     void send_one_with_lock(std::pair<const client_t::addr_t, client_info_t> *client,
                             msg_t msg,
                             const auto_drainer_t::lock_t &lock);
@@ -564,6 +721,42 @@ private:
     // We need access to the stamp lock that exists on the parent.
     store_t *parent;
 
+    // Protected by the parent's stamp lock, see `read_aggregate_view`.
+    struct aggregate_view_info_t {
+        scoped_ptr_t<aggregate_view_t> view;
+        // Tells the read that builds the view apart from later ones for the same key.
+        uint64_t build_id;
+        microtime_t last_read;
+    };
+    std::map<std::string, aggregate_view_info_t> aggregate_views;
+    uint64_t next_aggregate_view_build_id;
+
+    // The change log lets range subscriptions with `include_positions` resume
+    // from a position they saw in an earlier feed.  It's bounded by
+    // `MAX_CHANGE_LOG_CHANGES` and `MAX_CHANGE_LOG_BYTES`.  We only keep it while
+    // somebody is subscribed with positions, and for `CHANGE_LOG_RETENTION_USECS`
+    // after the last of them goes away so that they can still resume; after that
+    // `send_all` drops it.  All of this is protected by the parent's stamp lock.
+    //
+    // The log is only kept in memory, on purpose: it's meant to bridge a dropped
+    // client connection, not to survive the server.  So positions are only
+    // meaningful for this `server_t`, which is why tokens are keyed by its uuid.
+    // After a restart, a reshard or a new primary replica the uuids are different,
+    // resuming fails with `OP_FAILED`, and the client has to start over with
+    // `include_initial`.  Keeping the log on disk would need a new per-shard
+    // structure next to the secondary indexes, with its own migration and
+    // backfill; we don't have that.
+    void forget_positions_filters(client_info_t *info);
+    uint64_t next_position;
+    bool change_log_enabled;
+    size_t positions_filters_count;
+    microtime_t change_log_idle_since;
+    // The position of the first change we still have all the changes from.
+    uint64_t change_log_start;
+    // The changes, with their serialized sizes.
+    std::deque<std::pair<msg_t::change_t, size_t> > change_log;
+    size_t change_log_bytes;
+
     auto_drainer_t drainer;
     // Clients send a message to this mailbox with their address when they want
     // to unsubscribe.  The callback of this mailbox acquires the drainer, so it
@@ -573,6 +766,9 @@ private:
     // changefeed.
     mailbox_t<client_t::addr_t, optional<std::string>, uuid_u>
         limit_stop_mailbox;
+    // Clients send a message to this mailbox to remove the filter of a range or
+    // point subscription that's gone.
+    mailbox_t<client_t::addr_t, uuid_u> filter_stop_mailbox;
 };
 
 class artificial_feed_t;
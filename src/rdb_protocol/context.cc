@@ -76,7 +76,19 @@ rdb_context_t::stats_t::stats_t(perfmon_collection_t *global_stats)
                                  &queries_per_sec, "queries_per_sec"),
       queries_total(get_num_threads()),
       queries_total_membership(&qe_stats_collection,
-                               &queries_total, "queries_total") { }
+                               &queries_total, "queries_total"),
+      changefeed_queued_changes(get_num_threads()),
+      changefeed_queued_changes_membership(&qe_stats_collection,
+                                           &changefeed_queued_changes,
+                                           "changefeed_queued_changes"),
+      changefeed_changes_coalesced(get_num_threads()),
+      changefeed_changes_coalesced_membership(&qe_stats_collection,
+                                              &changefeed_changes_coalesced,
+                                              "changefeed_changes_coalesced"),
+      changefeed_limit_reads_per_sec(secs_to_ticks(1), get_num_threads()),
+      changefeed_limit_reads_per_sec_membership(&qe_stats_collection,
+                                                &changefeed_limit_reads_per_sec,
+                                                "changefeed_limit_reads_per_sec") { }
 
 rdb_context_t::rdb_context_t()
     : extproc_pool(nullptr),
@@ -231,6 +231,15 @@ public:
         ql::env_t *env,
         durability_requirement_t durability) = 0;
 
+    /* Allows `read_mode_t::SINGLE` reads on this table to be served by replicas that
+    are at most `max_staleness_ms` behind the primary. Tables that have no replicas
+    ignore it. */
+    virtual void set_max_staleness(uint64_t) { }
+
+    /* Lets eligible `count` reads on this table be answered from, and build, the
+    shards' aggregate views. Tables that don't have shards ignore it. */
+    virtual void set_use_aggregate_views() { }
+
     /* This must be public */
     virtual ~base_table_t() { }
 };
@@ -284,6 +293,7 @@ public:
             const table_generate_config_params_t &config_params,
             const std::string &primary_key,
             write_durability_t durability,
+            int num_cpu_shards,
             signal_t *interruptor,
             ql::datum_t *result_out,
             admin_err_t *error_out) = 0;
@@ -366,6 +376,16 @@ public:
             ql::datum_t *result_out,
             admin_err_t *error_out) = 0;
 
+    virtual bool table_set_cpu_shards(
+            auth::user_context_t const &user_context,
+            counted_t<const ql::db_t> db,
+            const name_string_t &name,
+            int num_cpu_shards,
+            bool dry_run,
+            signal_t *interruptor,
+            ql::datum_t *result_out,
+            admin_err_t *error_out) = 0;
+
     virtual bool table_rebalance(
             auth::user_context_t const &user_context,
             counted_t<const ql::db_t> db,
@@ -502,6 +522,15 @@ public:
         perfmon_membership_t queries_per_sec_membership;
         perfmon_counter_t queries_total;
         perfmon_membership_t queries_total_membership;
+        // How many changes are waiting to be read from changefeeds, and how many
+        // changes were merged into later ones because a changefeed fell behind.
+        perfmon_counter_t changefeed_queued_changes;
+        perfmon_membership_t changefeed_queued_changes_membership;
+        perfmon_counter_t changefeed_changes_coalesced;
+        perfmon_membership_t changefeed_changes_coalesced_membership;
+        // How often `.limit().changes()` feeds have to read from disk to refill.
+        perfmon_rate_monitor_t changefeed_limit_reads_per_sec;
+        perfmon_membership_t changefeed_limit_reads_per_sec_membership;
     private:
         DISABLE_COPYING(stats_t);
     } stats;
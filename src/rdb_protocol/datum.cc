@@ -1811,6 +1811,91 @@ int datum_t::cmp(const datum_t &rhs) const {
         });
 }
 
+// FNV-1a, which is plenty for grouping keys and cheap to compute incrementally.
+static const size_t datum_hash_seed = 14695981039346656037ULL;
+
+static size_t datum_hash_bytes(size_t h, const char *data, size_t size) {
+    for (size_t i = 0; i < size; ++i) {
+        h ^= static_cast<uint8_t>(data[i]);
+        h *= 1099511628211ULL;
+    }
+    return h;
+}
+
+template <class T>
+static size_t datum_hash_pod(size_t h, T value) {
+    return datum_hash_bytes(h, reinterpret_cast<const char *>(&value), sizeof(value));
+}
+
+static size_t datum_hash_str(size_t h, const datum_string_t &str) {
+    // Hash the length too, so that adjacent strings in arrays and objects can't
+    // run together.
+    return datum_hash_bytes(datum_hash_pod(h, str.size()), str.data(), str.size());
+}
+
+size_t datum_t::hash_unchecked_stack() const {
+    // This has to mirror `cmp_unchecked_stack` exactly: anything that `cmp`
+    // considers equal must hash equally.
+    if (is_ptype() && !pseudo_compares_as_obj()) {
+        const std::string reql_type = get_reql_type();
+        size_t h = datum_hash_bytes(
+            datum_hash_pod(datum_hash_seed, static_cast<int>(R_BINARY)),
+            reql_type.data(), reql_type.size());
+        if (get_type() == R_BINARY) {
+            return datum_hash_str(h, as_binary());
+        } else if (reql_type == pseudo::time_string) {
+            // Times compare by their epoch time only, not their timezone.
+            return datum_hash_pod(
+                h, datum_t(pseudo::time_to_epoch_time(*this)).hash_unchecked_stack());
+        }
+        return h;
+    }
+
+    size_t h = datum_hash_pod(datum_hash_seed, static_cast<int>(get_type()));
+    switch (get_type()) {
+    case R_NULL: return h;
+    case MINVAL: return h;
+    case MAXVAL: return h;
+    case R_BOOL: return datum_hash_pod(h, as_bool());
+    case R_NUM: {
+        double d = as_num();
+        // `0.0 == -0.0`, so they must hash the same.
+        if (d == 0) {
+            d = 0;
+        }
+        return datum_hash_pod(h, d);
+    } unreachable();
+    case R_STR: return datum_hash_str(h, as_str());
+    case R_ARRAY: {
+        const size_t sz = arr_size();
+        h = datum_hash_pod(h, sz);
+        for (size_t i = 0; i < sz; ++i) {
+            h = datum_hash_pod(h, unchecked_get(i).hash_unchecked_stack());
+        }
+        return h;
+    } unreachable();
+    case R_OBJECT: {
+        const size_t sz = obj_size();
+        h = datum_hash_pod(h, sz);
+        for (size_t i = 0; i < sz; ++i) {
+            auto pair = unchecked_get_pair(i);
+            h = datum_hash_str(h, pair.first);
+            h = datum_hash_pod(h, pair.second.hash_unchecked_stack());
+        }
+        return h;
+    } unreachable();
+    case R_BINARY: // This should be handled by the ptype code above
+    case UNINITIALIZED: // fallthru
+    default: unreachable();
+    }
+}
+
+size_t datum_t::hash() const {
+    return call_with_enough_stack_datum<size_t>([&] {
+            return this->hash_unchecked_stack();
+        });
+}
+
 bool datum_t::operator==(const datum_t &rhs) const { return cmp(rhs) == 0; }
 bool datum_t::operator!=(const datum_t &rhs) const { return cmp(rhs) != 0; }
 bool datum_t::operator<(const datum_t &rhs) const { return cmp(rhs) < 0; }
@@ -324,6 +324,11 @@ public:
     bool operator>(const datum_t &rhs) const;
     bool operator>=(const datum_t &rhs) const;
 
+    // A hash that is consistent with `cmp`: data that compare equal have equal
+    // hashes.  Used for hash-based grouping, where no ordering is needed until the
+    // result is produced.
+    size_t hash() const;
+
     NORETURN void runtime_fail(base_exc_t::type_t exc_type,
 #ifdef RQL_ERROR_BT
                                const char *test, const char *file, int line,
@@ -395,6 +400,7 @@ private:
         std::string *str_out) const;
 
     int cmp_unchecked_stack(const datum_t &rhs) const;
+    size_t hash_unchecked_stack() const;
 
     int pseudo_cmp(const datum_t &rhs) const;
     bool pseudo_compares_as_obj() const;
@@ -5,11 +5,13 @@
 
 #include <map>
 
+#include "assignment_sentry.hpp"
 #include "math.hpp"
 #include "rdb_protocol/batching.hpp"
 #include "rdb_protocol/datum_stream/array.hpp"
 #include "rdb_protocol/datum_stream/eq_join.hpp"
 #include "rdb_protocol/datum_stream/fold.hpp"
+#include "rdb_protocol/datum_stream/hash_join.hpp"
 #include "rdb_protocol/datum_stream/indexed_sort.hpp"
 #include "rdb_protocol/datum_stream/lazy.hpp"
 #include "rdb_protocol/datum_stream/map.hpp"
@@ -2295,7 +2297,12 @@ bool map_datum_stream_t::is_exhausted() const {
     return false;
 }
 
-eq_join_datum_stream_t::eq_join_datum_stream_t(counted_t<datum_stream_t> _stream,
+// The maximum number of lookups an `eq_join_datum_stream_t` runs at a time.  Each
+// one is for a batch of left-hand rows.
+const size_t EQ_JOIN_MAX_IN_FLIGHT_LOOKUPS = 8;
+
+eq_join_datum_stream_t::eq_join_datum_stream_t(env_t *env,
+                                               counted_t<datum_stream_t> _stream,
                                                counted_t<table_t> _table,
                                                datum_string_t _join_index,
                                                counted_t<const func_t> _predicate,
@@ -2309,104 +2316,423 @@ eq_join_datum_stream_t::eq_join_datum_stream_t(counted_t<datum_stream_t> _stream
     ordered(_ordered),
     is_array_eq_join(stream->is_array()),
     is_infinite_eq_join(stream->is_infinite()),
-    eq_join_type(stream->cfeed_type()) { }
+    eq_join_type(stream->cfeed_type()) {
+    if (env->trace != nullptr) {
+        trace = make_scoped<profile::trace_t>();
+        disabler = make_scoped<profile::disabler_t>(trace.get());
+    }
+    coro_env = make_scoped<env_t>(
+        env->get_rdb_ctx(),
+        env->return_empty_normal_batches,
+        drainer.get_drain_signal(),
+        env->get_serializable_env(),
+        trace.has() ? trace.get() : nullptr);
+}
+
+void eq_join_datum_stream_t::launch_lookup(env_t *env,
+                                           std::vector<datum_t> &&stream_batch,
+                                           const batchspec_t &batchspec) {
+    scoped_ptr_t<lookup_t> lookup = make_scoped<lookup_t>(batchspec);
+    for (size_t i = 0; i < stream_batch.size(); ++i) {
+        datum_t key_val;
+        try {
+            key_val = predicate->call(
+                env,
+                std::vector<datum_t>{stream_batch[i]})->as_datum();
+        } catch (const exc_t &e) {
+            if (e.get_type() == base_exc_t::NON_EXISTENCE) {
+                continue;
+            } else {
+                throw;
+            }
+        }
+        // Build a multimap from sindex value to datums from left side stream.
+        if (key_val.get_type() != datum_t::type_t::R_NULL) {
+            lookup->key_to_left.insert(
+                std::make_pair(key_val, lookup->left_rows.size()));
+            lookup->keys[key_val] = 1;
+            lookup->left_rows.push_back(std::move(stream_batch[i]));
+        }
+    }
+    lookup_t *l = lookup.get();
+    lookups.push_back(std::move(lookup));
+    if (l->keys.empty()) {
+        l->finished = true;
+    } else {
+        auto_drainer_t::lock_t keepalive(&drainer);
+        coro_t::spawn_sometime([this, l, keepalive] {
+            this->run_lookup(l, keepalive);
+        });
+    }
+}
+
+void eq_join_datum_stream_t::run_lookup(lookup_t *lookup,
+                                        auto_drainer_t::lock_t keepalive) {
+    try {
+        // Basically do a get all on the keys, but we get the reader directly so we
+        // can read the sindex from the lookup.
+        scoped_ptr_t<reader_t> reader = table->get_all_with_sindexes(
+            coro_env.get(),
+            datumspec_t(std::move(lookup->keys)),
+            join_index.to_std(),
+            backtrace());
+        while (!reader->is_finished()) {
+            std::vector<rget_item_t> items =
+                reader->raw_next_batch(coro_env.get(), lookup->batchspec);
+            if (items.empty()) {
+                continue;
+            }
+            lookup->right_items = std::move(items);
+            lookup->has_right_items = true;
+            notify_lookup_ready();
+            cond_t taken;
+            assignment_sentry_t<cond_t *> taken_sentry(
+                &lookup->right_items_taken, &taken);
+            wait_interruptible(&taken, keepalive.get_drain_signal());
+        }
+    } catch (...) {
+        lookup->exc = std::current_exception();
+    }
+    lookup->finished = true;
+    notify_lookup_ready();
+}
+
+void eq_join_datum_stream_t::notify_lookup_ready() {
+    if (lookup_ready.has() && !lookup_ready->is_pulsed()) {
+        lookup_ready->pulse();
+    }
+}
+
+std::deque<scoped_ptr_t<eq_join_datum_stream_t::lookup_t> >::iterator
+eq_join_datum_stream_t::wait_for_lookup(env_t *env) {
+    r_sanity_check(!lookups.empty());
+    auto is_ready = [](const scoped_ptr_t<lookup_t> &l) {
+        return l->has_right_items || l->finished;
+    };
+    for (;;) {
+        auto it = ordered
+            ? (is_ready(lookups.front()) ? lookups.begin() : lookups.end())
+            : std::find_if(lookups.begin(), lookups.end(), is_ready);
+        if (it != lookups.end()) {
+            return it;
+        }
+        lookup_ready = make_scoped<cond_t>();
+        wait_interruptible(lookup_ready.get(), env->interruptor);
+        lookup_ready.reset();
+    }
+}
 
 std::vector<datum_t> eq_join_datum_stream_t::next_raw_batch(
     env_t *env,
     const batchspec_t &batchspec) {
+    // This needs to be on the same thread as the coroutines we spawn.
+    home_thread_mixin_t::assert_thread();
     batcher_t batcher = batchspec.to_batcher();
 
-    batchspec_t inner_batchspec = ordered ?
-        batchspec_t::all().with_at_most(1) :
-        batchspec;
+    // With `ordered` every lookup is for a single left-hand row, so that we can emit
+    // the right-hand rows as they come in and still keep the order of `stream`.
+    batchspec_t stream_batchspec = ordered
+        ? batchspec_t::all().with_at_most(1)
+        : batchspec;
 
+    datum_string_t right("right");
+    datum_string_t left("left");
     std::vector<datum_t> res;
-    while (!is_exhausted() && !batcher.should_send_batch()) {
-        if (!get_all_reader.has() ||
-            (get_all_reader->is_finished() &&
-             get_all_items.empty())) {
-            // Get a new batch of keys
-            std::vector<datum_t> stream_batch = stream->next_batch(env,
-                                                                   inner_batchspec);
+    bool stream_has_more = true;
+    while (!batcher.should_send_batch()) {
+        // Keep the lookup window full, so that the next batch from `stream` is read
+        // while the lookups for the previous ones are in flight.
+        while (stream_has_more
+               && lookups.size() < EQ_JOIN_MAX_IN_FLIGHT_LOOKUPS
+               && !stream->is_exhausted()) {
+            std::vector<datum_t> stream_batch =
+                stream->next_batch(env, stream_batchspec);
             if (stream_batch.empty()) {
                 // We got an empty batch from the input stream. It's either exhausted
-                // or a changefeed. In either case we abort and emit our current results.
+                // or a changefeed. In either case we emit the results of the
+                // lookups we already have and then stop.
+                stream_has_more = false;
                 break;
             }
-            // Basically do a get all on the new keys
-            // but we get the reader directly so we can read the sindex from the lookup.
-            sindex_to_datum.clear();
-            std::map<datum_t, uint64_t> keys;
-            for (size_t i = 0; i < stream_batch.size(); ++i) {
-                datum_t key_val;
-                try {
-                    key_val = predicate->call(
-                        env,
-                        std::vector<datum_t>{stream_batch[i]})->as_datum();
-                } catch (const exc_t &e) {
-                    if (e.get_type() == base_exc_t::NON_EXISTENCE) {
-                        continue;
-                    } else {
-                        throw;
-                    }
-                }
-                // Build a multimap from sindex value to datums from left side stream.
-                if (key_val.get_type() != datum_t::type_t::R_NULL) {
-                    sindex_to_datum.insert(std::pair<datum_t, datum_t>{
-                            key_val, stream_batch[i]});
-                    keys[key_val] = 1;
-                }
-            }
-            get_all_reader = table->get_all_with_sindexes(
-                env,
-                datumspec_t(std::move(keys)),
-                join_index.to_std(),
-                backtrace());
+            launch_lookup(env, std::move(stream_batch), batchspec);
         }
-        if (get_all_items.empty()) {
-            get_all_items = get_all_reader->raw_next_batch(env, batchspec);
+        if (lookups.empty()) {
+            break;
         }
-        rget_item_t item;
-        if (!get_all_items.empty()) {
-            item = get_all_items.back();
-            get_all_items.pop_back();
-        } else {
+
+        auto it = wait_for_lookup(env);
+        lookup_t *lookup = it->get();
+        if (!lookup->has_right_items) {
+            scoped_ptr_t<lookup_t> finished = std::move(*it);
+            lookups.erase(it);
+            if (finished->exc) {
+                std::rethrow_exception(finished->exc);
+            }
             continue;
         }
-        // Get each item in get_all results, and match it with all datums that match
-        // in the multimap from the left side stream.
-        std::pair<std::multimap<datum_t, datum_t>::iterator,
-                  std::multimap<datum_t, datum_t>::iterator> range;
-        if (item.sindex_key.has()) {
-            range = sindex_to_datum.equal_range(item.sindex_key);
-        } else {
-            range = sindex_to_datum.equal_range(item.data.get_field(join_index));
-        }
-        datum_string_t right("right");
-        datum_string_t left("left");
-        for (auto pair = range.first; pair != range.second; ++pair) {
-            ql::datum_object_builder_t res_item;
-            bool conflict = true;
-            conflict &= res_item.add(right, item.data);
-            conflict &= res_item.add(left, pair->second);
-            guarantee(!conflict);
-            datum_t res_datum = std::move(res_item).to_datum();
-            batcher.note_el(res_datum);
-            res.push_back(std::move(res_datum));
+        std::vector<rget_item_t> right_items = std::move(lookup->right_items);
+        lookup->right_items.clear();
+        lookup->has_right_items = false;
+        if (lookup->right_items_taken != nullptr) {
+            lookup->right_items_taken->pulse();
+        }
+
+        // Match each item in the get_all results with all datums that match in the
+        // multimap from the left side stream.
+        for (const rget_item_t &item : right_items) {
+            auto range = lookup->key_to_left.equal_range(
+                item.sindex_key.has()
+                    ? item.sindex_key
+                    : item.data.get_field(join_index));
+            for (auto pair = range.first; pair != range.second; ++pair) {
+                ql::datum_object_builder_t res_item;
+                bool conflict = true;
+                conflict &= res_item.add(right, item.data);
+                conflict &= res_item.add(left, lookup->left_rows[pair->second]);
+                guarantee(!conflict);
+                datum_t res_datum = std::move(res_item).to_datum();
+                batcher.note_el(res_datum);
+                res.push_back(std::move(res_datum));
+            }
         }
     }
     return res;
 }
 
 bool eq_join_datum_stream_t::is_exhausted() const {
-    if (stream->is_exhausted() &&
-        get_all_items.empty() &&
-        (!get_all_reader.has() || get_all_reader->is_finished())) {
+    if (stream->is_exhausted() && lookups.empty()) {
         return batch_cache_exhausted();
     }
     return false;
 }
 
+bool hash_join_table_t::add_all(env_t *env,
+                                const counted_t<datum_stream_t> &stream,
+                                const counted_t<const func_t> &key_func,
+                                size_t max_size) {
+    batchspec_t batchspec = batchspec_t::user(batch_type_t::TERMINAL, env);
+    while (!stream->is_exhausted()) {
+        std::vector<datum_t> batch = stream->next_batch(env, batchspec);
+        if (batch.empty()) {
+            break;
+        }
+        for (auto &&row : batch) {
+            size += serialized_size<cluster_version_t::CLUSTER>(row);
+            if (size > max_size) {
+                return false;
+            }
+            datum_t key;
+            try {
+                key = key_func->call(env, row)->as_datum();
+            } catch (const interrupted_exc_t &) {
+                throw;
+            } catch (...) {
+                key_error = std::current_exception();
+                rows_before_key_error = num_rows;
+                return true;
+            }
+            buckets[key].push_back(std::move(row));
+            ++num_rows;
+        }
+    }
+    return true;
+}
+
+hash_join_datum_stream_t::hash_join_datum_stream_t(
+        counted_t<datum_stream_t> _left,
+        counted_t<const func_t> _right_func,
+        counted_t<const func_t> _left_key_func,
+        counted_t<const func_t> _right_key_func,
+        join_type_t _join_type,
+        bool _left_key_first,
+        backtrace_id_t _bt)
+    : eager_datum_stream_t(_bt),
+      left(std::move(_left)),
+      right_func(std::move(_right_func)),
+      left_key_func(std::move(_left_key_func)),
+      right_key_func(std::move(_right_key_func)),
+      join_type(_join_type),
+      left_key_first(_left_key_first),
+      build_left(false),
+      is_array_hash_join(left->is_array()),
+      is_infinite_hash_join(left->is_infinite()),
+      hash_join_type(left->cfeed_type()) { }
+
+static datum_t make_join_row(const datum_t &left_row, const datum_t &right_row) {
+    datum_object_builder_t res_item;
+    bool conflict = res_item.add("left", left_row);
+    if (right_row.has()) {
+        conflict |= res_item.add("right", right_row);
+    }
+    guarantee(!conflict);
+    return std::move(res_item).to_datum();
+}
+
+void hash_join_datum_stream_t::hash_join_row(env_t *env,
+                                             const datum_t &left_row,
+                                             std::vector<datum_t> *out) {
+    // The nested loop join never evaluates the predicate if the right-hand side is
+    // empty, so it doesn't fail on left rows that don't have the field.
+    const bool has_key_error = right_table->key_error != std::exception_ptr();
+    std::vector<datum_t> *matches = nullptr;
+    if (right_table->num_rows != 0 || has_key_error) {
+        if (has_key_error
+            && !left_key_first
+            && right_table->rows_before_key_error == 0) {
+            std::rethrow_exception(right_table->key_error);
+        }
+        datum_t key = left_key_func->call(env, left_row)->as_datum();
+        if (has_key_error) {
+            std::rethrow_exception(right_table->key_error);
+        }
+        auto it = right_table->buckets.find(key);
+        if (it != right_table->buckets.end()) {
+            matches = &it->second;
+        }
+    }
+    if (matches != nullptr) {
+        for (const datum_t &right_row : *matches) {
+            out->push_back(make_join_row(left_row, right_row));
+        }
+    } else if (join_type == join_type_t::OUTER) {
+        out->push_back(make_join_row(left_row, datum_t()));
+    }
+}
+
+void hash_join_datum_stream_t::hash_join_left_block(env_t *env,
+                                                    const std::vector<datum_t> &block,
+                                                    std::vector<datum_t> *out) {
+    // The rows of `block` by key, as indexes into `block`.  Like `hash_join_row`, we
+    // only raise the error of a left row's key once we know that the nested loop
+    // join would get to it.
+    hashed_groups_t<std::vector<size_t> > block_by_key;
+    std::exception_ptr left_key_error;
+    size_t left_rows_before_key_error = block.size();
+    for (size_t i = 0; i < block.size(); ++i) {
+        try {
+            block_by_key[left_key_func->call(env, block[i])->as_datum()].push_back(i);
+        } catch (const interrupted_exc_t &) {
+            throw;
+        } catch (...) {
+            left_key_error = std::current_exception();
+            left_rows_before_key_error = i;
+            break;
+        }
+    }
+
+    // The right rows that match each row of `block`, in their original order
+    std::vector<std::vector<datum_t> > matches(block.size());
+    size_t num_right_rows = 0;
+    std::exception_ptr right_key_error;
+    counted_t<datum_stream_t> right = right_func->call(env)->as_seq(env);
+    batchspec_t batchspec = batchspec_t::user(batch_type_t::TERMINAL, env);
+    while (right_key_error == std::exception_ptr() && !right->is_exhausted()) {
+        std::vector<datum_t> batch = right->next_batch(env, batchspec);
+        if (batch.empty()) {
+            break;
+        }
+        for (auto &&right_row : batch) {
+            datum_t key;
+            try {
+                key = right_key_func->call(env, right_row)->as_datum();
+            } catch (const interrupted_exc_t &) {
+                throw;
+            } catch (...) {
+                right_key_error = std::current_exception();
+                break;
+            }
+            auto it = block_by_key.find(key);
+            if (it != block_by_key.end()) {
+                for (size_t i : it->second) {
+                    matches[i].push_back(right_row);
+                }
+            }
+            ++num_right_rows;
+        }
+    }
+
+    // This raises the same errors as `hash_join_row` would for each row in turn.
+    const bool has_right_key_error = right_key_error != std::exception_ptr();
+    for (size_t i = 0; i < block.size(); ++i) {
+        if (num_right_rows != 0 || has_right_key_error) {
+            if (has_right_key_error && !left_key_first && num_right_rows == 0) {
+                std::rethrow_exception(right_key_error);
+            }
+            if (i == left_rows_before_key_error) {
+                std::rethrow_exception(left_key_error);
+            }
+            if (has_right_key_error) {
+                std::rethrow_exception(right_key_error);
+            }
+        }
+        if (!matches[i].empty()) {
+            for (const datum_t &right_row : matches[i]) {
+                out->push_back(make_join_row(block[i], right_row));
+            }
+        } else if (join_type == join_type_t::OUTER) {
+            out->push_back(make_join_row(block[i], datum_t()));
+        }
+    }
+}
+
+std::vector<datum_t> hash_join_datum_stream_t::next_raw_batch(
+    env_t *env,
+    const batchspec_t &batchspec) {
+    batcher_t batcher = batchspec.to_batcher();
+
+    std::vector<datum_t> res;
+    while (!left->is_exhausted() && !batcher.should_send_batch()) {
+        std::vector<datum_t> left_batch = left->next_batch(env, batchspec);
+        if (left_batch.empty()) {
+            // We got an empty batch from the input stream. It's either exhausted
+            // or a changefeed. In either case we abort and emit our current results.
+            break;
+        }
+        if (!right_table.has() && !build_left) {
+            right_table = make_scoped<hash_join_table_t>();
+            counted_t<datum_stream_t> right = right_func->call(env)->as_seq(env);
+            if (!right_table->add_all(env,
+                                      right,
+                                      right_key_func,
+                                      HASH_JOIN_MAX_TABLE_SIZE)) {
+                right_table.reset();
+                build_left = true;
+            }
+        }
+        size_t old_size = res.size();
+        if (build_left) {
+            // The left batch is usually much smaller than the table may be, but we
+            // split it up if it isn't.
+            std::vector<datum_t> block;
+            size_t block_size = 0;
+            for (auto &&left_row : left_batch) {
+                block_size += serialized_size<cluster_version_t::CLUSTER>(left_row);
+                block.push_back(std::move(left_row));
+                if (block_size >= HASH_JOIN_MAX_TABLE_SIZE) {
+                    hash_join_left_block(env, block, &res);
+                    block.clear();
+                    block_size = 0;
+                }
+            }
+            if (!block.empty()) {
+                hash_join_left_block(env, block, &res);
+            }
+        } else {
+            for (const datum_t &left_row : left_batch) {
+                hash_join_row(env, left_row, &res);
+            }
+        }
+        for (size_t i = old_size; i < res.size(); ++i) {
+            batcher.note_el(res[i]);
+        }
+    }
+    return res;
+}
+
+bool hash_join_datum_stream_t::is_exhausted() const {
+    return left->is_exhausted() && batch_cache_exhausted();
+}
+
 fold_datum_stream_t::fold_datum_stream_t(
     counted_t<datum_stream_t> &&_stream,
     datum_t _base,
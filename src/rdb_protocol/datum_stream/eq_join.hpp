@@ -1,13 +1,29 @@
 #ifndef RDB_PROTOCOL_DATUM_STREAM_EQ_JOIN_HPP_
 #define RDB_PROTOCOL_DATUM_STREAM_EQ_JOIN_HPP_
 
+#include <deque>
+#include <exception>
+#include <map>
+#include <vector>
+
+#include "concurrency/auto_drainer.hpp"
+#include "concurrency/cond_var.hpp"
 #include "rdb_protocol/datum_stream.hpp"
 
 namespace ql {
 
-class eq_join_datum_stream_t : public eager_datum_stream_t {
+// Reads batches from `stream` and looks up the matching rows of `table` for each of
+// them.  Up to `EQ_JOIN_MAX_IN_FLIGHT_LOOKUPS` lookups run in their own coroutines
+// at a time, so that reading from `stream` overlaps with the reads on the shards.
+// Each lookup reads the right-hand rows in batches that respect the batchspec, and
+// only reads the next one once we have taken the last one, so a key with many
+// matches doesn't pile up in memory.  If `ordered` is true every lookup is for a
+// single left-hand row and we emit them in the order of `stream`; otherwise lookups
+// are for whole batches and we emit whichever right-hand batch is ready first.
+class eq_join_datum_stream_t : public eager_datum_stream_t, public home_thread_mixin_t {
 public:
-    eq_join_datum_stream_t(counted_t<datum_stream_t> _stream,
+    eq_join_datum_stream_t(env_t *env,
+                           counted_t<datum_stream_t> _stream,
                            counted_t<table_t> _table,
                            datum_string_t _join_index,
                            counted_t<const func_t> _predicate,
@@ -30,16 +46,40 @@ public:
     }
 
 private:
+    // The lookup of the right-hand rows for one batch of left-hand rows.
+    struct lookup_t {
+        explicit lookup_t(const batchspec_t &_batchspec)
+            : batchspec(_batchspec), has_right_items(false), finished(false),
+              right_items_taken(nullptr) { }
+        batchspec_t batchspec;
+        // Only the left-hand rows that have a join key, in order.
+        std::vector<datum_t> left_rows;
+        // Maps join keys to indexes into `left_rows`.
+        std::multimap<datum_t, size_t> key_to_left;
+        std::map<datum_t, uint64_t> keys;
+        // Set by the coroutine, which then waits for `right_items_taken` before it
+        // reads the next batch.
+        std::vector<rget_item_t> right_items;
+        bool has_right_items;
+        // Set by the coroutine once it has nothing more to read, or failed with `exc`.
+        bool finished;
+        std::exception_ptr exc;
+        cond_t *right_items_taken;
+    };
+
+    void launch_lookup(env_t *env,
+                       std::vector<datum_t> &&stream_batch,
+                       const batchspec_t &batchspec);
+    void run_lookup(lookup_t *lookup, auto_drainer_t::lock_t keepalive);
+    void notify_lookup_ready();
+    // Waits until a lookup that we can emit from has right-hand rows or is finished.
+    std::deque<scoped_ptr_t<lookup_t> >::iterator wait_for_lookup(env_t *env);
+
     counted_t<datum_stream_t> stream;
-    scoped_ptr_t<reader_t> get_all_reader;
-    std::vector<rget_item_t> get_all_items;
 
     counted_t<table_t> table;
     datum_string_t join_index;
 
-    std::multimap<ql::datum_t,
-                  ql::datum_t> sindex_to_datum;
-
     counted_t<const func_t> predicate;
 
     bool ordered;
@@ -47,9 +87,19 @@ private:
     bool is_array_eq_join;
     bool is_infinite_eq_join;
     feed_type_t eq_join_type;
-};
 
+    // The lookups run in `coro_env`, which is set during construction.
+    scoped_ptr_t<profile::trace_t> trace;
+    scoped_ptr_t<profile::disabler_t> disabler;
+    scoped_ptr_t<env_t> coro_env;
+
+    // In the order of `stream`.
+    std::deque<scoped_ptr_t<lookup_t> > lookups;
+    // Pulsed when a lookup has right-hand rows or finishes while we're waiting.
+    scoped_ptr_t<cond_t> lookup_ready;
 
+    auto_drainer_t drainer;
+};
 
 }  // namespace ql
 
@@ -0,0 +1,109 @@
+// Copyright 2010-2016 RethinkDB, all rights reserved.
+#ifndef RDB_PROTOCOL_DATUM_STREAM_HASH_JOIN_HPP_
+#define RDB_PROTOCOL_DATUM_STREAM_HASH_JOIN_HPP_
+
+#include <exception>
+#include <vector>
+
+#include "rdb_protocol/datum_stream.hpp"
+#include "rdb_protocol/shards.hpp"
+
+namespace ql {
+
+// The right-hand side of a hash join, bucketed by join key.
+class hash_join_table_t {
+public:
+    hash_join_table_t() : num_rows(0), size(0), rows_before_key_error(0) { }
+
+    // Reads all of `stream` into the table.  Returns false if the rows take up more
+    // than `max_size` bytes, in which case the table is incomplete.
+    bool add_all(env_t *env,
+                 const counted_t<datum_stream_t> &stream,
+                 const counted_t<const func_t> &key_func,
+                 size_t max_size);
+
+private:
+    friend class hash_join_datum_stream_t;
+
+    hashed_groups_t<std::vector<datum_t> > buckets;
+    size_t num_rows;
+    size_t size;
+
+    // A nested loop join only computes keys once it has a row from the left-hand
+    // side, and stops at the first error.  So if computing a key fails we remember
+    // the error, and the join stream rethrows it where the nested loop would have.
+    std::exception_ptr key_error;
+    size_t rows_before_key_error;
+
+    DISABLE_COPYING(hash_join_table_t);
+};
+
+// Implements `inner_join` and `outer_join` when the predicate compares a field of
+// the left row with a field of the right row for equality.  Rather than evaluating
+// the predicate for every pair of rows, we build a hash table of one side by key and
+// stream the other side through it.  The output is in the same order as the nested
+// loop join's, and we raise the same errors.
+//
+// We build the table from the smaller side.  If the right-hand side fits into
+// `HASH_JOIN_MAX_TABLE_SIZE` bytes, we read it once into the table and look up each
+// left row's key in it.  Otherwise we build the table from blocks of left rows that
+// fit, and read the right-hand side once per block.  That's still a lot cheaper than
+// the nested loop join, which reads it once per left row.  We never spill the table
+// to disk, because there's nowhere to put the temporary data of a query.
+class hash_join_datum_stream_t : public eager_datum_stream_t {
+public:
+    enum class join_type_t { INNER, OUTER };
+    // `right_func` takes no arguments and returns the right-hand sequence.
+    // `left_key_first` says whether the predicate evaluates the left row's key
+    // before the right row's, so that we raise the same error first.
+    hash_join_datum_stream_t(counted_t<datum_stream_t> _left,
+                             counted_t<const func_t> _right_func,
+                             counted_t<const func_t> _left_key_func,
+                             counted_t<const func_t> _right_key_func,
+                             join_type_t _join_type,
+                             bool _left_key_first,
+                             backtrace_id_t bt);
+
+    bool is_array() const final {
+        return is_array_hash_join;
+    }
+    bool is_infinite() const final {
+        return is_infinite_hash_join;
+    }
+    bool is_exhausted() const final;
+
+    std::vector<datum_t>
+    next_raw_batch(env_t *env, const batchspec_t &batchspec);
+
+    feed_type_t cfeed_type() const final {
+        return hash_join_type;
+    }
+
+private:
+    // Appends the joined rows for `left_row` to `out`, using `right_table`.
+    void hash_join_row(env_t *env, const datum_t &left_row, std::vector<datum_t> *out);
+    // Appends the joined rows for all of `block` to `out`, reading the right-hand
+    // side once.
+    void hash_join_left_block(
+        env_t *env, const std::vector<datum_t> &block, std::vector<datum_t> *out);
+
+    counted_t<datum_stream_t> left;
+    counted_t<const func_t> right_func;
+    counted_t<const func_t> left_key_func;
+    counted_t<const func_t> right_key_func;
+    join_type_t join_type;
+    bool left_key_first;
+
+    // Built when we see the first left row, unless the right-hand side doesn't fit,
+    // in which case we set `build_left` instead.
+    scoped_ptr_t<hash_join_table_t> right_table;
+    bool build_left;
+
+    bool is_array_hash_join;
+    bool is_infinite_hash_join;
+    feed_type_t hash_join_type;
+};
+
+}  // namespace ql
+
+#endif  // RDB_PROTOCOL_DATUM_STREAM_HASH_JOIN_HPP_
@@ -16,7 +16,7 @@ distribution_progress_estimator_t::distribution_progress_estimator_t(
         [](const region_t &, const binary_blob_t &) { });
 #endif
 
-    distribution_read_t distribution_read(max_depth, result_limit);
+    distribution_read_t distribution_read(max_depth, result_limit, false);
     read_t read(
         distribution_read, profile_bool_t::DONT_PROFILE, read_mode_t::OUTDATED);
     read_response_t read_response;
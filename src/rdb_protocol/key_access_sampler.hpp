@@ -0,0 +1,151 @@
+// Copyright 2010-2016 RethinkDB, all rights reserved.
+#ifndef RDB_PROTOCOL_KEY_ACCESS_SAMPLER_HPP_
+#define RDB_PROTOCOL_KEY_ACCESS_SAMPLER_HPP_
+
+#include <math.h>
+
+#include <algorithm>
+#include <map>
+#include <utility>
+#include <vector>
+
+#include "btree/keys.hpp"
+#include "random.hpp"
+#include "threading.hpp"
+#include "time.hpp"
+
+/* `key_access_sampler_t` estimates how the recent read and write load of a `store_t` is
+spread over its primary keys, so that the distribution queries that rebalancing is based
+on can take the load on each key range into account, not just the number of documents.
+
+Every access counts, but older accesses count for less: an access's weight halves every
+`HALF_LIFE_SECS`. The sampler keeps two things:
+
+ - The decayed number of accesses, which gives the current load in accesses per second.
+   A steady load of `r` accesses per second converges on `r`, and after the load stops
+   the estimate halves every `HALF_LIFE_SECS`.
+
+ - A weighted sample of at most `MAX_SAMPLES` keys, in which each access is included
+   with a probability proportional to its weight. This is priority sampling with forward
+   decay: each access gets the priority `E / w`, where `E` is a random exponential
+   variable and `w` is its weight, and we keep the accesses with the smallest
+   priorities. The share of the samples that falls into a key range estimates the share
+   of the load that goes to it.
+
+Weights are relative to `landmark`, and grow with time instead of shrinking, so that we
+don't have to touch the samples on every access. Once they've grown enough we move
+`landmark` forward and rescale the samples. The samples are only allocated as accesses
+come in, so idle tables don't pay for them. */
+
+class key_access_sampler_t : public home_thread_mixin_debug_only_t {
+public:
+    static const size_t MAX_SAMPLES = 512;
+    static const int HALF_LIFE_SECS = 60;
+
+    key_access_sampler_t() :
+        landmark(0), last_access(0), decayed_accesses(0) { }
+
+    void note_access(const store_key_t &key, ticks_t now) {
+        assert_thread();
+        if (samples.empty() && decayed_accesses == 0) {
+            landmark = last_access = now;
+        }
+        now = std::max(now, last_access);
+        decayed_accesses = decayed_accesses * decay(now - last_access) + 1;
+        last_access = now;
+
+        double age = ticks_to_secs(now - landmark) * decay_per_sec();
+        if (age > MAX_LANDMARK_AGE) {
+            /* Relative to the new landmark every weight is `exp(age)` times smaller, so
+            every priority is that much larger. Scaling all of them by the same factor
+            doesn't change their order. (Very old samples can end up as infinity, which
+            is fine because they are the first to go.) */
+            double scale = exp(age);
+            for (auto &sample : samples) {
+                sample.first *= scale;
+            }
+            landmark = now;
+            age = 0;
+        }
+
+        /* `randdouble()` returns a number in `[0, 1)`, so the logarithm is finite. */
+        double priority = -log(1 - randdouble()) / exp(age);
+        if (samples.size() < MAX_SAMPLES) {
+            samples.push_back(std::make_pair(priority, key));
+            std::push_heap(samples.begin(), samples.end(), compare_priorities);
+        } else if (priority < samples.front().first) {
+            std::pop_heap(samples.begin(), samples.end(), compare_priorities);
+            samples.back() = std::make_pair(priority, key);
+            std::push_heap(samples.begin(), samples.end(), compare_priorities);
+        }
+    }
+
+    /* `estimate_load()` takes the buckets of a `distribution_read_response_t`, where
+    each key starts a bucket that ends where the next one starts, and sets
+    `(*loads_out)[k]` to the estimated number of accesses per second to the bucket that
+    starts at `k`. Keys outside of `range` or before the first bucket are ignored.
+    Returns the estimated number of accesses per second to all buckets. */
+    double estimate_load(
+            const key_range_t &range,
+            const std::map<store_key_t, int64_t> &buckets,
+            ticks_t now,
+            std::map<store_key_t, double> *loads_out) const {
+        assert_thread();
+        for (const auto &pair : buckets) {
+            (*loads_out)[pair.first] = 0;
+        }
+        if (samples.empty()) {
+            return 0;
+        }
+        double load_per_sample = decay(std::max(now, last_access) - last_access)
+            * decayed_accesses * decay_per_sec() / samples.size();
+        double total = 0;
+        for (const auto &sample : samples) {
+            if (!range.contains_key(sample.second)) {
+                continue;
+            }
+            auto it = buckets.upper_bound(sample.second);
+            if (it == buckets.begin()) {
+                continue;
+            }
+            --it;
+            (*loads_out)[it->first] += load_per_sample;
+            total += load_per_sample;
+        }
+        return total;
+    }
+
+private:
+    /* How far we let `landmark` fall behind, in units of `1 / decay_per_sec()`. The
+    weights grow by a factor of `exp(MAX_LANDMARK_AGE)` before we rescale, which leaves
+    plenty of room in a `double`. */
+    static constexpr double MAX_LANDMARK_AGE = 64;
+
+    static double decay_per_sec() {
+        return log(2.0) / HALF_LIFE_SECS;
+    }
+
+    /* The factor by which an access's weight has decayed after `ticks` */
+    static double decay(ticks_t ticks) {
+        return exp(-ticks_to_secs(ticks) * decay_per_sec());
+    }
+
+    /* `samples` is a max-heap by priority, so the sample we'd replace first is at the
+    front. */
+    static bool compare_priorities(
+            const std::pair<double, store_key_t> &a,
+            const std::pair<double, store_key_t> &b) {
+        return a.first < b.first;
+    }
+
+    ticks_t landmark;
+    ticks_t last_access;
+    /* The number of accesses, each decayed to `last_access`. The decayed rate in
+    accesses per second is this times `decay_per_sec()`. */
+    double decayed_accesses;
+    std::vector<std::pair<double, store_key_t> > samples;
+
+    DISABLE_COPYING(key_access_sampler_t);
+};
+
+#endif  // RDB_PROTOCOL_KEY_ACCESS_SAMPLER_HPP_
@@ -40,6 +40,7 @@ static const std::set<std::string> acceptable_optargs({
     "_EVAL_FLAGS_",
     "_NO_RECURSE_",
     "_SHORTCUT_",
+    "aggregate_views",
     "array_limit",
     "attempts",
     "auth",
@@ -78,6 +79,7 @@ static const std::set<std::string> acceptable_optargs({
     "max_batch_seconds",
     "max_dist",
     "max_results",
+    "max_staleness",
     "method",
     "min_batch_rows",
     "multi",
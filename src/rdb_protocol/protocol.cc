@@ -13,6 +13,7 @@
 #include "containers/archive/boost_types.hpp"
 #include "containers/archive/optional.hpp"
 #include "containers/disk_backed_queue.hpp"
+#include "rdb_protocol/aggregate_view.hpp"
 #include "rdb_protocol/btree.hpp"
 #include "rdb_protocol/changefeed.hpp"
 #include "rdb_protocol/distribution_progress.hpp"
@@ -597,8 +598,14 @@ struct rdb_r_shard_visitor_t : public boost::static_visitor<bool> {
             auto *rg_out = boost::get<rget_read_t>(payload_out);
             guarantee(!region.inner.right.unbounded);
             rg_out->current_shard.set(region);
+            /* Each CPU shard covers an equal part of the hash space, so the width
+            of `region` tells us how many CPU shards the table has. */
+            uint64_t hash_width = region.end - region.beg;
+            int64_t num_cpu_shards = std::min<uint64_t>(MAX_CPU_SHARDING_FACTOR,
+                std::max<uint64_t>(1,
+                    (HASH_REGION_HASH_SIZE + hash_width / 2) / hash_width));
             rg_out->batchspec = rg_out->batchspec.scale_down(
-                rg.hints.has_value() ? rg.hints->size() : CPU_SHARDING_FACTOR);
+                rg.hints.has_value() ? rg.hints->size() : num_cpu_shards);
             if (rg_out->primary_keys.has_value()) {
                 for (auto it = rg_out->primary_keys->begin();
                      it != rg_out->primary_keys->end();) {
@@ -652,6 +659,8 @@ bool read_t::shard(const hash_region_t<key_range_t> &region,
     read_t::variant_t payload;
     bool result = boost::apply_visitor(rdb_r_shard_visitor_t(&region, &payload), read);
     *read_out = read_t(payload, profile, read_mode);
+    read_out->max_staleness_ms = max_staleness_ms;
+    read_out->use_aggregate_views = use_aggregate_views;
     return result;
 }
 
@@ -733,6 +742,10 @@ void rdb_r_unshard_visitor_t::operator()(const changefeed_subscribe_t &) {
         for (auto it = res->addrs.begin(); it != res->addrs.end(); ++it) {
             out->addrs.insert(std::move(*it));
         }
+        for (auto it = res->filter_stop_addrs.begin();
+             it != res->filter_stop_addrs.end(); ++it) {
+            out->filter_stop_addrs.insert(std::move(*it));
+        }
         for (auto it = res->server_uuids.begin();
              it != res->server_uuids.end(); ++it) {
             out->server_uuids.insert(std::move(*it));
@@ -1081,9 +1094,37 @@ struct use_snapshot_visitor_t : public boost::static_visitor<bool> {
 
 // Only use snapshotting if we're doing a range get.
 bool read_t::use_snapshot() const THROWS_NOTHING {
+    // Reads that use aggregate views need to get in line for the changefeed stamp
+    // lock before they snapshot, like `include_initial` changefeeds.
+    if (aggregate_view_key().has_value()) {
+        return false;
+    }
     return boost::apply_visitor(use_snapshot_visitor_t(), read);
 }
 
+optional<std::string> read_t::aggregate_view_key() const THROWS_NOTHING {
+    // Aggregate views are only maintained on the primary, where all of the writes
+    // happen.  A secondary might be catching up through a backfill.  Reads with a
+    // `max_staleness_ms` bound are `SINGLE` reads too, but they can run on a
+    // secondary, so they must neither use nor build a view.
+    if (!use_aggregate_views
+        || (read_mode != read_mode_t::SINGLE && read_mode != read_mode_t::MAJORITY)
+        || max_staleness_ms.has_value()) {
+        return r_nullopt;
+    }
+    const rget_read_t *rget = boost::get<rget_read_t>(&read);
+    if (rget == nullptr
+        || rget->stamp.has_value()
+        || rget->sindex.has_value()
+        || rget->primary_keys.has_value()
+        || rget->hints.has_value()
+        || !rget->current_shard.has_value()
+        || !(rget->region == *rget->current_shard)) {
+        return r_nullopt;
+    }
+    return ql::aggregate_view_t::key_for(rget->transforms, rget->terminal);
+}
+
 struct route_to_primary_visitor_t : public boost::static_visitor<bool> {
     // `include_initial` changefeed reads must be routed to the primary, since
     // that's where changefeeds are managed.
@@ -1472,12 +1513,12 @@ RDB_IMPL_SERIALIZABLE_3_FOR_CLUSTER(
     rget_read_response_t, stamp_response, result, reql_version);
 RDB_IMPL_SERIALIZABLE_1_FOR_CLUSTER(nearest_geo_read_response_t, results_or_error);
 RDB_IMPL_SERIALIZABLE_2_FOR_CLUSTER(distribution_read_response_t, region, key_counts);
-RDB_IMPL_SERIALIZABLE_2_FOR_CLUSTER(
-    changefeed_subscribe_response_t, server_uuids, addrs);
+RDB_IMPL_SERIALIZABLE_3_FOR_CLUSTER(
+    changefeed_subscribe_response_t, server_uuids, addrs, filter_stop_addrs);
 RDB_IMPL_SERIALIZABLE_2_FOR_CLUSTER(
     changefeed_limit_subscribe_response_t, shards, limit_addrs);
-RDB_IMPL_SERIALIZABLE_3_FOR_CLUSTER(
-    shard_stamp_info_t, stamp, shard_region, last_read_start);
+RDB_IMPL_SERIALIZABLE_4_FOR_CLUSTER(
+    shard_stamp_info_t, stamp, shard_region, last_read_start, start_position);
 RDB_IMPL_SERIALIZABLE_1_FOR_CLUSTER(changefeed_stamp_response_t, stamp_infos);
 
 RDB_IMPL_SERIALIZABLE_2_FOR_CLUSTER(
@@ -1538,8 +1579,8 @@ RDB_IMPL_SERIALIZABLE_8_FOR_CLUSTER(
     table_name,
     sindex_id);
 
-RDB_IMPL_SERIALIZABLE_3_FOR_CLUSTER(
-        distribution_read_t, max_depth, result_limit, region);
+RDB_IMPL_SERIALIZABLE_4_FOR_CLUSTER(
+        distribution_read_t, max_depth, result_limit, weight_by_load, region);
 
 RDB_IMPL_SERIALIZABLE_2_FOR_CLUSTER(changefeed_subscribe_t, addr, shard_region);
 RDB_IMPL_SERIALIZABLE_7_FOR_CLUSTER(
@@ -1551,10 +1592,13 @@ RDB_IMPL_SERIALIZABLE_7_FOR_CLUSTER(
     serializable_env,
     region,
     current_shard);
-RDB_IMPL_SERIALIZABLE_2_FOR_CLUSTER(changefeed_stamp_t, addr, region);
-RDB_IMPL_SERIALIZABLE_2_FOR_CLUSTER(changefeed_point_stamp_t, addr, key);
+RDB_IMPL_SERIALIZABLE_5_FOR_CLUSTER(
+    changefeed_filter_spec_t, id, range, serializable_env, include_positions, since);
+RDB_IMPL_SERIALIZABLE_3_FOR_CLUSTER(changefeed_stamp_t, addr, region, filter);
+RDB_IMPL_SERIALIZABLE_3_FOR_CLUSTER(changefeed_point_stamp_t, addr, key, filter_id);
 
-RDB_IMPL_SERIALIZABLE_3_FOR_CLUSTER(read_t, read, profile, read_mode);
+RDB_IMPL_SERIALIZABLE_5_FOR_CLUSTER(
+    read_t, read, profile, read_mode, max_staleness_ms, use_aggregate_views);
 
 RDB_IMPL_SERIALIZABLE_1_FOR_CLUSTER(point_write_response_t, result);
 RDB_IMPL_SERIALIZABLE_1_FOR_CLUSTER(point_delete_response_t, result);
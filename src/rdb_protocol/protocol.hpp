@@ -109,6 +109,9 @@ struct shard_stamp_info_t {
     region_t shard_region;
     // The starting points of the reads (assuming left to right traversal)
     store_key_t last_read_start;
+    // For subscriptions with `include_positions`, the position the subscription
+    // starts from.  See `ql::changefeed::server_t::get_stamp_with_positions`.
+    optional<uint64_t> start_position;
 };
 RDB_DECLARE_SERIALIZABLE_FOR_CLUSTER(shard_stamp_info_t);
 
@@ -169,6 +172,7 @@ struct changefeed_subscribe_response_t {
     changefeed_subscribe_response_t() { }
     std::set<uuid_u> server_uuids;
     std::set<ql::changefeed::server_t::addr_t> addrs;
+    std::set<ql::changefeed::server_t::filter_stop_addr_t> filter_stop_addrs;
 };
 RDB_DECLARE_SERIALIZABLE_FOR_CLUSTER(changefeed_subscribe_response_t);
 
@@ -284,12 +288,34 @@ struct sindex_rangespec_t {
 
 RDB_DECLARE_SERIALIZABLE_FOR_CLUSTER(sindex_rangespec_t);
 
+// Describes the changes a range subscription is interested in, so that the
+// changefeed `server_t` can avoid sending changes the subscription would discard.
+// See `ql::changefeed::change_filter_t`.
+struct changefeed_filter_spec_t {
+    uuid_u id;
+    ql::changefeed::keyspec_t::range_t range;
+    serializable_env_t serializable_env;
+    // Whether the subscription wants the positions of its changes, and the
+    // positions (by changefeed `server_t` uuid) to resume from, if any.
+    bool include_positions;
+    optional<std::map<uuid_u, uint64_t> > since;
+};
+RDB_DECLARE_SERIALIZABLE_FOR_CLUSTER(changefeed_filter_spec_t);
+
 struct changefeed_stamp_t {
     changefeed_stamp_t() : region(region_t::universe()) { }
     explicit changefeed_stamp_t(ql::changefeed::client_t::addr_t _addr)
         : addr(std::move(_addr)), region(region_t::universe()) { }
+    changefeed_stamp_t(ql::changefeed::client_t::addr_t _addr,
+                       changefeed_filter_spec_t _filter)
+        : addr(std::move(_addr)),
+          region(region_t::universe()),
+          filter(std::move(_filter)) { }
     ql::changefeed::client_t::addr_t addr;
     region_t region;
+    // If this is set, the filter is registered with the `server_t` together with
+    // taking the stamp, so that it applies to exactly the changes after the stamp.
+    optional<changefeed_filter_spec_t> filter;
 };
 RDB_DECLARE_SERIALIZABLE_FOR_CLUSTER(changefeed_stamp_t);
 
@@ -427,15 +453,20 @@ RDB_DECLARE_SERIALIZABLE_FOR_CLUSTER(nearest_geo_read_t);
 class distribution_read_t {
 public:
     distribution_read_t()
-        : max_depth(0), result_limit(0), region(region_t::universe())
+        : max_depth(0), result_limit(0), weight_by_load(false),
+          region(region_t::universe())
     { }
-    distribution_read_t(int _max_depth, size_t _result_limit)
+    distribution_read_t(int _max_depth, size_t _result_limit, bool _weight_by_load)
         : max_depth(_max_depth), result_limit(_result_limit),
-          region(region_t::universe())
+          weight_by_load(_weight_by_load), region(region_t::universe())
     { }
 
     int max_depth;
     size_t result_limit;
+    /* If `weight_by_load` is `true`, the counts in the response are a blend of the
+    number of documents and the recent read and write load on each range (see
+    `key_access_sampler_t`), instead of just the number of documents. */
+    bool weight_by_load;
     region_t region;
 };
 RDB_DECLARE_SERIALIZABLE_FOR_CLUSTER(distribution_read_t);
@@ -478,6 +509,9 @@ RDB_DECLARE_SERIALIZABLE(changefeed_limit_subscribe_t);
 struct changefeed_point_stamp_t {
     ql::changefeed::client_t::addr_t addr;
     store_key_t key;
+    // The id the point subscription's filter is registered under, like
+    // `changefeed_filter_spec_t::id`.
+    uuid_u filter_id;
 };
 RDB_DECLARE_SERIALIZABLE_FOR_CLUSTER(changefeed_point_stamp_t);
 
@@ -497,6 +531,15 @@ struct read_t {
     profile_bool_t profile;
     read_mode_t read_mode;
 
+    // If set, a `read_mode_t::SINGLE` read may be answered by any replica that is
+    // known to be no more than this many milliseconds behind the primary. Otherwise
+    // it goes to the primary like any other `SINGLE` read.
+    optional<uint64_t> max_staleness_ms;
+
+    // Set by `r.table(..., aggregate_views=true)`.  Only such reads may be answered
+    // from, or build, a shard's aggregate view.
+    bool use_aggregate_views;
+
     region_t get_region() const THROWS_NOTHING;
     // Returns true if the read has any operation for this region.  Returns
     // false if read_out has not been touched.
@@ -508,15 +551,26 @@ struct read_t {
                  signal_t *interruptor) const
         THROWS_ONLY(interrupted_exc_t);
 
-    read_t() : profile(profile_bool_t::DONT_PROFILE), read_mode(read_mode_t::SINGLE) { }
+    read_t()
+        : profile(profile_bool_t::DONT_PROFILE),
+          read_mode(read_mode_t::SINGLE),
+          use_aggregate_views(false) { }
     template<class T>
     read_t(T &&_read, profile_bool_t _profile, read_mode_t _read_mode)
-        : read(std::forward<T>(_read)), profile(_profile), read_mode(_read_mode) { }
+        : read(std::forward<T>(_read)),
+          profile(_profile),
+          read_mode(_read_mode),
+          use_aggregate_views(false) { }
 
     // We use snapshotting for queries that acquire-and-hold large portions of the
     // table, so that they don't block writes.
     bool use_snapshot() const THROWS_NOTHING;
 
+    // Returns the key of the `ql::aggregate_view_t` that can answer this read, if
+    // it asks for aggregate views and it's an aggregation over a whole shard that we
+    // can maintain a view for.
+    optional<std::string> aggregate_view_key() const THROWS_NOTHING;
+
     // At the moment changefeed reads must be routed to the primary replica.
     bool route_to_primary() const THROWS_NOTHING;
 };
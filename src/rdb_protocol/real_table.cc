@@ -342,6 +342,14 @@ bool real_table_t::write_sync_depending_on_durability(ql::env_t *env,
     return true; // With our current implementation, a sync can never fail.
 }
 
+void real_table_t::set_max_staleness(uint64_t _max_staleness_ms) {
+    max_staleness_ms.set(_max_staleness_ms);
+}
+
+void real_table_t::set_use_aggregate_views() {
+    use_aggregate_views = true;
+}
+
 void real_table_t::read_with_profile(ql::env_t *env, const read_t &read,
         read_response_t *response) {
     PROFILE_STARTER_IF_ENABLED(
@@ -355,11 +363,25 @@ void real_table_t::read_with_profile(ql::env_t *env, const read_t &read,
     /* propagate whether or not we're doing profiles */
     r_sanity_check(read.profile == env->profile());
 
+    /* Only `SINGLE` reads can be relaxed to a bounded staleness. */
+    const bool bounded =
+        static_cast<bool>(max_staleness_ms) && read.read_mode == read_mode_t::SINGLE;
+    read_t table_read;
+    const read_t *read_to_send = &read;
+    if (bounded || use_aggregate_views) {
+        table_read = read;
+        if (bounded) {
+            table_read.max_staleness_ms = max_staleness_ms;
+        }
+        table_read.use_aggregate_views = use_aggregate_views;
+        read_to_send = &table_read;
+    }
+
     /* Do the actual read. */
     try {
         namespace_access.get()->read(
             env->get_user_context(),
-            read,
+            *read_to_send,
             response,
             order_token_t::ignore,
             env->interruptor);
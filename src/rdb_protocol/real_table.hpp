@@ -40,7 +40,8 @@ public:
         namespace_access(_namespace_access),
         pkey(_pkey),
         changefeed_client(_changefeed_client),
-        m_table_meta_client(table_meta_client) { }
+        m_table_meta_client(table_meta_client),
+        use_aggregate_views(false) { }
 
     namespace_id_t get_id() const;
     const std::string &get_pkey() const;
@@ -118,6 +119,9 @@ public:
     void read_with_profile(ql::env_t *env, const read_t &, read_response_t *response);
     void write_with_profile(ql::env_t *env, write_t *, write_response_t *response);
 
+    void set_max_staleness(uint64_t max_staleness_ms) final;
+    void set_use_aggregate_views() final;
+
 private:
     optional<counted_t<const ql::func_t> > get_write_hook(
         ql::env_t *env,
@@ -128,6 +132,12 @@ private:
     std::string pkey;
     ql::changefeed::client_t *changefeed_client;
     table_meta_client_t *m_table_meta_client;
+
+    /* Set by the `max_staleness` optarg of `r.table()`, which creates a new
+    `real_table_t` each time it's evaluated. */
+    optional<uint64_t> max_staleness_ms;
+    /* Set by the `aggregate_views` optarg of `r.table()`. */
+    bool use_aggregate_views;
 };
 
 #endif // RDB_PROTOCOL_REAL_TABLE_HPP_
@@ -78,7 +78,8 @@ protected:
 
     virtual void finish_impl(continue_bool_t, result_t *out) {
         *out = grouped_t<T>();
-        boost::get<grouped_t<T> >(*out).swap(acc);
+        hashed_groups_to_map(
+            &acc, boost::get<grouped_t<T> >(*out).get_underlying_map());
         guarantee(acc.size() == 0);
     }
 private:
@@ -110,7 +111,7 @@ private:
 
     virtual void unshard(env_t *env, const std::vector<result_t *> &results) {
         guarantee(acc.size() == 0);
-        std::map<datum_t, std::vector<T *>, optional_datum_less_t> vecs;
+        hashed_groups_t<std::vector<T *> > vecs;
         r_sanity_check(results.size() != 0);
         for (auto res = results.begin(); res != results.end(); ++res) {
             guarantee(*res);
@@ -129,10 +130,10 @@ private:
 
 protected:
     const T *get_default_val() { return &default_val; }
-    grouped_t<T> *get_acc() { return &acc; }
+    hashed_groups_t<T> *get_acc() { return &acc; }
 private:
     const T default_val;
-    grouped_t<T> acc;
+    hashed_groups_t<T> acc;
 };
 
 class append_t : public grouped_acc_t<stream_t> {
@@ -513,7 +514,7 @@ protected:
     explicit terminal_t(T &&t) : grouped_acc_t<T>(std::move(t)) { }
 private:
     virtual void operator()(env_t *env, groups_t *groups) {
-        grouped_t<T> *_acc = grouped_acc_t<T>::get_acc();
+        hashed_groups_t<T> *_acc = grouped_acc_t<T>::get_acc();
         const T *_default_val = grouped_acc_t<T>::get_default_val();
         for (auto it = groups->begin(); it != groups->end(); ++it) {
             auto pair = _acc->insert(std::make_pair(it->first, *_default_val));
@@ -533,7 +534,7 @@ private:
                                              bool is_grouped,
                                              UNUSED const configured_limits_t &limits) {
         accumulator_t::mark_finished();
-        grouped_t<T> *_acc = grouped_acc_t<T>::get_acc();
+        hashed_groups_t<T> *_acc = grouped_acc_t<T>::get_acc();
         const T *_default_val = grouped_acc_t<T>::get_default_val();
         scoped_ptr_t<val_t> retval;
         if (is_grouped) {
@@ -558,7 +559,7 @@ private:
     virtual datum_t unpack(T *t) = 0;
 
     virtual void add_res(env_t *env, result_t *res, sorting_t) {
-        grouped_t<T> *_acc = grouped_acc_t<T>::get_acc();
+        hashed_groups_t<T> *_acc = grouped_acc_t<T>::get_acc();
         const T *_default_val = grouped_acc_t<T>::get_default_val();
         if (auto e = boost::get<exc_t>(res)) {
             throw *e;
@@ -566,7 +567,10 @@ private:
         grouped_t<T> *gres = boost::get<grouped_t<T> >(res);
         r_sanity_check(gres);
         if (_acc->size() == 0) {
-            _acc->swap(*gres);
+            for (auto kv = gres->begin(); kv != gres->end(); ++kv) {
+                _acc->insert(std::make_pair(kv->first, std::move(kv->second)));
+            }
+            gres->clear();
         } else {
             // Order in fact does NOT matter here.  The reason is, each `kv->first`
             // value is different, which means each operation works on a different
@@ -884,6 +888,7 @@ private:
         if (groups->size() == 0) return;
         r_sanity_check(groups->size() == 1 && !groups->begin()->first.has());
         datums_t *ds = &groups->begin()->second;
+        hashed_groups_t<datums_t> new_groups;
         for (auto el = ds->begin(); el != ds->end(); ++el) {
             std::vector<datum_t> arr;
             arr.reserve(funcs.size() + append_index);
@@ -910,7 +915,7 @@ private:
             r_sanity_check(arr.size() == (funcs.size() + append_index));
 
             if (!multi) {
-                add(groups, std::move(arr), *el, env->limits());
+                add(&new_groups, std::move(arr), *el, env->limits());
             } else {
                 std::vector<std::vector<datum_t> > perms(arr.size());
                 for (size_t i = 0; i < arr.size(); ++i) {
@@ -925,21 +930,25 @@ private:
                 }
                 std::vector<datum_t> instance;
                 instance.reserve(perms.size());
-                add_perms(groups, &instance, &perms, 0, *el, env->limits());
+                add_perms(&new_groups, &instance, &perms, 0, *el, env->limits());
                 r_sanity_check(instance.size() == 0);
             }
 
+            // `groups` still holds the ungrouped entry, which has always been
+            // counted towards the limit.
             rcheck_src(bt,
-                       groups->size() <= env->limits().array_size_limit(),
+                       new_groups.size() + groups->size()
+                           <= env->limits().array_size_limit(),
                        base_exc_t::RESOURCE,
                        strprintf("Too many groups (> %zu).",
                                  env->limits().array_size_limit()));
         }
         size_t erased = groups->erase(datum_t());
         r_sanity_check(erased == 1);
+        hashed_groups_to_map(&new_groups, groups);
     }
 
-    void add(groups_t *groups,
+    void add(hashed_groups_t<datums_t> *groups,
              std::vector<datum_t> &&arr,
              const datum_t &el,
              const configured_limits_t &limits) {
@@ -950,7 +959,7 @@ private:
         (*groups)[group].push_back(el);
     }
 
-    void add_perms(groups_t *groups,
+    void add_perms(hashed_groups_t<datums_t> *groups,
                    std::vector<datum_t> *instance,
                    std::vector<std::vector<datum_t> > *arr,
                    size_t index,
@@ -1130,6 +1139,47 @@ scoped_ptr_t<op_t> make_op(const transform_variant_t &tv) {
     return scoped_ptr_t<op_t>(boost::apply_visitor(transform_visitor_t(), tv));
 }
 
+bool is_deterministic_on_shard(const counted_t<const func_t> &f) {
+    return f->is_deterministic().test(single_server_t::yes, constant_now_t::no);
+}
+
+class row_local_transform_visitor_t : public boost::static_visitor<bool> {
+public:
+    bool operator()(const map_wire_func_t &f) const {
+        return is_deterministic_on_shard(f.compile_wire_func());
+    }
+    bool operator()(const group_wire_func_t &f) const {
+        if (f.should_append_index()) {
+            return false;
+        }
+        for (const auto &func : f.compile_funcs()) {
+            if (!is_deterministic_on_shard(func)) {
+                return false;
+            }
+        }
+        return true;
+    }
+    bool operator()(const filter_wire_func_t &f) const {
+        return is_deterministic_on_shard(f.filter_func.compile_wire_func())
+            && (!f.default_filter_val.has_value()
+                || is_deterministic_on_shard(
+                    f.default_filter_val->compile_wire_func()));
+    }
+    bool operator()(const concatmap_wire_func_t &f) const {
+        return is_deterministic_on_shard(f.compile_wire_func());
+    }
+    bool operator()(const distinct_wire_func_t &) const {
+        return false;
+    }
+    bool operator()(const zip_wire_func_t &) const {
+        return true;
+    }
+};
+
+bool is_row_local_and_deterministic(const transform_variant_t &tv) {
+    return boost::apply_visitor(row_local_transform_visitor_t(), tv);
+}
+
 RDB_IMPL_SERIALIZABLE_3_FOR_CLUSTER(rget_item_t, key, sindex_key, data);
 RDB_IMPL_SERIALIZABLE_2_FOR_CLUSTER(keyed_stream_t, stream, last_key);
 RDB_IMPL_SERIALIZABLE_1_FOR_CLUSTER(stream_t, substreams);
@@ -13,6 +13,7 @@
 #include "btree/types.hpp"
 #include "containers/archive/stl_types.hpp"
 #include "containers/archive/varint.hpp"
+#include "containers/open_hash_map.hpp"
 #include "containers/uuid.hpp"
 #include "rdb_protocol/batching.hpp"
 #include "rdb_protocol/configured_limits.hpp"
@@ -50,6 +51,35 @@ T groups_to_batch(std::map<datum_t, T, optional_datum_less_t> *g) {
 typedef std::vector<ql::datum_t> datums_t;
 typedef std::map<ql::datum_t, datums_t, optional_datum_less_t> groups_t;
 
+// Groups that are being accumulated don't need to be ordered until the accumulation
+// is finished, so we look them up by datum hash instead of paying for a tree walk
+// full of datum comparisons on every row.
+template <class T>
+using hashed_groups_t =
+    open_hash_map_t<datum_t, T, optional_datum_hash_t, optional_datum_equal_t>;
+
+// Moves the contents of `hashed` into the empty map `out`.  Sorting once and then
+// inserting in order costs a constant amount per group, rather than a tree insert.
+template <class T>
+void hashed_groups_to_map(hashed_groups_t<T> *hashed,
+                          std::map<datum_t, T, optional_datum_less_t> *out) {
+    guarantee(out->empty());
+    std::vector<std::pair<datum_t, T> > sorted;
+    sorted.reserve(hashed->size());
+    for (auto &&pair : *hashed) {
+        sorted.push_back(std::move(pair));
+    }
+    hashed->clear();
+    optional_datum_less_t less;
+    std::sort(sorted.begin(), sorted.end(),
+              [&less](const std::pair<datum_t, T> &a, const std::pair<datum_t, T> &b) {
+                  return less(a.first, b.first);
+              });
+    for (auto &&pair : sorted) {
+        out->insert(out->end(), std::move(pair));
+    }
+}
+
 struct rget_item_t {
     rget_item_t() = default;
     rget_item_t(store_key_t _key,
@@ -433,6 +463,16 @@ scoped_ptr_t<eager_acc_t> make_to_array();
 scoped_ptr_t<eager_acc_t> make_eager_terminal(const terminal_variant_t &t);
 scoped_ptr_t<op_t> make_op(const transform_variant_t &tv);
 
+// Returns true if `f` gives the same results no matter where on this server and in
+// which environment it's evaluated (`r.now()` is not allowed, since it comes from the
+// environment).
+bool is_deterministic_on_shard(const counted_t<const func_t> &f);
+
+// Returns true if `tv` looks at one row at a time and its functions are deterministic
+// on the shard, so it doesn't matter in which order, in which `env_t` or on which
+// thread the rows pass through it.
+bool is_row_local_and_deterministic(const transform_variant_t &tv);
+
 } // namespace ql
 
 #endif  // RDB_PROTOCOL_SHARDS_HPP_
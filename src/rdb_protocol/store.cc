@@ -10,6 +10,7 @@
 #include "concurrency/cross_thread_watchable.hpp"
 #include "concurrency/wait_any.hpp"
 #include "containers/archive/vector_stream.hpp"
+#include "rdb_protocol/aggregate_view.hpp"
 #include "rdb_protocol/btree.hpp"
 #include "rdb_protocol/datum.hpp"
 #include "rdb_protocol/env.hpp"
@@ -290,6 +291,11 @@ void do_read(ql::env_t *env,
     }
 }
 
+// Below this many accesses per second, a distribution read that is weighted by load
+// only counts the documents.  A trickle of accesses says little about where the load
+// is going to be.
+static const double min_load_for_weighting = 1.0;
+
 // TODO: get rid of this extra response_t copy on the stack
 struct rdb_read_visitor_t : public boost::static_visitor<void> {
     void operator()(const changefeed_subscribe_t &s) {
@@ -301,6 +307,7 @@ struct rdb_read_visitor_t : public boost::static_visitor<void> {
         guarantee(res != NULL);
         res->server_uuids.insert(cserver.first->get_uuid());
         res->addrs.insert(cserver.first->get_stop_addr());
+        res->filter_stop_addrs.insert(cserver.first->get_filter_stop_addr());
     }
 
     void operator()(const changefeed_limit_subscribe_t &s) {
@@ -395,6 +402,78 @@ struct rdb_read_visitor_t : public boost::static_visitor<void> {
         response->response = changefeed_limit_subscribe_response_t(1, std::move(vec));
     }
 
+    // Answers `rget` from the shard's aggregate view, or runs it and builds the view
+    // if there isn't one yet.  Returns false if we can't use aggregate views, in
+    // which case the superblock hasn't been snapshotted yet.
+    bool do_aggregate_view_read(const rget_read_t &rget,
+                                const std::string &view_key,
+                                rget_read_response_t *res) {
+        if (ctx == nullptr || ctx->manager == nullptr) {
+            return false;
+        }
+        // While a backfill is running we wouldn't store a view, so we don't even get
+        // in line for the stamp lock.  (We check again once we hold it.)
+        if (store->aggregate_views_blocked()) {
+            return false;
+        }
+        // Like in `do_stamp`, we get in line for the stamp lock while we're still
+        // holding the superblock, so the view reflects exactly the writes before
+        // this read.
+        guarantee(!superblock->get()->is_snapshotted());
+        superblock->get()->read_acq_signal()->wait_lazily_unordered();
+        auto cserver = store->changefeed_server(*rget.current_shard);
+        if (cserver.first == nullptr) {
+            cserver = store->get_or_make_changefeed_server(*rget.current_shard);
+        }
+        guarantee(cserver.first != nullptr);
+        uint64_t build_id;
+        {
+            rwlock_in_line_t stamp_spot =
+                store->get_in_line_for_cfeed_stamp(access_t::read);
+            // Backfills and `reset_data` change the data without updating the views,
+            // so we neither read nor build views while one of them is running.  They
+            // drop the views with a write lock on the stamp lock when they start.
+            stamp_spot.read_signal()->wait_lazily_unordered();
+            if (store->aggregate_views_blocked()) {
+                return false;
+            }
+            if (cserver.first->read_aggregate_view(
+                    view_key, &stamp_spot, &res->result, cserver.second)) {
+                return true;
+            }
+            // The view starts out at the snapshot that we're about to scan.  We don't
+            // hold the stamp lock during the scan, so the writes that come in the
+            // meantime go on, and they update the view as it's being built.
+            build_id = cserver.first->start_aggregate_view(
+                view_key,
+                make_scoped<ql::aggregate_view_t>(
+                    ctx, rget.serializable_env, rget.transforms, *rget.terminal),
+                &stamp_spot,
+                cserver.second);
+        }
+
+        superblock->get()->snapshot_subdag();
+        ql::env_t ql_env(
+            ctx,
+            ql::return_empty_normal_batches_t::NO,
+            interruptor,
+            rget.serializable_env,
+            trace);
+        do_read(&ql_env, store, btree, superblock, rget, res,
+                release_superblock_t::RELEASE, nullptr);
+        if (build_id != 0) {
+            rwlock_in_line_t stamp_spot =
+                store->get_in_line_for_cfeed_stamp(access_t::read);
+            cserver.first->finish_aggregate_view(
+                view_key,
+                build_id,
+                boost::get<ql::exc_t>(&res->result) == nullptr ? &res->result : nullptr,
+                &stamp_spot,
+                cserver.second);
+        }
+        return true;
+    }
+
     changefeed_stamp_response_t do_stamp(const changefeed_stamp_t &s,
                                          const region_t &current_shard,
                                          const store_key_t &read_start) {
@@ -404,14 +483,28 @@ struct rdb_read_visitor_t : public boost::static_visitor<void> {
 
         auto cserver = store->changefeed_server(s.region);
         if (cserver.first != nullptr) {
-            if (optional<uint64_t> stamp
-                    = cserver.first->get_stamp(s.addr, cserver.second)) {
+            scoped_ptr_t<ql::changefeed::change_filter_t> filter;
+            if (s.filter.has_value()) {
+                filter = make_scoped<ql::changefeed::change_filter_t>(ctx, *s.filter);
+            }
+            optional<uint64_t> stamp;
+            optional<uint64_t> start_position;
+            if (s.filter.has_value() && s.filter->include_positions) {
+                stamp = cserver.first->get_stamp_with_positions(
+                    s.addr, std::move(filter), s.filter->since, &start_position,
+                    cserver.second);
+            } else {
+                stamp = cserver.first->get_stamp(
+                    s.addr, std::move(filter), cserver.second);
+            }
+            if (stamp.has_value()) {
                 changefeed_stamp_response_t out;
                 out.stamp_infos.set(std::map<uuid_u, shard_stamp_info_t>());
                 (*out.stamp_infos)[cserver.first->get_uuid()] = shard_stamp_info_t{
                     *stamp,
                     current_shard,
-                    read_start};
+                    read_start,
+                    start_position};
                 return out;
             }
         }
@@ -433,8 +526,10 @@ struct rdb_read_visitor_t : public boost::static_visitor<void> {
         if (cserver.first != nullptr) {
             res->resp.set(changefeed_point_stamp_response_t::valid_response_t());
             auto *vres = &*res->resp;
-            if (optional<uint64_t> stamp
-                    = cserver.first->get_stamp(s.addr, cserver.second)) {
+            if (optional<uint64_t> stamp = cserver.first->get_stamp(
+                    s.addr,
+                    make_scoped<ql::changefeed::change_filter_t>(s.filter_id, s.key),
+                    cserver.second)) {
                 vres->stamp = std::make_pair(cserver.first->get_uuid(), *stamp);
             } else {
                 // The client was removed, so no future messages are coming.
@@ -453,6 +548,7 @@ struct rdb_read_visitor_t : public boost::static_visitor<void> {
         response->response = point_read_response_t();
         point_read_response_t *res =
             boost::get<point_read_response_t>(&response->response);
+        store->key_access_sampler.note_access(get.key, get_ticks());
         rdb_get(get.key, btree, superblock, res, trace);
     }
 
@@ -594,6 +690,14 @@ struct rdb_read_visitor_t : public boost::static_visitor<void> {
         response->response = rget_read_response_t();
         auto *res = boost::get<rget_read_response_t>(&response->response);
 
+        if (aggregate_view_key.has_value()) {
+            if (do_aggregate_view_read(rget, *aggregate_view_key, res)) {
+                return;
+            }
+            // `read_t::use_snapshot` left this to us.
+            superblock->get()->snapshot_subdag();
+        }
+
         if (rget.stamp) {
             res->stamp_response.set(changefeed_stamp_response_t());
             r_sanity_check(rget.current_shard);
@@ -666,6 +770,26 @@ struct rdb_read_visitor_t : public boost::static_visitor<void> {
             scale_down_distribution(dg.result_limit, &res->key_counts);
         }
 
+        if (dg.weight_by_load) {
+            /* Give the recent load the same total weight as the documents, so that
+            splitting by the blended counts balances both. If the range has hardly
+            seen any load lately, the counts are left as they are. */
+            std::map<store_key_t, double> loads;
+            double total_load = store->key_access_sampler.estimate_load(
+                dg.region.inner, res->key_counts, get_ticks(), &loads);
+            if (total_load >= min_load_for_weighting) {
+                int64_t total_keys = 0;
+                for (const auto &pair : res->key_counts) {
+                    total_keys += pair.second;
+                }
+                for (auto &pair : res->key_counts) {
+                    pair.second += static_cast<int64_t>(
+                        static_cast<double>(total_keys)
+                            * loads.at(pair.first) / total_load);
+                }
+            }
+        }
+
         res->region = dg.region;
     }
 
@@ -679,14 +803,16 @@ struct rdb_read_visitor_t : public boost::static_visitor<void> {
                        rdb_context_t *_ctx,
                        read_response_t *_response,
                        profile::trace_t *_trace,
-                       signal_t *_interruptor) :
+                       signal_t *_interruptor,
+                       optional<std::string> _aggregate_view_key) :
         response(_response),
         ctx(_ctx),
         interruptor(_interruptor),
         btree(_btree),
         store(_store),
         superblock(_superblock),
-        trace(_trace) { }
+        trace(_trace),
+        aggregate_view_key(std::move(_aggregate_view_key)) { }
 
 private:
 
@@ -697,6 +823,7 @@ private:
     store_t *const store;
     real_superblock_t *const superblock;
     profile::trace_t *const trace;
+    const optional<std::string> aggregate_view_key;
 
     DISABLE_COPYING(rdb_read_visitor_t);
 };
@@ -712,7 +839,8 @@ void store_t::protocol_read(const read_t &_read,
             _read.profile == profile_bool_t::PROFILE, "Perform read on shard.", trace);
         rdb_read_visitor_t v(btree.get(), this,
                              superblock,
-                             ctx, response, trace.get_or_null(), interruptor);
+                             ctx, response, trace.get_or_null(), interruptor,
+                             _read.aggregate_view_key());
         boost::apply_visitor(v, _read.read);
     }
 
@@ -819,6 +947,11 @@ struct rdb_write_visitor_t : public boost::static_visitor<void> {
             write_hook = br.write_hook->compile_wire_func();
         }
 
+        const ticks_t now = get_ticks();
+        for (const store_key_t &key : br.keys) {
+            store->key_access_sampler.note_access(key, now);
+        }
+
         func_replacer_t replacer(&ql_env,
                                  br.pkey,
                                  br.f,
@@ -851,8 +984,10 @@ struct rdb_write_visitor_t : public boost::static_visitor<void> {
                                   bi);
         std::vector<store_key_t> keys;
         keys.reserve(bi.inserts.size());
+        const ticks_t now = get_ticks();
         for (auto it = bi.inserts.begin(); it != bi.inserts.end(); ++it) {
             keys.emplace_back(it->get_field(datum_string_t(bi.pkey)).print_primary());
+            store->key_access_sampler.note_access(keys.back(), now);
         }
         response->response =
             rdb_batched_replace(
@@ -874,6 +1009,7 @@ struct rdb_write_visitor_t : public boost::static_visitor<void> {
 
         backfill_debug_key(w.key, strprintf("upsert %" PRIu64, timestamp.longtime));
 
+        store->key_access_sampler.note_access(w.key, get_ticks());
         rdb_live_deletion_context_t deletion_context;
         rdb_modification_report_t mod_report(w.key);
         rdb_set(w.key, w.data, w.overwrite, btree, timestamp, superblock->get(),
@@ -890,6 +1026,7 @@ struct rdb_write_visitor_t : public boost::static_visitor<void> {
 
         backfill_debug_key(d.key, strprintf("delete %" PRIu64, timestamp.longtime));
 
+        store->key_access_sampler.note_access(d.key, get_ticks());
         rdb_live_deletion_context_t deletion_context;
         rdb_modification_report_t mod_report(d.key);
         rdb_delete(d.key, btree, timestamp, superblock->get(), &deletion_context,
@@ -22,6 +22,7 @@
 #include "paths.hpp"
 #include "protocol_api.hpp"
 #include "rdb_protocol/changefeed.hpp"
+#include "rdb_protocol/key_access_sampler.hpp"
 #include "rdb_protocol/protocol.hpp"
 #include "rdb_protocol/store_metainfo.hpp"
 #include "rpc/mailbox/typed.hpp"
@@ -201,6 +202,12 @@ public:
     new_mutex_in_line_t get_in_line_for_sindex_queue(buf_lock_t *sindex_block);
     rwlock_in_line_t get_in_line_for_cfeed_stamp(access_t access);
 
+    // Backfills and `reset_data` don't update the changefeed servers' aggregate
+    // views, so views aren't used or built while one of them is running.
+    bool aggregate_views_blocked() const {
+        return aggregate_view_blockers > 0;
+    }
+
     void register_sindex_queue(
             disk_backed_queue_wrapper_t<rdb_modification_report_t> *disk_backed_queue,
             const key_range_t &construction_range,
@@ -398,7 +405,22 @@ public:
     // `btree.cc`.
     rwlock_t cfeed_stamp_lock;
 
+    // Samples the primary keys of point reads and writes, for load-based rebalancing.
+    key_access_sampler_t key_access_sampler;
+
 private:
+    // Drops all aggregate views when it's created, and blocks new ones until it's
+    // destroyed.
+    class aggregate_view_blocker_t {
+    public:
+        explicit aggregate_view_blocker_t(store_t *store);
+        ~aggregate_view_blocker_t();
+    private:
+        store_t *store;
+        DISABLE_COPYING(aggregate_view_blocker_t);
+    };
+    int aggregate_view_blockers;
+
     rdb_context_t *ctx;
     // We store regions here even though we only really need the key ranges
     // because it's nice to have a unique identifier across `store_t`s.  In the
@@ -1,6 +1,7 @@
 #include "rdb_protocol/store.hpp"
 
 #include "btree/backfill.hpp"
+#include "btree/depth_first_traversal.hpp"
 #include "btree/reql_specific.hpp"
 #include "rdb_protocol/btree.hpp"
 #include "rdb_protocol/serialize_datum.hpp"
@@ -83,6 +84,32 @@ private:
     auto_drainer_t drainer;
 };
 
+/* `range_has_no_pairs()` returns `true` if the B-tree has no key-value pairs in `range`.
+Deletion entries don't count. If the range isn't empty the traversal stops at the first
+pair, so this is cheap either way unless the range is full of deletion entries. */
+bool range_has_no_pairs(
+        cache_conn_t *cache_conn,
+        const key_range_t &range,
+        signal_t *interruptor) {
+    class callback_t : public depth_first_traversal_callback_t {
+    public:
+        continue_bool_t handle_pair(scoped_key_value_t &&, signal_t *) {
+            return continue_bool_t::ABORT;
+        }
+    } callback;
+    scoped_ptr_t<txn_t> txn;
+    scoped_ptr_t<real_superblock_t> superblock;
+    get_btree_superblock_and_txn_for_reading(
+        cache_conn, CACHE_SNAPSHOTTED_NO, &superblock, &txn);
+    continue_bool_t res = btree_depth_first_traversal(
+        superblock.get(), range, &callback, access_t::read, direction_t::FORWARD,
+        release_superblock_t::RELEASE, interruptor);
+    if (interruptor->is_pulsed()) {
+        throw interrupted_exc_t();
+    }
+    return res == continue_bool_t::CONTINUE;
+}
+
 /* `receive_backfill()` spawns a series of coroutines running `apply_empty_range()`,
 `apply_single_key_item()`, and `apply_multi_key_item()`. Each coroutine gets a
 `receive_backfill_tokens_t` that keeps track of order, takes care of updating the
@@ -92,8 +119,8 @@ entire backfill task, that the tokens need access to. */
 class receive_backfill_info_t {
 public:
     receive_backfill_info_t(
-            cache_conn_t *c, btree_slice_t *s, unsaved_data_limiter_t *l) :
-        cache_conn(c), slice(s), limiter(l),
+            cache_conn_t *c, btree_slice_t *s, unsaved_data_limiter_t *l, bool e) :
+        cache_conn(c), slice(s), limiter(l), range_was_empty(e),
         semaphore(MAX_CONCURRENT_BACKFILL_ITEMS) { }
 
     /* `cache_conn` and `slice` are just copied from the corresponding fields of the
@@ -104,6 +131,13 @@ public:
     /* `limiter` lives on the stack in `receive_backfill()` */
     unsaved_data_limiter_t *limiter;
 
+    /* `range_was_empty` is `true` if the B-tree had no key-value pairs in the range we
+    are backfilling when `receive_backfill()` started. This is the case when we are
+    seeding a new replica. Since the items are applied from left to right and nobody
+    else writes to the range while we're backfilling it, the part of the range that we
+    haven't reached yet stays empty, so `apply_multi_key_item()` can skip erasing it. */
+    const bool range_was_empty;
+
     /* `semaphore` limits how many coroutines can be running at once. */
     new_semaphore_t semaphore;
 
@@ -329,30 +363,42 @@ void apply_multi_key_item(
                 is_first = false;
             }
 
-            /* Establish an upper limit on how much of the range we're willing to delete
-            in this cycle. We choose the upper limit such that it contains no more than
-            `MAX_CHANGES_PER_TXN / 2` of the pairs in the backfill item. */
-            key_range_t range_to_delete;
-            range_to_delete.left = threshold.key();
-            if (next_pair + MAX_CHANGES_PER_TXN / 2 + 1 < item.pairs.size()) {
-                range_to_delete.right = key_range_t::right_bound_t(
-                    item.pairs[next_pair + MAX_CHANGES_PER_TXN / 2 + 1].key);
+            key_range_t range_deleted;
+            if (tokens.info->range_was_empty) {
+                /* There's nothing to delete, so we just take the next
+                `MAX_CHANGES_PER_TXN` pairs from the item. */
+                range_deleted.left = threshold.key();
+                if (next_pair + MAX_CHANGES_PER_TXN < item.pairs.size()) {
+                    range_deleted.right = key_range_t::right_bound_t(
+                        item.pairs[next_pair + MAX_CHANGES_PER_TXN].key);
+                } else {
+                    range_deleted.right = item.range.right;
+                }
             } else {
-                range_to_delete.right = item.range.right;
+                /* Establish an upper limit on how much of the range we're willing to
+                delete in this cycle. We choose the upper limit such that it contains no
+                more than `MAX_CHANGES_PER_TXN / 2` of the pairs in the backfill item. */
+                key_range_t range_to_delete;
+                range_to_delete.left = threshold.key();
+                if (next_pair + MAX_CHANGES_PER_TXN / 2 + 1 < item.pairs.size()) {
+                    range_to_delete.right = key_range_t::right_bound_t(
+                        item.pairs[next_pair + MAX_CHANGES_PER_TXN / 2 + 1].key);
+                } else {
+                    range_to_delete.right = item.range.right;
+                }
+
+                /* Delete a chunk of the range, making sure to do no more than
+                `MAX_CHANGES_PER_TXN / 2` changes at once. */
+                always_true_key_tester_t key_tester;
+                rdb_live_deletion_context_t deletion_context;
+                continue_bool_t res = rdb_erase_small_range(tokens.info->slice,
+                    &key_tester, range_to_delete, superblock.get(), &deletion_context,
+                    &non_interruptor, MAX_CHANGES_PER_TXN / 2,
+                    &mod_reports, &range_deleted);
+                guarantee(range_deleted.right == range_to_delete.right
+                    || res == continue_bool_t::CONTINUE);
             }
 
-            /* Delete a chunk of the range, making sure to do no more than
-            `MAX_CHANGES_PER_TXN / 2` changes at once. */
-            always_true_key_tester_t key_tester;
-            key_range_t range_deleted;
-            rdb_live_deletion_context_t deletion_context;
-            continue_bool_t res = rdb_erase_small_range(tokens.info->slice, &key_tester,
-                range_to_delete, superblock.get(), &deletion_context,
-                &non_interruptor, MAX_CHANGES_PER_TXN / 2,
-                &mod_reports, &range_deleted);
-            guarantee(range_deleted.right == range_to_delete.right
-                || res == continue_bool_t::CONTINUE);
-
             /* Apply any pairs from the item that fall within the deleted region */
             while (next_pair < item.pairs.size() &&
                     range_deleted.contains_key(item.pairs[next_pair].key)) {
@@ -389,10 +435,12 @@ continue_bool_t store_t::receive_backfill(
         signal_t *interruptor)
         THROWS_ONLY(interrupted_exc_t) {
     guarantee(_region.beg == get_region().beg && _region.end == get_region().end);
+    aggregate_view_blocker_t view_blocker(this);
 
     unsaved_data_limiter_t unsaved_data_limiter(general_cache_conn.get());
     receive_backfill_info_t info(
-        general_cache_conn.get(), btree.get(), &unsaved_data_limiter);
+        general_cache_conn.get(), btree.get(), &unsaved_data_limiter,
+        range_has_no_pairs(general_cache_conn.get(), _region.inner, interruptor));
 
     /* `spawn_threshold` is the point up to which we've spawned coroutines.
     `metainfo_threshold` is the point up to which we've applied the metainfo to the
@@ -165,7 +165,7 @@ public:
         : meta_op_term_t(env, term, argspec_t(1, 2),
             optargspec_t({"primary_key", "shards", "replicas",
                           "nonvoting_replica_tags", "primary_replica_tag",
-                          "durability"})) { }
+                          "durability", "cpu_shards"})) { }
 private:
     virtual scoped_ptr_t<val_t> eval_impl(
             scope_env_t *env, args_t *args, eval_flags_t) const {
@@ -197,6 +197,16 @@ private:
                 DURABILITY_REQUIREMENT_SOFT ?
                     write_durability_t::SOFT : write_durability_t::HARD;
 
+        // Parse the 'cpu_shards' optarg
+        int num_cpu_shards = CPU_SHARDING_FACTOR;
+        if (scoped_ptr_t<val_t> v = args->optarg(env, "cpu_shards")) {
+            int64_t n = v->as_int();
+            rcheck_target(v, n >= 1 && n <= MAX_CPU_SHARDING_FACTOR, base_exc_t::LOGIC,
+                          strprintf("`cpu_shards` must be between 1 and %d.",
+                                    MAX_CPU_SHARDING_FACTOR));
+            num_cpu_shards = static_cast<int>(n);
+        }
+
         counted_t<const db_t> db;
         name_string_t tbl_name;
         if (args->num_args() == 1) {
@@ -220,6 +230,7 @@ private:
                     config_params,
                     primary_key,
                     durability,
+                    num_cpu_shards,
                     env->env->interruptor,
                     &result,
                     &error)) {
@@ -553,8 +564,9 @@ class reconfigure_term_t : public table_or_db_meta_term_t {
 public:
     reconfigure_term_t(compile_env_t *env, const raw_term_t &term)
         : table_or_db_meta_term_t(env, term,
-            optargspec_t({"dry_run", "emergency_repair", "nonvoting_replica_tags",
-                "primary_replica_tag", "replicas", "shards"})) { }
+            optargspec_t({"cpu_shards", "dry_run", "emergency_repair",
+                "nonvoting_replica_tags", "primary_replica_tag", "replicas",
+                "shards"})) { }
 private:
     scoped_ptr_t<val_t> required_optarg(scope_env_t *env,
                                         args_t *args,
@@ -580,6 +592,50 @@ private:
             dry_run = v->as_bool();
         }
 
+        /* Changing the number of CPU shards leaves the shards and replicas alone, so
+        it's done on its own. */
+        if (scoped_ptr_t<val_t> cpu_shards = args->optarg(env, "cpu_shards")) {
+            int64_t n = cpu_shards->as_int();
+            rcheck_target(cpu_shards, n >= 1 && n <= MAX_CPU_SHARDING_FACTOR,
+                          base_exc_t::LOGIC,
+                          strprintf("`cpu_shards` must be between 1 and %d.",
+                                    MAX_CPU_SHARDING_FACTOR));
+            if (args->optarg(env, "emergency_repair").has() ||
+                    args->optarg(env, "nonvoting_replica_tags").has() ||
+                    args->optarg(env, "primary_replica_tag").has() ||
+                    args->optarg(env, "replicas").has() ||
+                    args->optarg(env, "shards").has()) {
+                rfail(base_exc_t::LOGIC, "When changing `cpu_shards`, you can't "
+                    "specify shards, replicas, etc.");
+            }
+            if (!static_cast<bool>(name_if_table)) {
+                rfail(base_exc_t::LOGIC, "Can't change `cpu_shards` for an entire "
+                    "database at once; instead you should run `reconfigure()` on each "
+                    "table individually.");
+            }
+
+            bool success;
+            datum_t result;
+            admin_err_t error;
+            try {
+                success = env->env->reql_cluster_interface()->table_set_cpu_shards(
+                    env->env->get_user_context(),
+                    db,
+                    *name_if_table,
+                    static_cast<int>(n),
+                    dry_run,
+                    env->env->interruptor,
+                    &result,
+                    &error);
+            } catch (auth::permission_error_t const &permission_error) {
+                rfail(ql::base_exc_t::PERMISSION_ERROR, "%s", permission_error.what());
+            }
+            if (!success) {
+                REQL_RETHROW(error);
+            }
+            return new_val(result);
+        }
+
         /* Figure out whether we're doing a regular reconfiguration or an emergency
         repair. */
         scoped_ptr_t<val_t> emergency_repair = args->optarg(env, "emergency_repair");
@@ -828,7 +884,8 @@ class table_term_t : public op_term_t {
 public:
     table_term_t(compile_env_t *env, const raw_term_t &term)
         : op_term_t(env, term, argspec_t(1, 2),
-                    optargspec_t({"read_mode", "use_outdated", "identifier_format"})) { }
+                    optargspec_t({"read_mode", "use_outdated", "identifier_format",
+                                  "max_staleness", "aggregate_views"})) { }
 private:
     virtual scoped_ptr_t<val_t> eval_impl(scope_env_t *env, args_t *args, eval_flags_t) const {
         read_mode_t read_mode = read_mode_t::SINGLE;
@@ -854,6 +911,25 @@ private:
             }
         }
 
+        optional<uint64_t> max_staleness_ms;
+        if (scoped_ptr_t<val_t> v = args->optarg(env, "max_staleness")) {
+            if (read_mode != read_mode_t::SINGLE) {
+                rfail(base_exc_t::LOGIC, "%s",
+                      "The `max_staleness` optarg can only be used with "
+                      "`read_mode` \"single\".");
+            }
+            double secs = v->as_num();
+            rcheck_target(v, secs >= 0 && secs <= 365 * 24 * 60 * 60,
+                          base_exc_t::LOGIC,
+                          "`max_staleness` must be between 0 and 31536000 seconds.");
+            max_staleness_ms.set(static_cast<uint64_t>(secs * 1000));
+        }
+
+        bool use_aggregate_views = false;
+        if (scoped_ptr_t<val_t> v = args->optarg(env, "aggregate_views")) {
+            use_aggregate_views = v->as_bool();
+        }
+
         optional<admin_identifier_format_t> identifier_format;
         if (scoped_ptr_t<val_t> v = args->optarg(env, "identifier_format")) {
             const datum_string_t &str = v->as_str();
@@ -886,6 +962,12 @@ private:
                 identifier_format, env->env->interruptor, &table, &error)) {
             REQL_RETHROW(error);
         }
+        if (static_cast<bool>(max_staleness_ms)) {
+            table->set_max_staleness(*max_staleness_ms);
+        }
+        if (use_aggregate_views) {
+            table->set_use_aggregate_views();
+        }
         return new_val(make_counted<table_t>(
             std::move(table), db, table_name.str(), read_mode, backtrace()));
     }
@@ -3,7 +3,9 @@
 
 #include <string>
 
+#include "rdb_protocol/datum_stream/hash_join.hpp"
 #include "rdb_protocol/error.hpp"
+#include "rdb_protocol/func.hpp"
 #include "rdb_protocol/minidriver.hpp"
 #include "rdb_protocol/op.hpp"
 #include "rdb_protocol/term_walker.hpp"
@@ -118,6 +120,162 @@ public:
     virtual const char *name() const { return "outer_join"; }
 };
 
+// A join predicate of the form `(l, r) -> l(field1) == r(field2)`, which we can
+// evaluate with a hash join instead of the nested loop rewrites above.
+class field_eq_predicate_t {
+public:
+    static optional<field_eq_predicate_t> parse(const raw_term_t &join_term) {
+        if (join_term.num_args() != 3 || join_term.num_optargs() != 0) {
+            return r_nullopt;
+        }
+        raw_term_t func = join_term.arg(2);
+        if (func.type() != Term::FUNC || func.num_args() != 2) {
+            return r_nullopt;
+        }
+        std::vector<datum_t> vars;
+        raw_term_t raw_vars = func.arg(0);
+        if (raw_vars.type() == Term::MAKE_ARRAY) {
+            for (size_t i = 0; i < raw_vars.num_args(); ++i) {
+                if (raw_vars.arg(i).type() != Term::DATUM) {
+                    return r_nullopt;
+                }
+                vars.push_back(raw_vars.arg(i).datum());
+            }
+        } else if (raw_vars.type() == Term::DATUM) {
+            datum_t d = raw_vars.datum();
+            if (d.get_type() != datum_t::R_ARRAY) {
+                return r_nullopt;
+            }
+            for (size_t i = 0; i < d.arr_size(); ++i) {
+                vars.push_back(d.get(i));
+            }
+        }
+        if (vars.size() != 2
+            || vars[0].get_type() != datum_t::R_NUM
+            || vars[1].get_type() != datum_t::R_NUM
+            || vars[0] == vars[1]) {
+            return r_nullopt;
+        }
+
+        raw_term_t body = func.arg(1);
+        if (body.type() != Term::EQ
+            || body.num_args() != 2
+            || body.num_optargs() != 0) {
+            return r_nullopt;
+        }
+        optional<datum_t> var_a = field_lookup_var(body.arg(0));
+        optional<datum_t> var_b = field_lookup_var(body.arg(1));
+        if (!var_a || !var_b) {
+            return r_nullopt;
+        }
+        if (*var_a == vars[0] && *var_b == vars[1]) {
+            return make_optional(field_eq_predicate_t(
+                vars[0], body.arg(0), vars[1], body.arg(1), true));
+        } else if (*var_a == vars[1] && *var_b == vars[0]) {
+            return make_optional(field_eq_predicate_t(
+                vars[0], body.arg(1), vars[1], body.arg(0), false));
+        } else {
+            return r_nullopt;
+        }
+    }
+
+    // The variable of the left row and the lookup of its field.
+    datum_t left_var;
+    raw_term_t left_key;
+    // The same for the right row.
+    datum_t right_var;
+    raw_term_t right_key;
+    // Whether `==` evaluates the left row's field first.
+    bool left_key_first;
+
+private:
+    field_eq_predicate_t(datum_t _left_var,
+                         raw_term_t _left_key,
+                         datum_t _right_var,
+                         raw_term_t _right_key,
+                         bool _left_key_first)
+        : left_var(std::move(_left_var)),
+          left_key(std::move(_left_key)),
+          right_var(std::move(_right_var)),
+          right_key(std::move(_right_key)),
+          left_key_first(_left_key_first) { }
+
+    // If `term` is `var(field)` or `var[field]` for a constant string field, returns
+    // the variable.
+    static optional<datum_t> field_lookup_var(const raw_term_t &term) {
+        if ((term.type() != Term::BRACKET && term.type() != Term::GET_FIELD)
+            || term.num_args() != 2
+            || term.num_optargs() != 0) {
+            return r_nullopt;
+        }
+        raw_term_t var = term.arg(0);
+        raw_term_t field = term.arg(1);
+        if (var.type() != Term::VAR
+            || var.num_args() != 1
+            || var.arg(0).type() != Term::DATUM
+            || field.type() != Term::DATUM
+            || field.datum().get_type() != datum_t::R_STR) {
+            return r_nullopt;
+        }
+        return make_optional(var.arg(0).datum());
+    }
+};
+
+class hash_join_term_t : public grouped_seq_op_term_t {
+public:
+    hash_join_term_t(compile_env_t *env,
+                     const raw_term_t &term,
+                     const field_eq_predicate_t &predicate,
+                     hash_join_datum_stream_t::join_type_t _join_type)
+        : grouped_seq_op_term_t(env, term, argspec_t(3)),
+          join_type(_join_type),
+          left_key_first(predicate.left_key_first) {
+        minidriver_t r(term.bt());
+        // The right-hand side is evaluated lazily, like in the nested loop join, so
+        // we wrap it in a function that takes no arguments.
+        right_func = make_counted<func_term_t>(
+            env, r.fun(r.expr(term.arg(1))).root_term());
+        // These are the sides of the `==` in the predicate, as functions of one row.
+        left_key_func = make_counted<func_term_t>(
+            env,
+            r.array(predicate.left_var).call(
+                Term::FUNC, r.expr(predicate.left_key)).root_term());
+        right_key_func = make_counted<func_term_t>(
+            env,
+            r.array(predicate.right_var).call(
+                Term::FUNC, r.expr(predicate.right_key)).root_term());
+    }
+
+private:
+    virtual scoped_ptr_t<val_t> eval_impl(scope_env_t *env,
+                                          args_t *args,
+                                          eval_flags_t) const {
+        counted_t<datum_stream_t> left = args->arg(env, 0)->as_seq(env->env);
+        counted_t<hash_join_datum_stream_t> stream =
+            make_counted<hash_join_datum_stream_t>(
+                std::move(left),
+                right_func->eval_to_func(env->scope),
+                left_key_func->eval_to_func(env->scope),
+                right_key_func->eval_to_func(env->scope),
+                join_type,
+                left_key_first,
+                backtrace());
+        return new_val(env->env, stream);
+    }
+
+    virtual const char *name() const {
+        return join_type == hash_join_datum_stream_t::join_type_t::INNER
+            ? "inner_join"
+            : "outer_join";
+    }
+
+    const hash_join_datum_stream_t::join_type_t join_type;
+    const bool left_key_first;
+    counted_t<const func_term_t> right_func;
+    counted_t<const func_term_t> left_key_func;
+    counted_t<const func_term_t> right_key_func;
+};
+
 class delete_term_t : public rewrite_term_t {
 public:
     delete_term_t(compile_env_t *env, const raw_term_t &term)
@@ -236,10 +394,18 @@ counted_t<term_t> make_skip_term(
 }
 counted_t<term_t> make_inner_join_term(
         compile_env_t *env, const raw_term_t &term) {
+    if (optional<field_eq_predicate_t> predicate = field_eq_predicate_t::parse(term)) {
+        return make_counted<hash_join_term_t>(
+            env, term, *predicate, hash_join_datum_stream_t::join_type_t::INNER);
+    }
     return make_counted<inner_join_term_t>(env, term);
 }
 counted_t<term_t> make_outer_join_term(
         compile_env_t *env, const raw_term_t &term) {
+    if (optional<field_eq_predicate_t> predicate = field_eq_predicate_t::parse(term)) {
+        return make_counted<hash_join_term_t>(
+            env, term, *predicate, hash_join_datum_stream_t::join_type_t::OUTER);
+    }
     return make_counted<outer_join_term_t>(env, term);
 }
 counted_t<term_t> make_update_term(
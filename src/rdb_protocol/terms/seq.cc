@@ -1,6 +1,7 @@
 // Copyright 2010-2015 RethinkDB, all rights reserved.
 #include "rdb_protocol/terms/terms.hpp"
 
+#include <map>
 #include <string>
 #include <utility>
 #include <vector>
@@ -251,7 +252,8 @@ private:
             key = datum_t(datum_string_t(table->get_pkey()));
         }
         counted_t<eq_join_datum_stream_t> eq_join_stream =
-            make_counted<eq_join_datum_stream_t>(stream,
+            make_counted<eq_join_datum_stream_t>(env->env,
+                                                 stream,
                                                  table,
                                                  key.as_str(),
                                                  predicate_function,
@@ -539,7 +541,9 @@ public:
                           "include_initial",
                           "include_offsets",
                           "include_states",
-                          "include_types"})) { }
+                          "include_types",
+                          "include_positions",
+                          "since"})) { }
 private:
     virtual scoped_ptr_t<val_t> eval_impl(
         scope_env_t *env, args_t *args, eval_flags_t) const {
@@ -576,6 +580,36 @@ private:
             include_offsets = v->as_bool();
         }
 
+        bool include_positions = false;
+        if (scoped_ptr_t<val_t> v = args->optarg(env, "include_positions")) {
+            include_positions = v->as_bool();
+        }
+
+        // A position token from an earlier feed with `include_positions`, which
+        // maps the uuids of changefeed servers to positions.
+        optional<std::map<uuid_u, uint64_t> > since;
+        if (scoped_ptr_t<val_t> v = args->optarg(env, "since")) {
+            datum_t token = v->as_datum();
+            rcheck_target(v, token.get_type() == datum_t::R_OBJECT,
+                          base_exc_t::LOGIC,
+                          strprintf("Expected a position token (an OBJECT) "
+                                    "but found %s.",
+                                    token.get_type_name().c_str()));
+            since.set(std::map<uuid_u, uint64_t>());
+            for (size_t i = 0; i < token.obj_size(); ++i) {
+                std::pair<datum_string_t, datum_t> pair = token.unchecked_get_pair(i);
+                uuid_u server_uuid;
+                rcheck_target(v, str_to_uuid(pair.first.to_std(), &server_uuid)
+                              && pair.second.get_type() == datum_t::R_NUM
+                              && pair.second.as_num() >= 0.0,
+                              base_exc_t::LOGIC,
+                              strprintf("Invalid position token `%s`.",
+                                        token.print().c_str()));
+                (*since)[server_uuid] = pair.second.as_int();
+            }
+            include_positions = true;
+        }
+
         scoped_ptr_t<val_t> v = args->arg(env, 0);
         configured_limits_t limits = env->env->limits_with_changefeed_queue_size(
                 args->optarg(env, "changefeed_queue_size"));
@@ -601,6 +635,8 @@ private:
                             include_offsets,
                             include_states,
                             include_types,
+                            include_positions,
+                            since,
                             limits,
                             squash,
                             std::move(changespec.keyspec.spec)),
@@ -635,6 +671,8 @@ private:
                         include_offsets,
                         include_states,
                         include_types,
+                        include_positions,
+                        since,
                         limits,
                         squash,
                         sel->get_spec()),
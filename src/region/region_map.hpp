@@ -267,7 +267,7 @@ void debug_print(printf_buffer_t *buf, const region_map_t<V> &map) {
 
 template<cluster_version_t W, class V>
 void serialize(write_message_t *wm, const region_map_t<V> &map) {
-    static_assert(W == cluster_version_t::v2_4_is_latest,
+    static_assert(W == cluster_version_t::v2_5_is_latest,
         "serialize() is only supported for the latest version");
     serialize<W>(wm, map.inner);
     serialize<W>(wm, map.hash_beg);
@@ -277,7 +277,8 @@ void serialize(write_message_t *wm, const region_map_t<V> &map) {
 template<cluster_version_t W, class V>
 MUST_USE archive_result_t deserialize(read_stream_t *s, region_map_t<V> *map) {
     switch (W) {
-        case cluster_version_t::v2_4_is_latest:
+        case cluster_version_t::v2_5_is_latest:
+        case cluster_version_t::v2_4:
         case cluster_version_t::v2_3:
         case cluster_version_t::v2_2:
         case cluster_version_t::v2_1: {
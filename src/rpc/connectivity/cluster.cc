@@ -20,9 +20,11 @@
 #include "config/args.hpp"
 #include "containers/archive/vector_stream.hpp"
 #include "containers/archive/versioned.hpp"
+#include "containers/buffer_group.hpp"
 #include "containers/object_buffer.hpp"
 #include "containers/uuid.hpp"
 #include "logger.hpp"
+#include "rpc/connectivity/compression.hpp"
 #include "rpc/semilattice/watchable.hpp"
 #include "stl_utils.hpp"
 #include "utils.hpp"
@@ -30,14 +32,36 @@
 // Number of messages after which the message handling loop yields
 #define MESSAGE_HANDLER_MAX_BATCH_SIZE           16
 
+// How long the leader waits for its extra lanes to be set up, and how long the follower
+// keeps a lane around for its connection to claim it
+#define LANE_SETUP_TIMEOUT_MS                    10000
+
+// Messages at least this big are written to the network straight from the buffers they
+// were serialized into, rather than being copied into the connection's write buffer
+#define ZERO_COPY_MESSAGE_SIZE                   (64 * KILOBYTE)
+
+// The feature that a server lists in its handshake if it can decompress messages. We use
+// zlib's deflate format, since we already depend on zlib.
+#define CLUSTER_COMPRESSION_FEATURE              "deflate"
+
+// How a congested lane divides its bandwidth between the `cluster_message_class_t`s
+// that have messages waiting, indexed by class
+static const int message_class_shares[3] = { 16, 4, 1 };
+
 // The cluster communication protocol version.
-static_assert(cluster_version_t::CLUSTER == cluster_version_t::v2_4_is_latest,
+static_assert(cluster_version_t::CLUSTER == cluster_version_t::v2_5_is_latest,
               "We need to update CLUSTER_VERSION_STRING when we add a new cluster "
               "version.");
 
-#define CLUSTER_VERSION_STRING "2.4.0"
+#define CLUSTER_VERSION_STRING "2.5.0"
+
+// The release series whose cluster protocol `CLUSTER_VERSION_STRING` replaced.  Its
+// servers see our version as an unrecognized greater one and leave it to us to
+// refuse the connection, so we tell them why they can't join.
+#define PREVIOUS_CLUSTER_VERSION_PREFIX "2.4."
 
 const std::string connectivity_cluster_t::cluster_proto_header("RethinkDB cluster\n");
+const std::string connectivity_cluster_t::cluster_lane_header("RethinkDB cluster lane\n");
 const std::string connectivity_cluster_t::cluster_version_string(CLUSTER_VERSION_STRING);
 
 // Returns true and sets *out to the version number, if the version number in
@@ -85,6 +109,13 @@ static bool version_number_unrecognized_greater(const std::string &version_strin
                                         parts.begin(), parts.end());
 }
 
+// Returns true if the version string belongs to the release series right before ours,
+// which can read our data files but not talk our cluster protocol.
+static bool version_number_previous_release(const std::string &version_string) {
+    return version_string.compare(0, strlen(PREVIOUS_CLUSTER_VERSION_PREFIX),
+                                  PREVIOUS_CLUSTER_VERSION_PREFIX) == 0;
+}
+
 // Given a remote version string, we figure out whether we can try to talk to it, and
 // if we can, what version we shall talk on.
 static bool resolve_protocol_version(const std::string &remote_version_string,
@@ -117,8 +148,6 @@ const std::string connectivity_cluster_t::cluster_build_mode("debug");
 #endif
 
 void connectivity_cluster_t::connection_t::kill_connection() {
-    /* `heartbeat_manager_t` assumes this doesn't block as long as it's called on the
-    home thread. */
     guarantee(!is_loopback(), "Attempted to kill connection to myself.");
     on_thread_t thread_switcher(conn->home_thread());
 
@@ -130,23 +159,171 @@ void connectivity_cluster_t::connection_t::kill_connection() {
     }
 }
 
+connectivity_cluster_t::connection_t::lane_t::lane_t(
+        connectivity_cluster_t *_cluster,
+        keepalive_tcp_conn_stream_t *_conn,
+        size_t _compression_threshold,
+        perfmon_collection_t *pm_collection,
+        const std::string &pm_name) :
+    conn(_conn),
+    flusher([this](signal_t *) {
+        // We need to acquire the send_mutex because flushing the buffer
+        // must not interleave with other writes (restriction of linux_tcp_conn_t).
+        mutex_t::acq_t acq(&send_mutex);
+        // We ignore the return value of flush_buffer(). Closed connections
+        // must be handled elsewhere.
+        conn->flush_buffer();
+    }, 1),
+    pm_bytes_sent(secs_to_ticks(1), true, get_num_threads()),
+    pm_bytes_sent_membership(pm_collection, &pm_bytes_sent, pm_name),
+    write_queue(1),
+    writer_callback([this](pending_write_t *pending_write, signal_t *) {
+        on_write_dequeued(pending_write);
+    }),
+    writer(1, &write_queue, &writer_callback),
+    num_pending_writes(0),
+    cluster(_cluster),
+    compression_threshold(_compression_threshold) {
+    guarantee(conn != nullptr);
+    guarantee(conn->home_thread() == get_thread_id());
+    if (compression_threshold > 0) {
+        compressor.init(new cluster_compressor_t);
+    }
+    for (size_t i = 0; i < 3; ++i) {
+        class_accounts[i].init(new accounting_queue_t<pending_write_t *>::account_t(
+            &write_queue, &class_queues[i], message_class_shares[i]));
+    }
+}
+
+connectivity_cluster_t::connection_t::lane_t::~lane_t() {
+    /* The connection is drained before its lanes are destroyed, so nobody can be
+    waiting for a write. */
+    guarantee(num_pending_writes == 0);
+    for (size_t i = 0; i < 3; ++i) {
+        class_accounts[i].reset();
+    }
+}
+
+struct connectivity_cluster_t::connection_t::lane_t::pending_write_t {
+    message_tag_t tag;
+    write_message_t *msg;
+    bool *result_out;
+    cond_t *done;
+};
+
+bool connectivity_cluster_t::connection_t::lane_t::write_message(
+        message_tag_t tag,
+        write_message_t *msg,
+        cluster_message_class_t message_class) {
+    guarantee(conn->home_thread() == get_thread_id());
+    /* If nothing else wants the lane there's nothing to schedule, so we skip the queue.
+    This is the common case, and it saves us a coroutine switch. */
+    if (num_pending_writes == 0 && !send_mutex.is_locked()) {
+        return write_now(tag, msg);
+    }
+    bool result;
+    cond_t done;
+    pending_write_t pending_write;
+    pending_write.tag = tag;
+    pending_write.msg = msg;
+    pending_write.result_out = &result;
+    pending_write.done = &done;
+    ++num_pending_writes;
+    class_queues[static_cast<size_t>(message_class)].push(&pending_write);
+    done.wait_lazily_unordered();
+    return result;
+}
+
+bool connectivity_cluster_t::connection_t::lane_t::write_now(
+        message_tag_t tag,
+        write_message_t *msg) {
+    /* Acquire the send-mutex so we don't collide with the flusher. The `true` is for
+    eager waiting, which is a significant performance optimization in this case. */
+    mutex_t::acq_t acq(&send_mutex, true);
+
+    /* Compress the message if it's big enough. The compressed message replaces the
+    original one, and the tag goes into it. */
+    write_message_t compressed;
+    if (compressor.has() && msg->size() >= compression_threshold) {
+        ticks_t start_ticks = get_ticks();
+        compressor->compress_message(tag, msg, &compressed);
+        cluster->pm_compression_nsecs += get_ticks() - start_ticks;
+        cluster->pm_compression_input_bytes += msg->size() + sizeof(tag);
+        cluster->pm_compression_output_bytes += compressed.size();
+    }
+
+    /* Write the tag to the network */
+    {
+        // All cluster versions use a uint8_t tag here.
+        write_message_t wm;
+        static_assert(std::is_same<message_tag_t, uint8_t>::value,
+                      "We expect to be serializing a uint8_t -- if this has "
+                      "changed, the cluster communication format has changed and "
+                      "you need to ask yourself whether live cluster upgrades work."
+                      );
+        if (compressed.size() > 0) {
+            serialize_universal(&wm, compressed_tag);
+            serialize_universal(&wm, static_cast<uint64_t>(msg->size() + sizeof(tag)));
+            serialize_universal(&wm, static_cast<uint64_t>(compressed.size()));
+            msg = &compressed;
+        } else {
+            serialize_universal(&wm, tag);
+        }
+        make_buffered_tcp_conn_stream_wrapper_t buffered_conn(conn);
+        int res = send_write_message(&buffered_conn, &wm);
+        if (res == -1) {
+            /* Close the other half of the lane to make sure that
+               `connectivity_cluster_t::run_t::handle()` notices that something is
+               up */
+            if (conn->is_read_open()) {
+                conn->shutdown_read();
+            }
+            return false;
+        }
+    }
+
+    /* Write the message itself to the network. Small messages are copied into the
+    connection's write buffer, so that they go out together with the messages around
+    them. Big messages are written straight from their serialization buffers. This
+    flushes whatever is in the write buffer (including the tag) first. */
+    int res;
+    if (msg->size() < ZERO_COPY_MESSAGE_SIZE) {
+        make_buffered_tcp_conn_stream_wrapper_t buffered_conn(conn);
+        res = send_write_message(&buffered_conn, msg);
+    } else {
+        const_buffer_group_t buffers;
+        intrusive_list_t<write_buffer_t> *chunks = msg->unsafe_expose_buffers();
+        for (write_buffer_t *p = chunks->head(); p != nullptr; p = chunks->next(p)) {
+            buffers.add_buffer(p->size, p->data);
+        }
+        res = conn->write_gathered(&buffers) == -1 ? -1 : 0;
+    }
+    if (res == -1) {
+        if (conn->is_read_open()) {
+            conn->shutdown_read();
+        }
+        return false;
+    }
+    return true;
+}
+
+void connectivity_cluster_t::connection_t::lane_t::on_write_dequeued(
+        pending_write_t *pending_write) {
+    *pending_write->result_out = write_now(pending_write->tag, pending_write->msg);
+    --num_pending_writes;
+    pending_write->done->pulse();
+}
+
 connectivity_cluster_t::connection_t::connection_t(
         run_t *_parent,
         const peer_id_t &_peer_id,
         const server_id_t &_server_id,
         keepalive_tcp_conn_stream_t *_conn,
+        const std::vector<keepalive_tcp_conn_stream_t *> &extra_lanes,
+        size_t compression_threshold,
         const peer_address_t &_peer_address) THROWS_NOTHING :
     conn(_conn),
     peer_address(_peer_address),
-    flusher([&](signal_t *) {
-        guarantee(this->conn != nullptr);
-        // We need to acquire the send_mutex because flushing the buffer
-        // must not interleave with other writes (restriction of linux_tcp_conn_t).
-        mutex_t::acq_t acq(&this->send_mutex);
-        // We ignore the return value of flush_buffer(). Closed connections
-        // must be handled elsewhere.
-        this->conn->flush_buffer();
-    }, 1),
     pm_collection(),
     pm_bytes_sent(secs_to_ticks(1), true, get_num_threads()),
     pm_collection_membership(
@@ -159,6 +336,20 @@ connectivity_cluster_t::connection_t::connection_t(
     server_id(_server_id),
     drainers()
 {
+    guarantee(conn != nullptr || extra_lanes.empty());
+    if (conn != nullptr) {
+        lanes.resize(extra_lanes.size() + 1);
+        connectivity_cluster_t *cluster = _parent->parent;
+        lanes[0].init(new lane_t(cluster, conn, compression_threshold, &pm_collection,
+                                 "lane_0_bytes_sent"));
+        pmap(extra_lanes.size(), [&](int i) {
+            on_thread_t thread_switcher(extra_lanes[i]->home_thread());
+            lanes[i + 1].init(new lane_t(
+                cluster, extra_lanes[i], compression_threshold, &pm_collection,
+                strprintf("lane_%d_bytes_sent", i + 1)));
+        });
+    }
+
     pmap(get_num_threads(), [this](int thread_id) {
         on_thread_t thread_switcher((threadnum_t(thread_id)));
         parent->parent->connections.get()->set_key_no_equals(
@@ -175,8 +366,31 @@ connectivity_cluster_t::connection_t::~connection_t() THROWS_NOTHING {
         drainers.get()->drain();
     });
 
-    /* The drainers have been destroyed, so nothing can be holding the `send_mutex`. */
-    guarantee(!send_mutex.is_locked());
+    /* The drainers have been destroyed, so nothing can be holding a `send_mutex`. */
+    pmap(lanes.size(), [this](int i) {
+        on_thread_t thread_switcher(lanes[i]->conn->home_thread());
+        guarantee(!lanes[i]->send_mutex.is_locked());
+        lanes[i].reset();
+    });
+}
+
+connectivity_cluster_t::connection_t::lane_t *
+connectivity_cluster_t::connection_t::get_lane(uint64_t stream_key) {
+    guarantee(!lanes.empty());
+    return lanes[stream_key % lanes.size()].get();
+}
+
+void connectivity_cluster_t::connection_t::shutdown_lanes() {
+    pmap(lanes.size(), [this](int i) {
+        keepalive_tcp_conn_stream_t *lane_conn = lanes[i]->conn;
+        on_thread_t thread_switcher(lane_conn->home_thread());
+        if (lane_conn->is_read_open()) {
+            lane_conn->shutdown_read();
+        }
+        if (lane_conn->is_write_open()) {
+            lane_conn->shutdown_write();
+        }
+    });
 }
 
 // Helper function for the `run_t` constructor's initialization list
@@ -219,6 +433,8 @@ connectivity_cluster_t::run_t::run_t(
         const int join_delay_secs,
         int port,
         int client_port,
+        int _connections_per_peer,
+        size_t _compression_threshold,
         std::shared_ptr<semilattice_read_view_t<heartbeat_semilattice_metadata_t> >
             _heartbeat_sl_view,
         std::shared_ptr<semilattice_read_view_t<auth_semilattice_metadata_t> >
@@ -226,8 +442,11 @@ connectivity_cluster_t::run_t::run_t(
         tls_ctx_t *_tls_ctx)
         THROWS_ONLY(address_in_use_exc_t, tcp_socket_exc_t) :
     parent(_parent),
+    connections_per_peer(_connections_per_peer),
+    compression_threshold(_compression_threshold),
     server_id(_server_id),
     tls_ctx(_tls_ctx),
+    next_parked_lane_id(0),
 
     /* Create the socket to use when listening for connections from peers */
     cluster_listener_socket(new tcp_bound_socket_t(local_addresses, port)),
@@ -259,7 +478,9 @@ connectivity_cluster_t::run_t::run_t(
     `connection_map` on each thread and notifying any listeners that we're now
     connected to ourself. The destructor will remove us from the
     `connection_map` and again notify any listeners. */
-    connection_to_ourself(this, parent->me, _server_id, nullptr, routing_table[parent->me]),
+    connection_to_ourself(this, parent->me, _server_id, nullptr,
+                          std::vector<keepalive_tcp_conn_stream_t *>(), 0,
+                          routing_table[parent->me]),
 
     heartbeat_sl_view(_heartbeat_sl_view),
     auth_sl_view(_auth_sl_view),
@@ -270,6 +491,7 @@ connectivity_cluster_t::run_t::run_t(
                  this, ph::_1, join_delay_secs, auto_drainer_t::lock_t(&drainer))))
 {
     parent->assert_thread();
+    guarantee(connections_per_peer >= 1);
 }
 
 connectivity_cluster_t::run_t::~run_t() {
@@ -321,9 +543,15 @@ void connectivity_cluster_t::run_t::on_new_connection(
         return;
     }
 
-    keepalive_tcp_conn_stream_t conn_stream(conn);
+    scoped_ptr_t<keepalive_tcp_conn_stream_t> conn_stream(
+        new keepalive_tcp_conn_stream_t(conn));
 
-    handle(&conn_stream, r_nullopt, r_nullopt, r_nullopt, lock, nullptr, join_delay_secs);
+    bool is_lane = false;
+    handle(conn_stream.get(), r_nullopt, r_nullopt, r_nullopt, lock, nullptr,
+           join_delay_secs, &is_lane);
+    if (is_lane) {
+        accept_lane(std::move(conn_stream), lock);
+    }
 }
 
 join_result_t connectivity_cluster_t::run_t::connect_to_peer(
@@ -361,7 +589,8 @@ join_result_t connectivity_cluster_t::run_t::connect_to_peer(
 
             join_result = handle(
                 &conn, expected_id, optional<peer_address_t>(*address),
-                expected_server_id, drainer_lock, successful_join_inout, join_delay_secs);
+                expected_server_id, drainer_lock, successful_join_inout, join_delay_secs,
+                nullptr);
         } catch (const tcp_conn_t::connect_failed_exc_t &) {
             /* Ignore */
         } catch (const crypto::openssl_error_t &) {
@@ -454,10 +683,45 @@ private:
     DISABLE_COPYING(cluster_conn_closing_subscription_t);
 };
 
-/* `heartbeat_manager_t` is responsible for sending heartbeats over a single connection
-and making sure that heartbeats have arrived on time.
-`connectivity_cluster_t::run_t::handle()` constructs one after constructing the
-`connection_t`. */
+/* `cluster_lane_thread_t` moves an extra lane of a connection to a thread of its own for
+as long as it exists. It must be created and destroyed on the thread that the lane was
+on before. */
+class cluster_lane_thread_t {
+public:
+    cluster_lane_thread_t(thread_allocator_t *allocator,
+                          keepalive_tcp_conn_stream_t *conn) :
+        conn_(conn),
+        allocation_(allocator),
+        unregister_(conn, INVALID_THREAD) {
+        on_thread_t thread_switcher(allocation_.get_thread());
+        reregister_.create(conn, get_thread_id());
+    }
+
+    threadnum_t get_thread() const {
+        return allocation_.get_thread();
+    }
+
+    ~cluster_lane_thread_t() {
+        on_thread_t thread_switcher(allocation_.get_thread());
+        /* Make sure that any pending network writes have either been transmitted or
+        aborted before we move the lane back. */
+        conn_->flush_buffer();
+        reregister_.reset();
+    }
+
+private:
+    keepalive_tcp_conn_stream_t *conn_;
+    thread_allocation_t allocation_;
+    rethread_tcp_conn_stream_t unregister_;
+    object_buffer_t<rethread_tcp_conn_stream_t> reregister_;
+    DISABLE_COPYING(cluster_lane_thread_t);
+};
+
+/* `heartbeat_manager_t` is responsible for sending heartbeats over a single lane of a
+connection and making sure that heartbeats have arrived on time on that lane.
+`connectivity_cluster_t::run_t::handle()` constructs one for every lane after
+constructing the `connection_t`, on the lane's thread. If any lane times out, we close
+it, which makes `handle()` take down the other lanes as well. */
 class connectivity_cluster_t::heartbeat_manager_t :
     public keepalive_tcp_conn_stream_t::keepalive_callback_t,
     private repeating_timer_callback_t,
@@ -468,11 +732,14 @@ public:
 
     heartbeat_manager_t(
             connectivity_cluster_t::connection_t *connection_,
+            size_t lane_index_,
             auto_drainer_t::lock_t connection_keepalive_,
             const std::string &peer_str_,
             clone_ptr_t<watchable_t<heartbeat_semilattice_metadata_t> >
                 heartbeat_sl_view_) :
         connection(connection_),
+        lane_index(lane_index_),
+        lane_conn(connection->lanes[lane_index]->conn),
         connection_keepalive(connection_keepalive_),
         read_done(false),
         write_done(false),
@@ -482,7 +749,8 @@ public:
         heartbeat_sl_view(std::move(heartbeat_sl_view_)),
         heartbeat_sl_view_sub(std::bind(&heartbeat_manager_t::on_heartbeat_change, this))
     {
-        connection->conn->set_keepalive_callback(this);
+        guarantee(lane_conn->home_thread() == get_thread_id());
+        lane_conn->set_keepalive_callback(this);
 
         // This will trigger the initialization of the timeout, and timer
         watchable_t<heartbeat_semilattice_metadata_t>::freeze_t
@@ -491,7 +759,7 @@ public:
     }
 
     ~heartbeat_manager_t() {
-        connection->conn->set_keepalive_callback(nullptr);
+        lane_conn->set_keepalive_callback(nullptr);
     }
 
     /* These are called by the `keepalive_tcp_conn_stream_t`. */
@@ -509,10 +777,14 @@ public:
         if (intervals_since_last_read_done > HEARTBEAT_TIMEOUT_INTERVALS) {
             logERR("Heartbeat timeout, killing connection to peer %s", peer_str.c_str());
 
-            /* This won't block if we call it from the same thread. This is an
-            implementation detail that outside code shouldn't rely on, but since
-            `heartbeat_manager_t` is part of `connectivity_cluster_t` it's OK. */
-            connection->kill_connection();
+            /* We're on the lane's thread, so this doesn't block. Once the lane is
+            closed, `handle()` closes the other lanes of the connection too. */
+            if (lane_conn->is_read_open()) {
+                lane_conn->shutdown_read();
+            }
+            if (lane_conn->is_write_open()) {
+                lane_conn->shutdown_write();
+            }
             return;
         }
         if (write_done) {
@@ -524,9 +796,13 @@ public:
             coro_t::spawn_later_ordered(
                 [this, this_keepalive /* important to capture */] {
                     /* This might block, so we have to run it in a sub-coroutine. */
+                    /* The stream key `lane_index` sends the heartbeat over the lane
+                    that we watch. It mustn't wait behind bulk messages or the other
+                    side might time out. */
                     connection->parent->parent->send_message(
                         connection, connection_keepalive,
-                        connectivity_cluster_t::heartbeat_tag, this);
+                        connectivity_cluster_t::heartbeat_tag, lane_index, this,
+                        cluster_message_class_t::CRITICAL);
                 });
         }
         if (read_done) {
@@ -543,7 +819,7 @@ public:
         }
     }
 
-    void write(write_stream_t *) {
+    void write(write_message_t *) {
         /* Do nothing. The cluster will end up sending just the tag 'H' with no message
         attached, which will trigger `keepalive_read()` on the remote server. */
     }
@@ -577,6 +853,8 @@ public:
 
 private:
     connectivity_cluster_t::connection_t *connection;
+    size_t lane_index;
+    keepalive_tcp_conn_stream_t *lane_conn;
     auto_drainer_t::lock_t connection_keepalive;
     bool read_done, write_done;
     int64_t intervals_since_last_read_done;
@@ -732,17 +1010,22 @@ enum class handshake_result_code_t {
     INCOMPATIBLE_BUILD = 3,
     PASSWORD_MISMATCH = 4,
     UNKNOWN_ERROR = 5,
-    UNEXPECTED_SERVER_ID = 6
+    UNEXPECTED_SERVER_ID = 6,
+    LANE_REJECTED = 7
 };
 
 class handshake_result_t {
 public:
     handshake_result_t() { }
-    static handshake_result_t success() {
-        return handshake_result_t(handshake_result_code_t::SUCCESS);
+    /* A successful result can list the optional protocol features that the sender
+    supports, separated by spaces. Older servers send an empty list, and ignore the
+    list that we send. */
+    static handshake_result_t success(const std::string &features = "") {
+        return handshake_result_t(handshake_result_code_t::SUCCESS, features);
     }
     static handshake_result_t error(handshake_result_code_t error_code,
                                     const std::string &additional_info) {
+        guarantee(error_code != handshake_result_code_t::SUCCESS);
         return handshake_result_t(error_code, additional_info);
     }
 
@@ -750,6 +1033,16 @@ public:
         return code;
     }
 
+    bool has_feature(const std::string &feature) const {
+        guarantee(code == handshake_result_code_t::SUCCESS);
+        for (const std::string &f : split_string(additional_info, ' ')) {
+            if (f == feature) {
+                return true;
+            }
+        }
+        return false;
+    }
+
     std::string get_error_reason() const {
         if (code == handshake_result_code_t::UNKNOWN_ERROR) {
             return error_code_string + " (" + additional_info + ")";
@@ -773,6 +1066,8 @@ private:
                 return "no admin password";
             case handshake_result_code_t::UNEXPECTED_SERVER_ID:
                 return "unexpected server id";
+            case handshake_result_code_t::LANE_REJECTED:
+                return "extra connection rejected";
             case handshake_result_code_t::UNKNOWN_ERROR:
                 unreachable();
             default:
@@ -780,16 +1075,13 @@ private:
         }
     }
 
-    handshake_result_t(handshake_result_code_t _error_code,
+    handshake_result_t(handshake_result_code_t _code,
                        const std::string &_additional_info)
-        : code(_error_code), additional_info(_additional_info) {
+        : code(_code), additional_info(_additional_info) {
         guarantee(code != handshake_result_code_t::UNKNOWN_ERROR);
-        guarantee(code != handshake_result_code_t::SUCCESS);
-        error_code_string = get_code_as_string();
-    }
-    explicit handshake_result_t(handshake_result_code_t _success)
-        : code(_success) {
-        guarantee(code == handshake_result_code_t::SUCCESS);
+        if (code != handshake_result_code_t::SUCCESS) {
+            error_code_string = get_code_as_string();
+        }
     }
 
     friend void serialize_universal(write_message_t *, const handshake_result_t &);
@@ -802,6 +1094,7 @@ private:
     // it might send us some error codes that we don't understand. However the
     // other node will know how to format that error into an error message.
     std::string error_code_string;
+    // The list of features if code is SUCCESS.
     std::string additional_info;
 };
 
@@ -868,7 +1161,8 @@ join_result_t connectivity_cluster_t::run_t::handle(
         optional<server_id_t> expected_server_id,
         auto_drainer_t::lock_t drainer_lock,
         bool *successful_join_inout,
-        const int join_delay_secs) THROWS_NOTHING
+        const int join_delay_secs,
+        bool *is_lane_out) THROWS_NOTHING
 {
     parent->assert_thread();
 
@@ -927,9 +1221,19 @@ join_result_t connectivity_cluster_t::run_t::handle(
         }
     }
 
-    // Receive & check header.
+    // Receive & check header. If we accept extra lanes on this connection, the other
+    // side may also send `cluster_lane_header`.
     {
-        for (size_t i = 0; i < cluster_proto_header.length(); ++i) {
+        bool may_be_proto = true;
+        bool may_be_lane = is_lane_out != nullptr;
+        for (size_t i = 0; ; ++i) {
+            if (may_be_proto && i == cluster_proto_header.length()) {
+                break;
+            }
+            if (may_be_lane && i == cluster_lane_header.length()) {
+                *is_lane_out = true;
+                return join_result_t::SUCCESS;
+            }
             // We read one byte at a time so we can bail out early if the header doesn't
             // match. This is ok performance-wise because `read` is buffered.
             char buffer;
@@ -939,8 +1243,10 @@ join_result_t connectivity_cluster_t::run_t::handle(
             }
             rassert(r >= 0);
             rassert(r <= 1);
+            may_be_proto = may_be_proto && cluster_proto_header[i] == buffer;
+            may_be_lane = may_be_lane && cluster_lane_header[i] == buffer;
             // If EOF or remote_header does not match header, terminate connection.
-            if (0 == r || cluster_proto_header[i] != buffer) {
+            if (0 == r || (!may_be_proto && !may_be_lane)) {
                 logWRN("Received invalid clustering header from %s, closing connection -- something might be connecting to the wrong port.", peername);
                 return join_result_t::PERMANENT_ERROR;
             }
@@ -957,10 +1263,15 @@ join_result_t connectivity_cluster_t::run_t::handle(
         }
 
         if (!resolve_protocol_version(remote_version_string, &resolved_version)) {
+            std::string info = strprintf("local: %s, remote: %s",
+                cluster_version_string.c_str(), remote_version_string.c_str());
+            if (version_number_previous_release(remote_version_string)) {
+                info += "; servers can't be upgraded one at a time from "
+                    PREVIOUS_CLUSTER_VERSION_PREFIX "x, stop them all and upgrade "
+                    "them together";
+            }
             auto reason = handshake_result_t::error(
-                handshake_result_code_t::UNRECOGNIZED_VERSION,
-                strprintf("local: %s, remote: %s",
-                          cluster_version_string.c_str(), remote_version_string.c_str()));
+                handshake_result_code_t::UNRECOGNIZED_VERSION, info);
             // Peers before 1.14 don't support receiving a handshake error message.
             // So we must not send one.
             bool handshake_error_supported = false;
@@ -1074,10 +1385,11 @@ join_result_t connectivity_cluster_t::run_t::handle(
         return join_result_t::TEMPORARY_ERROR;
     }
 
+    bool peer_accepts_compression;
     {
         // Tell the other node that we are happy to connect with it
         write_message_t wm;
-        serialize_universal(&wm, handshake_result_t::success());
+        serialize_universal(&wm, handshake_result_t::success(CLUSTER_COMPRESSION_FEATURE));
         if (send_write_message(conn, &wm)) {
             return join_result_t::TEMPORARY_ERROR; // network error.
         }
@@ -1096,6 +1408,8 @@ join_result_t connectivity_cluster_t::run_t::handle(
                 return join_result_t::TEMPORARY_ERROR;
             return join_result_t::PERMANENT_ERROR;
         }
+        peer_accepts_compression =
+            handshake_result.has_feature(CLUSTER_COMPRESSION_FEATURE);
     }
 
     // Look up the ip addresses for the other host
@@ -1176,6 +1490,9 @@ join_result_t connectivity_cluster_t::run_t::handle(
     parent->assert_thread();
     std::map<peer_id_t, std::set<host_and_port_t> > other_routing_table;
 
+    /* The extra TCP connections that make up the connection, besides `conn`. */
+    std::vector<scoped_ptr_t<keepalive_tcp_conn_stream_t> > extra_lanes;
+
     if (we_are_leader) {
         std::map<peer_id_t, std::set<host_and_port_t> > routing_table_to_send;
         if (!get_routing_table_to_send_and_add_peer(other_id,
@@ -1185,6 +1502,19 @@ join_result_t connectivity_cluster_t::run_t::handle(
             return join_result_t::TEMPORARY_ERROR;
         }
 
+        /* Open the extra lanes before we send the routing table, so that the follower
+        has them by the time it receives it. We connect to the follower's cluster port
+        on the address that the connection came from or went to. When we're using a
+        fixed client port, we can't open more than one connection to the peer. */
+        if (connections_per_peer > 1 && cluster_client_port == 0) {
+            for (const ip_and_port_t &addr : other_peer_addr.get()->ips()) {
+                if (addr.ip() == peer_addr.ip()) {
+                    open_lanes(other_id, addr, drainer_lock, &extra_lanes);
+                    break;
+                }
+            }
+        }
+
         /* We're good to go! Transmit the routing table to the follower, so it
         knows we're in. */
         {
@@ -1210,6 +1540,10 @@ join_result_t connectivity_cluster_t::run_t::handle(
             return join_result_t::TEMPORARY_ERROR;
         }
 
+        /* The leader has opened all of its extra lanes before sending the routing
+        table, so any that we accepted are parked by now. */
+        claim_lanes(other_id, peer_addr.ip(), &extra_lanes);
+
         std::map<peer_id_t, std::set<host_and_port_t> > routing_table_to_send;
         if (!get_routing_table_to_send_and_add_peer(other_id,
                                                     *other_peer_addr.get(),
@@ -1282,14 +1616,39 @@ join_result_t connectivity_cluster_t::run_t::handle(
 
     thread_allocation_t chosen_thread(&parent->thread_allocator);
 
+    /* Each extra lane gets a thread of its own. */
+    std::vector<scoped_ptr_t<cluster_lane_thread_t> > lane_threads;
+    std::vector<keepalive_tcp_conn_stream_t *> extra_lane_conns;
+    for (const auto &lane : extra_lanes) {
+        lane_threads.push_back(make_scoped<cluster_lane_thread_t>(
+            &parent->thread_allocator, lane.get()));
+        extra_lane_conns.push_back(lane.get());
+    }
+
     cross_thread_signal_t connection_thread_drain_signal(
         drainer_lock.get_drain_signal(),
         chosen_thread.get_thread());
-    cross_thread_watchable_variable_t<heartbeat_semilattice_metadata_t>
-        cross_thread_heartbeat_sl_view(
-            clone_ptr_t<semilattice_watchable_t<heartbeat_semilattice_metadata_t> >(
-                new semilattice_watchable_t<heartbeat_semilattice_metadata_t>(
-                    heartbeat_sl_view)), chosen_thread.get_thread());
+    /* Every lane runs its own `heartbeat_manager_t` on its thread, so every lane's
+    thread needs to see the heartbeat settings. */
+    std::vector<scoped_ptr_t<
+        cross_thread_watchable_variable_t<heartbeat_semilattice_metadata_t> > >
+            cross_thread_heartbeat_sl_views;
+    {
+        std::vector<threadnum_t> lane_thread_nums;
+        lane_thread_nums.push_back(chosen_thread.get_thread());
+        for (const auto &lane_thread : lane_threads) {
+            lane_thread_nums.push_back(lane_thread->get_thread());
+        }
+        for (threadnum_t thread : lane_thread_nums) {
+            cross_thread_heartbeat_sl_views.push_back(make_scoped<
+                cross_thread_watchable_variable_t<heartbeat_semilattice_metadata_t> >(
+                    clone_ptr_t<semilattice_watchable_t<
+                            heartbeat_semilattice_metadata_t> >(
+                        new semilattice_watchable_t<heartbeat_semilattice_metadata_t>(
+                            heartbeat_sl_view)),
+                    thread));
+        }
+    }
 
     rethread_tcp_conn_stream_t unregister_conn(conn, INVALID_THREAD);
     on_thread_t conn_threader(chosen_thread.get_thread());
@@ -1319,68 +1678,36 @@ join_result_t connectivity_cluster_t::run_t::handle(
         constructor registers it in the `connectivity_cluster_t`'s connection
         map. */
         connection_t conn_structure(
-            this, other_id, remote_server_id, conn, *other_peer_addr.get());
-
-        /* `heartbeat_manager` will periodically send a heartbeat message to
-        other servers, and it will also close the connection if we don't
-        receive anything for a while. */
-        heartbeat_manager_t heartbeat_manager(
-            &conn_structure,
-            auto_drainer_t::lock_t(conn_structure.drainers.get()),
-            peerstr,
-            cross_thread_heartbeat_sl_view.get_watchable());
-
-        /* Main message-handling loop: read messages off the connection until
-        it's closed, which may be due to network events, or the other end
-        shutting down, or us shutting down. */
-        try {
-            int messages_handled_since_yield = 0;
-            while (true) {
-                message_tag_t tag;
-                archive_result_t res = deserialize_universal(conn, &tag);
-                if (bad(res)) { throw fake_archive_exc_t(); }
+            this, other_id, remote_server_id, conn, extra_lane_conns,
+            peer_accepts_compression ? compression_threshold : 0,
+            *other_peer_addr.get());
 
-                /* Ignore messages tagged with the heartbeat tag. The
-                `keepalive_tcp_conn_stream_t` will have already notified the
-                `heartbeat_manager_t` as soon as the heartbeat arrived. */
-                if (tag != heartbeat_tag) {
-                    cluster_message_handler_t *handler = parent->message_handlers[tag];
-                    guarantee(handler != nullptr, "Got a message for an unfamiliar tag. "
-                        "Apparently we aren't compatible with the cluster on the other "
-                        "end.");
-
-                    /* If you really want to support old cluster versions, the
-                    resolved_version should be passed into the on_message() handler. */
-                    guarantee(resolved_version == cluster_version_t::CLUSTER);
-                    handler->on_message(
-                        &conn_structure,
-                        auto_drainer_t::lock_t(conn_structure.drainers.get()),
-                        conn); // might raise fake_archive_exc_t
-                }
+        /* If you really want to support old cluster versions, the
+        resolved_version should be passed into the on_message() handler. */
+        guarantee(resolved_version == cluster_version_t::CLUSTER);
 
-                ++messages_handled_since_yield;
-                if (messages_handled_since_yield >= MESSAGE_HANDLER_MAX_BATCH_SIZE) {
-                    coro_t::yield();
-                    messages_handled_since_yield = 0;
-                }
+        /* Main message-handling loop: read messages off every lane of the connection
+        until one of them is closed, which may be due to network events, or the other
+        end shutting down, or us shutting down. Messages that were sent over a lane
+        that went down may have been lost, so we then take down the other lanes as
+        well. */
+        pmap(conn_structure.lanes.size(), [&](int i) {
+            keepalive_tcp_conn_stream_t *lane_conn = conn_structure.lanes[i]->conn;
+            on_thread_t thread_switcher(lane_conn->home_thread());
+            {
+                /* `heartbeat_manager` will periodically send a heartbeat message over
+                this lane, and it will also close the lane if we don't receive anything
+                on it for a while. */
+                heartbeat_manager_t heartbeat_manager(
+                    &conn_structure,
+                    i,
+                    auto_drainer_t::lock_t(conn_structure.drainers.get()),
+                    peerstr,
+                    cross_thread_heartbeat_sl_views[i]->get_watchable());
+                handle_messages(&conn_structure, lane_conn);
             }
-        } catch (const fake_archive_exc_t &) {
-            /* The exception broke us out of the loop, and that's what we
-            wanted. This could either be because we lost contact with the peer
-            or because the cluster is shutting down and `close_conn()` got
-            called. */
-        }
-
-        if (conn->is_read_open()) {
-            logWRN("Received invalid data on a cluster connection. Disconnecting.");
-            conn->shutdown_read();
-        }
-        if (conn->is_write_open()) {
-            /* Shutdown the write direction as well, to make sure that any active
-            `send_message` calls get interrupted and don't stop us from destructing
-            the `conn_structure`. */
-            conn->shutdown_write();
-        }
+            conn_structure.shutdown_lanes();
+        });
 
         /* The `conn_structure` destructor removes us from the connection map. It also
         blocks until all references to `conn_structure` have been released (using its
@@ -1395,6 +1722,278 @@ join_result_t connectivity_cluster_t::run_t::handle(
     return join_result_t::SUCCESS;
 }
 
+void connectivity_cluster_t::run_t::handle_messages(
+        connection_t *connection,
+        keepalive_tcp_conn_stream_t *c) THROWS_NOTHING {
+    /* The other end of the lane's compressed stream. We create it when the first
+    compressed message arrives. */
+    scoped_ptr_t<cluster_decompressor_t> decompressor;
+    try {
+        int messages_handled_since_yield = 0;
+        while (true) {
+            message_tag_t tag;
+            archive_result_t res = deserialize_universal(c, &tag);
+            if (bad(res)) { throw fake_archive_exc_t(); }
+
+            if (tag == compressed_tag) {
+                /* Decompress the message, and then hand it to its handler as if it had
+                arrived uncompressed. */
+                uint64_t uncompressed_size, compressed_size;
+                res = deserialize_universal(c, &uncompressed_size);
+                if (bad(res)) { throw fake_archive_exc_t(); }
+                res = deserialize_universal(c, &compressed_size);
+                if (bad(res)) { throw fake_archive_exc_t(); }
+                if (uncompressed_size < sizeof(message_tag_t)) {
+                    throw fake_archive_exc_t();
+                }
+                std::vector<char> compressed(compressed_size);
+                int64_t bytes_read = force_read(c, compressed.data(), compressed_size);
+                if (bytes_read != static_cast<int64_t>(compressed_size)) {
+                    throw fake_archive_exc_t();
+                }
+                if (!decompressor.has()) {
+                    decompressor.init(new cluster_decompressor_t);
+                }
+                std::vector<char> data(uncompressed_size);
+                ticks_t start_ticks = get_ticks();
+                if (!decompressor->decompress_message(compressed, &data)) {
+                    throw fake_archive_exc_t();
+                }
+                parent->pm_compression_nsecs += get_ticks() - start_ticks;
+
+                tag = static_cast<message_tag_t>(data[0]);
+                cluster_message_handler_t *handler = parent->message_handlers[tag];
+                if (handler == nullptr) {
+                    throw fake_archive_exc_t();
+                }
+                vector_read_stream_t stream(std::move(data), sizeof(message_tag_t));
+                handler->on_message(
+                    connection,
+                    auto_drainer_t::lock_t(connection->drainers.get()),
+                    &stream); // might raise fake_archive_exc_t
+            } else if (tag != heartbeat_tag) {
+                /* Ignore messages tagged with the heartbeat tag. The
+                `keepalive_tcp_conn_stream_t` will have already notified the
+                `heartbeat_manager_t` as soon as the heartbeat arrived. */
+                cluster_message_handler_t *handler = parent->message_handlers[tag];
+                guarantee(handler != nullptr, "Got a message for an unfamiliar tag. "
+                    "Apparently we aren't compatible with the cluster on the other "
+                    "end.");
+
+                handler->on_message(
+                    connection,
+                    auto_drainer_t::lock_t(connection->drainers.get()),
+                    c); // might raise fake_archive_exc_t
+            }
+
+            ++messages_handled_since_yield;
+            if (messages_handled_since_yield >= MESSAGE_HANDLER_MAX_BATCH_SIZE) {
+                coro_t::yield();
+                messages_handled_since_yield = 0;
+            }
+        }
+    } catch (const fake_archive_exc_t &) {
+        /* The exception broke us out of the loop, and that's what we
+        wanted. This could either be because we lost contact with the peer
+        or because the cluster is shutting down and `close_conn()` got
+        called. */
+    }
+
+    if (c->is_read_open()) {
+        logWRN("Received invalid data on a cluster connection. Disconnecting.");
+        c->shutdown_read();
+    }
+    if (c->is_write_open()) {
+        /* Shutdown the write direction as well, to make sure that any active
+        `send_message` calls get interrupted and don't stop us from destructing
+        the `connection_t`. */
+        c->shutdown_write();
+    }
+}
+
+void connectivity_cluster_t::run_t::open_lanes(
+        const peer_id_t &other_id,
+        const ip_and_port_t &address,
+        auto_drainer_t::lock_t drainer_lock,
+        std::vector<scoped_ptr_t<keepalive_tcp_conn_stream_t> > *lanes_out)
+        THROWS_NOTHING {
+    parent->assert_thread();
+    signal_timer_t timeout;
+    timeout.start(LANE_SETUP_TIMEOUT_MS);
+    wait_any_t interruptor(&timeout, drainer_lock.get_drain_signal());
+    pmap(connections_per_peer - 1, [&](int) {
+        scoped_ptr_t<keepalive_tcp_conn_stream_t> lane;
+        if (connect_lane(other_id, address, &interruptor, &lane)) {
+            lanes_out->push_back(std::move(lane));
+        }
+    });
+}
+
+bool connectivity_cluster_t::run_t::connect_lane(
+        const peer_id_t &other_id,
+        const ip_and_port_t &address,
+        signal_t *interruptor,
+        scoped_ptr_t<keepalive_tcp_conn_stream_t> *lane_out) THROWS_NOTHING {
+    const std::string peerstr = address.to_string();
+    const char *peername = peerstr.c_str();
+    scoped_ptr_t<keepalive_tcp_conn_stream_t> lane;
+    try {
+        lane.init(new keepalive_tcp_conn_stream_t(
+            tls_ctx, address.ip(), address.port().value(), interruptor));
+    } catch (const tcp_conn_t::connect_failed_exc_t &) {
+        return false;
+    } catch (const crypto::openssl_error_t &) {
+        return false;
+    } catch (const interrupted_exc_t &) {
+        return false;
+    }
+
+    cluster_conn_closing_subscription_t lane_closer(lane.get());
+    lane_closer.reset(interruptor);
+
+    {
+        write_message_t wm;
+        wm.append(cluster_lane_header.c_str(), cluster_lane_header.length());
+        serialize_universal(&wm, parent->me);
+        if (send_write_message(lane.get(), &wm)) {
+            return false; // network error.
+        }
+    }
+
+    /* The other side greets us the same way as for a new connection before it finds
+    out that this is a lane. We only check that it's the server we expect. */
+    {
+        scoped_array_t<char> header(cluster_proto_header.length());
+        int64_t r = force_read(lane.get(), header.data(), header.size());
+        if (r != static_cast<int64_t>(header.size())
+            || std::string(header.data(), header.size()) != cluster_proto_header) {
+            return false;
+        }
+        std::string remote_version_string, remote_arch_bitsize, remote_build_mode;
+        server_id_t remote_server_id;
+        bool remote_has_admin_password;
+        peer_id_t remote_id;
+        std::set<host_and_port_t> remote_hosts;
+        if (!deserialize_compatible_string(lane.get(), &remote_version_string, peername)
+            || deserialize_universal_and_check(lane.get(), &remote_server_id, peername)
+            || !deserialize_compatible_string(lane.get(), &remote_arch_bitsize, peername)
+            || !deserialize_compatible_string(lane.get(), &remote_build_mode, peername)
+            || deserialize_universal_and_check(
+                lane.get(), &remote_has_admin_password, peername)
+            || deserialize_universal_and_check(lane.get(), &remote_id, peername)
+            || deserialize_universal_and_check(lane.get(), &remote_hosts, peername)) {
+            return false;
+        }
+        if (remote_id != other_id) {
+            return false;
+        }
+    }
+
+    handshake_result_t handshake_result;
+    if (deserialize_universal_and_check(lane.get(), &handshake_result, peername)) {
+        return false;
+    }
+    if (handshake_result.get_code() != handshake_result_code_t::SUCCESS) {
+        logWRN("Peer %s refused an extra cluster connection, reason: \"%s\"",
+               peername,
+               sanitize_for_logger(handshake_result.get_error_reason()).c_str());
+        return false;
+    }
+
+    if (interruptor->is_pulsed()) {
+        return false;
+    }
+    *lane_out = std::move(lane);
+    return true;
+}
+
+void connectivity_cluster_t::run_t::accept_lane(
+        scoped_ptr_t<keepalive_tcp_conn_stream_t> &&c,
+        auto_drainer_t::lock_t drainer_lock) THROWS_NOTHING {
+    parent->assert_thread();
+    scoped_ptr_t<keepalive_tcp_conn_stream_t> lane(std::move(c));
+
+    ip_and_port_t peer_addr;
+    std::string peerstr = "(unknown)";
+    if (lane->get_underlying_conn()->getpeername(&peer_addr))
+        peerstr = peer_addr.to_string();
+    const char *peername = peerstr.c_str();
+
+    peer_id_t other_id;
+    {
+        cluster_conn_closing_subscription_t lane_closer(lane.get());
+        lane_closer.reset(drainer_lock.get_drain_signal());
+        if (deserialize_universal_and_check(lane.get(), &other_id, peername)) {
+            return;
+        }
+    }
+
+    std::map<uint64_t, parked_lane_t> *parked = &parked_lanes[other_id];
+    if (static_cast<int>(parked->size()) >= connections_per_peer - 1) {
+        fail_handshake(lane.get(), peername, handshake_result_t::error(
+            handshake_result_code_t::LANE_REJECTED,
+            strprintf("this server accepts at most %d connections per peer",
+                      connections_per_peer)));
+        if (parked->empty()) {
+            parked_lanes.erase(other_id);
+        }
+        return;
+    }
+
+    /* We park the lane before telling the other side that we have accepted it, so
+    that it's parked by the time the other side sends us its routing table. */
+    const uint64_t lane_id = next_parked_lane_id++;
+    keepalive_tcp_conn_stream_t *lane_ptr = lane.get();
+    cond_t claimed;
+    parked->insert(std::make_pair(lane_id, parked_lane_t(std::move(lane), &claimed)));
+    {
+        write_message_t wm;
+        serialize_universal(&wm, handshake_result_t::success());
+        if (send_write_message(lane_ptr, &wm)) {
+            // Network error. We drop the lane below.
+        } else {
+            signal_timer_t timeout;
+            timeout.start(LANE_SETUP_TIMEOUT_MS);
+            wait_any_t waiter(&claimed, &timeout, drainer_lock.get_drain_signal());
+            waiter.wait_lazily_unordered();
+        }
+    }
+
+    /* If the connection hasn't claimed the lane by now, something went wrong, and we
+    close it. The entry must be gone before `claimed` goes out of scope. */
+    auto it = parked_lanes.find(other_id);
+    if (it != parked_lanes.end()) {
+        it->second.erase(lane_id);
+        if (it->second.empty()) {
+            parked_lanes.erase(it);
+        }
+    }
+}
+
+void connectivity_cluster_t::run_t::claim_lanes(
+        const peer_id_t &other_id,
+        const ip_address_t &other_ip,
+        std::vector<scoped_ptr_t<keepalive_tcp_conn_stream_t> > *lanes_out)
+        THROWS_NOTHING {
+    parent->assert_thread();
+    auto it = parked_lanes.find(other_id);
+    if (it == parked_lanes.end()) {
+        return;
+    }
+    for (auto &pair : it->second) {
+        /* Only accept lanes that come from the same address as the connection. The
+        others are closed below. */
+        ip_and_port_t lane_addr;
+        if (pair.second.conn->get_underlying_conn()->getpeername(&lane_addr)
+            && lane_addr.ip() == other_ip) {
+            lanes_out->push_back(std::move(pair.second.conn));
+        }
+        /* Either way `accept_lane()` doesn't have to wait for the lane anymore */
+        pair.second.claimed->pulse_if_not_already_pulsed();
+    }
+    parked_lanes.erase(it);
+}
+
 connectivity_cluster_t::connectivity_cluster_t() THROWS_NOTHING :
     me(peer_id_t(generate_uuid())),
     /* We assign threads from the highest thread number downwards. This is to reduce the
@@ -1405,7 +2004,14 @@ connectivity_cluster_t::connectivity_cluster_t() THROWS_NOTHING :
     }),
     current_run(nullptr),
     connectivity_collection(),
-    stats_membership(&get_global_perfmon_collection(), &connectivity_collection, "connectivity")
+    stats_membership(&get_global_perfmon_collection(), &connectivity_collection, "connectivity"),
+    pm_compression_input_bytes(get_num_threads()),
+    pm_compression_output_bytes(get_num_threads()),
+    pm_compression_nsecs(get_num_threads()),
+    pm_compression_membership(&connectivity_collection,
+        &pm_compression_input_bytes, "compression_input_bytes",
+        &pm_compression_output_bytes, "compression_output_bytes",
+        &pm_compression_nsecs, "compression_nsecs")
 {
     for (int i = 0; i < max_message_tag; i++) {
         message_handlers[i] = nullptr;
@@ -1468,25 +2074,24 @@ connectivity_cluster_t::connection_t *connectivity_cluster_t::get_connection(
 void connectivity_cluster_t::send_message(connection_t *connection,
                                      auto_drainer_t::lock_t connection_keepalive,
                                      message_tag_t tag,
-                                     cluster_send_message_write_callback_t *callback) {
+                                     uint64_t stream_key,
+                                     cluster_send_message_write_callback_t *callback,
+                                     cluster_message_class_t message_class) {
     // We could be on _any_ thread.
 
     /* If the connection is being closed, just drop the message now. It's not going
-    to actually get sent anyway. That way we avoid getting in line for the send_mutex. */
+    to actually get sent anyway. That way we avoid getting in line for the lane. */
     if (connection_keepalive.get_drain_signal()->is_pulsed()) {
         return;
     }
 
-    /* We currently write the message to a vector_stream_t, then
-       serialize that as a string. It's horribly inefficient, of course. */
-    // TODO: If we don't do it this way, we (or the caller) will need
-    // to worry about having the writer run on the connection thread.
-    vector_stream_t buffer;
-    // Reserve some space to reduce overhead (especially for small messages)
-    buffer.reserve(1024);
+    /* We serialize the message on the calling thread, so that the callback doesn't
+    have to worry about running on the lane's thread. `wm` is a chain of buffers that
+    we later write to the network without flattening it. */
+    write_message_t wm;
     {
         ASSERT_FINITE_CORO_WAITING;
-        callback->write(&buffer);
+        callback->write(&wm);
     }
 
 #ifdef CLUSTER_MESSAGE_DEBUGGING
@@ -1495,9 +2100,12 @@ void connectivity_cluster_t::send_message(connection_t *connection,
         buf.appendf("from ");
         debug_print(&buf, me);
         buf.appendf(" to ");
-        debug_print(&buf, dest);
+        debug_print(&buf, connection->get_peer_id());
         buf.appendf("\n");
-        print_hd(buffer.vector().data(), 0, buffer.vector().size());
+        intrusive_list_t<write_buffer_t> *chunks = wm.unsafe_expose_buffers();
+        for (write_buffer_t *p = chunks->head(); p != nullptr; p = chunks->next(p)) {
+            print_hd(p->data, 0, p->size);
+        }
     }
 #endif
 
@@ -1511,7 +2119,7 @@ void connectivity_cluster_t::send_message(connection_t *connection,
     }
 #endif
 
-    size_t bytes_sent = buffer.vector().size();
+    size_t bytes_sent = wm.size();
 
 #ifdef ENABLE_MESSAGE_PROFILER
     std::pair<uint64_t, uint64_t> *stats =
@@ -1522,68 +2130,34 @@ void connectivity_cluster_t::send_message(connection_t *connection,
 
     if (connection->is_loopback()) {
         // We could be on any thread here! Oh no!
+        vector_stream_t buffer;
+        buffer.reserve(bytes_sent);
+        int res = send_write_message(&buffer, &wm);
+        guarantee(res == 0);
         std::vector<char> buffer_data;
         buffer.swap(&buffer_data);
         rassert(message_handlers[tag], "No message handler for tag %" PRIu8, tag);
         message_handlers[tag]->on_local_message(connection, connection_keepalive,
             std::move(buffer_data));
     } else {
-        on_thread_t threader(connection->conn->home_thread());
+        connection_t::lane_t *lane = connection->get_lane(stream_key);
+        on_thread_t threader(lane->conn->home_thread());
 
-        /* Acquire the send-mutex so we don't collide with other things trying
-        to send on the same connection. */
-        {
-            /* The `true` is for eager waiting, which is a significant performance
-            optimization in this case. */
-            mutex_t::acq_t acq(&connection->send_mutex, true);
-
-            /* Write the tag to the network */
-            {
-                // All cluster versions use a uint8_t tag here.
-                write_message_t wm;
-                static_assert(std::is_same<message_tag_t, uint8_t>::value,
-                              "We expect to be serializing a uint8_t -- if this has "
-                              "changed, the cluster communication format has changed and "
-                              "you need to ask yourself whether live cluster upgrades work."
-                              );
-                serialize_universal(&wm, tag);
-                make_buffered_tcp_conn_stream_wrapper_t buffered_conn(connection->conn);
-                int res = send_write_message(&buffered_conn, &wm);
-                if (res == -1) {
-                    /* Close the other half of the connection to make sure that
-                       `connectivity_cluster_t::run_t::handle()` notices that something is
-                       up */
-                    if (connection->conn->is_read_open()) {
-                        connection->conn->shutdown_read();
-                    }
-                    return;
-                }
-            }
-
-            /* Write the message itself to the network */
-            {
-                int64_t res = connection->conn->write_buffered(buffer.vector().data(),
-                                                               buffer.vector().size());
-                if (res == -1) {
-                    if (connection->conn->is_read_open()) {
-                        connection->conn->shutdown_read();
-                    }
-                    return;
-                } else {
-                    guarantee(res == static_cast<int64_t>(buffer.vector().size()));
-                }
-            }
-        } /* Releases the send_mutex */
+        if (!lane->write_message(tag, &wm, message_class)) {
+            return;
+        }
 
-        connection->flusher.notify();
+        lane->flusher.notify();
         cond_t dummy_interruptor;
-        connection->flusher.flush(&dummy_interruptor);
-        if (!connection->conn->is_write_open()) {
-            if (connection->conn->is_read_open()) {
-                connection->conn->shutdown_read();
+        lane->flusher.flush(&dummy_interruptor);
+        if (!lane->conn->is_write_open()) {
+            if (lane->conn->is_read_open()) {
+                lane->conn->shutdown_read();
             }
             return;
         }
+
+        lane->pm_bytes_sent.record(bytes_sent);
     }
 
     connection->pm_bytes_sent.record(bytes_sent);
@@ -1598,6 +2172,9 @@ cluster_message_handler_t::cluster_message_handler_t(
     rassert(tag != connectivity_cluster_t::heartbeat_tag,
         "Tag %" PRIu8 " is reserved for heartbeat messages.",
         connectivity_cluster_t::heartbeat_tag);
+    rassert(tag != connectivity_cluster_t::compressed_tag,
+        "Tag %" PRIu8 " is reserved for compressed messages.",
+        connectivity_cluster_t::compressed_tag);
     rassert(connectivity_cluster->message_handlers[tag] == nullptr);
     connectivity_cluster->message_handlers[tag] = this;
 }
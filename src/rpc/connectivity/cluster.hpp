@@ -11,11 +11,16 @@
 #include "arch/types.hpp"
 #include "arch/io/openssl.hpp"
 #include "concurrency/auto_drainer.hpp"
+#include "concurrency/cond_var.hpp"
+#include "concurrency/coro_pool.hpp"
 #include "concurrency/mutex.hpp"
 #include "concurrency/one_per_thread.hpp"
+#include "concurrency/queue/accounting.hpp"
+#include "concurrency/queue/unlimited_fifo.hpp"
 #include "concurrency/watchable_map.hpp"
 #include "containers/archive/tcp_conn_stream.hpp"
 #include "containers/map_sentries.hpp"
+#include "containers/scoped.hpp"
 #include "concurrency/pump_coro.hpp"
 #include "perfmon/perfmon.hpp"
 #include "random.hpp"
@@ -24,6 +29,7 @@
 #include "utils.hpp"
 
 class auth_semilattice_metadata_t;
+class cluster_compressor_t;
 class cluster_message_handler_t;
 class co_semaphore_t;
 class heartbeat_semilattice_metadata_t;
@@ -38,6 +44,19 @@ enum class join_result_t {
 
 typedef std::map<ip_and_port_t, join_result_t> join_results_t;
 
+/* Every cluster message is sent in one of these classes. When messages of several
+classes are waiting to be written to the same lane of a connection, the lane takes
+turns between the classes in proportion to fixed shares, so a pile of big bulk messages
+can't hold up a latency-critical message for more than a message or two. */
+enum class cluster_message_class_t {
+    /* Heartbeats and Raft traffic, which time out if they're held up. */
+    CRITICAL = 0,
+    /* Queries and most everything else. */
+    NORMAL = 1,
+    /* Big messages whose latency doesn't matter much, like backfill chunks. */
+    BULK = 2
+};
+
 /* Uncomment this to enable message profiling. Message profiling will keep track of how
 many messages of each type are sent over the network; it will dump the results to a file
 named `msg_profiler_out_PID.txt` on shutdown. Each line of that file will be of the
@@ -52,8 +71,9 @@ class cluster_send_message_write_callback_t {
 public:
     virtual ~cluster_send_message_write_callback_t() { }
     // write() doesn't take a version argument because the version is always
-    // cluster_version_t::CLUSTER for cluster messages.
-    virtual void write(write_stream_t *stream) = 0;
+    // cluster_version_t::CLUSTER for cluster messages. Big messages are sent straight
+    // from the buffers of `wm`, so serializing into it is the only copy we make.
+    virtual void write(write_message_t *wm) = 0;
 
 #ifdef ENABLE_MESSAGE_PROFILER
     /* This should return a string that describes the type of message being sent for
@@ -77,15 +97,25 @@ connection. Once a connection is established, messages can be sent across it in
 directions. Every message is guaranteed to eventually arrive unless the connection goes
 down. Messages cannot be duplicated.
 
-Can messages be reordered? I think the current implementation doesn't ever reorder
-messages, but don't rely on this guarantee. However, some old code may rely on this
-guarantee (I'm not sure) so don't break this property without checking first. */
+A connection to another server may be made up of several TCP connections, called
+"lanes", each of which is served by a different thread. This lets us use more than one
+core and more than one socket buffer for the traffic to a single peer. Every message is
+sent with a "stream key", and messages with the same stream key always travel over the
+same lane, so they arrive in the order they were sent, as long as they're also in the
+same `cluster_message_class_t`. Messages with different stream keys can be reordered
+with respect to each other if there is more than one lane, and messages in different
+classes can overtake each other on the same lane. Only messages with the same stream key
+and class are never reordered, and some old code may rely on more than that, so check
+before sending related messages with different stream keys or classes. */
 
 class connectivity_cluster_t :
     public home_thread_mixin_debug_only_t
 {
 public:
     static const std::string cluster_proto_header;
+    /* Sent instead of `cluster_proto_header` when opening an extra lane for an existing
+    connection. */
+    static const std::string cluster_lane_header;
     static const std::string cluster_version_string;
     static const std::string cluster_arch_bitsize;
     static const std::string cluster_build_mode;
@@ -101,6 +131,13 @@ public:
     /* This tag is reserved exclusively for heartbeat messages. */
     static const message_tag_t heartbeat_tag = 'H';
 
+    /* This tag is reserved for compressed messages. If both servers support it, a
+    connection can compress the messages that are bigger than the sender's compression
+    threshold. A compressed message is sent with this tag, followed by its size before
+    and after compression and the compressed data, which contains the message's real
+    tag and the message itself. */
+    static const message_tag_t compressed_tag = 'Z';
+
     class run_t;
 
     /* `connection_t` represents an open connection to another server. If we lose
@@ -143,16 +180,89 @@ public:
     private:
         friend class connectivity_cluster_t;
 
+        /* A `lane_t` is one of the TCP connections that make up a `connection_t`. It
+        lives on the home thread of its `conn`. */
+        class lane_t {
+        public:
+            /* If `compression_threshold` is non-zero, messages at least that big are
+            compressed. */
+            lane_t(connectivity_cluster_t *cluster,
+                   keepalive_tcp_conn_stream_t *conn,
+                   size_t compression_threshold,
+                   perfmon_collection_t *pm_collection,
+                   const std::string &pm_name);
+            ~lane_t();
+
+            /* Writes the tag and the serialized message to `conn`, but doesn't flush
+            it. If other messages are already waiting for the lane, the message waits
+            in the queue for its class until the writer picks it. Returns `false` if the
+            write failed, in which case it also shuts down the reading half of `conn`. */
+            bool write_message(message_tag_t tag,
+                               write_message_t *msg,
+                               cluster_message_class_t message_class);
+
+            keepalive_tcp_conn_stream_t *const conn;
+
+            /* Held while writing to or flushing `conn`. */
+            mutex_t send_mutex;
+
+            /* Calls `conn->flush_buffer()`. Can be used for making sure that a
+            buffered write makes it to the TCP stack. */
+            pump_coro_t flusher;
+
+            perfmon_sampler_t pm_bytes_sent;
+            perfmon_membership_t pm_bytes_sent_membership;
+
+        private:
+            struct pending_write_t;
+
+            bool write_now(message_tag_t tag, write_message_t *msg);
+            void on_write_dequeued(pending_write_t *pending_write);
+
+            /* When a message can't be written right away we put it in the queue for
+            its class. `write_queue` picks from the class queues by their shares, and
+            `writer` writes the messages it picks one at a time. `num_pending_writes`
+            counts the messages that are queued or being written by `writer`; while it's
+            non-zero, new messages must get in line so that they don't overtake messages
+            of the same class. */
+            unlimited_fifo_queue_t<pending_write_t *> class_queues[3];
+            accounting_queue_t<pending_write_t *> write_queue;
+            scoped_ptr_t<accounting_queue_t<pending_write_t *>::account_t>
+                class_accounts[3];
+            std_function_callback_t<pending_write_t *> writer_callback;
+            coro_pool_t<pending_write_t *> writer;
+            int num_pending_writes;
+
+            connectivity_cluster_t *const cluster;
+
+            /* Our end of the compressed stream, if we compress messages on this
+            lane. Only used while holding `send_mutex`. */
+            const size_t compression_threshold;
+            scoped_ptr_t<cluster_compressor_t> compressor;
+
+            DISABLE_COPYING(lane_t);
+        };
+
         /* The constructor registers us in every thread's `connections` map, thereby
-        notifying event subscribers. */
+        notifying event subscribers. `extra_lanes` are the TCP connections to the peer
+        other than `conn`; they may already be on other threads than `conn`. Messages at
+        least `compression_threshold` bytes big are compressed, unless it's zero. */
         connection_t(
             run_t *,
             const peer_id_t &peer_id,
             const server_id_t &server_id,
             keepalive_tcp_conn_stream_t *,
+            const std::vector<keepalive_tcp_conn_stream_t *> &extra_lanes,
+            size_t compression_threshold,
             const peer_address_t &peer_address) THROWS_NOTHING;
         ~connection_t() THROWS_NOTHING;
 
+        /* Returns the lane that messages with the given stream key are sent over. */
+        lane_t *get_lane(uint64_t stream_key);
+
+        /* Shuts down every lane. Unlike `kill_connection()`, this switches threads. */
+        void shutdown_lanes();
+
         /* NULL for the loopback connection (i.e. our "connection" to ourself) */
         keepalive_tcp_conn_stream_t *conn;
 
@@ -161,17 +271,16 @@ public:
         cross-thread to access the routing table. */
         peer_address_t peer_address;
 
-        /* Unused for our connection to ourself */
-        mutex_t send_mutex;
-
-        /* Calls `conn->flush_buffer()`. Can be used for making sure that a
-        buffered write makes it to the TCP stack. */
-        pump_coro_t flusher;
-
+        /* `pm_bytes_sent` counts the bytes sent over all lanes, and each lane also
+        counts its own. */
         perfmon_collection_t pm_collection;
         perfmon_sampler_t pm_bytes_sent;
         perfmon_membership_t pm_collection_membership, pm_bytes_sent_membership;
 
+        /* Empty for our connection to ourself. Otherwise `lanes[0]` is the lane for
+        `conn`. Every lane carries its own heartbeats. */
+        std::vector<scoped_ptr_t<lane_t> > lanes;
+
         /* We only hold this information so we can deregister ourself */
         run_t *parent;
 
@@ -195,6 +304,8 @@ public:
               const int join_delay_secs,
               int port,
               int client_port,
+              int connections_per_peer,
+              size_t compression_threshold,
               std::shared_ptr<semilattice_read_view_t<
                   heartbeat_semilattice_metadata_t> > heartbeat_sl_view,
               std::shared_ptr<semilattice_read_view_t<
@@ -276,17 +387,59 @@ public:
         connect-notification, receiving messages from the peer until it
         disconnects or we are shut down, and sending out the
         disconnect-notification. It returns a join_result_t indicating the outcome
-        of the attempted join. */
+        of the attempted join.
+
+        If `is_lane_out` is non-NULL and the other server turns out to be opening an
+        extra lane for an existing connection rather than a new connection, `handle()`
+        sets `*is_lane_out` to `true` and returns right after reading the header, so
+        that the caller can pass the TCP connection on to `accept_lane()`. */
         join_result_t handle(keepalive_tcp_conn_stream_t *c,
             optional<peer_id_t> expected_id,
             optional<peer_address_t> expected_address,
             optional<server_id_t> expected_server_id,
             auto_drainer_t::lock_t,
             bool *successful_join_inout,
-            const int join_delay_secs) THROWS_NOTHING;
+            const int join_delay_secs,
+            bool *is_lane_out) THROWS_NOTHING;
+
+        /* Reads messages off of one of the lanes of `connection` until it's closed. */
+        void handle_messages(connection_t *connection,
+                             keepalive_tcp_conn_stream_t *c) THROWS_NOTHING;
+
+        /* Extra lanes are always opened by the leader (see `handle()`), after it has
+        registered the connection and before it sends its routing table to the
+        follower. `open_lanes()` opens them on the leader's side. On the follower's
+        side `accept_lane()` puts them into `parked_lanes` until the follower receives
+        the routing table and takes them out with `claim_lanes()`. Lanes that nobody
+        claims are closed after a while. */
+        void open_lanes(const peer_id_t &other_id,
+                        const ip_and_port_t &address,
+                        auto_drainer_t::lock_t drainer_lock,
+                        std::vector<scoped_ptr_t<keepalive_tcp_conn_stream_t> > *lanes_out)
+            THROWS_NOTHING;
+        bool connect_lane(const peer_id_t &other_id,
+                          const ip_and_port_t &address,
+                          signal_t *interruptor,
+                          scoped_ptr_t<keepalive_tcp_conn_stream_t> *lane_out)
+            THROWS_NOTHING;
+        void accept_lane(scoped_ptr_t<keepalive_tcp_conn_stream_t> &&c,
+                         auto_drainer_t::lock_t drainer_lock) THROWS_NOTHING;
+        void claim_lanes(const peer_id_t &other_id,
+                         const ip_address_t &other_ip,
+                         std::vector<scoped_ptr_t<keepalive_tcp_conn_stream_t> > *lanes_out)
+            THROWS_NOTHING;
 
         connectivity_cluster_t *parent;
 
+        /* The number of TCP connections we open to each peer, including the one the
+        connection was established over. */
+        const int connections_per_peer;
+
+        /* We compress the messages we send that are at least this big, if the other
+        server supports compression. Zero means we never compress them. We always
+        accept compressed messages. */
+        const size_t compression_threshold;
+
         /* The server's own id and the set of servers we are connected to, we only allow
         a single connection per server. */
         server_id_t server_id;
@@ -313,6 +466,21 @@ public:
         redundant connections to the same peer. */
         mutex_t new_connection_mutex;
 
+        /* Extra lanes that other servers have opened to us, but that haven't been
+        claimed by their connection yet, by an ID that `accept_lane()` assigns.
+        `accept_lane()` waits on `claimed` until `claim_lanes()` takes the lane out, or
+        until it gives up on it. */
+        class parked_lane_t {
+        public:
+            parked_lane_t(scoped_ptr_t<keepalive_tcp_conn_stream_t> &&_conn,
+                          cond_t *_claimed) :
+                conn(std::move(_conn)), claimed(_claimed) { }
+            scoped_ptr_t<keepalive_tcp_conn_stream_t> conn;
+            cond_t *claimed;
+        };
+        std::map<peer_id_t, std::map<uint64_t, parked_lane_t> > parked_lanes;
+        uint64_t next_parked_lane_id;
+
         scoped_ptr_t<tcp_bound_socket_t> cluster_listener_socket;
         int cluster_listener_port;
         int cluster_client_port;
@@ -355,11 +523,16 @@ public:
 
     /* Sends a message to the other server. The message is associated with a "tag",
     which determines which message handler on the other server will receive the message.
-    */
+    Messages with the same `stream_key` are sent over the same lane of the connection
+    (see the comment above `connectivity_cluster_t`), and `message_class` decides how
+    the message is scheduled on that lane. */
     void send_message(connection_t *connection,
                       auto_drainer_t::lock_t connection_keepalive,
                       message_tag_t tag,
-                      cluster_send_message_write_callback_t *callback);
+                      uint64_t stream_key,
+                      cluster_send_message_write_callback_t *callback,
+                      cluster_message_class_t message_class =
+                          cluster_message_class_t::NORMAL);
 
 private:
     friend class cluster_message_handler_t;
@@ -397,6 +570,14 @@ private:
     perfmon_collection_t connectivity_collection;
     perfmon_membership_t stats_membership;
 
+    /* How many bytes of messages we have compressed, how many bytes they compressed
+    to, and how many nanoseconds we have spent compressing and decompressing
+    messages. */
+    perfmon_counter_t pm_compression_input_bytes;
+    perfmon_counter_t pm_compression_output_bytes;
+    perfmon_counter_t pm_compression_nsecs;
+    perfmon_multi_membership_t pm_compression_membership;
+
     DISABLE_COPYING(connectivity_cluster_t);
 };
 
@@ -0,0 +1,81 @@
+// Copyright 2010-2016 RethinkDB, all rights reserved.
+#include "rpc/connectivity/compression.hpp"
+
+#include <string.h>
+#include <zlib.h>
+
+#include "containers/archive/archive.hpp"
+
+// How much compressed output we collect before appending it to the output message
+#define COMPRESSION_OUTPUT_CHUNK_SIZE (16 * KILOBYTE)
+
+cluster_compressor_t::cluster_compressor_t() : stream(new z_stream) {
+    memset(stream.get(), 0, sizeof(z_stream));
+    /* We favor speed over ratio, because the compression runs on the thread that
+    serves the connection. */
+    int res = deflateInit(stream.get(), Z_BEST_SPEED);
+    guarantee(res == Z_OK, "deflateInit failed: %d", res);
+}
+
+cluster_compressor_t::~cluster_compressor_t() {
+    deflateEnd(stream.get());
+}
+
+void cluster_compressor_t::compress_message(
+        uint8_t tag, write_message_t *msg, write_message_t *out) {
+    deflate_data(&tag, sizeof(tag), Z_NO_FLUSH, out);
+    intrusive_list_t<write_buffer_t> *chunks = msg->unsafe_expose_buffers();
+    for (write_buffer_t *p = chunks->head(); p != nullptr; p = chunks->next(p)) {
+        deflate_data(p->data, p->size, Z_NO_FLUSH, out);
+    }
+    /* `Z_SYNC_FLUSH` makes the stream byte-aligned and emits everything we have fed
+    to it so far, without resetting the compression state. */
+    deflate_data(nullptr, 0, Z_SYNC_FLUSH, out);
+}
+
+void cluster_compressor_t::deflate_data(
+        const void *data, size_t size, int flush, write_message_t *out) {
+    char buffer[COMPRESSION_OUTPUT_CHUNK_SIZE];
+    stream->next_in = reinterpret_cast<Bytef *>(const_cast<void *>(data));
+    stream->avail_in = size;
+    do {
+        stream->next_out = reinterpret_cast<Bytef *>(buffer);
+        stream->avail_out = sizeof(buffer);
+        int res = deflate(stream.get(), flush);
+        guarantee(res == Z_OK || res == Z_BUF_ERROR, "deflate failed: %d", res);
+        out->append(buffer, sizeof(buffer) - stream->avail_out);
+        /* If `deflate()` filled the whole buffer it may have more output pending. */
+    } while (stream->avail_in > 0 || stream->avail_out == 0);
+}
+
+cluster_decompressor_t::cluster_decompressor_t() : stream(new z_stream) {
+    memset(stream.get(), 0, sizeof(z_stream));
+    int res = inflateInit(stream.get());
+    guarantee(res == Z_OK, "inflateInit failed: %d", res);
+}
+
+cluster_decompressor_t::~cluster_decompressor_t() {
+    inflateEnd(stream.get());
+}
+
+bool cluster_decompressor_t::decompress_message(
+        const std::vector<char> &in, std::vector<char> *out) {
+    stream->next_in = reinterpret_cast<Bytef *>(const_cast<char *>(in.data()));
+    stream->avail_in = in.size();
+    stream->next_out = reinterpret_cast<Bytef *>(out->data());
+    stream->avail_out = out->size();
+    /* The sender flushed after the message, so all of it can be decompressed now. The
+    flush marker at the end doesn't need any room in the output. */
+    while (stream->avail_in > 0) {
+        uInt avail_in_before = stream->avail_in;
+        int res = inflate(stream.get(), Z_SYNC_FLUSH);
+        if (res != Z_OK && res != Z_BUF_ERROR) {
+            return false;
+        }
+        if (stream->avail_in == avail_in_before) {
+            /* No progress, so the data decompresses to more than we have room for. */
+            return false;
+        }
+    }
+    return stream->avail_out == 0;
+}
@@ -0,0 +1,57 @@
+// Copyright 2010-2016 RethinkDB, all rights reserved.
+#ifndef RPC_CONNECTIVITY_COMPRESSION_HPP_
+#define RPC_CONNECTIVITY_COMPRESSION_HPP_
+
+#include <stdint.h>
+
+#include <vector>
+
+#include "containers/scoped.hpp"
+#include "errors.hpp"
+
+class write_message_t;
+struct z_stream_s;
+
+/* `cluster_compressor_t` and `cluster_decompressor_t` are the two ends of the deflate
+stream that a lane of a cluster connection carries when compression is on (see
+`connectivity_cluster_t`). Only the messages that the sender decides to compress go
+through the stream. Each of them is flushed on its own, so that the receiver can
+decompress it as soon as it arrives, but the compression state carries over from one
+message to the next. That way field names and values that keep coming up compress well
+even when the messages are small. */
+
+class cluster_compressor_t {
+public:
+    cluster_compressor_t();
+    ~cluster_compressor_t();
+
+    /* Compresses `tag` followed by the contents of `msg`, and appends the output to
+    `out`. */
+    void compress_message(uint8_t tag, write_message_t *msg, write_message_t *out);
+
+private:
+    void deflate_data(const void *data, size_t size, int flush, write_message_t *out);
+
+    scoped_ptr_t<z_stream_s> stream;
+
+    DISABLE_COPYING(cluster_compressor_t);
+};
+
+class cluster_decompressor_t {
+public:
+    cluster_decompressor_t();
+    ~cluster_decompressor_t();
+
+    /* Decompresses the output of one call to `compress_message()` into `out`, which must
+    already have the size of the uncompressed message. Returns `false` if the data is
+    corrupt or doesn't decompress to exactly that size. */
+    MUST_USE bool decompress_message(const std::vector<char> &in,
+                                     std::vector<char> *out);
+
+private:
+    scoped_ptr_t<z_stream_s> stream;
+
+    DISABLE_COPYING(cluster_decompressor_t);
+};
+
+#endif  // RPC_CONNECTIVITY_COMPRESSION_HPP_
@@ -6,6 +6,7 @@
 
 #include "concurrency/wait_any.hpp"
 #include "containers/archive/optional.hpp"
+#include "containers/archive/stl_types.hpp"
 
 template<class key_t, class value_t>
 directory_map_read_manager_t<key_t, value_t>::directory_map_read_manager_t(
@@ -33,21 +34,19 @@ void directory_map_read_manager_t<key_t, value_t>::on_message(
     if (res != archive_result_t::SUCCESS) {
         throw fake_archive_exc_t();
     }
-    key_t key;
-    res = deserialize<cluster_version_t::CLUSTER>(s, &key);
-    if (res != archive_result_t::SUCCESS) {
-        throw fake_archive_exc_t();
-    }
-    optional<value_t> value;
-    res = deserialize<cluster_version_t::CLUSTER>(s, &value);
+    std::vector<std::pair<key_t, optional<value_t> > > updates;
+    res = deserialize<cluster_version_t::CLUSTER>(s, &updates);
     if (res != archive_result_t::SUCCESS) {
         throw fake_archive_exc_t();
     }
+    /* A message carries a batch of updates (see `directory_map_write_manager_t`). We
+    apply all of them in one coroutine, so we only switch to the home thread once per
+    batch. */
     auto_drainer_t::lock_t this_keepalive(per_thread_drainers.get());
     coro_t::spawn_sometime(std::bind(
         &directory_map_read_manager_t::do_update, this,
         connection->get_peer_id(), connection_keepalive, this_keepalive,
-        timestamp, key, value));
+        timestamp, std::move(updates)));
 }
 
 template<class key_t, class value_t>
@@ -56,8 +55,7 @@ void directory_map_read_manager_t<key_t, value_t>::do_update(
         auto_drainer_t::lock_t connection_keepalive,
         auto_drainer_t::lock_t this_keepalive,
         uint64_t timestamp,
-        const key_t &key,
-        const optional<value_t> &value) {
+        const std::vector<std::pair<key_t, optional<value_t> > > &updates) {
     /* If we're the first call to `do_update()` for this connection, then we create the
     entry in `timestamps` for this peer, and then the coroutine stays alive and waits for
     the connection to end so it can clean up. If we're not the first call to
@@ -68,24 +66,28 @@ void directory_map_read_manager_t<key_t, value_t>::do_update(
         auto pair = timestamps.insert(std::make_pair(
             peer_id, std::map<key_t, uint64_t>()));
         should_cleanup = pair.second;
-        /* If there's no entry in `timestamps` for this key, or there is an entry but the
-        timestamp is earlier, then we should deliver our update. Otherwise, we shouldn't,
-        because we don't want to overwrite a later value. */
-        auto pair2 = pair.first->second.insert(std::make_pair(key, timestamp));
-        bool should_update = false;
-        if (pair2.second) {
-            should_update = true;
-        } else {
-            if (pair2.first->second < timestamp) {
-                pair2.first->second = timestamp;
+        for (const auto &update : updates) {
+            const key_t &key = update.first;
+            const optional<value_t> &value = update.second;
+            /* If there's no entry in `timestamps` for this key, or there is an entry
+            but the timestamp is earlier, then we should deliver our update. Otherwise,
+            we shouldn't, because we don't want to overwrite a later value. */
+            auto pair2 = pair.first->second.insert(std::make_pair(key, timestamp));
+            bool should_update = false;
+            if (pair2.second) {
                 should_update = true;
-            }
-        }
-        if (should_update) {
-            if (static_cast<bool>(value)) {
-                map_var.set_key_no_equals(std::make_pair(peer_id, key), *value);
             } else {
-                map_var.delete_key(std::make_pair(peer_id, key));
+                if (pair2.first->second < timestamp) {
+                    pair2.first->second = timestamp;
+                    should_update = true;
+                }
+            }
+            if (should_update) {
+                if (static_cast<bool>(value)) {
+                    map_var.set_key_no_equals(std::make_pair(peer_id, key), *value);
+                } else {
+                    map_var.delete_key(std::make_pair(peer_id, key));
+                }
             }
         }
     }
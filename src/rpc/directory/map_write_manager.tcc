@@ -6,6 +6,7 @@
 
 #include "concurrency/wait_any.hpp"
 #include "containers/archive/optional.hpp"
+#include "containers/archive/stl_types.hpp"
 
 template<class key_t, class value_t>
 directory_map_write_manager_t<key_t, value_t>::directory_map_write_manager_t(
@@ -36,24 +37,27 @@ directory_map_write_manager_t<key_t, value_t>::directory_map_write_manager_t(
 {
 }
 
+/* `DIRECTORY_MAP_MAX_KEYS_PER_MESSAGE` is how many key-value pairs we put into a single
+message at most. On a cluster with tens of thousands of tables, the initial exchange
+after a connection comes up and mass changes like a `reconfigure` of every table would
+otherwise cost one message per table, so the per-message overhead on both ends
+dominates. */
+static const size_t DIRECTORY_MAP_MAX_KEYS_PER_MESSAGE = 100;
+
 template<class key_t, class value_t>
 class directory_map_write_manager_t<key_t, value_t>::update_writer_t :
     public cluster_send_message_write_callback_t
 {
 public:
-    update_writer_t(
-            uint64_t _timestamp, const key_t &_key, optional<value_t> &&_value) :
-        timestamp(_timestamp), key(_key), value(std::move(_value)) { }
+    explicit update_writer_t(uint64_t _timestamp) : timestamp(_timestamp) { }
 
-    void write(write_stream_t *s) {
-        write_message_t wm;
-        serialize<cluster_version_t::CLUSTER>(&wm, timestamp);
-        serialize<cluster_version_t::CLUSTER>(&wm, key);
-        serialize<cluster_version_t::CLUSTER>(&wm, value);
-        int res = send_write_message(s, &wm);
-        if (res) {
-            throw fake_archive_exc_t();
-        }
+    void add(const key_t &key, optional<value_t> &&value) {
+        updates.push_back(std::make_pair(key, std::move(value)));
+    }
+
+    void write(write_message_t *wm) {
+        serialize<cluster_version_t::CLUSTER>(wm, timestamp);
+        serialize<cluster_version_t::CLUSTER>(wm, updates);
     }
 
 #ifdef ENABLE_MESSAGE_PROFILER
@@ -66,8 +70,7 @@ public:
 
 private:
     uint64_t timestamp;
-    key_t key;
-    optional<value_t> value;
+    std::vector<std::pair<key_t, optional<value_t> > > updates;
 };
 
 template<class key_t, class value_t>
@@ -114,18 +117,27 @@ void directory_map_write_manager_t<key_t, value_t>::stream_to_conn(
             issues. */
             std::set<key_t> dirty_keys;
             std::swap(dirty_keys, conns_entry->second.dirty_keys);
-            for (const key_t &key : dirty_keys) {
+            auto it = dirty_keys.begin();
+            while (it != dirty_keys.end()) {
                 if (interruptor.is_pulsed()) {
                     throw interrupted_exc_t();
                 }
-                /* If the key changed again since we copied `dirty_keys`, we'll be
-                sending the newest value, because we didn't copy the value at the same
-                time as we copied `dirty_keys`. So it's OK to remove the key from
-                `dirty_keys` to prevent sending a redundant message. */
-                conns_entry->second.dirty_keys.erase(key);
-                update_writer_t writer(timestamp, key, value->get_key(key));
+                /* Batch up to `DIRECTORY_MAP_MAX_KEYS_PER_MESSAGE` keys into one
+                message. We read the values and the timestamp without blocking in
+                between, so the batch is a consistent snapshot of `value`.
+                If a key changed again since we copied `dirty_keys`, we'll be sending
+                the newest value, because we didn't copy the value at the same time as
+                we copied `dirty_keys`. So it's OK to remove the key from `dirty_keys`
+                to prevent sending a redundant message. */
+                update_writer_t writer(timestamp);
+                for (size_t n = 0;
+                        n < DIRECTORY_MAP_MAX_KEYS_PER_MESSAGE && it != dirty_keys.end();
+                        ++n, ++it) {
+                    conns_entry->second.dirty_keys.erase(*it);
+                    writer.add(*it, value->get_key(*it));
+                }
                 connectivity_cluster->send_message(
-                    connection, connection_keepalive, message_tag, &writer);
+                    connection, connection_keepalive, message_tag, 0, &writer);
             }
         }
     } catch (const interrupted_exc_t &) {
@@ -25,30 +25,24 @@ public:
         subwriter(_subwriter) { }
     virtual ~raw_mailbox_writer_t() { }
 
-    void write(write_stream_t *stream) {
-        write_message_t wm;
+    void write(write_message_t *wm) {
         // Right now, we serialize this length/thread/mailbox information the same
         // way irrespective of version. (Serialization methods for primitive types
         // all behave the same way anyway -- this is just for performance, avoiding
         // unnecessary branching on cluster_version.)  See read_mailbox_header for
         // the deserialization.
-        serialize_universal(&wm, dest_thread);
-        serialize_universal(&wm, dest_mailbox_id);
-        uint64_t prefix_length = static_cast<uint64_t>(wm.size());
+        rassert(wm->size() == 0);
+        serialize_universal(wm, dest_thread);
+        serialize_universal(wm, dest_mailbox_id);
+        uint64_t prefix_length = static_cast<uint64_t>(wm->size());
 
-        subwriter->write(cluster_version_t::CLUSTER, &wm);
+        subwriter->write(cluster_version_t::CLUSTER, wm);
 
         // Prepend the message length.
-        // TODO: It would be more efficient if we could make this part of `msg`.
-        //  e.g. with a `prepend()` method on write_message_t.
         write_message_t length_msg;
         serialize_universal(&length_msg,
-                            static_cast<uint64_t>(wm.size()) - prefix_length);
-
-        int res = send_write_message(stream, &length_msg);
-        if (res) { throw fake_archive_exc_t(); }
-        res = send_write_message(stream, &wm);
-        if (res) { throw fake_archive_exc_t(); }
+                            static_cast<uint64_t>(wm->size()) - prefix_length);
+        wm->prepend(&length_msg);
     }
 
 #ifdef ENABLE_MESSAGE_PROFILER
@@ -64,10 +58,15 @@ private:
 };
 
 void send_write(mailbox_manager_t *src, raw_mailbox_t::address_t dest,
-                mailbox_write_callback_t *callback) {
+                mailbox_write_callback_t *callback,
+                cluster_message_class_t message_class) {
     guarantee(src);
     guarantee(!dest.is_nil());
-    new_semaphore_in_line_t acq(src->semaphores.get(), 1);
+    new_semaphore_in_line_t acq(
+        message_class == cluster_message_class_t::BULK
+            ? src->bulk_semaphores.get()
+            : src->semaphores.get(),
+        1);
     acq.acquisition_signal()->wait();
     connectivity_cluster_t::connection_t *connection;
     auto_drainer_t::lock_t connection_keepalive;
@@ -76,8 +75,10 @@ void send_write(mailbox_manager_t *src, raw_mailbox_t::address_t dest,
         return;
     }
     raw_mailbox_writer_t writer(dest.thread, dest.mailbox_id, callback);
+    /* Messages to the same mailbox go over the same lane of the connection, so they
+    arrive in order if they're in the same class. */
     src->get_connectivity_cluster()->send_message(connection, connection_keepalive,
-        src->get_message_tag(), &writer);
+        src->get_message_tag(), dest.mailbox_id, &writer, message_class);
 }
 
 static const int MAX_OUTSTANDING_MAILBOX_WRITES_PER_THREAD = 4;
@@ -85,7 +86,8 @@ static const int MAX_OUTSTANDING_MAILBOX_WRITES_PER_THREAD = 4;
 mailbox_manager_t::mailbox_manager_t(connectivity_cluster_t *_connectivity_cluster,
         connectivity_cluster_t::message_tag_t message_tag) :
     cluster_message_handler_t(_connectivity_cluster, message_tag),
-    semaphores(MAX_OUTSTANDING_MAILBOX_WRITES_PER_THREAD)
+    semaphores(MAX_OUTSTANDING_MAILBOX_WRITES_PER_THREAD),
+    bulk_semaphores(MAX_OUTSTANDING_MAILBOX_WRITES_PER_THREAD)
     { }
 
 mailbox_manager_t::mailbox_table_t::mailbox_table_t() {
@@ -104,7 +106,7 @@ mailbox_manager_t::mailbox_table_t::~mailbox_table_t() {
 }
 
 raw_mailbox_t *mailbox_manager_t::mailbox_table_t::find_mailbox(raw_mailbox_t::id_t id) {
-    std::map<raw_mailbox_t::id_t, raw_mailbox_t *>::iterator it = mailboxes.find(id);
+    auto it = mailboxes.find(id);
     if (it == mailboxes.end()) {
         return nullptr;
     } else {
@@ -112,6 +114,14 @@ raw_mailbox_t *mailbox_manager_t::mailbox_table_t::find_mailbox(raw_mailbox_t::i
     }
 }
 
+mailbox_manager_t::delivery_queues_t::delivery_queues_t() :
+    batches(get_num_threads()),
+    batch_scheduled(get_num_threads(), false) { }
+
+mailbox_manager_t::delivery_queues_t::~delivery_queues_t() {
+    drainer.drain();
+}
+
 // This type merely reduces the amount of pointers we have to pass to read_mailbox_header().
 struct mailbox_header_t {
     uint64_t data_length;
@@ -132,7 +142,11 @@ void read_mailbox_header(read_stream_t *stream,
     }
     header_out->data_length = data_length;
     res = deserialize_universal(stream, &header_out->dest_thread);
-    if (bad(res)) { throw fake_archive_exc_t(); }
+    if (bad(res)
+        || header_out->dest_thread < 0
+        || header_out->dest_thread >= get_num_threads()) {
+        throw fake_archive_exc_t();
+    }
     res = deserialize_universal(stream, &header_out->dest_mailbox_id);
     if (bad(res)) { throw fake_archive_exc_t(); }
 }
@@ -184,15 +198,68 @@ void mailbox_manager_t::on_message(
         throw fake_archive_exc_t();
     }
 
-    // We use `spawn_now_dangerously()` to avoid having to heap-allocate `stream_data`.
-    // Instead we pass in a pointer to our local automatically allocated object
-    // and `mailbox_read_coroutine()` moves the data out of it before it yields.
-    coro_t::spawn_now_dangerously(
-        [this, mbox_header, &stream_data]() {
-            mailbox_read_coroutine(
-                threadnum_t(mbox_header.dest_thread), mbox_header.dest_mailbox_id,
-                &stream_data, 0, MAYBE_YIELD);
-        });
+    threadnum_t dest_thread(mbox_header.dest_thread);
+    if (dest_thread == get_thread_id()) {
+        deliver_message(mbox_header.dest_mailbox_id, &stream_data, 0);
+        return;
+    }
+
+    delivery_queues_t *queues = delivery_queues.get();
+    if (queues->drainer.is_draining()) {
+        // We're shutting down.
+        return;
+    }
+    queues->batches[dest_thread.threadnum].push_back(
+        pending_message_t{mbox_header.dest_mailbox_id, std::move(stream_data)});
+    if (!queues->batch_scheduled[dest_thread.threadnum]) {
+        queues->batch_scheduled[dest_thread.threadnum] = true;
+        auto_drainer_t::lock_t keepalive(&queues->drainer);
+        coro_t::spawn_sometime(std::bind(&mailbox_manager_t::deliver_batch,
+                                         this, dest_thread, keepalive));
+    }
+}
+
+void mailbox_manager_t::deliver_batch(threadnum_t dest_thread,
+                                      auto_drainer_t::lock_t keepalive) {
+    keepalive.assert_is_holding(&delivery_queues.get()->drainer);
+    // Messages that arrive from now on go into the next batch.
+    std::vector<pending_message_t> batch;
+    batch.swap(delivery_queues.get()->batches[dest_thread.threadnum]);
+    delivery_queues.get()->batch_scheduled[dest_thread.threadnum] = false;
+
+    on_thread_t thread_switcher(dest_thread);
+    for (pending_message_t &message : batch) {
+        deliver_message(message.dest_mailbox_id, &message.data, 0);
+    }
+}
+
+void mailbox_manager_t::deliver_message(raw_mailbox_t::id_t dest_mailbox_id,
+                                        std::vector<char> *stream_data,
+                                        int64_t stream_data_offset) {
+    raw_mailbox_t *mbox = mailbox_tables.get()->find_mailbox(dest_mailbox_id);
+    if (mbox == nullptr) {
+        return;
+    }
+    if (mbox->delivery == mailbox_delivery_t::INLINE) {
+        vector_read_stream_t stream(std::move(*stream_data), stream_data_offset);
+        try {
+            ASSERT_FINITE_CORO_WAITING;
+            auto_drainer_t::lock_t keepalive(&mbox->drainer);
+            mbox->callback->read(&stream, keepalive.get_drain_signal());
+        } catch (const fake_archive_exc_t &e) {
+            logWRN("Received an invalid cluster message from a peer.");
+        }
+    } else {
+        // We use `spawn_now_dangerously()` to avoid having to heap-allocate
+        // `stream_data`. `mailbox_read_coroutine()` moves the data out of it before it
+        // yields.
+        coro_t::spawn_now_dangerously(
+            [this, dest_mailbox_id, stream_data, stream_data_offset]() {
+                mailbox_read_coroutine(
+                    get_thread_id(), dest_mailbox_id,
+                    stream_data, stream_data_offset, MAYBE_YIELD);
+            });
+    }
 }
 
 void mailbox_manager_t::mailbox_read_coroutine(
@@ -240,10 +307,7 @@ raw_mailbox_t::id_t mailbox_manager_t::generate_mailbox_id() {
 
 raw_mailbox_t::id_t mailbox_manager_t::register_mailbox(raw_mailbox_t *mb) {
     raw_mailbox_t::id_t id = generate_mailbox_id();
-    std::map<raw_mailbox_t::id_t, raw_mailbox_t *> *mailboxes =
-        &mailbox_tables.get()->mailboxes;
-    std::pair<std::map<raw_mailbox_t::id_t, raw_mailbox_t *>::iterator, bool> res
-        = mailboxes->insert(std::make_pair(id, mb));
+    auto res = mailbox_tables.get()->mailboxes.insert(std::make_pair(id, mb));
     guarantee(res.second);  // Assert a new element was inserted.
     return id;
 }
@@ -2,14 +2,15 @@
 #ifndef RPC_MAILBOX_MAILBOX_HPP_
 #define RPC_MAILBOX_MAILBOX_HPP_
 
-#include <map>
 #include <string>
 #include <vector>
 
 #include "backtrace.hpp"
+#include "concurrency/auto_drainer.hpp"
 #include "concurrency/new_semaphore.hpp"
 #include "containers/archive/archive.hpp"
 #include "containers/archive/vector_stream.hpp"
+#include "containers/open_hash_map.hpp"
 #include "rpc/connectivity/cluster.hpp"
 #include "rpc/mailbox/raw_mailbox.hpp"
 #include "rpc/semilattice/joins/macros.hpp"
@@ -18,11 +19,15 @@ class mailbox_manager_t;
 
 /* `send_write()` sends a message to a mailbox. `send_write()` can block and must be called
 in a coroutine. If the mailbox does not exist or the peer is disconnected, `send_write()`
-will silently fail. Mailbox messages are not necessarily delivered in order. */
+will silently fail. Mailbox messages are not necessarily delivered in order.
+`message_class` says how urgent the message is compared to other traffic to the same
+server (see `cluster_message_class_t`); `BULK` messages also don't count against the
+limit on outstanding mailbox writes that other messages have to wait for. */
 
 void send_write(mailbox_manager_t *src,
                 raw_mailbox_t::address_t dest,
-                mailbox_write_callback_t *callback);
+                mailbox_write_callback_t *callback,
+                cluster_message_class_t message_class = cluster_message_class_t::NORMAL);
 
 /* `mailbox_manager_t` is a `cluster_message_handler_t` that takes care
 of actually routing messages to mailboxes. */
@@ -34,22 +39,48 @@ public:
 
 private:
     friend class raw_mailbox_t;
-    friend void send_write(mailbox_manager_t *, raw_mailbox_t::address_t, mailbox_write_callback_t *callback);
+    friend void send_write(mailbox_manager_t *, raw_mailbox_t::address_t,
+                           mailbox_write_callback_t *callback,
+                           cluster_message_class_t message_class);
 
     struct mailbox_table_t {
         mailbox_table_t();
         ~mailbox_table_t();
         raw_mailbox_t::id_t next_mailbox_id;
-        // TODO: use a buffered structure to reduce dynamic allocation
-        std::map<raw_mailbox_t::id_t, raw_mailbox_t *> mailboxes;
+        /* Every incoming message is looked up here, and reply mailboxes come and go
+        all the time, so we keep the entries in one flat array rather than allocating
+        a tree node per mailbox. */
+        open_hash_map_t<raw_mailbox_t::id_t, raw_mailbox_t *> mailboxes;
         raw_mailbox_t *find_mailbox(raw_mailbox_t::id_t);
     };
     one_per_thread_t<mailbox_table_t> mailbox_tables;
 
+    /* Messages for mailboxes on other threads aren't sent across one at a time.
+    Instead `on_message()` appends them to the batch for the destination thread, and a
+    single coroutine carries the whole batch over with one thread switch. Under load the
+    connection reads many messages before that coroutine gets to run, so consecutive
+    messages to the same mailbox (or just to the same thread) are delivered together. */
+    struct pending_message_t {
+        raw_mailbox_t::id_t dest_mailbox_id;
+        std::vector<char> data;
+    };
+    struct delivery_queues_t {
+        delivery_queues_t();
+        ~delivery_queues_t();
+        // Indexed by destination thread
+        std::vector<std::vector<pending_message_t> > batches;
+        // Whether a coroutine has been spawned to deliver the batch
+        std::vector<bool> batch_scheduled;
+        auto_drainer_t drainer;
+    };
+    one_per_thread_t<delivery_queues_t> delivery_queues;
+
     /* We must acquire one of these semaphores whenever we want to send a message over a
     mailbox. This prevents mailbox messages from starving directory and semilattice
-    messages. */
+    messages. `BULK` messages use `bulk_semaphores` instead, so that a backfill that is
+    blocked on a slow connection doesn't hold up queries on the same thread. */
     one_per_thread_t<new_semaphore_t> semaphores;
+    one_per_thread_t<new_semaphore_t> bulk_semaphores;
 
     raw_mailbox_t::id_t generate_mailbox_id();
 
@@ -68,6 +99,14 @@ private:
                           auto_drainer_t::lock_t connection_keepalive,
                           std::vector<char> &&data);
 
+    void deliver_batch(threadnum_t dest_thread, auto_drainer_t::lock_t keepalive);
+
+    /* Must be called on the mailbox's thread. Runs `INLINE` callbacks right away and
+    spawns a coroutine for the others. */
+    void deliver_message(raw_mailbox_t::id_t dest_mailbox_id,
+                         std::vector<char> *stream_data,
+                         int64_t stream_data_offset);
+
     enum force_yield_t {FORCE_YIELD, MAYBE_YIELD};
     void mailbox_read_coroutine(threadnum_t dest_thread,
                                 raw_mailbox_t::id_t dest_mailbox_id,
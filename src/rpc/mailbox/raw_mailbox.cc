@@ -23,10 +23,12 @@ std::string raw_mailbox_t::address_t::human_readable() const {
     return strprintf("%s:%d:%" PRIu64, uuid_to_str(peer.get_uuid()).c_str(), thread, mailbox_id);
 }
 
-raw_mailbox_t::raw_mailbox_t(mailbox_manager_t *m, mailbox_read_callback_t *_callback) :
+raw_mailbox_t::raw_mailbox_t(mailbox_manager_t *m, mailbox_read_callback_t *_callback,
+                             mailbox_delivery_t _delivery) :
     manager(m),
     mailbox_id(manager->register_mailbox(this)),
-    callback(_callback) {
+    callback(_callback),
+    delivery(_delivery) {
     guarantee(callback != nullptr);
 }
 
@@ -7,10 +7,19 @@
 #include "rpc/semilattice/joins/macros.hpp"
 #include "threading.hpp"
 
+enum class cluster_message_class_t;
 class mailbox_manager_t;
 class mailbox_read_callback_t;
 class mailbox_write_callback_t;
 
+/* `mailbox_delivery_t` says how a mailbox's callback is run when a message arrives.
+`COROUTINE` callbacks get a coroutine of their own and may block. `INLINE` callbacks are
+called directly on the mailbox's thread, from the code that delivers the message, which
+saves spawning a coroutine per message; they must not block (this is checked with
+`ASSERT_FINITE_CORO_WAITING` in debug mode). Use `INLINE` for callbacks that just record
+the message somewhere and pulse a signal, like reply mailboxes. */
+enum class mailbox_delivery_t { COROUTINE, INLINE };
+
 class raw_mailbox_t : public home_thread_mixin_t {
 public:
     struct address_t;
@@ -23,7 +32,8 @@ public:
 private:
     friend class mailbox_manager_t;
     friend class raw_mailbox_writer_t;
-    friend void send_write(mailbox_manager_t *, address_t, mailbox_write_callback_t *);
+    friend void send_write(mailbox_manager_t *, address_t, mailbox_write_callback_t *,
+                           cluster_message_class_t);
 
     mailbox_manager_t *manager;
 
@@ -34,6 +44,8 @@ private:
     the destructor won't call `begin_shutdown()` again. */
     mailbox_read_callback_t *callback;
 
+    const mailbox_delivery_t delivery;
+
     auto_drainer_t drainer;
 
     DISABLE_COPYING(raw_mailbox_t);
@@ -69,7 +81,9 @@ public:
         RDB_MAKE_ME_SERIALIZABLE_3(address_t, peer, thread, mailbox_id);
 
     private:
-        friend void send_write(mailbox_manager_t *, raw_mailbox_t::address_t, mailbox_write_callback_t *callback);
+        friend void send_write(mailbox_manager_t *, raw_mailbox_t::address_t,
+                               mailbox_write_callback_t *callback,
+                               cluster_message_class_t message_class);
         friend class raw_mailbox_t;
         friend class mailbox_manager_t;
 
@@ -83,7 +97,9 @@ public:
         id_t mailbox_id;
     };
 
-    raw_mailbox_t(mailbox_manager_t *, mailbox_read_callback_t *callback);
+    raw_mailbox_t(mailbox_manager_t *,
+                  mailbox_read_callback_t *callback,
+                  mailbox_delivery_t delivery = mailbox_delivery_t::COROUTINE);
 
     /* Note that `~raw_mailbox_t()` will block until all of the callbacks have finished
     running. */
@@ -7,6 +7,7 @@
 
 #include "containers/archive/versioned.hpp"
 #include "containers/archive/tuple.hpp"
+#include "rpc/connectivity/cluster.hpp"
 #include "rpc/serialize_macros.hpp"
 #include "rpc/mailbox/raw_mailbox.hpp"
 #include "rpc/semilattice/joins/macros.hpp"
@@ -52,13 +53,23 @@ public:
 private:
     template <class... Args2>
     friend void send(mailbox_manager_t *, mailbox_addr_t<Args2...>, const Args2 &... args);
+    template <class... Args2>
+    friend void send(mailbox_manager_t *,
+                     cluster_message_class_t,
+                     mailbox_addr_t<Args2...>,
+                     const Args2 &... args);
+    template <class... Args2>
+    friend void send_write(mailbox_manager_t *,
+                           mailbox_addr_t<Args2...>,
+                           mailbox_write_callback_t *);
 
     raw_mailbox_t::address_t addr;
 };
 
 /* `mailbox_t` is a receiver of messages. Construct it with a callback function
 to handle messages it receives. To send messages to the mailbox, call the
-`get_address()` method and then call `send_write()` on the address it returns. */
+`get_address()` method and then call `send_write()` on the address it returns. Pass
+`mailbox_delivery_t::INLINE` if the callback never blocks (see `raw_mailbox.hpp`). */
 
 template <class... Args>
 class mailbox_t {
@@ -84,8 +95,9 @@ public:
     typedef mailbox_addr_t<Args...> address_t;
 
     mailbox_t(mailbox_manager_t *manager,
-              const std::function< void(signal_t *, Args...)> &f) :
-        reader(this), fun(f), mailbox(manager, &reader)
+              const std::function< void(signal_t *, Args...)> &f,
+              mailbox_delivery_t delivery = mailbox_delivery_t::COROUTINE) :
+        reader(this), fun(f), mailbox(manager, &reader, delivery)
         { }
 
     void begin_shutdown() {
@@ -128,7 +140,29 @@ public:
 template <class... Args>
 void send(mailbox_manager_t *src, mailbox_addr_t<Args...> dest, const Args &... args) {
     mailbox_write_impl<Args...> writer(args...);
-    send_write(src, dest.addr, &writer);
+    send_write(src, dest.addr, &writer, cluster_message_class_t::NORMAL);
+}
+
+/* Like `send()`, but the message is sent in the given class rather than `NORMAL`. All the
+messages to a mailbox should use the same class, since messages in different classes
+can overtake each other. */
+template <class... Args>
+void send(mailbox_manager_t *src,
+          cluster_message_class_t message_class,
+          mailbox_addr_t<Args...> dest,
+          const Args &... args) {
+    mailbox_write_impl<Args...> writer(args...);
+    send_write(src, dest.addr, &writer, message_class);
+}
+
+/* Like `send()`, but `writer` serializes the arguments.  It must write exactly what
+`mailbox_write_impl<Args...>` would.  This is for senders that send the same big
+message to many mailboxes, so they can serialize the common part only once. */
+template <class... Args>
+void send_write(mailbox_manager_t *src,
+                mailbox_addr_t<Args...> dest,
+                mailbox_write_callback_t *writer) {
+    send_write(src, dest.addr, writer, cluster_message_class_t::NORMAL);
 }
 
 #endif // RPC_MAILBOX_TYPED_HPP_
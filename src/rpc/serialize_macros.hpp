@@ -132,6 +132,10 @@ struct always_false
 #define RDB_IMPL_SERIALIZABLE_0_SINCE_v2_4(type_t) \
     RDB_IMPL_SERIALIZABLE_0(type_t); \
     INSTANTIATE_SERIALIZABLE_SINCE_v2_4(type_t)
+
+#define RDB_IMPL_SERIALIZABLE_0_SINCE_v2_5(type_t) \
+    RDB_IMPL_SERIALIZABLE_0(type_t); \
+    INSTANTIATE_SERIALIZABLE_SINCE_v2_5(type_t)
 #define RDB_MAKE_ME_SERIALIZABLE_0(type_t) \
     template <cluster_version_t W> \
     friend void serialize(UNUSED write_message_t *wm, UNUSED const type_t &thing) { \
@@ -201,6 +205,10 @@ struct always_false
 #define RDB_IMPL_SERIALIZABLE_1_SINCE_v2_4(type_t, field1) \
     RDB_IMPL_SERIALIZABLE_1(type_t, field1); \
     INSTANTIATE_SERIALIZABLE_SINCE_v2_4(type_t)
+
+#define RDB_IMPL_SERIALIZABLE_1_SINCE_v2_5(type_t, field1) \
+    RDB_IMPL_SERIALIZABLE_1(type_t, field1); \
+    INSTANTIATE_SERIALIZABLE_SINCE_v2_5(type_t)
 #define RDB_MAKE_ME_SERIALIZABLE_1(type_t, field1) \
     template <cluster_version_t W> \
     friend void serialize(write_message_t *wm, const type_t &thing) { \
@@ -280,6 +288,10 @@ struct always_false
 #define RDB_IMPL_SERIALIZABLE_2_SINCE_v2_4(type_t, field1, field2) \
     RDB_IMPL_SERIALIZABLE_2(type_t, field1, field2); \
     INSTANTIATE_SERIALIZABLE_SINCE_v2_4(type_t)
+
+#define RDB_IMPL_SERIALIZABLE_2_SINCE_v2_5(type_t, field1, field2) \
+    RDB_IMPL_SERIALIZABLE_2(type_t, field1, field2); \
+    INSTANTIATE_SERIALIZABLE_SINCE_v2_5(type_t)
 #define RDB_MAKE_ME_SERIALIZABLE_2(type_t, field1, field2) \
     template <cluster_version_t W> \
     friend void serialize(write_message_t *wm, const type_t &thing) { \
@@ -369,6 +381,10 @@ struct always_false
 #define RDB_IMPL_SERIALIZABLE_3_SINCE_v2_4(type_t, field1, field2, field3) \
     RDB_IMPL_SERIALIZABLE_3(type_t, field1, field2, field3); \
     INSTANTIATE_SERIALIZABLE_SINCE_v2_4(type_t)
+
+#define RDB_IMPL_SERIALIZABLE_3_SINCE_v2_5(type_t, field1, field2, field3) \
+    RDB_IMPL_SERIALIZABLE_3(type_t, field1, field2, field3); \
+    INSTANTIATE_SERIALIZABLE_SINCE_v2_5(type_t)
 #define RDB_MAKE_ME_SERIALIZABLE_3(type_t, field1, field2, field3) \
     template <cluster_version_t W> \
     friend void serialize(write_message_t *wm, const type_t &thing) { \
@@ -468,6 +484,10 @@ struct always_false
 #define RDB_IMPL_SERIALIZABLE_4_SINCE_v2_4(type_t, field1, field2, field3, field4) \
     RDB_IMPL_SERIALIZABLE_4(type_t, field1, field2, field3, field4); \
     INSTANTIATE_SERIALIZABLE_SINCE_v2_4(type_t)
+
+#define RDB_IMPL_SERIALIZABLE_4_SINCE_v2_5(type_t, field1, field2, field3, field4) \
+    RDB_IMPL_SERIALIZABLE_4(type_t, field1, field2, field3, field4); \
+    INSTANTIATE_SERIALIZABLE_SINCE_v2_5(type_t)
 #define RDB_MAKE_ME_SERIALIZABLE_4(type_t, field1, field2, field3, field4) \
     template <cluster_version_t W> \
     friend void serialize(write_message_t *wm, const type_t &thing) { \
@@ -577,6 +597,10 @@ struct always_false
 #define RDB_IMPL_SERIALIZABLE_5_SINCE_v2_4(type_t, field1, field2, field3, field4, field5) \
     RDB_IMPL_SERIALIZABLE_5(type_t, field1, field2, field3, field4, field5); \
     INSTANTIATE_SERIALIZABLE_SINCE_v2_4(type_t)
+
+#define RDB_IMPL_SERIALIZABLE_5_SINCE_v2_5(type_t, field1, field2, field3, field4, field5) \
+    RDB_IMPL_SERIALIZABLE_5(type_t, field1, field2, field3, field4, field5); \
+    INSTANTIATE_SERIALIZABLE_SINCE_v2_5(type_t)
 #define RDB_MAKE_ME_SERIALIZABLE_5(type_t, field1, field2, field3, field4, field5) \
     template <cluster_version_t W> \
     friend void serialize(write_message_t *wm, const type_t &thing) { \
@@ -696,6 +720,10 @@ struct always_false
 #define RDB_IMPL_SERIALIZABLE_6_SINCE_v2_4(type_t, field1, field2, field3, field4, field5, field6) \
     RDB_IMPL_SERIALIZABLE_6(type_t, field1, field2, field3, field4, field5, field6); \
     INSTANTIATE_SERIALIZABLE_SINCE_v2_4(type_t)
+
+#define RDB_IMPL_SERIALIZABLE_6_SINCE_v2_5(type_t, field1, field2, field3, field4, field5, field6) \
+    RDB_IMPL_SERIALIZABLE_6(type_t, field1, field2, field3, field4, field5, field6); \
+    INSTANTIATE_SERIALIZABLE_SINCE_v2_5(type_t)
 #define RDB_MAKE_ME_SERIALIZABLE_6(type_t, field1, field2, field3, field4, field5, field6) \
     template <cluster_version_t W> \
     friend void serialize(write_message_t *wm, const type_t &thing) { \
@@ -825,6 +853,10 @@ struct always_false
 #define RDB_IMPL_SERIALIZABLE_7_SINCE_v2_4(type_t, field1, field2, field3, field4, field5, field6, field7) \
     RDB_IMPL_SERIALIZABLE_7(type_t, field1, field2, field3, field4, field5, field6, field7); \
     INSTANTIATE_SERIALIZABLE_SINCE_v2_4(type_t)
+
+#define RDB_IMPL_SERIALIZABLE_7_SINCE_v2_5(type_t, field1, field2, field3, field4, field5, field6, field7) \
+    RDB_IMPL_SERIALIZABLE_7(type_t, field1, field2, field3, field4, field5, field6, field7); \
+    INSTANTIATE_SERIALIZABLE_SINCE_v2_5(type_t)
 #define RDB_MAKE_ME_SERIALIZABLE_7(type_t, field1, field2, field3, field4, field5, field6, field7) \
     template <cluster_version_t W> \
     friend void serialize(write_message_t *wm, const type_t &thing) { \
@@ -964,6 +996,10 @@ struct always_false
 #define RDB_IMPL_SERIALIZABLE_8_SINCE_v2_4(type_t, field1, field2, field3, field4, field5, field6, field7, field8) \
     RDB_IMPL_SERIALIZABLE_8(type_t, field1, field2, field3, field4, field5, field6, field7, field8); \
     INSTANTIATE_SERIALIZABLE_SINCE_v2_4(type_t)
+
+#define RDB_IMPL_SERIALIZABLE_8_SINCE_v2_5(type_t, field1, field2, field3, field4, field5, field6, field7, field8) \
+    RDB_IMPL_SERIALIZABLE_8(type_t, field1, field2, field3, field4, field5, field6, field7, field8); \
+    INSTANTIATE_SERIALIZABLE_SINCE_v2_5(type_t)
 #define RDB_MAKE_ME_SERIALIZABLE_8(type_t, field1, field2, field3, field4, field5, field6, field7, field8) \
     template <cluster_version_t W> \
     friend void serialize(write_message_t *wm, const type_t &thing) { \
@@ -1113,6 +1149,10 @@ struct always_false
 #define RDB_IMPL_SERIALIZABLE_9_SINCE_v2_4(type_t, field1, field2, field3, field4, field5, field6, field7, field8, field9) \
     RDB_IMPL_SERIALIZABLE_9(type_t, field1, field2, field3, field4, field5, field6, field7, field8, field9); \
     INSTANTIATE_SERIALIZABLE_SINCE_v2_4(type_t)
+
+#define RDB_IMPL_SERIALIZABLE_9_SINCE_v2_5(type_t, field1, field2, field3, field4, field5, field6, field7, field8, field9) \
+    RDB_IMPL_SERIALIZABLE_9(type_t, field1, field2, field3, field4, field5, field6, field7, field8, field9); \
+    INSTANTIATE_SERIALIZABLE_SINCE_v2_5(type_t)
 #define RDB_MAKE_ME_SERIALIZABLE_9(type_t, field1, field2, field3, field4, field5, field6, field7, field8, field9) \
     template <cluster_version_t W> \
     friend void serialize(write_message_t *wm, const type_t &thing) { \
@@ -1272,6 +1312,10 @@ struct always_false
 #define RDB_IMPL_SERIALIZABLE_10_SINCE_v2_4(type_t, field1, field2, field3, field4, field5, field6, field7, field8, field9, field10) \
     RDB_IMPL_SERIALIZABLE_10(type_t, field1, field2, field3, field4, field5, field6, field7, field8, field9, field10); \
     INSTANTIATE_SERIALIZABLE_SINCE_v2_4(type_t)
+
+#define RDB_IMPL_SERIALIZABLE_10_SINCE_v2_5(type_t, field1, field2, field3, field4, field5, field6, field7, field8, field9, field10) \
+    RDB_IMPL_SERIALIZABLE_10(type_t, field1, field2, field3, field4, field5, field6, field7, field8, field9, field10); \
+    INSTANTIATE_SERIALIZABLE_SINCE_v2_5(type_t)
 #define RDB_MAKE_ME_SERIALIZABLE_10(type_t, field1, field2, field3, field4, field5, field6, field7, field8, field9, field10) \
     template <cluster_version_t W> \
     friend void serialize(write_message_t *wm, const type_t &thing) { \
@@ -1441,6 +1485,10 @@ struct always_false
 #define RDB_IMPL_SERIALIZABLE_11_SINCE_v2_4(type_t, field1, field2, field3, field4, field5, field6, field7, field8, field9, field10, field11) \
     RDB_IMPL_SERIALIZABLE_11(type_t, field1, field2, field3, field4, field5, field6, field7, field8, field9, field10, field11); \
     INSTANTIATE_SERIALIZABLE_SINCE_v2_4(type_t)
+
+#define RDB_IMPL_SERIALIZABLE_11_SINCE_v2_5(type_t, field1, field2, field3, field4, field5, field6, field7, field8, field9, field10, field11) \
+    RDB_IMPL_SERIALIZABLE_11(type_t, field1, field2, field3, field4, field5, field6, field7, field8, field9, field10, field11); \
+    INSTANTIATE_SERIALIZABLE_SINCE_v2_5(type_t)
 #define RDB_MAKE_ME_SERIALIZABLE_11(type_t, field1, field2, field3, field4, field5, field6, field7, field8, field9, field10, field11) \
     template <cluster_version_t W> \
     friend void serialize(write_message_t *wm, const type_t &thing) { \
@@ -1620,6 +1668,10 @@ struct always_false
 #define RDB_IMPL_SERIALIZABLE_12_SINCE_v2_4(type_t, field1, field2, field3, field4, field5, field6, field7, field8, field9, field10, field11, field12) \
     RDB_IMPL_SERIALIZABLE_12(type_t, field1, field2, field3, field4, field5, field6, field7, field8, field9, field10, field11, field12); \
     INSTANTIATE_SERIALIZABLE_SINCE_v2_4(type_t)
+
+#define RDB_IMPL_SERIALIZABLE_12_SINCE_v2_5(type_t, field1, field2, field3, field4, field5, field6, field7, field8, field9, field10, field11, field12) \
+    RDB_IMPL_SERIALIZABLE_12(type_t, field1, field2, field3, field4, field5, field6, field7, field8, field9, field10, field11, field12); \
+    INSTANTIATE_SERIALIZABLE_SINCE_v2_5(type_t)
 #define RDB_MAKE_ME_SERIALIZABLE_12(type_t, field1, field2, field3, field4, field5, field6, field7, field8, field9, field10, field11, field12) \
     template <cluster_version_t W> \
     friend void serialize(write_message_t *wm, const type_t &thing) { \
@@ -1809,6 +1861,10 @@ struct always_false
 #define RDB_IMPL_SERIALIZABLE_13_SINCE_v2_4(type_t, field1, field2, field3, field4, field5, field6, field7, field8, field9, field10, field11, field12, field13) \
     RDB_IMPL_SERIALIZABLE_13(type_t, field1, field2, field3, field4, field5, field6, field7, field8, field9, field10, field11, field12, field13); \
     INSTANTIATE_SERIALIZABLE_SINCE_v2_4(type_t)
+
+#define RDB_IMPL_SERIALIZABLE_13_SINCE_v2_5(type_t, field1, field2, field3, field4, field5, field6, field7, field8, field9, field10, field11, field12, field13) \
+    RDB_IMPL_SERIALIZABLE_13(type_t, field1, field2, field3, field4, field5, field6, field7, field8, field9, field10, field11, field12, field13); \
+    INSTANTIATE_SERIALIZABLE_SINCE_v2_5(type_t)
 #define RDB_MAKE_ME_SERIALIZABLE_13(type_t, field1, field2, field3, field4, field5, field6, field7, field8, field9, field10, field11, field12, field13) \
     template <cluster_version_t W> \
     friend void serialize(write_message_t *wm, const type_t &thing) { \
@@ -2008,6 +2064,10 @@ struct always_false
 #define RDB_IMPL_SERIALIZABLE_14_SINCE_v2_4(type_t, field1, field2, field3, field4, field5, field6, field7, field8, field9, field10, field11, field12, field13, field14) \
     RDB_IMPL_SERIALIZABLE_14(type_t, field1, field2, field3, field4, field5, field6, field7, field8, field9, field10, field11, field12, field13, field14); \
     INSTANTIATE_SERIALIZABLE_SINCE_v2_4(type_t)
+
+#define RDB_IMPL_SERIALIZABLE_14_SINCE_v2_5(type_t, field1, field2, field3, field4, field5, field6, field7, field8, field9, field10, field11, field12, field13, field14) \
+    RDB_IMPL_SERIALIZABLE_14(type_t, field1, field2, field3, field4, field5, field6, field7, field8, field9, field10, field11, field12, field13, field14); \
+    INSTANTIATE_SERIALIZABLE_SINCE_v2_5(type_t)
 #define RDB_MAKE_ME_SERIALIZABLE_14(type_t, field1, field2, field3, field4, field5, field6, field7, field8, field9, field10, field11, field12, field13, field14) \
     template <cluster_version_t W> \
     friend void serialize(write_message_t *wm, const type_t &thing) { \
@@ -2217,6 +2277,10 @@ struct always_false
 #define RDB_IMPL_SERIALIZABLE_15_SINCE_v2_4(type_t, field1, field2, field3, field4, field5, field6, field7, field8, field9, field10, field11, field12, field13, field14, field15) \
     RDB_IMPL_SERIALIZABLE_15(type_t, field1, field2, field3, field4, field5, field6, field7, field8, field9, field10, field11, field12, field13, field14, field15); \
     INSTANTIATE_SERIALIZABLE_SINCE_v2_4(type_t)
+
+#define RDB_IMPL_SERIALIZABLE_15_SINCE_v2_5(type_t, field1, field2, field3, field4, field5, field6, field7, field8, field9, field10, field11, field12, field13, field14, field15) \
+    RDB_IMPL_SERIALIZABLE_15(type_t, field1, field2, field3, field4, field5, field6, field7, field8, field9, field10, field11, field12, field13, field14, field15); \
+    INSTANTIATE_SERIALIZABLE_SINCE_v2_5(type_t)
 #define RDB_MAKE_ME_SERIALIZABLE_15(type_t, field1, field2, field3, field4, field5, field6, field7, field8, field9, field10, field11, field12, field13, field14, field15) \
     template <cluster_version_t W> \
     friend void serialize(write_message_t *wm, const type_t &thing) { \
@@ -2436,6 +2500,10 @@ struct always_false
 #define RDB_IMPL_SERIALIZABLE_16_SINCE_v2_4(type_t, field1, field2, field3, field4, field5, field6, field7, field8, field9, field10, field11, field12, field13, field14, field15, field16) \
     RDB_IMPL_SERIALIZABLE_16(type_t, field1, field2, field3, field4, field5, field6, field7, field8, field9, field10, field11, field12, field13, field14, field15, field16); \
     INSTANTIATE_SERIALIZABLE_SINCE_v2_4(type_t)
+
+#define RDB_IMPL_SERIALIZABLE_16_SINCE_v2_5(type_t, field1, field2, field3, field4, field5, field6, field7, field8, field9, field10, field11, field12, field13, field14, field15, field16) \
+    RDB_IMPL_SERIALIZABLE_16(type_t, field1, field2, field3, field4, field5, field6, field7, field8, field9, field10, field11, field12, field13, field14, field15, field16); \
+    INSTANTIATE_SERIALIZABLE_SINCE_v2_5(type_t)
 #define RDB_MAKE_ME_SERIALIZABLE_16(type_t, field1, field2, field3, field4, field5, field6, field7, field8, field9, field10, field11, field12, field13, field14, field15, field16) \
     template <cluster_version_t W> \
     friend void serialize(write_message_t *wm, const type_t &thing) { \
@@ -2665,6 +2733,10 @@ struct always_false
 #define RDB_IMPL_SERIALIZABLE_17_SINCE_v2_4(type_t, field1, field2, field3, field4, field5, field6, field7, field8, field9, field10, field11, field12, field13, field14, field15, field16, field17) \
     RDB_IMPL_SERIALIZABLE_17(type_t, field1, field2, field3, field4, field5, field6, field7, field8, field9, field10, field11, field12, field13, field14, field15, field16, field17); \
     INSTANTIATE_SERIALIZABLE_SINCE_v2_4(type_t)
+
+#define RDB_IMPL_SERIALIZABLE_17_SINCE_v2_5(type_t, field1, field2, field3, field4, field5, field6, field7, field8, field9, field10, field11, field12, field13, field14, field15, field16, field17) \
+    RDB_IMPL_SERIALIZABLE_17(type_t, field1, field2, field3, field4, field5, field6, field7, field8, field9, field10, field11, field12, field13, field14, field15, field16, field17); \
+    INSTANTIATE_SERIALIZABLE_SINCE_v2_5(type_t)
 #define RDB_MAKE_ME_SERIALIZABLE_17(type_t, field1, field2, field3, field4, field5, field6, field7, field8, field9, field10, field11, field12, field13, field14, field15, field16, field17) \
     template <cluster_version_t W> \
     friend void serialize(write_message_t *wm, const type_t &thing) { \
@@ -2904,6 +2976,10 @@ struct always_false
 #define RDB_IMPL_SERIALIZABLE_18_SINCE_v2_4(type_t, field1, field2, field3, field4, field5, field6, field7, field8, field9, field10, field11, field12, field13, field14, field15, field16, field17, field18) \
     RDB_IMPL_SERIALIZABLE_18(type_t, field1, field2, field3, field4, field5, field6, field7, field8, field9, field10, field11, field12, field13, field14, field15, field16, field17, field18); \
     INSTANTIATE_SERIALIZABLE_SINCE_v2_4(type_t)
+
+#define RDB_IMPL_SERIALIZABLE_18_SINCE_v2_5(type_t, field1, field2, field3, field4, field5, field6, field7, field8, field9, field10, field11, field12, field13, field14, field15, field16, field17, field18) \
+    RDB_IMPL_SERIALIZABLE_18(type_t, field1, field2, field3, field4, field5, field6, field7, field8, field9, field10, field11, field12, field13, field14, field15, field16, field17, field18); \
+    INSTANTIATE_SERIALIZABLE_SINCE_v2_5(type_t)
 #define RDB_MAKE_ME_SERIALIZABLE_18(type_t, field1, field2, field3, field4, field5, field6, field7, field8, field9, field10, field11, field12, field13, field14, field15, field16, field17, field18) \
     template <cluster_version_t W> \
     friend void serialize(write_message_t *wm, const type_t &thing) { \
@@ -3153,6 +3229,10 @@ struct always_false
 #define RDB_IMPL_SERIALIZABLE_19_SINCE_v2_4(type_t, field1, field2, field3, field4, field5, field6, field7, field8, field9, field10, field11, field12, field13, field14, field15, field16, field17, field18, field19) \
     RDB_IMPL_SERIALIZABLE_19(type_t, field1, field2, field3, field4, field5, field6, field7, field8, field9, field10, field11, field12, field13, field14, field15, field16, field17, field18, field19); \
     INSTANTIATE_SERIALIZABLE_SINCE_v2_4(type_t)
+
+#define RDB_IMPL_SERIALIZABLE_19_SINCE_v2_5(type_t, field1, field2, field3, field4, field5, field6, field7, field8, field9, field10, field11, field12, field13, field14, field15, field16, field17, field18, field19) \
+    RDB_IMPL_SERIALIZABLE_19(type_t, field1, field2, field3, field4, field5, field6, field7, field8, field9, field10, field11, field12, field13, field14, field15, field16, field17, field18, field19); \
+    INSTANTIATE_SERIALIZABLE_SINCE_v2_5(type_t)
 #define RDB_MAKE_ME_SERIALIZABLE_19(type_t, field1, field2, field3, field4, field5, field6, field7, field8, field9, field10, field11, field12, field13, field14, field15, field16, field17, field18, field19) \
     template <cluster_version_t W> \
     friend void serialize(write_message_t *wm, const type_t &thing) { \
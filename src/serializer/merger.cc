@@ -15,6 +15,7 @@ merger_serializer_t::merger_serializer_t(scoped_ptr_t<serializer_t> _inner,
                                          int _max_active_writes) :
     inner(std::move(_inner)),
     block_writes_io_account(make_io_account(MERGER_BLOCK_WRITE_IO_PRIORITY)),
+    merged_index_writes(0),
     write_committer(std::bind(&merger_serializer_t::do_index_write, this),
                     _max_active_writes) { }
 
@@ -83,6 +84,7 @@ void merger_serializer_t::do_index_write() {
 
     new_mutex_in_line_t mutex_acq(&inner_index_write_mutex);
     mutex_acq.acq_signal()->wait();
+    ++merged_index_writes;
     inner->index_write(
         &mutex_acq,
         [&]() {
@@ -114,6 +114,12 @@ public:
         return inner->is_gc_active();
     }
 
+    /* The number of index writes that were passed on to the inner serializer, after
+    merging */
+    uint64_t num_merged_index_writes() const {
+        return merged_index_writes;
+    }
+
 private:
     // Adds `op` to `outstanding_index_write_ops`, using `merge_index_write_op()` if
     // necessary
@@ -140,6 +146,8 @@ private:
     // serializer.
     new_mutex_t outstanding_index_write_mutex;
 
+    uint64_t merged_index_writes;
+
     pump_coro_t write_committer;
 
     DISABLE_COPYING(merger_serializer_t);
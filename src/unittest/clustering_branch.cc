@@ -5,6 +5,7 @@
 #include "clustering/immediate_consistency/primary_dispatcher.hpp"
 #include "clustering/immediate_consistency/remote_replicator_client.hpp"
 #include "clustering/immediate_consistency/remote_replicator_server.hpp"
+#include "clustering/immediate_consistency/replica_freshness.hpp"
 #include "clustering/immediate_consistency/standard_backfill_throttler.hpp"
 #include "clustering/table_manager/backfill_progress_tracker.hpp"
 #include "containers/uuid.hpp"
@@ -147,7 +148,8 @@ void run_backfill_test(
 
     remote_replicator_server_t remote_replicator_server(
         cluster->get_mailbox_manager(),
-        dispatcher);
+        dispatcher,
+        []() { return true; });
 
     standard_backfill_throttler_t backfill_throttler;
     backfill_progress_tracker_t backfill_progress_tracker;
@@ -156,6 +158,7 @@ void run_backfill_test(
     /* Set up a second mirror */
     mock_store_t store2((binary_blob_t(version_t::zero())));
     in_memory_branch_history_manager_t bhm2;
+    replica_freshness_t freshness;
     cond_t interruptor;
     remote_replicator_client_t remote_replicator_client(
         &backfill_throttler,
@@ -170,10 +173,14 @@ void run_backfill_test(
         server_id_t::generate_server_id(),
         &store2,
         &bhm2,
+        &freshness,
         &interruptor);
 
     nap(100);
 
+    /* By now the second mirror should have found out how far behind it is */
+    EXPECT_TRUE(freshness.is_within(10 * THOUSAND));
+
     /* Stop the inserter, then let any lingering writes finish */
     inserter.stop();
     /* Let any lingering writes finish */
@@ -190,4 +197,127 @@ TPTEST(ClusteringBranch, Backfill) {
     run_with_primary(&run_backfill_test);
 }
 
+/* The `ConcurrentWrites` test sends a lot of writes at once to a primary with one local
+and one remote replica, so that the writes to the remote replica get batched. Soft and
+hard writes alternate in runs, which splits up the batches. */
+
+void run_concurrent_writes_test(
+        simple_mailbox_cluster_t *cluster,
+        primary_dispatcher_t *dispatcher,
+        mock_store_t *store1,
+        local_replicator_t *local_replicator,
+        order_source_t *order_source) {
+    remote_replicator_server_t remote_replicator_server(
+        cluster->get_mailbox_manager(),
+        dispatcher,
+        []() { return true; });
+
+    standard_backfill_throttler_t backfill_throttler;
+    backfill_progress_tracker_t backfill_progress_tracker;
+    mock_store_t store2((binary_blob_t(version_t::zero())));
+    in_memory_branch_history_manager_t bhm2;
+    cond_t interruptor;
+    remote_replicator_client_t remote_replicator_client(
+        &backfill_throttler,
+        backfill_config_t(),
+        &backfill_progress_tracker,
+        cluster->get_mailbox_manager(),
+        server_id_t::generate_server_id(),
+        backfill_throttler_t::priority_t::critical_t::NO,
+        dispatcher->get_branch_id(),
+        remote_replicator_server.get_bcard(),
+        local_replicator->get_replica_bcard(),
+        server_id_t::generate_server_id(),
+        &store2,
+        &bhm2,
+        nullptr,
+        &interruptor);
+
+    /* Wait for the remote replica to be ready for synchronous writes */
+    dispatcher->get_ready_dispatchees()->run_until_satisfied(
+        [](const std::set<server_id_t> &ready) { return ready.size() == 2; },
+        &interruptor);
+
+    const int num_writes = 500;
+    std::vector<scoped_ptr_t<simple_write_callback_t> > write_callbacks;
+    for (int i = 0; i < num_writes; ++i) {
+        write_callbacks.push_back(make_scoped<simple_write_callback_t>());
+        write_t w = mock_overwrite(strprintf("key%d", i), strprintf("%d", i));
+        w.durability_requirement = (i / 10) % 2 == 0
+            ? DURABILITY_REQUIREMENT_SOFT
+            : DURABILITY_REQUIREMENT_HARD;
+        dispatcher->spawn_write(
+            w,
+            order_source->check_in("run_concurrent_writes_test(write)"),
+            write_callbacks.back().get());
+    }
+    for (const auto &write_callback : write_callbacks) {
+        write_callback->wait_lazily_unordered();
+        EXPECT_EQ(2, write_callback->acks);
+    }
+
+    for (int i = 0; i < num_writes; ++i) {
+        EXPECT_EQ(strprintf("%d", i), mock_lookup(store1, strprintf("key%d", i)));
+        EXPECT_EQ(strprintf("%d", i), mock_lookup(&store2, strprintf("key%d", i)));
+    }
+}
+TPTEST(ClusteringBranch, ConcurrentWrites) {
+    run_with_primary(&run_concurrent_writes_test);
+}
+
+/* The `PartitionedPrimary` test checks that a remote replica stops counting as fresh
+while its primary can't vouch for its timestamps, as when the primary is cut off from a
+majority of the replicas, and that it recovers once the primary can again. */
+
+void run_partitioned_primary_test(
+        simple_mailbox_cluster_t *cluster,
+        primary_dispatcher_t *dispatcher,
+        UNUSED mock_store_t *store1,
+        local_replicator_t *local_replicator,
+        UNUSED order_source_t *order_source) {
+    bool has_majority = true;
+    remote_replicator_server_t remote_replicator_server(
+        cluster->get_mailbox_manager(),
+        dispatcher,
+        [&]() { return has_majority; });
+
+    standard_backfill_throttler_t backfill_throttler;
+    backfill_progress_tracker_t backfill_progress_tracker;
+    mock_store_t store2((binary_blob_t(version_t::zero())));
+    in_memory_branch_history_manager_t bhm2;
+    replica_freshness_t freshness;
+    cond_t interruptor;
+    remote_replicator_client_t remote_replicator_client(
+        &backfill_throttler,
+        backfill_config_t(),
+        &backfill_progress_tracker,
+        cluster->get_mailbox_manager(),
+        server_id_t::generate_server_id(),
+        backfill_throttler_t::priority_t::critical_t::NO,
+        dispatcher->get_branch_id(),
+        remote_replicator_server.get_bcard(),
+        local_replicator->get_replica_bcard(),
+        server_id_t::generate_server_id(),
+        &store2,
+        &bhm2,
+        &freshness,
+        &interruptor);
+
+    nap(500);
+    EXPECT_TRUE(freshness.is_within(500));
+
+    /* The primary loses its majority, so the probes go unanswered */
+    has_majority = false;
+    nap(1000);
+    EXPECT_FALSE(freshness.is_within(500));
+
+    /* Once it's back, the replica catches up after at most one probe timeout */
+    has_majority = true;
+    nap(2000);
+    EXPECT_TRUE(freshness.is_within(500));
+}
+TPTEST(ClusteringBranch, PartitionedPrimary) {
+    run_with_primary(&run_partitioned_primary_test);
+}
+
 }   /* namespace unittest */
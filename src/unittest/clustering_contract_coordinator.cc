@@ -52,6 +52,7 @@ public:
         cs.config.basic.primary_key = "id";
         cs.config.write_ack_config = write_ack_config_t::MAJORITY;
         cs.config.durability = write_durability_t::HARD;
+        cs.config.auto_rebalance = false;
 
         key_range_t::right_bound_t prev_right(store_key_t::min());
         for (const quick_shard_args_t &qs : qss) {
@@ -82,7 +83,8 @@ public:
         for (size_t i = 0; i < CPU_SHARDING_FACTOR; ++i) {
             res.contract_ids[i] = generate_uuid();
             state.contracts[res.contract_ids[i]] = std::make_pair(
-                region_intersection(region_t(res.range), cpu_sharding_subspace(i)),
+                region_intersection(
+                    region_t(res.range), cpu_sharding_subspace(i, CPU_SHARDING_FACTOR)),
                 contracts.contracts[i]);
         }
         return res;
@@ -93,7 +95,7 @@ public:
     range during the initial branch registration of a new primary. */
     void set_current_branches(const cpu_branch_ids_t &branches) {
         for (size_t i = 0; i < CPU_SHARDING_FACTOR; ++i) {
-            region_t reg = cpu_sharding_subspace(i);
+            region_t reg = cpu_sharding_subspace(i, CPU_SHARDING_FACTOR);
             reg.inner = branches.range;
             state.current_branches.update(reg, branches.branch_ids[i]);
         }
@@ -216,7 +218,7 @@ public:
         }
         for (const auto &pair : state.contracts) {
             if (pair.second.first.inner == range) {
-                size_t i = get_cpu_shard_number(pair.second.first);
+                size_t i = get_cpu_shard_number(pair.second.first, CPU_SHARDING_FACTOR);
                 EXPECT_FALSE(found[i]);
                 found[i] = true;
                 res.contract_ids[i] = pair.first;
@@ -264,10 +266,10 @@ public:
         state.current_branches.visit(
             region_t(branches.range),
             [&](const region_t &reg, const branch_id_t &branch) {
-                int cs = get_cpu_shard_approx_number(reg);
+                int cs = get_cpu_shard_approx_number(reg, CPU_SHARDING_FACTOR);
                 /* Make sure the CPU shard matches exactly and fail otherwise. */
-                EXPECT_TRUE(cpu_sharding_subspace(cs).beg == reg.beg &&
-                    cpu_sharding_subspace(cs).end == reg.end);
+                region_t subspace = cpu_sharding_subspace(cs, CPU_SHARDING_FACTOR);
+                EXPECT_TRUE(subspace.beg == reg.beg && subspace.end == reg.end);
                 if (branch != branches.branch_ids[cs]) {
                     mismatched[cs] = true;
                 }
@@ -623,5 +625,74 @@ TPTEST(ClusteringContractCoordinator, FailoverSplit) {
     test.check_current_branches(branch1);
 }
 
+/* The `NumCpuShards` test checks that a new table's contracts are split into the
+requested number of CPU shards, and that the number can be read back from them. */
+TPTEST(ClusteringContractCoordinator, NumCpuShards) {
+    server_id_t alice = server_id_t::generate_server_id();
+    table_config_and_shards_t config;
+    config.config.basic.name = name_string_t::guarantee_valid("test");
+    config.config.basic.database = generate_uuid();
+    config.config.basic.primary_key = "id";
+    table_config_t::shard_t shard;
+    shard.primary_replica = alice;
+    shard.all_replicas.insert(alice);
+    config.config.shards.push_back(shard);
+    config.config.shards.push_back(shard);
+    config.shard_scheme.split_points.push_back(store_key_t("M"));
+
+    for (int num_cpu_shards : {1, 3, CPU_SHARDING_FACTOR, MAX_CPU_SHARDING_FACTOR}) {
+        table_raft_state_t state = make_new_table_raft_state(config, num_cpu_shards);
+        EXPECT_EQ(num_cpu_shards, state.num_cpu_shards());
+        EXPECT_EQ(2 * static_cast<size_t>(num_cpu_shards), state.contracts.size());
+
+        /* The CPU shards must cover the hash space without gaps or overlaps */
+        uint64_t next_beg = 0;
+        for (int i = 0; i < num_cpu_shards; ++i) {
+            region_t subspace = cpu_sharding_subspace(i, num_cpu_shards);
+            EXPECT_EQ(next_beg, subspace.beg);
+            EXPECT_EQ(i, get_cpu_shard_number(subspace, num_cpu_shards));
+            next_beg = subspace.end;
+        }
+        EXPECT_EQ(HASH_REGION_HASH_SIZE, next_beg);
+    }
+}
+
+/* The `CpuReshard` test checks that `make_cpu_resharded_table_raft_state()` splits an
+existing table's contracts into a different number of CPU shards without changing
+anything else, and that it refuses to do so while the contracts differ between CPU
+shards. */
+TPTEST(ClusteringContractCoordinator, CpuReshard) {
+    server_id_t alice = server_id_t::generate_server_id();
+    table_config_and_shards_t config;
+    config.config.basic.name = name_string_t::guarantee_valid("test");
+    config.config.basic.database = generate_uuid();
+    config.config.basic.primary_key = "id";
+    table_config_t::shard_t shard;
+    shard.primary_replica = alice;
+    shard.all_replicas.insert(alice);
+    config.config.shards.push_back(shard);
+    config.config.shards.push_back(shard);
+    config.shard_scheme.split_points.push_back(store_key_t("M"));
+
+    table_raft_state_t old_state =
+        make_new_table_raft_state(config, CPU_SHARDING_FACTOR);
+    table_raft_state_t new_state;
+    ASSERT_TRUE(make_cpu_resharded_table_raft_state(old_state, 3, &new_state));
+    EXPECT_EQ(3, new_state.num_cpu_shards());
+    EXPECT_EQ(2 * 3u, new_state.contracts.size());
+    EXPECT_TRUE(old_state.config == new_state.config);
+    EXPECT_TRUE(old_state.member_ids == new_state.member_ids);
+    EXPECT_TRUE(old_state.current_branches == new_state.current_branches);
+    for (const auto &pair : new_state.contracts) {
+        EXPECT_TRUE(old_state.contracts.begin()->second.second == pair.second.second);
+    }
+
+    /* The contracts for the first key range no longer agree */
+    table_raft_state_t diverged_state = old_state;
+    diverged_state.contracts.begin()->second.second.voters.clear();
+    EXPECT_FALSE(
+        make_cpu_resharded_table_raft_state(diverged_state, 3, &new_state));
+}
+
 } /* namespace unittest */
 
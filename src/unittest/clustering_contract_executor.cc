@@ -7,6 +7,8 @@
 #include "clustering/table_manager/backfill_progress_tracker.hpp"
 #include "clustering/query_routing/metadata.hpp"
 #include "clustering/query_routing/primary_query_client.hpp"
+#include "concurrency/pmap.hpp"
+#include "perfmon/collect.hpp"
 #include "unittest/branch_history_manager.hpp"
 #include "unittest/clustering_contract_utils.hpp"
 #include "unittest/mock_store.hpp"
@@ -54,7 +56,8 @@ public:
         for (size_t i = 0; i < CPU_SHARDING_FACTOR; ++i) {
             res.contract_ids[i] = generate_uuid();
             state.contracts[res.contract_ids[i]] = std::make_pair(
-                region_intersection(region_t(res.range), cpu_sharding_subspace(i)),
+                region_intersection(
+                    region_t(res.range), cpu_sharding_subspace(i, CPU_SHARDING_FACTOR)),
                 contracts.contracts[i]);
         }
         return res;
@@ -66,7 +69,7 @@ public:
     }
     void set_current_branches(const cpu_branch_ids_t &branches) {
         for (size_t i = 0; i < CPU_SHARDING_FACTOR; ++i) {
-            region_t reg = cpu_sharding_subspace(i);
+            region_t reg = cpu_sharding_subspace(i, CPU_SHARDING_FACTOR);
             reg.inner = branches.range;
             state.current_branches.update(reg, branches.branch_ids[i]);
         }
@@ -106,6 +109,9 @@ public:
             stores[i]->rethread(home_thread());
         }
     }
+    int num_cpu_shards() {
+        return CPU_SHARDING_FACTOR;
+    }
     branch_history_manager_t *get_branch_history_manager() {
         return &branch_history_manager;
     }
@@ -130,7 +136,9 @@ public:
     executor_tester_t(
             executor_tester_context_t *_context,
             executor_tester_files_t *_files) :
-        context(_context), files(_files)
+        context(_context), files(_files),
+        perfmon_membership(&get_global_perfmon_collection(), &perfmons,
+                           uuid_to_str(files->server_id.get_uuid()))
     {
         executor.init(new contract_executor_t(
             files->server_id,
@@ -142,7 +150,7 @@ public:
             &context->io_backender,
             &context->backfill_throttler,
             &context->backfill_progress_tracker,
-            &get_global_perfmon_collection()));
+            &perfmons));
 
         /* Copy our contract execution bcards into the context's map so that other
         `executor_tester_t`s can see them. */
@@ -221,6 +229,55 @@ public:
         EXPECT_EQ(expect, mock_parse_read_response(response));
     }
 
+    /* `read_primary_majority()` performs `num_reads` concurrent reads in 'majority'
+    mode through the primary, and compares each result to `expect`. */
+    void read_primary_majority(
+            const std::string &key, const std::string &expect, size_t num_reads) {
+        primary_finder_t primary_finder(this, key);
+        pmap(num_reads, [&](size_t) {
+            read_t read = mock_read(key);
+            read.read_mode = read_mode_t::MAJORITY;
+            fifo_enforcer_sink_t::exit_read_t token;
+            primary_finder.get_client()->new_read_token(&token);
+            read_response_t response;
+            try {
+                primary_finder.get_client()->read(
+                    read,
+                    &response,
+                    order_token_t::ignore,
+                    &token,
+                    primary_finder.get_disconnect_signal());
+            } catch (const interrupted_exc_t &) {
+                ADD_FAILURE() << "lost contact with primary";
+                return;
+            } catch (const cannot_perform_query_exc_t &exc) {
+                ADD_FAILURE() << "majority read failed: " << exc.what();
+                return;
+            }
+            EXPECT_EQ(expect, mock_parse_read_response(response));
+        });
+    }
+
+    /* `get_primary_stat()` adds up the perfmon counter `name` over all the primaries
+    that this `executor_tester_t` has had. */
+    double get_primary_stat(const std::string &name) {
+        ql::datum_t stats = perfmon_get_stats().get_field(
+            datum_string_t(uuid_to_str(files->server_id.get_uuid())));
+        double total = 0;
+        for (size_t i = 0; i < stats.obj_size(); ++i) {
+            std::pair<datum_string_t, ql::datum_t> pair = stats.get_pair(i);
+            if (pair.first.to_std().find("primary-") != 0) {
+                continue;
+            }
+            ql::datum_t value = pair.second.get_field(
+                datum_string_t(name), ql::throw_bool_t::NOTHROW);
+            if (value.has()) {
+                total += value.as_num();
+            }
+        }
+        return total;
+    }
+
     /* `read_store()` is like `read_primary()` except that it goes directly to the
     storage layer instead of routing the read through the primary. So it works on any
     server, even if it's not a primary. */
@@ -351,6 +408,8 @@ private:
 
     executor_tester_context_t * const context;
     executor_tester_files_t * const files;
+    perfmon_collection_t perfmons;
+    perfmon_membership_t perfmon_membership;
     scoped_ptr_t<contract_executor_t> executor;
     scoped_ptr_t<watchable_map_t<
         std::pair<server_id_t, branch_id_t>,
@@ -632,5 +691,50 @@ TPTEST(ClusteringContractExecutor, HandOverSafety) {
     }
 }
 
+TPTEST(ClusteringContractExecutor, ConcurrentMajorityReads) {
+    server_id_t alice = server_id_t::generate_server_id(),
+                billy = server_id_t::generate_server_id();
+
+    /* Bring up the primary, `alice`, with `billy` as a secondary, so that majority reads
+    need a round-trip to `billy` */
+
+    executor_tester_context_t context;
+    cpu_contract_ids_t cid1 = context.add_contract("*-*",
+        quick_contract_simple({alice, billy}, alice));
+    context.publish();
+
+    executor_tester_files_t alice_files(alice);
+    executor_tester_t alice_exec(&context, &alice_files);
+    executor_tester_files_t billy_files(billy);
+    executor_tester_t billy_exec(&context, &billy_files);
+
+    cpu_branch_ids_t branch1;
+    alice_exec.check_acks(cid1, contract_ack_t::state_t::primary_need_branch,
+        &context.state.branch_history, &branch1);
+
+    context.remove_contract(cid1);
+    cpu_contract_ids_t cid2 = context.add_contract("*-*",
+        quick_contract_simple({alice, billy}, alice));
+    context.set_current_branches(branch1);
+    context.publish();
+
+    alice_exec.check_acks(cid2, contract_ack_t::state_t::primary_ready);
+    billy_exec.check_acks(cid2, contract_ack_t::state_t::secondary_streaming);
+    alice_exec.write_primary("hello", "world");
+
+    /* All the reads go to the same key, so they're all handled by the same primary. They
+    should share their sync writes instead of making one round-trip each. */
+    const size_t num_reads = 32;
+    double reads_before = alice_exec.get_primary_stat("majority_reads");
+    double round_trips_before = alice_exec.get_primary_stat("majority_read_round_trips");
+    alice_exec.read_primary_majority("hello", "world", num_reads);
+    EXPECT_EQ(static_cast<double>(num_reads),
+        alice_exec.get_primary_stat("majority_reads") - reads_before);
+    double round_trips =
+        alice_exec.get_primary_stat("majority_read_round_trips") - round_trips_before;
+    EXPECT_LE(1, round_trips);
+    EXPECT_GT(static_cast<double>(num_reads), round_trips);
+}
+
 } /* namespace unittest */
 
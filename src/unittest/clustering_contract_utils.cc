@@ -11,7 +11,8 @@ region_map_t<version_t> quick_cpu_version_map(
     for (const quick_cpu_version_map_args_t &qvm : qvms) {
         key_range_t range = quick_range(qvm.quick_range_spec);
         region_t region = region_intersection(
-            region_t(range), cpu_sharding_subspace(which_cpu_subspace));
+            region_t(range),
+            cpu_sharding_subspace(which_cpu_subspace, CPU_SHARDING_FACTOR));
         version_t version;
         if (qvm.branch == nullptr) {
             guarantee(qvm.timestamp == 0);
@@ -50,7 +51,7 @@ cpu_branch_ids_t quick_cpu_branch(
     branch_birth_certificate_t bcs[CPU_SHARDING_FACTOR];
     for (size_t i = 0; i < CPU_SHARDING_FACTOR; ++i) {
         region_t region = region_intersection(
-            region_t(res.range), cpu_sharding_subspace(i));
+            region_t(res.range), cpu_sharding_subspace(i, CPU_SHARDING_FACTOR));
         bcs[i].initial_timestamp = state_timestamp_t::zero();
         bcs[i].origin = quick_cpu_version_map(i, origin);
         bcs[i].origin.visit(region, [&](const region_t &, const version_t &v) {
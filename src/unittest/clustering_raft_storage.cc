@@ -2,11 +2,13 @@
 #include "unittest/gtest.hpp"
 
 #include "arch/io/disk.hpp"
+#include "arch/timing.hpp"
 #include "clustering/administration/persist/file.hpp"
 #include "clustering/administration/persist/file_keys.hpp"
 #include "clustering/administration/persist/raft_storage_interface.hpp"
 #include "clustering/administration/tables/split_points.hpp"
 #include "clustering/table_contract/contract_metadata.hpp"
+#include "concurrency/pmap.hpp"
 #include "unittest/clustering_utils_raft.hpp"
 #include "unittest/unittest_utils.hpp"
 
@@ -25,6 +27,7 @@ table_config_and_shards_t make_table_config_and_shards() {
     calculate_split_points_for_uuids(1, &table_config_and_shards.shard_scheme);
     table_config_and_shards.config.write_ack_config = write_ack_config_t::MAJORITY;
     table_config_and_shards.config.durability = write_durability_t::HARD;
+    table_config_and_shards.config.auto_rebalance = false;
     table_config_and_shards.server_names.names[shard.primary_replica] =
         std::make_pair(0ul, name_string_t::guarantee_valid("primary"));
 
@@ -55,7 +58,7 @@ TPTEST(ClusteringRaft, StorageRoundtrip) {
     namespace_id_t table_id = generate_uuid();
 
     table_raft_state_t table_raft_state =
-        make_new_table_raft_state(make_table_config_and_shards());
+        make_new_table_raft_state(make_table_config_and_shards(), CPU_SHARDING_FACTOR);
     raft_member_id_t raft_member_id(generate_uuid());
     raft_config_t raft_config;
     raft_config.voting_members.insert(raft_member_id);
@@ -91,7 +94,7 @@ TPTEST(ClusteringRaft, StorageErase) {
     namespace_id_t table_id = generate_uuid();
 
     table_raft_state_t table_raft_state =
-        make_new_table_raft_state(make_table_config_and_shards());
+        make_new_table_raft_state(make_table_config_and_shards(), CPU_SHARDING_FACTOR);
     raft_member_id_t raft_member_id(generate_uuid());
     raft_config_t raft_config;
     raft_config.voting_members.insert(raft_member_id);
@@ -141,7 +144,7 @@ TPTEST(ClusteringRaft, StorageWriteCurrentTermAndVotedFor) {
     namespace_id_t table_id = generate_uuid();
 
     table_raft_state_t table_raft_state =
-        make_new_table_raft_state(make_table_config_and_shards());
+        make_new_table_raft_state(make_table_config_and_shards(), CPU_SHARDING_FACTOR);
     raft_member_id_t raft_member_id(generate_uuid());
     raft_member_id_t raft_member_id_voted_for(generate_uuid());
     raft_config_t raft_config;
@@ -188,7 +191,7 @@ TPTEST(ClusteringRaft, StorageWriteCommitIndex) {
     namespace_id_t table_id = generate_uuid();
 
     table_raft_state_t table_raft_state =
-        make_new_table_raft_state(make_table_config_and_shards());
+        make_new_table_raft_state(make_table_config_and_shards(), CPU_SHARDING_FACTOR);
     raft_member_id_t raft_member_id(generate_uuid());
     raft_config_t raft_config;
     raft_config.voting_members.insert(raft_member_id);
@@ -231,7 +234,7 @@ TPTEST(ClusteringRaft, StorageWriteLogReplaceTail) {
     namespace_id_t table_id = generate_uuid();
 
     table_raft_state_t table_raft_state =
-        make_new_table_raft_state(make_table_config_and_shards());
+        make_new_table_raft_state(make_table_config_and_shards(), CPU_SHARDING_FACTOR);
     raft_member_id_t raft_member_id(generate_uuid());
     raft_config_t raft_config;
     raft_config.voting_members.insert(raft_member_id);
@@ -286,7 +289,7 @@ TPTEST(ClusteringRaft, StorageWriteLogAppendOne) {
     namespace_id_t table_id = generate_uuid();
 
     table_raft_state_t table_raft_state =
-        make_new_table_raft_state(make_table_config_and_shards());
+        make_new_table_raft_state(make_table_config_and_shards(), CPU_SHARDING_FACTOR);
     raft_member_id_t raft_member_id(generate_uuid());
     raft_config_t raft_config;
     raft_config.voting_members.insert(raft_member_id);
@@ -336,7 +339,7 @@ TPTEST(ClusteringRaft, StorageWriteSnapshot) {
     namespace_id_t table_id = generate_uuid();
 
     table_raft_state_t table_raft_state =
-        make_new_table_raft_state(make_table_config_and_shards());
+        make_new_table_raft_state(make_table_config_and_shards(), CPU_SHARDING_FACTOR);
     raft_member_id_t raft_member_id(generate_uuid());
     raft_config_t raft_config;
     raft_config.voting_members.insert(raft_member_id);
@@ -379,5 +382,84 @@ TPTEST(ClusteringRaft, StorageWriteSnapshot) {
         raft_persistent_state);
 }
 
+/* Many tables appending to their Raft logs at the same time, as happens on startup or
+during a mass `reconfigure`. The writes share the metadata file, so this exercises the
+group commit in `metadata_file_t::write_txn_t::commit()`. */
+TPTEST(ClusteringRaft, StorageConcurrentAppends) {
+    temp_directory_t temp_dir;
+    io_backender_t io_backender(file_direct_io_mode_t::buffered_desired);
+    cond_t non_interruptor;
+    const size_t num_tables = 64;
+    const size_t entries_per_table = 20;
+
+    table_raft_state_t table_raft_state =
+        make_new_table_raft_state(make_table_config_and_shards(), CPU_SHARDING_FACTOR);
+    raft_member_id_t raft_member_id(generate_uuid());
+    raft_config_t raft_config;
+    raft_config.voting_members.insert(raft_member_id);
+    raft_persistent_state_t<table_raft_state_t> raft_persistent_state =
+        raft_persistent_state_t<table_raft_state_t>::make_initial(
+            table_raft_state, raft_config);
+
+    raft_log_entry_t<table_raft_state_t> raft_log_entry;
+    raft_log_entry.type = raft_log_entry_type_t::regular;
+    raft_log_entry.term = 1;
+    table_raft_state_t::change_t::set_table_config_t set_table_config;
+    set_table_config.new_config = make_table_config_and_shards();
+    raft_log_entry.change.set(set_table_config);
+
+    std::vector<namespace_id_t> table_ids;
+    for (size_t i = 0; i < num_tables; ++i) {
+        table_ids.push_back(generate_uuid());
+    }
+
+    {
+        metadata_file_t metadata_file(
+            &io_backender,
+            temp_dir.path(),
+            &get_global_perfmon_collection(),
+            [&](metadata_file_t::write_txn_t *, signal_t *) { },
+            &non_interruptor);
+        std::vector<scoped_ptr_t<table_raft_storage_interface_t> > storages(num_tables);
+        {
+            metadata_file_t::write_txn_t write_txn(&metadata_file, &non_interruptor);
+            for (size_t i = 0; i < num_tables; ++i) {
+                storages[i].init(new table_raft_storage_interface_t(
+                    &metadata_file,
+                    &write_txn,
+                    table_ids[i],
+                    raft_persistent_state));
+            }
+            write_txn.commit();
+        }
+
+        uint64_t index_writes_before = metadata_file.num_index_writes();
+        pmap(num_tables, [&](size_t i) {
+            for (size_t j = 0; j < entries_per_table; ++j) {
+                /* Interleave the tables' writes in a random order, the way independent
+                Raft members would. */
+                nap(randint(3), &non_interruptor);
+                storages[i]->write_log_append_one(raft_log_entry);
+                storages[i]->write_commit_index(j + 1);
+            }
+        });
+        /* Every append and every commit index update is its own write transaction.
+        If they were flushed one at a time, each of them would write the index. */
+        uint64_t num_txns = 2 * num_tables * entries_per_table;
+        EXPECT_LT(metadata_file.num_index_writes() - index_writes_before, num_txns);
+    }
+
+    for (size_t j = 0; j < entries_per_table; ++j) {
+        raft_persistent_state.log.append(raft_log_entry);
+    }
+    raft_persistent_state.commit_index = entries_per_table;
+
+    for (const namespace_id_t &table_id : table_ids) {
+        EXPECT_EQ(
+            raft_persistent_state_from_metadata_file(temp_dir, table_id),
+            raft_persistent_state);
+    }
+}
+
 }   /* namespace unittest */
 
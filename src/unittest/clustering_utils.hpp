@@ -240,9 +240,12 @@ peer_address_t get_cluster_local_address(connectivity_cluster_t *cm);
 class test_cluster_run_t {
 public:
     explicit test_cluster_run_t(connectivity_cluster_t *c,
-                                const peer_address_t &canonical_addr = peer_address_t())
+                                const peer_address_t &canonical_addr = peer_address_t(),
+                                int connections_per_peer = 1,
+                                size_t compression_threshold = 0)
         : run(c, server_id_t::generate_server_id(),
             get_unittest_addresses(), canonical_addr, 0, ANY_PORT, 0,
+            connections_per_peer, compression_threshold,
             heartbeat_manager.get_view(), auth_manager.get_view(), nullptr) { }
 
     operator connectivity_cluster_t::run_t&() {
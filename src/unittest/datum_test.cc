@@ -5,6 +5,7 @@
 #include "rdb_protocol/datum.hpp"
 #include "rdb_protocol/datum_string.hpp"
 #include "rdb_protocol/env.hpp"
+#include "rdb_protocol/pseudo_time.hpp"
 #include "rdb_protocol/serialize_datum.hpp"
 #include "unittest/gtest.hpp"
 
@@ -207,4 +208,40 @@ TEST(DatumTest, OffsetScaling) {
     }
 }
 
+// Data that compare equal must hash equally, or hash-based grouping would split
+// them into separate groups.
+TEST(DatumTest, HashConsistentWithCmp) {
+    ql::datum_t zero(0.0);
+    ql::datum_t neg_zero(-0.0);
+    ASSERT_EQ(zero, neg_zero);
+    EXPECT_EQ(zero.hash(), neg_zero.hash());
+
+    // Times compare by epoch time, regardless of their timezone.
+    ql::datum_t utc = ql::pseudo::make_time(1234567890.0, "+00:00");
+    ql::datum_t pst = ql::pseudo::make_time(1234567890.0, "-08:00");
+    ASSERT_EQ(utc, pst);
+    EXPECT_EQ(utc.hash(), pst.hash());
+
+    ql::datum_t obj1(std::map<datum_string_t, ql::datum_t>
+            {std::make_pair(datum_string_t("a"), ql::datum_t(1.0)),
+             std::make_pair(datum_string_t("b"), ql::datum_t(datum_string_t("x")))});
+    ql::datum_t obj2(std::map<datum_string_t, ql::datum_t>
+            {std::make_pair(datum_string_t("b"), ql::datum_t(datum_string_t("x"))),
+             std::make_pair(datum_string_t("a"), ql::datum_t(1.0))});
+    ASSERT_EQ(obj1, obj2);
+    EXPECT_EQ(obj1.hash(), obj2.hash());
+
+    // And some data that are different should (very likely) hash differently.
+    ql::datum_t arr1(std::vector<ql::datum_t>
+            {ql::datum_t(datum_string_t("ab")), ql::datum_t(datum_string_t("c"))},
+            ql::configured_limits_t::unlimited);
+    ql::datum_t arr2(std::vector<ql::datum_t>
+            {ql::datum_t(datum_string_t("a")), ql::datum_t(datum_string_t("bc"))},
+            ql::configured_limits_t::unlimited);
+    ASSERT_NE(arr1, arr2);
+    EXPECT_NE(arr1.hash(), arr2.hash());
+    EXPECT_NE(ql::datum_t(datum_string_t("1")).hash(), ql::datum_t(1.0).hash());
+    EXPECT_NE(ql::datum_t::null().hash(), ql::datum_t::boolean(false).hash());
+}
+
 }  // namespace unittest
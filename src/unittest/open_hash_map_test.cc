@@ -0,0 +1,71 @@
+// Copyright 2010-2016 RethinkDB, all rights reserved.
+#include <map>
+#include <string>
+
+#include "containers/open_hash_map.hpp"
+#include "random.hpp"
+#include "unittest/gtest.hpp"
+
+namespace unittest {
+
+TEST(OpenHashMapTest, Basic) {
+    open_hash_map_t<std::string, int> m;
+    EXPECT_EQ(0, m.size());
+    EXPECT_TRUE(m.begin() == m.end());
+    EXPECT_TRUE(m.find("a") == m.end());
+
+    auto res = m.insert(std::make_pair(std::string("a"), 1));
+    EXPECT_TRUE(res.second);
+    EXPECT_EQ(1, res.first->second);
+    // Like `std::map`, inserting an existing key leaves its value alone.
+    res = m.insert(std::make_pair(std::string("a"), 2));
+    EXPECT_FALSE(res.second);
+    EXPECT_EQ(1, res.first->second);
+    m["b"] += 5;
+    m["b"] += 5;
+    EXPECT_EQ(2, m.size());
+    EXPECT_EQ(10, m.find("b")->second);
+
+    EXPECT_EQ(1, m.erase("a"));
+    EXPECT_EQ(0, m.erase("a"));
+    EXPECT_TRUE(m.find("a") == m.end());
+    EXPECT_EQ(1, m.size());
+    m.clear();
+    EXPECT_EQ(0, m.size());
+    EXPECT_TRUE(m.begin() == m.end());
+}
+
+// A deliberately terrible hash, so that everything collides and erasing has to
+// shift long probe sequences around (including across the end of the table).
+struct bad_hash_t {
+    size_t operator()(int x) const { return 13 + (x % 3); }
+};
+
+TEST(OpenHashMapTest, AgainstStdMap) {
+    open_hash_map_t<int, int, bad_hash_t> m;
+    std::map<int, int> reference;
+    for (int i = 0; i < 10000; ++i) {
+        int key = randint(200);
+        if (randint(3) == 0) {
+            ASSERT_EQ(reference.erase(key), m.erase(key));
+        } else {
+            bool inserted = reference.insert(std::make_pair(key, i)).second;
+            ASSERT_EQ(inserted, m.insert(std::make_pair(key, i)).second);
+        }
+        ASSERT_EQ(reference.size(), m.size());
+        if (i % 100 == 0) {
+            std::map<int, int> contents;
+            for (auto &&pair : m) {
+                ASSERT_TRUE(contents.insert(pair).second);
+            }
+            ASSERT_EQ(reference, contents);
+            for (auto &&pair : reference) {
+                auto it = m.find(pair.first);
+                ASSERT_TRUE(it != m.end());
+                ASSERT_EQ(pair.second, it->second);
+            }
+        }
+    }
+}
+
+}  // namespace unittest
@@ -257,7 +257,8 @@ void run_backfill_test(const backfill_test_config_t &cfg) {
 
             remote_replicator_server_t remote_replicator_server(
                 cluster.get_mailbox_manager(),
-                &dispatcher);
+                &dispatcher,
+                []() { return true; });
 
             stress_backfill_throttler_t backfill_throttler(cfg);
             backfill_debug_all("begin backfill store1 -> store2");
@@ -268,7 +269,7 @@ void run_backfill_test(const backfill_test_config_t &cfg) {
                 backfill_throttler_t::priority_t::critical_t::NO,
                 dispatcher.get_branch_id(), remote_replicator_server.get_bcard(),
                 local_replicator.get_replica_bcard(), server_id_t::generate_server_id(),
-                &store2.store, &bhm, &non_interruptor);
+                &store2.store, &bhm, nullptr, &non_interruptor);
             backfill_debug_all("end backfill store1 -> store2");
             backfill_debug_all("begin backfill store1 -> store3");
             remote_replicator_client_t remote_replicator_client_3(&backfill_throttler,
@@ -277,7 +278,7 @@ void run_backfill_test(const backfill_test_config_t &cfg) {
                 backfill_throttler_t::priority_t::critical_t::NO,
                 dispatcher.get_branch_id(), remote_replicator_server.get_bcard(),
                 local_replicator.get_replica_bcard(), server_id_t::generate_server_id(),
-                &store3.store, &bhm, &non_interruptor);
+                &store3.store, &bhm, nullptr, &non_interruptor);
             backfill_debug_all("end backfill store1 -> store3");
 
             if (cfg.stream_during_backfill) {
@@ -330,7 +331,8 @@ void run_backfill_test(const backfill_test_config_t &cfg) {
         reverse the writes that were performed earlier. */
         remote_replicator_server_t remote_replicator_server(
             cluster.get_mailbox_manager(),
-            &dispatcher);
+            &dispatcher,
+            []() { return true; });
 
         stress_backfill_throttler_t backfill_throttler(cfg);
         backfill_debug_all("begin backfill store2 -> store1");
@@ -341,7 +343,7 @@ void run_backfill_test(const backfill_test_config_t &cfg) {
             backfill_throttler_t::priority_t::critical_t::NO,
             dispatcher.get_branch_id(), remote_replicator_server.get_bcard(),
             local_replicator.get_replica_bcard(), server_id_t::generate_server_id(),
-            &store1.store, &bhm, &non_interruptor);
+            &store1.store, &bhm, nullptr, &non_interruptor);
         backfill_debug_all("end backfill store2 -> store1");
 
         if (cfg.stream_during_backfill) {
@@ -376,7 +378,8 @@ void run_backfill_test(const backfill_test_config_t &cfg) {
         `store2` to `store3` via `store1`. */
         remote_replicator_server_t remote_replicator_server(
             cluster.get_mailbox_manager(),
-            &dispatcher);
+            &dispatcher,
+            []() { return true; });
 
         stress_backfill_throttler_t backfill_throttler(cfg);
         backfill_debug_all("begin backfill store1 -> store3");
@@ -387,7 +390,7 @@ void run_backfill_test(const backfill_test_config_t &cfg) {
             backfill_throttler_t::priority_t::critical_t::NO,
             dispatcher.get_branch_id(), remote_replicator_server.get_bcard(),
             local_replicator.get_replica_bcard(), server_id_t::generate_server_id(),
-            &store3.store, &bhm, &non_interruptor);
+            &store3.store, &bhm, nullptr, &non_interruptor);
         backfill_debug_all("end backfill store1 -> store3");
 
         if (cfg.stream_during_backfill) {
@@ -496,6 +499,7 @@ TPTEST(RDBBackfill, FillItemQueue) {
     preempt. */
     backfill_test_config_t cfg;
     cfg.backfill.item_queue_mem_size = 1;
+    cfg.backfill.max_item_queue_mem_size = 1;
     cfg.backfill.item_chunk_mem_size = 1;
     cfg.backfill.pre_item_queue_mem_size = GIGABYTE;
     cfg.min_preempt_ms = cfg.max_preempt_ms = 60 * 60 * 1000;
@@ -534,6 +538,7 @@ TPTEST(RDBBackfill, FillBothQueuesAndPreemptOften) {
     */
     backfill_test_config_t cfg;
     cfg.backfill.item_queue_mem_size = 1;
+    cfg.backfill.max_item_queue_mem_size = 1;
     cfg.backfill.item_chunk_mem_size = 1;
     cfg.backfill.pre_item_queue_mem_size = 1;
     cfg.backfill.pre_item_chunk_mem_size = 1;
@@ -544,5 +549,143 @@ TPTEST(RDBBackfill, FillBothQueuesAndPreemptOften) {
     run_backfill_test(cfg);
 }
 
+/* `read_from_store()` performs `read` directly on `store`, without going through a
+dispatcher. */
+read_response_t read_from_store(store_t *store, const read_t &read) {
+#ifndef NDEBUG
+    metainfo_checker_t checker(store->get_region(),
+        [](const region_t &, const binary_blob_t &) { });
+#endif
+    read_token_t token;
+    store->new_read_token(&token);
+    read_response_t response;
+    cond_t non_interruptor;
+    store->read(DEBUG_ONLY(checker, ) read, &response, &token, &non_interruptor);
+    return response;
+}
+
+/* `read_rows_via_sindex()` returns every row whose secondary index key is `value` */
+std::vector<ql::datum_t> read_rows_via_sindex(
+        store_t *store, const std::string &sindex_id, const std::string &value) {
+    read_response_t response = read_from_store(store,
+        make_sindex_read(ql::datum_t(datum_string_t(value)), sindex_id));
+    rget_read_response_t *rget_response =
+        boost::get<rget_read_response_t>(&response.response);
+    guarantee(rget_response != nullptr);
+    ql::grouped_t<ql::stream_t> *groups =
+        boost::get<ql::grouped_t<ql::stream_t> >(&rget_response->result);
+    guarantee(groups != nullptr);
+    std::vector<ql::datum_t> rows;
+    for (const auto &group : *groups) {
+        for (const auto &substream : group.second.substreams) {
+            for (const auto &item : substream.second.stream) {
+                rows.push_back(item.data);
+            }
+        }
+    }
+    return rows;
+}
+
+/* `create_value_sindex()` creates a secondary index on the `value` field of the
+documents that `dispatcher_inserter_t` writes, and waits for it to be ready. */
+void create_value_sindex(store_t *store, const std::string &sindex_id) {
+    const ql::sym_t arg(1);
+    ql::minidriver_t r(ql::backtrace_id_t::empty());
+    sindex_config_t sindex(
+        ql::map_wire_func_t(r.var(arg)["value"].root_term(), make_vector(arg)),
+        reql_version_t::LATEST,
+        sindex_multi_bool_t::SINGLE,
+        sindex_geo_bool_t::REGULAR);
+    cond_t non_interruptor;
+    store->sindex_create(sindex_id, sindex, &non_interruptor);
+    for (int attempts = 0; attempts < 50; ++attempts) {
+        auto sindexes = store->sindex_list(&non_interruptor);
+        auto it = sindexes.find(sindex_id);
+        if (it != sindexes.end() && it->second.second.ready) {
+            return;
+        }
+        nap((attempts + 1) * 50);
+    }
+    ADD_FAILURE() << "Waiting for sindex " << sindex_id << " timed out.";
+}
+
+/* This test seeds an empty replica, which takes the code path in `receive_backfill()`
+that doesn't erase the range before applying the backfill items. Afterwards both stores
+must have the same documents and the same secondary index entries. */
+TPTEST(RDBBackfill, SeedEmptyReplica) {
+    backfill_test_config_t cfg;
+    cfg.num_initial_writes = 5000;
+    cfg.min_preempt_ms = cfg.max_preempt_ms = 60 * 60 * 1000;
+
+    order_source_t order_source;
+    simple_mailbox_cluster_t cluster;
+    io_backender_t io_backender(file_direct_io_mode_t::buffered_desired);
+    extproc_pool_t extproc_pool(2);
+    dummy_semilattice_controller_t<auth_semilattice_metadata_t> auth_manager;
+    rdb_context_t ctx(&extproc_pool, nullptr, auth_manager.get_view());
+    cond_t non_interruptor;
+
+    in_memory_branch_history_manager_t bhm;
+    test_store_t store1(&io_backender, &order_source, &ctx);
+    test_store_t store2(&io_backender, &order_source, &ctx);
+
+    /* Secondary indexes are part of the table config, not of the backfill, so both
+    stores get the index before anything is written. */
+    std::string sindex_id = uuid_to_str(generate_uuid());
+    create_value_sindex(&store1.store, sindex_id);
+    create_value_sindex(&store2.store, sindex_id);
+
+    std::map<std::string, std::string> inserter_state;
+    {
+        primary_dispatcher_t dispatcher(
+            &get_global_perfmon_collection(),
+            region_map_t<version_t>(region_t::universe(), version_t::zero()));
+
+        local_replicator_t local_replicator(
+            cluster.get_mailbox_manager(), server_id_t::generate_server_id(),
+            &dispatcher, &store1.store, &bhm, &non_interruptor);
+
+        dispatcher_inserter_t inserter(
+            &dispatcher, &order_source, cfg.value_padding_length, &inserter_state,
+            false);
+        inserter.insert(cfg.num_initial_writes);
+
+        remote_replicator_server_t remote_replicator_server(
+            cluster.get_mailbox_manager(),
+            &dispatcher,
+            []() { return true; });
+
+        stress_backfill_throttler_t backfill_throttler(cfg);
+        backfill_progress_tracker_t backfill_progress_tracker;
+        remote_replicator_client_t remote_replicator_client(&backfill_throttler,
+            cfg.backfill, &backfill_progress_tracker, cluster.get_mailbox_manager(),
+            server_id_t::generate_server_id(),
+            backfill_throttler_t::priority_t::critical_t::NO,
+            dispatcher.get_branch_id(), remote_replicator_server.get_bcard(),
+            local_replicator.get_replica_bcard(), server_id_t::generate_server_id(),
+            &store2.store, &bhm, nullptr, &non_interruptor);
+    }
+
+    for (const auto &pair : inserter_state) {
+        read_t read(point_read_t(store_key_t(pair.first)),
+                    profile_bool_t::DONT_PROFILE, read_mode_t::SINGLE);
+        read_response_t response1 = read_from_store(&store1.store, read);
+        read_response_t response2 = read_from_store(&store2.store, read);
+        ql::datum_t doc1 = boost::get<point_read_response_t>(response1.response).data;
+        ql::datum_t doc2 = boost::get<point_read_response_t>(response2.response).data;
+        EXPECT_EQ(doc1, doc2) << "for key " << pair.first;
+        EXPECT_EQ(pair.second.empty(), doc2.get_type() == ql::datum_t::R_NULL);
+
+        if (!pair.second.empty()) {
+            std::vector<ql::datum_t> rows1 =
+                read_rows_via_sindex(&store1.store, sindex_id, pair.second);
+            std::vector<ql::datum_t> rows2 =
+                read_rows_via_sindex(&store2.store, sindex_id, pair.second);
+            ASSERT_EQ(1u, rows1.size());
+            EXPECT_EQ(rows1, rows2) << "for value " << pair.second;
+        }
+    }
+}
+
 }   /* namespace unittest */
 
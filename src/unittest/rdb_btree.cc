@@ -453,4 +453,138 @@ TPTEST(RDBBtree, SindexInterruptionViaStoreDelete) {
     store.reset();
 }
 
+/* Reads all rows of `store` through the ReQL function `row => row(field)`. Sets
+`*error_out` instead if that failed. */
+std::vector<ql::datum_t> read_rows_mapped(
+        store_t *store,
+        rdb_context_t *ctx,
+        const char *field,
+        std::string *error_out) {
+    cond_t dummy_interruptor;
+    read_token_t token;
+    store->new_read_token(&token);
+
+    scoped_ptr_t<txn_t> txn;
+    scoped_ptr_t<real_superblock_t> superblock;
+    store->acquire_superblock_for_read(
+            &token, &txn, &superblock,
+            &dummy_interruptor, true);
+
+    ql::sym_t one(1);
+    ql::minidriver_t r(ql::backtrace_id_t::empty());
+    std::vector<ql::transform_variant_t> transforms;
+    transforms.push_back(
+        ql::map_wire_func_t(r.var(one)[field].root_term(), make_vector(one)));
+
+    // The offloading needs an `rdb_context_t` and must not be profiled.
+    ql::env_t env(ctx,
+                  ql::return_empty_normal_batches_t::NO,
+                  &dummy_interruptor,
+                  serializable_env_t{
+                      ql::global_optargs_t(),
+                      auth::user_context_t(auth::permissions_t(
+                          tribool::False, tribool::False,
+                          tribool::False, tribool::False)),
+                      ql::datum_t()},
+                  nullptr);
+
+    rget_read_response_t res;
+    rdb_rget_slice(
+        store->btree.get(),
+        region_t::universe(),
+        key_range_t::universe(),
+        r_nullopt,
+        superblock.get(),
+        &env,
+        ql::batchspec_t::all(),
+        transforms,
+        optional<ql::terminal_variant_t>(),
+        sorting_t::ASCENDING,
+        &res,
+        release_superblock_t::RELEASE);
+
+    std::vector<ql::datum_t> rows;
+    if (ql::exc_t *e = boost::get<ql::exc_t>(&res.result)) {
+        *error_out = e->what();
+        return rows;
+    }
+    ql::grouped_t<ql::stream_t> *groups =
+        boost::get<ql::grouped_t<ql::stream_t> >(&res.result);
+    guarantee(groups != nullptr);
+    for (const auto &group : *groups) {
+        for (const auto &substream : group.second.substreams) {
+            for (const auto &item : substream.second.stream) {
+                rows.push_back(item.data);
+            }
+        }
+    }
+    return rows;
+}
+
+/* Forces range reads to run their transformations on other threads, in small batches,
+and checks that they get the same results and errors as when they run them on the
+store's thread. */
+TPTEST(RDBBtree, OffloadedTransforms, 4) {
+    ASSERT_GT(get_num_db_threads(), 1);
+    recreate_temporary_directory(base_path_t("."));
+    temp_file_t temp_file;
+
+    io_backender_t io_backender(file_direct_io_mode_t::buffered_desired);
+    dummy_cache_balancer_t balancer(GIGABYTE);
+
+    filepath_file_opener_t file_opener(temp_file.name(), &io_backender);
+    log_serializer_t::create(
+        &file_opener,
+        log_serializer_t::static_config_t());
+
+    log_serializer_t serializer(
+        log_serializer_t::dynamic_config_t(),
+        &file_opener,
+        &get_global_perfmon_collection());
+
+    rdb_context_t ctx;
+    store_t store(
+            region_t::universe(),
+            &serializer,
+            &balancer,
+            "unit_test_store",
+            true,
+            &get_global_perfmon_collection(),
+            &ctx,
+            &io_backender,
+            base_path_t("."),
+            generate_uuid(),
+            update_sindexes_t::UPDATE);
+
+    insert_rows(0, TOTAL_KEYS_TO_INSERT, &store);
+
+    std::string inline_error;
+    std::vector<ql::datum_t> inline_rows =
+        read_rows_mapped(&store, &ctx, "sid", &inline_error);
+    std::string inline_missing_error;
+    read_rows_mapped(&store, &ctx, "missing", &inline_missing_error);
+
+    read_offload_config_t old_config = read_offload_config;
+    read_offload_config.min_store_thread_utilization = 0;
+    read_offload_config.max_helper_thread_utilization = 1;
+    read_offload_config.max_batch_size = 7;
+    std::string offloaded_error;
+    std::vector<ql::datum_t> offloaded_rows =
+        read_rows_mapped(&store, &ctx, "sid", &offloaded_error);
+    std::string offloaded_missing_error;
+    read_rows_mapped(&store, &ctx, "missing", &offloaded_missing_error);
+    read_offload_config = old_config;
+
+    ASSERT_EQ("", inline_error);
+    ASSERT_EQ("", offloaded_error);
+    ASSERT_EQ(static_cast<size_t>(TOTAL_KEYS_TO_INSERT), inline_rows.size());
+    ASSERT_EQ(inline_rows.size(), offloaded_rows.size());
+    for (size_t i = 0; i < inline_rows.size(); ++i) {
+        ASSERT_EQ(inline_rows[i], offloaded_rows[i]);
+    }
+
+    ASSERT_NE("", inline_missing_error);
+    ASSERT_EQ(inline_missing_error, offloaded_missing_error);
+}
+
 } //namespace unittest
@@ -419,6 +419,7 @@ bool test_rdb_env_t::instance_t::table_create(
         UNUSED const table_generate_config_params_t &config_params,
         UNUSED const std::string &primary_key,
         UNUSED write_durability_t durability,
+        UNUSED int num_cpu_shards,
         UNUSED signal_t *local_interruptor,
         UNUSED ql::datum_t *result_out,
         admin_err_t *error_out) {
@@ -599,6 +600,21 @@ bool test_rdb_env_t::instance_t::table_emergency_repair(
     return false;
 }
 
+bool test_rdb_env_t::instance_t::table_set_cpu_shards(
+        UNUSED auth::user_context_t const &user_context,
+        UNUSED counted_t<const ql::db_t> db,
+        UNUSED const name_string_t &name,
+        UNUSED int num_cpu_shards,
+        UNUSED bool dry_run,
+        UNUSED signal_t *local_interruptor,
+        UNUSED ql::datum_t *result_out,
+        admin_err_t *error_out) {
+    *error_out = admin_err_t{
+        "test_rdb_env_t::instance_t doesn't support reconfigure()",
+        query_state_t::FAILED};
+    return false;
+}
+
 bool test_rdb_env_t::instance_t::table_rebalance(
         UNUSED auth::user_context_t const &user_context,
         UNUSED counted_t<const ql::db_t> db,
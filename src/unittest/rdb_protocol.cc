@@ -920,6 +920,8 @@ TPTEST(RDBProtocol, ArtificialChangefeeds) {
                               false,
                               false,
                               false,
+                              false,
+                              r_nullopt,
                               ql::configured_limits_t(),
                               ql::datum_t::boolean(false),
                               keyspec_t::point_t{ql::datum_t(0.0)}),
@@ -935,6 +937,8 @@ TPTEST(RDBProtocol, ArtificialChangefeeds) {
                                false,
                                false,
                                false,
+                               false,
+                               r_nullopt,
                                ql::configured_limits_t(),
                                ql::datum_t::boolean(false),
                                keyspec_t::point_t{ql::datum_t(10.0)}),
@@ -950,6 +954,8 @@ TPTEST(RDBProtocol, ArtificialChangefeeds) {
                             false,
                             false,
                             false,
+                            false,
+                            r_nullopt,
                             ql::configured_limits_t(),
                             ql::datum_t::boolean(false),
                             keyspec_t::range_t{
@@ -981,7 +987,8 @@ TPTEST(RDBProtocol, ArtificialChangefeeds) {
             index_vals_t(),
             store_key_t(ql::datum_t(static_cast<double>(i)).print_primary()),
             ql::datum_t(-static_cast<double>(i)),
-            ql::datum_t(static_cast<double>(i))}));
+            ql::datum_t(static_cast<double>(i)),
+            0}));
     }
     for (const auto &pair : bundles) {
         ql::batchspec_t bs(ql::batchspec_t::all()
@@ -2,10 +2,12 @@
 #include <string>
 
 #include "unittest/gtest.hpp"
+#include "unittest/unittest_utils.hpp"
 
 #include "clustering/administration/tables/split_points.hpp"
 #include "clustering/administration/tables/table_metadata.hpp"
 #include "btree/keys.hpp"
+#include "rdb_protocol/key_access_sampler.hpp"
 
 namespace unittest {
 
@@ -70,4 +72,50 @@ TEST(Rebalance, MaxKeyLength) {
     do_rebalance(distribution, 3);
 }
 
+TPTEST(Rebalance, KeyAccessSampler) {
+    std::map<store_key_t, int64_t> buckets;
+    buckets[store_key_t("A")] = 10;
+    buckets[store_key_t("M")] = 10;
+
+    /* 100 accesses per second for ten half-lives */
+    key_access_sampler_t sampler;
+    const ticks_t interval = secs_to_ticks(1) / 100;
+    const size_t num_accesses = 100 * 10 * key_access_sampler_t::HALF_LIFE_SECS;
+    ticks_t now = secs_to_ticks(1000);
+    for (size_t i = 0; i < num_accesses; ++i) {
+        sampler.note_access(store_key_t("Z"), now);
+        now += interval;
+    }
+    std::map<store_key_t, double> loads;
+    EXPECT_NEAR(100, sampler.estimate_load(
+        key_range_t::universe(), buckets, now, &loads), 1);
+    EXPECT_EQ(0, loads[store_key_t("A")]);
+    EXPECT_NEAR(100, loads[store_key_t("M")], 1);
+
+    /* Accesses outside of the range don't count */
+    loads.clear();
+    EXPECT_EQ(0, sampler.estimate_load(
+        key_range_t(key_range_t::none, store_key_t(),
+                    key_range_t::open, store_key_t("M")),
+        buckets, now, &loads));
+    EXPECT_EQ(0, loads[store_key_t("M")]);
+
+    /* Once the load moves, the old accesses fade out */
+    for (size_t i = 0; i < num_accesses; ++i) {
+        sampler.note_access(store_key_t("B"), now);
+        now += interval;
+    }
+    loads.clear();
+    EXPECT_NEAR(100, sampler.estimate_load(
+        key_range_t::universe(), buckets, now, &loads), 1);
+    EXPECT_GT(loads[store_key_t("A")], 95);
+    EXPECT_LT(loads[store_key_t("M")], 5);
+
+    /* Without accesses, the load halves every half-life */
+    now += 2 * secs_to_ticks(key_access_sampler_t::HALF_LIFE_SECS);
+    loads.clear();
+    EXPECT_NEAR(25, sampler.estimate_load(
+        key_range_t::universe(), buckets, now, &loads), 0.5);
+}
+
 }  // namespace unittest
@@ -4,6 +4,8 @@
 #include <limits.h>  // NOLINT(build/include_order)
 
 #include <functional>  // NOLINT(build/include_order)
+#include <string>  // NOLINT(build/include_order)
+#include <vector>  // NOLINT(build/include_order)
 
 #ifdef _WIN32
 #include "windows.hpp"
@@ -11,18 +13,39 @@
 #include <iphlpapi.h> // NOLINT
 #endif
 
+#include "arch/io/network.hpp"
 #include "arch/runtime/thread_pool.hpp"
 #include "arch/timing.hpp"
+#include "concurrency/cond_var.hpp"
+#include "concurrency/pmap.hpp"
+#include "containers/buffer_group.hpp"
 #include "containers/scoped.hpp"
 #include "containers/archive/socket_stream.hpp"
+#include "containers/archive/vector_stream.hpp"
 #include "unittest/clustering_utils.hpp"
 #include "unittest/unittest_utils.hpp"
 #include "rpc/connectivity/cluster.hpp"
+#include "rpc/connectivity/compression.hpp"
 
 namespace unittest {
 
+/* Returns `size` bytes of padding for the message `message`. It looks a bit like the
+JSON documents that make up most cluster traffic, so that it compresses about as well. */
+std::string make_padding(int message, size_t size) {
+    std::string padding;
+    padding.reserve(size);
+    for (int i = 0; padding.size() < size; ++i) {
+        padding += strprintf("{\"id\":%d,\"name\":\"user %d\",\"active\":%s},",
+                             message + i, (message + i) % 1000,
+                             i % 3 == 0 ? "true" : "false");
+    }
+    padding.resize(size);
+    return padding;
+}
+
 /* `recording_test_application_t` sends and receives integers over a
-`message_service_t`. It keeps track of the integers it has received.
+`message_service_t`. It keeps track of the integers it has received. Each integer can be
+followed by some padding to make the message bigger, which the receiver checks.
 */
 
 class recording_test_application_t :
@@ -33,27 +56,32 @@ public:
     explicit recording_test_application_t(connectivity_cluster_t *cm,
                                           connectivity_cluster_t::message_tag_t _tag) :
         cluster_message_handler_t(cm, _tag),
-        sequence_number(0)
+        sequence_number(0),
+        hold_signal(nullptr)
         { }
-    void send(int message, peer_id_t peer) {
+    void send(int message, peer_id_t peer, uint64_t stream_key = 0,
+            cluster_message_class_t message_class = cluster_message_class_t::NORMAL,
+            size_t padding = 0) {
         auto_drainer_t::lock_t connection_keepalive;
         connectivity_cluster_t::connection_t *connection =
             get_connectivity_cluster()->get_connection(peer, &connection_keepalive);
         if (connection) {
-            send(message, connection, connection_keepalive);
+            send(message, connection, connection_keepalive, stream_key, message_class,
+                padding);
         }
     }
     void send(int message, connectivity_cluster_t::connection_t *connection,
-            auto_drainer_t::lock_t connection_keepalive) {
+            auto_drainer_t::lock_t connection_keepalive, uint64_t stream_key = 0,
+            cluster_message_class_t message_class = cluster_message_class_t::NORMAL,
+            size_t padding = 0) {
         class writer_t : public cluster_send_message_write_callback_t {
         public:
-            explicit writer_t(int _data) : data(_data) { }
+            writer_t(int _data, size_t padding_size) :
+                data(_data), padding(make_padding(_data, padding_size)) { }
             virtual ~writer_t() { }
-            void write(write_stream_t *stream) {
-                write_message_t wm;
-                serialize<cluster_version_t::CLUSTER>(&wm, data);
-                int res = send_write_message(stream, &wm);
-                if (res) { throw fake_archive_exc_t(); }
+            void write(write_message_t *wm) {
+                serialize<cluster_version_t::CLUSTER>(wm, data);
+                serialize<cluster_version_t::CLUSTER>(wm, padding);
             }
 #ifdef ENABLE_MESSAGE_PROFILER
             const char *message_profiler_tag() const {
@@ -61,9 +89,16 @@ public:
             }
 #endif
             int32_t data;
-        } writer(message);
+            std::string padding;
+        } writer(message, padding);
         get_connectivity_cluster()->send_message(connection, connection_keepalive,
-            get_message_tag(), &writer);
+            get_message_tag(), stream_key, &writer, message_class);
+    }
+    /* The next message we receive isn't recorded until `signal` is pulsed. Until then
+    the messages behind it back up in the connection. */
+    void hold_next_message(signal_t *signal) {
+        assert_thread();
+        hold_signal = signal;
     }
     void expect(int message, peer_id_t peer) {
         expect_delivered(message);
@@ -84,6 +119,16 @@ public:
         assert_thread();
         EXPECT_LT(timing[first], timing[second]);
     }
+    size_t num_delivered() {
+        assert_thread();
+        return inbox.size();
+    }
+    bool delivered_before(int first, int second) {
+        expect_delivered(first);
+        expect_delivered(second);
+        assert_thread();
+        return timing[first] < timing[second];
+    }
 
 private:
     void on_message(connectivity_cluster_t::connection_t *connection,
@@ -93,7 +138,16 @@ private:
         archive_result_t res
             = deserialize<cluster_version_t::CLUSTER>(stream, &i);
         if (bad(res)) { throw fake_archive_exc_t(); }
+        std::string padding;
+        res = deserialize<cluster_version_t::CLUSTER>(stream, &padding);
+        if (bad(res)) { throw fake_archive_exc_t(); }
+        EXPECT_TRUE(padding == make_padding(i, padding.size()));
         on_thread_t th(home_thread());
+        if (hold_signal != nullptr) {
+            signal_t *signal = hold_signal;
+            hold_signal = nullptr;
+            signal->wait_lazily_unordered();
+        }
         inbox[i] = connection->get_peer_id();
         timing[i] = sequence_number++;
     }
@@ -101,6 +155,7 @@ private:
     std::map<int, peer_id_t> inbox;
     std::map<int, int> timing;
     int sequence_number;
+    signal_t *hold_signal;
 };
 
 /* `StartStop` starts a cluster of three nodes, then shuts it down again. */
@@ -244,6 +299,190 @@ TPTEST_MULTITHREAD(RPCConnectivityTest, Ordering, 3) {
     }
 }
 
+/* `MultipleConnections` checks that messages get delivered when there are several TCP
+connections between two servers, and that messages with the same stream key stay in
+order. */
+
+TPTEST_MULTITHREAD(RPCConnectivityTest, MultipleConnections, 3) {
+    connectivity_cluster_t c1, c2;
+    recording_test_application_t a1(&c1, 'T'), a2(&c2, 'T');
+    test_cluster_run_t cr1(&c1, peer_address_t(), 3);
+    test_cluster_run_t cr2(&c2, peer_address_t(), 3);
+
+    cr1.join(get_cluster_local_address(&c2), 0);
+
+    let_stuff_happen();
+
+    for (int i = 0; i < 30; i++) {
+        a1.send(i, c2.get_me(), i % 3);
+        a2.send(i + 100, c1.get_me(), i % 3);
+    }
+
+    let_stuff_happen();
+
+    for (int i = 0; i < 30; i++) {
+        a2.expect(i, c1.get_me());
+        a1.expect(i + 100, c2.get_me());
+    }
+    for (int i = 0; i < 27; i++) {
+        a2.expect_order(i, i + 3);
+        a1.expect_order(i + 100, i + 103);
+    }
+}
+
+/* `MessageClasses` reproduces head-of-line blocking between two servers: it stalls the
+receiving end while a pile of big bulk messages is waiting to be sent, and then sends a
+small message. The small message should overtake the bulk messages that were still
+waiting for the lane instead of arriving after all of them. */
+
+TPTEST_MULTITHREAD(RPCConnectivityTest, MessageClasses, 3) {
+    connectivity_cluster_t c1, c2;
+    recording_test_application_t a1(&c1, 'T'), a2(&c2, 'T');
+    test_cluster_run_t cr1(&c1);
+    test_cluster_run_t cr2(&c2);
+
+    cr1.join(get_cluster_local_address(&c2), 0);
+
+    let_stuff_happen();
+
+    /* Together these should be much bigger than the socket buffers on both ends, so
+    most of them will be stuck in the lane's queue while `a2` is held up. */
+    const int num_bulk = 32;
+    const size_t bulk_size = 1024 * 1024;
+    const int small_message = 1000;
+
+    cond_t release;
+    a2.hold_next_message(&release);
+    pmap(num_bulk + 2, [&](int i) {
+        if (i < num_bulk) {
+            a1.send(i, c2.get_me(), 0, cluster_message_class_t::BULK, bulk_size);
+        } else if (i == num_bulk) {
+            nap(200);
+            a1.send(small_message, c2.get_me());
+        } else {
+            nap(400);
+            release.pulse();
+        }
+    });
+
+    let_stuff_happen();
+
+    int bulk_overtaken = 0;
+    for (int i = 0; i < num_bulk; i++) {
+        if (a2.delivered_before(small_message, i)) {
+            ++bulk_overtaken;
+        }
+    }
+    EXPECT_GT(bulk_overtaken, 0);
+}
+
+/* `Compression` sends messages of all sizes between two servers, one of which
+compresses the big messages that it sends. The other one only accepts compressed
+messages. */
+
+TPTEST_MULTITHREAD(RPCConnectivityTest, Compression, 3) {
+    connectivity_cluster_t c1, c2;
+    recording_test_application_t a1(&c1, 'T'), a2(&c2, 'T');
+    test_cluster_run_t cr1(&c1, peer_address_t(), 2, 1000);
+    test_cluster_run_t cr2(&c2, peer_address_t(), 2, 0);
+
+    cr1.join(get_cluster_local_address(&c2), 0);
+
+    let_stuff_happen();
+
+    const std::vector<size_t> padding_sizes = {0, 100, 999, 1000, 10000, 1000000};
+    const int num_messages = 60;
+    for (int i = 0; i < num_messages; i++) {
+        size_t padding = padding_sizes[i % padding_sizes.size()];
+        a1.send(i, c2.get_me(), i % 2, cluster_message_class_t::NORMAL, padding);
+        a2.send(i + 100, c1.get_me(), i % 2, cluster_message_class_t::NORMAL, padding);
+    }
+
+    let_stuff_happen();
+
+    for (int i = 0; i < num_messages; i++) {
+        a2.expect(i, c1.get_me());
+        a1.expect(i + 100, c2.get_me());
+    }
+    for (int i = 0; i < num_messages - 2; i++) {
+        a2.expect_order(i, i + 2);
+        a1.expect_order(i + 100, i + 102);
+    }
+}
+
+/* `CompressionStream` checks that messages survive a trip through a
+`cluster_compressor_t` and a `cluster_decompressor_t`, and that the decompressor
+rejects messages of the wrong size. */
+
+TPTEST(RPCConnectivityTest, CompressionStream) {
+    cluster_compressor_t compressor;
+    cluster_decompressor_t decompressor;
+    rng_t rng;
+    for (int i = 0; i < 50; i++) {
+        write_message_t msg;
+        std::string payload;
+        if (i % 5 == 0) {
+            // Random bytes don't compress, so this makes sure big output works.
+            for (int j = 0; j < 100000; j++) {
+                payload.push_back(static_cast<char>(rng.randint(256)));
+            }
+        } else {
+            payload = make_padding(i, i * 1000);
+        }
+        msg.append(payload.data(), payload.size());
+
+        write_message_t compressed_msg;
+        compressor.compress_message('T', &msg, &compressed_msg);
+        vector_stream_t compressed_stream;
+        ASSERT_EQ(0, send_write_message(&compressed_stream, &compressed_msg));
+
+        std::vector<char> data(payload.size() + 1);
+        ASSERT_TRUE(decompressor.decompress_message(compressed_stream.vector(), &data));
+        EXPECT_EQ('T', data[0]);
+        EXPECT_TRUE(std::string(data.begin() + 1, data.end()) == payload);
+    }
+
+    write_message_t msg;
+    std::string payload = make_padding(0, 1000);
+    msg.append(payload.data(), payload.size());
+    write_message_t compressed_msg;
+    compressor.compress_message('T', &msg, &compressed_msg);
+    vector_stream_t compressed_stream;
+    ASSERT_EQ(0, send_write_message(&compressed_stream, &compressed_msg));
+    std::vector<char> too_small(payload.size());
+    EXPECT_FALSE(decompressor.decompress_message(compressed_stream.vector(), &too_small));
+}
+
+// This is not really a unit test, but a micro benchmark that measures how fast we can
+// send big, JSON-like messages between two servers over the loopback interface, with
+// and without compression. No need to run this in debug mode.
+#ifdef NDEBUG
+TPTEST_MULTITHREAD(RPCConnectivityTest, CompressionBenchmark, 3) {
+    for (size_t compression_threshold : std::vector<size_t>{0, 1024}) {
+        connectivity_cluster_t c1, c2;
+        recording_test_application_t a1(&c1, 'T'), a2(&c2, 'T');
+        test_cluster_run_t cr1(&c1, peer_address_t(), 1, compression_threshold);
+        test_cluster_run_t cr2(&c2, peer_address_t(), 1, compression_threshold);
+        cr1.join(get_cluster_local_address(&c2), 0);
+        let_stuff_happen();
+
+        const int num_messages = 2000;
+        const size_t message_size = 64 * KILOBYTE;
+        ticks_t start_ticks = get_ticks();
+        for (int i = 0; i < num_messages; i++) {
+            a1.send(i, c2.get_me(), 0, cluster_message_class_t::NORMAL, message_size);
+        }
+        while (a2.num_delivered() < static_cast<size_t>(num_messages)) {
+            nap(1);
+        }
+        double secs = ticks_to_secs(get_ticks() - start_ticks);
+        printf("compression %s: %.1f MB/s\n",
+               compression_threshold > 0 ? "on" : "off",
+               num_messages * message_size / secs / MEGABYTE);
+    }
+}
+#endif  // NDEBUG
+
 /* `GetConnections` confirms that the behavior of `cluster_t::get_connections()` is
 correct. */
 
@@ -403,13 +642,12 @@ public:
             public cluster_send_message_write_callback_t {
         public:
             virtual ~dump_spectrum_writer_t() { }
-            void write(write_stream_t *stream) {
+            void write(write_message_t *wm) {
                 char spectrum[CHAR_MAX - CHAR_MIN + 1];
                 for (int i = CHAR_MIN; i <= CHAR_MAX; i++) {
                     spectrum[i - CHAR_MIN] = i;
                 }
-                int64_t res = stream->write(spectrum, CHAR_MAX - CHAR_MIN + 1);
-                if (res != CHAR_MAX - CHAR_MIN + 1) { throw fake_archive_exc_t(); }
+                wm->append(spectrum, CHAR_MAX - CHAR_MIN + 1);
             }
 #ifdef ENABLE_MESSAGE_PROFILER
             const char *message_profiler_tag() const {
@@ -422,7 +660,7 @@ public:
             get_connectivity_cluster()->get_connection(peer, &connection_keepalive);
         ASSERT_TRUE(connection != nullptr);
         get_connectivity_cluster()->send_message(connection, connection_keepalive,
-                                                 get_message_tag(), &writer);
+                                                 get_message_tag(), 0, &writer);
     }
     void on_message(connectivity_cluster_t::connection_t *,
                     auto_drainer_t::lock_t,
@@ -455,6 +693,152 @@ TPTEST_MULTITHREAD(RPCConnectivityTest, BinaryData, 3) {
     EXPECT_TRUE(a2.got_spectrum);
 }
 
+/* `gathered_write_fixture_t` is a pair of TCP connections over the loopback
+interface, for testing `tcp_conn_t` on its own. */
+class gathered_write_fixture_t {
+public:
+    gathered_write_fixture_t() :
+        listener(std::set<ip_address_t>(), 0,
+            [this](scoped_ptr_t<tcp_conn_descriptor_t> &nconn) {
+                nconn->make_server_connection(nullptr, &server, &non_interruptor);
+                got_server.pulse();
+            }),
+        client(ip_address_t("127.0.0.1"), listener.get_port(), &non_interruptor) {
+        got_server.wait();
+    }
+
+    // Sends `msg` with `send()` while reading it on the other end, and checks that it
+    // arrives intact.
+    void send_and_check(write_message_t *msg,
+                        const std::function<void(write_message_t *)> &send) {
+        std::string expected;
+        for (write_buffer_t *p = msg->unsafe_expose_buffers()->head();
+             p != nullptr;
+             p = msg->unsafe_expose_buffers()->next(p)) {
+            expected.append(p->data, p->size);
+        }
+        std::string received(expected.size(), '\0');
+        cond_t read_done;
+        coro_t::spawn_sometime([&]() {
+            server->read(&received[0], received.size(), &non_interruptor);
+            read_done.pulse();
+        });
+        send(msg);
+        read_done.wait();
+        EXPECT_TRUE(expected == received);
+    }
+
+    cond_t non_interruptor;
+    cond_t got_server;
+    scoped_ptr_t<tcp_conn_t> server;
+    tcp_listener_t listener;
+    tcp_conn_t client;
+};
+
+void fill_message(size_t size, write_message_t *msg) {
+    std::string chunk;
+    for (size_t i = 0; i < 1000; ++i) {
+        chunk.push_back(static_cast<char>('a' + i % 26));
+    }
+    for (size_t done = 0; done < size; done += chunk.size()) {
+        msg->append(chunk.data(), std::min(chunk.size(), size - done));
+    }
+}
+
+/* `GatheredWrite` checks that `write_gathered()` sends the buffers of a message in
+order, and that it doesn't copy them into the connection's write buffer the way that
+`write_buffered()` does. */
+TPTEST(RPCConnectivityTest, GatheredWrite) {
+    gathered_write_fixture_t f;
+
+    for (size_t size : std::vector<size_t>{1, 4095, 4096, 100000, 4 * MEGABYTE}) {
+        write_message_t msg;
+        fill_message(size, &msg);
+        const_buffer_group_t buffers;
+        for (write_buffer_t *p = msg.unsafe_expose_buffers()->head();
+             p != nullptr;
+             p = msg.unsafe_expose_buffers()->next(p)) {
+            buffers.add_buffer(p->size, p->data);
+        }
+        f.send_and_check(&msg, [&](write_message_t *) {
+            f.client.write_gathered(&buffers, &f.non_interruptor);
+        });
+    }
+    EXPECT_EQ(0u, f.client.get_write_buffer_bytes());
+
+    write_message_t msg;
+    fill_message(100000, &msg);
+    f.send_and_check(&msg, [&](write_message_t *m) {
+        for (write_buffer_t *p = m->unsafe_expose_buffers()->head();
+             p != nullptr;
+             p = m->unsafe_expose_buffers()->next(p)) {
+            f.client.write_buffered(p->data, p->size, &f.non_interruptor);
+        }
+        f.client.flush_buffer(&f.non_interruptor);
+    });
+    EXPECT_EQ(100000u, f.client.get_write_buffer_bytes());
+}
+
+// This is not really a unit test, but a micro benchmark that compares how many times
+// the bytes of a cluster message are copied on the way to the socket, and how fast
+// that is, when we flatten the message and buffer it (as we used to do for every
+// message) and when we write it straight from its serialization buffers. No need to
+// run this in debug mode.
+#ifdef NDEBUG
+TPTEST(RPCConnectivityTest, GatheredWriteBenchmark) {
+    gathered_write_fixture_t f;
+    scoped_array_t<char> sink(MEGABYTE);
+    for (size_t size : std::vector<size_t>{KILOBYTE, 64 * KILOBYTE, MEGABYTE}) {
+        const int num_messages = (256 * MEGABYTE) / size;
+        write_message_t msg;
+        fill_message(size, &msg);
+
+        for (bool gathered : {false, true}) {
+            cond_t read_done;
+            coro_t::spawn_sometime([&]() {
+                for (size_t left = size * num_messages; left > 0; ) {
+                    size_t chunk = std::min<size_t>(left, sink.size());
+                    f.server->read(sink.data(), chunk, &f.non_interruptor);
+                    left -= chunk;
+                }
+                read_done.pulse();
+            });
+            const uint64_t copied_before = f.client.get_write_buffer_bytes();
+            uint64_t flattened = 0;
+            ticks_t start_ticks = get_ticks();
+            for (int i = 0; i < num_messages; ++i) {
+                if (gathered) {
+                    const_buffer_group_t buffers;
+                    for (write_buffer_t *p = msg.unsafe_expose_buffers()->head();
+                         p != nullptr;
+                         p = msg.unsafe_expose_buffers()->next(p)) {
+                        buffers.add_buffer(p->size, p->data);
+                    }
+                    f.client.write_gathered(&buffers, &f.non_interruptor);
+                } else {
+                    vector_stream_t flat;
+                    flat.reserve(size);
+                    int res = send_write_message(&flat, &msg);
+                    guarantee(res == 0);
+                    flattened += flat.vector().size();
+                    f.client.write_buffered(
+                        flat.vector().data(), flat.vector().size(), &f.non_interruptor);
+                }
+            }
+            f.client.flush_buffer(&f.non_interruptor);
+            read_done.wait();
+            double secs = ticks_to_secs(get_ticks() - start_ticks);
+            const uint64_t copied =
+                flattened + (f.client.get_write_buffer_bytes() - copied_before);
+            printf("%8zu byte messages, %s: %.2f copies per byte, %.1f MB/s\n",
+                   size, gathered ? "gathered" : "buffered",
+                   static_cast<double>(copied) / (size * num_messages),
+                   (size * num_messages) / secs / MEGABYTE);
+        }
+    }
+}
+#endif  // NDEBUG
+
 /* `PeerIDSemantics` makes sure that `peer_id_t::is_nil()` works as expected. */
 TPTEST_MULTITHREAD(RPCConnectivityTest, PeerIDSemantics, 3) {
     peer_id_t nil_peer;
@@ -591,7 +975,7 @@ TPTEST(RPCConnectivityTest, CheckHeaders) {
     check_tcp_closed(&stream);
 }
 
-TPTEST(RPCConnectivityTest, DifferentVersion) {
+void run_version_refused_test(const std::string &bad_version_str) {
     // Set up a cluster node.
     connectivity_cluster_t c1;
     test_cluster_run_t cr1(&c1);
@@ -619,7 +1003,6 @@ TPTEST(RPCConnectivityTest, DifferentVersion) {
     ASSERT_TRUE(stream.is_read_open() && stream.is_write_open());
 
     // Send bad version
-    std::string bad_version_str("0.1.1b");
     write_message_t bad_version_msg;
     serialize<cluster_version_t::CLUSTER>(&bad_version_msg,
                                          bad_version_str.length());
@@ -640,6 +1023,14 @@ TPTEST(RPCConnectivityTest, DifferentVersion) {
     check_tcp_closed(&stream);
 }
 
+TPTEST(RPCConnectivityTest, DifferentVersion) {
+    run_version_refused_test("0.1.1b");
+}
+
+TPTEST(RPCConnectivityTest, PreviousVersion) {
+    run_version_refused_test("2.4.0");
+}
+
 TPTEST(RPCConnectivityTest, DifferentArch) {
     // Set up a cluster node.
     connectivity_cluster_t c1;
@@ -3,6 +3,8 @@
 
 #include "arch/timing.hpp"
 #include "clustering/administration/metadata.hpp"
+#include "concurrency/pmap.hpp"
+#include "containers/scoped.hpp"
 #include "unittest/clustering_utils.hpp"
 #include "unittest/dummy_metadata_controller.hpp"
 #include "unittest/unittest_utils.hpp"
@@ -177,4 +179,90 @@ TPTEST_MULTITHREAD(RPCMailboxTest, TypedMailbox, 3) {
     }
 }
 
+/* `InlineDelivery` sends a stream of messages from another server to mailboxes on every
+thread, both `INLINE` and `COROUTINE` ones, and makes sure they all arrive in order.
+Most of them have to be carried over to another thread in batches. */
+TPTEST_MULTITHREAD(RPCMailboxTest, InlineDelivery, 3) {
+    connectivity_cluster_t c1, c2;
+    mailbox_manager_t m1(&c1, 'M'), m2(&c2, 'M');
+    test_cluster_run_t r1(&c1);
+    test_cluster_run_t r2(&c2);
+    r1.join(get_cluster_local_address(&c2), 0);
+    let_stuff_happen();
+
+    const int num_messages = 1000;
+    std::vector<std::vector<int> > inboxes(2 * get_num_threads());
+    std::vector<scoped_ptr_t<mailbox_t<int> > > mailboxes(inboxes.size());
+    std::vector<mailbox_addr_t<int> > addrs(inboxes.size());
+    pmap(inboxes.size(), [&](int i) {
+        on_thread_t thread_switcher(threadnum_t(i / 2));
+        std::vector<int> *inbox = &inboxes[i];
+        mailboxes[i].init(new mailbox_t<int>(&m1,
+            [inbox](signal_t *, int message) {
+                inbox->push_back(message);
+            },
+            i % 2 == 0 ? mailbox_delivery_t::INLINE : mailbox_delivery_t::COROUTINE));
+        addrs[i] = mailboxes[i]->get_address();
+    });
+
+    for (int j = 0; j < num_messages; ++j) {
+        for (const mailbox_addr_t<int> &addr : addrs) {
+            send(&m2, addr, j);
+        }
+    }
+
+    for (int attempts = 0; attempts < 100; ++attempts) {
+        size_t total = 0;
+        for (size_t i = 0; i < inboxes.size(); ++i) {
+            on_thread_t thread_switcher(threadnum_t(i / 2));
+            total += inboxes[i].size();
+        }
+        if (total == inboxes.size() * num_messages) {
+            break;
+        }
+        nap(50);
+    }
+
+    pmap(inboxes.size(), [&](int i) {
+        on_thread_t thread_switcher(threadnum_t(i / 2));
+        ASSERT_EQ(static_cast<size_t>(num_messages), inboxes[i].size());
+        for (int j = 0; j < num_messages; ++j) {
+            EXPECT_EQ(j, inboxes[i][j]);
+        }
+        mailboxes[i].reset();
+    });
+}
+
+/* `ManyMailboxes` creates and destroys lots of mailboxes, so that the mailbox table
+has to grow and shrink, and checks that messages still find the right one. */
+TPTEST(RPCMailboxTest, ManyMailboxes) {
+    connectivity_cluster_t c;
+    mailbox_manager_t m(&c, 'M');
+    test_cluster_run_t r(&c);
+
+    std::vector<scoped_ptr_t<dummy_mailbox_t> > mailboxes(1000);
+    for (size_t i = 0; i < mailboxes.size(); ++i) {
+        mailboxes[i].init(new dummy_mailbox_t(&m));
+    }
+    // Destroy every other mailbox, and then replace them
+    for (size_t i = 0; i < mailboxes.size(); i += 2) {
+        mailboxes[i].reset();
+    }
+    for (size_t i = 0; i < mailboxes.size(); i += 4) {
+        mailboxes[i].init(new dummy_mailbox_t(&m));
+    }
+
+    for (size_t i = 0; i < mailboxes.size(); ++i) {
+        if (mailboxes[i].has()) {
+            send(&m, mailboxes[i]->mailbox.get_address(), static_cast<int>(i));
+        }
+    }
+    let_stuff_happen();
+    for (size_t i = 0; i < mailboxes.size(); ++i) {
+        if (mailboxes[i].has()) {
+            mailboxes[i]->expect(static_cast<int>(i));
+        }
+    }
+}
+
 }   /* namespace unittest */
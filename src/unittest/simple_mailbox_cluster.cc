@@ -32,6 +32,8 @@ struct simple_mailbox_cluster_t::simple_mailbox_cluster_state {
                                  0,
                                  ANY_PORT,
                                  0,
+                                 1,
+                                 0,
                                  heartbeat_manager.get_view(),
                                  auth_manager.get_view(),
                                  nullptr) {}
@@ -0,0 +1,26 @@
+// Copyright 2010-2016 RethinkDB, all rights reserved.
+#include "arch/runtime/coroutines.hpp"
+#include "arch/runtime/runtime.hpp"
+#include "config/args.hpp"
+#include "time.hpp"
+#include "unittest/gtest.hpp"
+#include "unittest/unittest_utils.hpp"
+
+namespace unittest {
+
+TPTEST(ThreadUtilizationTest, BusyThreadStandsOut, 3) {
+    // Keep thread 1 busy for several windows without ever returning to its event loop.
+    // Thread 2 has nothing to do in the meantime.
+    on_thread_t thread_switcher((threadnum_t(1)));
+    const ticks_t start = get_ticks();
+    while (get_ticks() - start < 3 * THREAD_UTILIZATION_WINDOW_MS * MILLION) { }
+
+    double busy = get_thread_utilization(threadnum_t(1));
+    double idle = get_thread_utilization(threadnum_t(2));
+    EXPECT_GE(busy, 0.5);
+    EXPECT_LE(busy, 1.0);
+    EXPECT_GE(idle, 0.0);
+    EXPECT_LT(idle, 0.5);
+}
+
+}  // namespace unittest
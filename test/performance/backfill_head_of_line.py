@@ -0,0 +1,78 @@
+#!/usr/bin/env python
+# Copyright 2010-2016 RethinkDB, all rights reserved.
+
+'''Measures the latency of reads that cross from one server to another, first while the
+cluster is idle and then while a big backfill is running between the same two servers.
+The reads are sent to the second server, but the table they read lives on the first, so
+their replies share the connection with the backfill chunks.  Without message classes
+in the cluster transport the replies queue up behind the chunks.'''
+
+import os
+import sys
+import time
+
+sys.path.append(os.path.abspath(os.path.join(os.path.dirname(__file__), os.path.pardir, 'common')))
+import driver, utils
+
+r = utils.import_python_driver()
+
+num_big_docs = 2000
+big_doc_size = 50000
+reads_per_phase = 1000
+
+def percentile(sorted_vals, p):
+    return sorted_vals[min(len(sorted_vals) - 1, int(len(sorted_vals) * p))]
+
+def measure(name, conn, table, keep_going=lambda: True):
+    latencies = []
+    while len(latencies) < reads_per_phase and keep_going():
+        start = time.time()
+        table.get(len(latencies) % 100).run(conn)
+        latencies.append(time.time() - start)
+    latencies.sort()
+    print("%-16s %5d reads: mean %.3f ms, p50 %.3f ms, p99 %.3f ms, max %.3f ms" % (
+        name,
+        len(latencies),
+        1000 * sum(latencies) / len(latencies),
+        1000 * percentile(latencies, 0.5),
+        1000 * percentile(latencies, 0.99),
+        1000 * latencies[-1]))
+
+def main():
+    executable_path = utils.find_rethinkdb_executable()
+    with driver.Cluster(initial_servers=['first', 'second'], output_folder='.',
+                        executable_path=executable_path, wait_until_ready=True) as cluster:
+        first, second = cluster[0], cluster[1]
+        conn = r.connect(host="localhost", port=second.driver_port)
+        if 'test' not in r.db_list().run(conn):
+            r.db_create('test').run(conn)
+        r.db('test').table_create('small').run(conn)
+        r.db('test').table_create('big').run(conn)
+        for name in ['small', 'big']:
+            r.db('test').table(name).config().update({'shards': [
+                {'primary_replica': first.name, 'replicas': [first.name]}
+            ]}).run(conn)
+        r.db('test').wait(wait_for="all_replicas_ready").run(conn)
+
+        small = r.db('test').table('small')
+        big = r.db('test').table('big')
+        small.insert([{'id': i} for i in range(100)]).run(conn)
+        padding = 'x' * big_doc_size
+        for i in range(0, num_big_docs, 100):
+            big.insert([{'id': j, 'padding': padding} for j in range(i, i + 100)],
+                       durability='soft').run(conn)
+
+        measure("idle", conn, small)
+
+        # Adding a replica on the second server makes the first one backfill the whole
+        # table to it.
+        big.config().update({'shards': [
+            {'primary_replica': first.name, 'replicas': [first.name, second.name]}
+        ]}).run(conn)
+        status_conn = r.connect(host="localhost", port=first.driver_port)
+        def backfilling():
+            return not big.status()['status']['all_replicas_ready'].run(status_conn)
+        measure("during backfill", conn, small, backfilling)
+
+if __name__ == "__main__":
+    main()
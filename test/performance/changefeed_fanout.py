@@ -0,0 +1,69 @@
+#!/usr/bin/env python
+# Copyright 2010-2016 RethinkDB, all rights reserved.
+
+'''Measures the latency of single-document writes while 1, 100 and 10000
+changefeeds are open on the table.  Half of the feeds are on the whole table and
+half of them filter on a field the writes never match, so this covers both sending
+changes to many feeds and filtering them out on the shard.'''
+
+import os
+import sys
+import time
+
+sys.path.append(os.path.abspath(os.path.join(os.path.dirname(__file__), os.path.pardir, 'common')))
+import driver, utils
+
+r = utils.import_python_driver()
+
+feed_counts = [1, 100, 10000]
+writes_per_count = 1000
+feeds_per_connection = 500
+
+def percentile(sorted_vals, p):
+    return sorted_vals[min(len(sorted_vals) - 1, int(len(sorted_vals) * p))]
+
+def measure(conn, table, num_feeds, driver_port):
+    feed_conns = []
+    feeds = []
+    for i in range(num_feeds):
+        if i % feeds_per_connection == 0:
+            feed_conns.append(r.connect(host="localhost", port=driver_port))
+        if i % 2 == 0:
+            query = table.changes()
+        else:
+            query = table.filter({'color': 'red'}).changes()
+        feeds.append(query.run(feed_conns[-1]))
+
+    latencies = []
+    for i in range(writes_per_count):
+        start = time.time()
+        table.get(i % 100).update({'value': i}, durability='soft').run(conn)
+        latencies.append(time.time() - start)
+    latencies.sort()
+
+    for feed in feeds:
+        feed.close()
+    for feed_conn in feed_conns:
+        feed_conn.close()
+
+    print("%6d feeds: mean %.3f ms, p50 %.3f ms, p99 %.3f ms" % (
+        num_feeds,
+        1000 * sum(latencies) / len(latencies),
+        1000 * percentile(latencies, 0.5),
+        1000 * percentile(latencies, 0.99)))
+
+def main():
+    executable_path = utils.find_rethinkdb_executable()
+    with driver.Process(name='./changefeed_fanout', executable_path=executable_path) as server:
+        conn = r.connect(host="localhost", port=server.driver_port)
+        if 'test' not in r.db_list().run(conn):
+            r.db_create('test').run(conn)
+        r.db('test').table_create('fanout').run(conn)
+        table = r.db('test').table('fanout')
+        table.insert([{'id': i, 'color': 'blue', 'value': 0} for i in range(100)]).run(conn)
+
+        for num_feeds in feed_counts:
+            measure(conn, table, num_feeds, server.driver_port)
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,65 @@
+#!/usr/bin/env python
+# Copyright 2010-2016 RethinkDB, all rights reserved.
+
+'''Measures write throughput into a single table created with 1 to 64 CPU shards
+(the `cpu_shards` option of `table_create`).  Several clients insert small documents
+with soft durability at the same time, so the server is limited by how many threads
+the table's stores can keep busy rather than by the disk.'''
+
+import os
+import sys
+import threading
+import time
+
+sys.path.append(os.path.abspath(os.path.join(os.path.dirname(__file__), os.path.pardir, 'common')))
+import driver, utils
+
+r = utils.import_python_driver()
+
+cpu_shard_counts = [1, 2, 4, 8, 16, 32, 64]
+num_clients = 32
+batch_size = 100
+seconds_per_count = 10
+
+def run_client(driver_port, table_name, client_id, stop_time, counts):
+    conn = r.connect(host="localhost", port=driver_port)
+    table = r.db('test').table(table_name)
+    written = 0
+    while time.time() < stop_time:
+        table.insert([{'client': client_id, 'n': written + i} for i in range(batch_size)],
+                     durability='soft').run(conn)
+        written += batch_size
+    counts[client_id] = written
+    conn.close()
+
+def measure(conn, driver_port, num_cpu_shards):
+    table_name = 'cpu_shards_%d' % num_cpu_shards
+    r.db('test').table_create(table_name, cpu_shards=num_cpu_shards).run(conn)
+    r.db('test').table(table_name).wait(wait_for='all_replicas_ready').run(conn)
+
+    counts = [0] * num_clients
+    start = time.time()
+    stop_time = start + seconds_per_count
+    threads = [threading.Thread(target=run_client,
+                                args=(driver_port, table_name, i, stop_time, counts))
+               for i in range(num_clients)]
+    for thread in threads:
+        thread.start()
+    for thread in threads:
+        thread.join()
+    elapsed = time.time() - start
+
+    print("%3d CPU shards: %8.0f writes/s" % (num_cpu_shards, sum(counts) / elapsed))
+    r.db('test').table_drop(table_name).run(conn)
+
+def main():
+    executable_path = utils.find_rethinkdb_executable()
+    with driver.Process(name='./cpu_shards_scaling', executable_path=executable_path) as server:
+        conn = r.connect(host="localhost", port=server.driver_port)
+        if 'test' not in r.db_list().run(conn):
+            r.db_create('test').run(conn)
+        for num_cpu_shards in cpu_shard_counts:
+            measure(conn, server.driver_port, num_cpu_shards)
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,80 @@
+#!/usr/bin/env python
+# Copyright 2010-2016 RethinkDB, all rights reserved.
+
+'''Measures how the metadata layer copes with many tables on a cluster of three servers.
+For 100 up to 20000 tables it reports how long it takes to create them, how long
+`table_list()` and a full read of `rethinkdb.table_status` take, how much CPU the
+servers use while nothing is happening, and how long a restarted server takes until
+all tables are ready again.  Every table has a single replica, so most servers only
+learn about most tables through the directory and the table metadata that the servers
+send each other.'''
+
+import os
+import sys
+import time
+
+sys.path.append(os.path.abspath(os.path.join(os.path.dirname(__file__), os.path.pardir, 'common')))
+import driver, utils
+
+r = utils.import_python_driver()
+
+table_counts = [100, 1000, 10000, 20000]
+create_batch_size = 100
+idle_seconds = 10
+
+def cpu_seconds(server):
+    # Fields 14 and 15 of `/proc/<pid>/stat` are the user and system time in clock ticks
+    with open('/proc/%d/stat' % server.pid) as stat_file:
+        fields = stat_file.read().rsplit(')', 1)[1].split()
+    return (int(fields[11]) + int(fields[12])) / float(os.sysconf('SC_CLK_TCK'))
+
+def timed(query, conn):
+    start = time.time()
+    query.run(conn)
+    return time.time() - start
+
+def create_tables(conn, first, last):
+    start = time.time()
+    for batch_start in range(first, last, create_batch_size):
+        batch_end = min(last, batch_start + create_batch_size)
+        r.expr(list(range(batch_start, batch_end))).for_each(
+            lambda i: r.db('test').table_create(r.add('many_', i.coerce_to('string')))
+        ).run(conn)
+    r.db('test').wait(wait_for='all_replicas_ready', timeout=3600).run(conn)
+    return time.time() - start
+
+def main():
+    executable_path = utils.find_rethinkdb_executable()
+    with driver.Cluster(initial_servers=['first', 'second', 'third'], output_folder='.',
+                        executable_path=executable_path, wait_until_ready=True) as cluster:
+        conn = r.connect(host="localhost", port=cluster[0].driver_port)
+        if 'test' not in r.db_list().run(conn):
+            r.db_create('test').run(conn)
+
+        num_tables = 0
+        for count in table_counts:
+            create_secs = create_tables(conn, num_tables, count)
+            num_tables = count
+
+            list_secs = timed(r.db('test').table_list(), conn)
+            status_secs = timed(r.db('rethinkdb').table('table_status').count(), conn)
+
+            cpu_before = [cpu_seconds(server) for server in cluster]
+            time.sleep(idle_seconds)
+            idle_cpu = max(cpu_seconds(server) - before
+                           for server, before in zip(cluster, cpu_before)) / idle_seconds
+
+            restarted = cluster[len(cluster) - 1]
+            restart_start = time.time()
+            restarted.stop()
+            restarted.start()
+            r.db('test').wait(wait_for='all_replicas_ready', timeout=3600).run(conn)
+            restart_secs = time.time() - restart_start
+
+            print("%5d tables: create %7.1fs, table_list %6.3fs, table_status %6.3fs, "
+                  "idle CPU %5.1f%%, restart %6.1fs" % (
+                      num_tables, create_secs, list_secs, status_secs,
+                      idle_cpu * 100, restart_secs))
+
+if __name__ == "__main__":
+    main()
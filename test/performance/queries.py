@@ -78,6 +78,10 @@ table_queries = [
         "query": "r.db('test').table(table['name']).eq_join('id', r.db('test').table(table['name'])).zip()",
         "tag": "eq_join_zip"
     },
+    {
+        "query": "r.db('test').table(table['name']).order_by(index='id').eq_join('id', r.db('test').table(table['name']), ordered=True)",
+        "tag": "eq_join_ordered"
+    },
     {
         "query": "r.db('test').table(table['name']).map(r.row['id'])",
         "tag": "map_id"
@@ -155,6 +159,26 @@ table_queries = [
     {
         "query": "r.db('test').table(table['name']).filter(r.expr(True)).count()",
         "tag": "filter-true-count"
+    },
+    {
+        "query": "r.db('test').table(table['name']).group('boolean').count()",
+        "tag": "group-low-cardinality-count"
+    },
+    {
+        "query": "r.db('test').table(table['name']).group('boolean').map(r.row['id']).reduce(lambda a, b: r.branch(a.gt(b), a, b))",
+        "tag": "group-low-cardinality-reduce"
+    },
+    {
+        "query": "r.db('test').table(table['name']).group('field0').count()",
+        "tag": "group-mid-cardinality-count"
+    },
+    {
+        "query": "r.db('test').table(table['name']).group('id').count()",
+        "tag": "group-high-cardinality-count"
+    },
+    {
+        "query": "r.db('test').table(table['name']).group(lambda doc: [doc['id'], doc['boolean']]).count()",
+        "tag": "group-high-cardinality-compound-count"
     }
 ]
 
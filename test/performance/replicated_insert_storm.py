@@ -0,0 +1,68 @@
+#!/usr/bin/env python
+# Copyright 2010-2016 RethinkDB, all rights reserved.
+
+'''Measures how many small documents per second a table with two replicas can take when
+many clients insert one document at a time.  Every insert is a separate write that the
+primary replica has to send to the secondary and wait for, so this is limited by the
+replication messages between the two servers rather than by the documents themselves.
+It runs with soft and hard durability and with more and more clients.'''
+
+import os
+import sys
+import threading
+import time
+
+sys.path.append(os.path.abspath(os.path.join(os.path.dirname(__file__), os.path.pardir, 'common')))
+import driver, utils
+
+r = utils.import_python_driver()
+
+client_counts = [1, 8, 32, 128]
+seconds_per_run = 10
+
+def run_client(driver_port, durability, client_id, stop_time, counts):
+    conn = r.connect(host="localhost", port=driver_port)
+    table = r.db('test').table('storm')
+    written = 0
+    while time.time() < stop_time:
+        table.insert({'client': client_id, 'n': written}, durability=durability).run(conn)
+        written += 1
+    counts[client_id] = written
+    conn.close()
+
+def measure(driver_port, durability, num_clients):
+    counts = [0] * num_clients
+    start = time.time()
+    stop_time = start + seconds_per_run
+    threads = [threading.Thread(target=run_client,
+                                args=(driver_port, durability, i, stop_time, counts))
+               for i in range(num_clients)]
+    for thread in threads:
+        thread.start()
+    for thread in threads:
+        thread.join()
+    elapsed = time.time() - start
+
+    print("%-4s durability, %3d clients: %8.0f inserts/s" % (
+        durability, num_clients, sum(counts) / elapsed))
+
+def main():
+    executable_path = utils.find_rethinkdb_executable()
+    with driver.Cluster(initial_servers=['first', 'second'], output_folder='.',
+                        executable_path=executable_path, wait_until_ready=True) as cluster:
+        first, second = cluster[0], cluster[1]
+        conn = r.connect(host="localhost", port=first.driver_port)
+        if 'test' not in r.db_list().run(conn):
+            r.db_create('test').run(conn)
+        r.db('test').table_create('storm').run(conn)
+        r.db('test').table('storm').config().update({'shards': [
+            {'primary_replica': first.name, 'replicas': [first.name, second.name]}
+        ]}).run(conn)
+        r.db('test').table('storm').wait(wait_for="all_replicas_ready").run(conn)
+
+        for durability in ['soft', 'hard']:
+            for num_clients in client_counts:
+                measure(first.driver_port, durability, num_clients)
+
+if __name__ == "__main__":
+    main()